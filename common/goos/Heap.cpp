@@ -0,0 +1,151 @@
+/*!
+ * @file Heap.cpp
+ * The heap that GOOS objects are allocated on. See Heap.h.
+ */
+
+#include <algorithm>
+#include <cassert>
+#include <mutex>
+#include "Heap.h"
+#include "Object.h"
+
+namespace goos {
+namespace {
+std::mutex g_lock;
+std::vector<GcRoots*> g_roots;
+
+#ifdef GOOS_GC_HEAP
+// Each thread links the objects it allocates into its own list, so allocating doesn't take a lock.
+// The lists are only walked by collect_garbage, when no other thread is using objects. They are
+// never freed, because a thread that exits may have left objects in its list, and neither is the
+// vector of them, so they stay reachable while static objects are destroyed at exit.
+struct ThreadObjects {
+  HeapObject* head = nullptr;
+  size_t count = 0;
+};
+
+std::vector<ThreadObjects*>& g_thread_objects = *new std::vector<ThreadObjects*>();
+thread_local ThreadObjects* t_objects = nullptr;
+
+ThreadObjects* thread_objects() {
+  if (!t_objects) {
+    t_objects = new ThreadObjects();
+    std::lock_guard<std::mutex> lock(g_lock);
+    g_thread_objects.push_back(t_objects);
+  }
+  return t_objects;
+}
+#endif
+}  // namespace
+
+#ifdef GOOS_GC_HEAP
+namespace heap {
+void add_object(HeapObject* obj) {
+  auto objects = thread_objects();
+  obj->gc_next = objects->head;
+  objects->head = obj;
+  objects->count++;
+}
+}  // namespace heap
+#endif
+
+void GcTracer::mark(const Object& obj) {
+  // the empty list is a single object which isn't on the heap, and the rest are stored inline.
+  if (obj.type >= ObjectType::SYMBOL && obj.type < ObjectType::INVALID) {
+    mark(obj.heap_obj.get());
+  }
+}
+
+void GcTracer::mark(const HeapObject* obj) {
+#ifdef GOOS_GC_HEAP
+  if (obj && !obj->gc_marked) {
+    const_cast<HeapObject*>(obj)->gc_marked = true;
+    m_stack.push_back(obj);
+  }
+#else
+  (void)obj;
+#endif
+}
+
+/*!
+ * Mark everything reachable from the objects marked so far.
+ */
+void GcTracer::trace_marked() {
+  while (!m_stack.empty()) {
+    auto obj = m_stack.back();
+    m_stack.pop_back();
+    obj->trace(*this);
+  }
+}
+
+GcRoots::GcRoots(std::function<void(GcTracer&)> trace, std::function<void()> before_free)
+    : m_trace(std::move(trace)), m_before_free(std::move(before_free)) {
+  std::lock_guard<std::mutex> lock(g_lock);
+  g_roots.push_back(this);
+}
+
+GcRoots::~GcRoots() {
+  std::lock_guard<std::mutex> lock(g_lock);
+  g_roots.erase(std::find(g_roots.begin(), g_roots.end(), this));
+}
+
+bool GcRoots::is_marked(const HeapObject* obj) {
+#ifdef GOOS_GC_HEAP
+  return obj->gc_marked;
+#else
+  (void)obj;
+  return true;
+#endif
+}
+
+size_t collect_garbage() {
+#ifdef GOOS_GC_HEAP
+  std::lock_guard<std::mutex> lock(g_lock);
+  GcTracer tracer;
+  for (auto roots : g_roots) {
+    roots->m_trace(tracer);
+    tracer.trace_marked();
+  }
+
+  for (auto roots : g_roots) {
+    if (roots->m_before_free) {
+      roots->m_before_free();
+    }
+  }
+
+  size_t freed = 0;
+  for (auto objects : g_thread_objects) {
+    HeapObject** link = &objects->head;
+    while (*link) {
+      auto obj = *link;
+      if (obj->gc_marked) {
+        obj->gc_marked = false;
+        link = &obj->gc_next;
+      } else {
+        *link = obj->gc_next;
+        delete obj;
+        objects->count--;
+        freed++;
+      }
+    }
+  }
+  return freed;
+#else
+  return 0;
+#endif
+}
+
+size_t heap_object_count() {
+#ifdef GOOS_GC_HEAP
+  std::lock_guard<std::mutex> lock(g_lock);
+  size_t count = 0;
+  for (auto objects : g_thread_objects) {
+    count += objects->count;
+  }
+  return count;
+#else
+  return 0;
+#endif
+}
+
+}  // namespace goos
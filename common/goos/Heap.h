@@ -0,0 +1,189 @@
+#pragma once
+
+/*!
+ * @file Heap.h
+ * The heap that GOOS objects are allocated on.
+ *
+ * By default, heap objects are reference counted with std::shared_ptr.
+ *
+ * When built with GOOS_GC_HEAP defined (the goos_gc library, or the GOOS_GC_HEAP CMake option),
+ * heap objects are instead referenced by plain pointers, and an Object is a 16 byte tagged value.
+ * Copying an Object never touches the object it refers to. Nothing is freed until
+ * collect_garbage() is called, which marks everything reachable from the registered GcRoots and
+ * frees the rest. Objects which are only referenced from C++ locals aren't roots, so collection is
+ * only safe at points where everything still needed is reachable from a root, like between the
+ * forms typed into a REPL. With the reference counted heap, collect_garbage() does nothing.
+ *
+ * Code which uses the as_<type> methods of Object, and HeapPtr and make_heap instead of
+ * std::shared_ptr and std::make_shared, works with either heap.
+ */
+
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace goos {
+
+class Object;
+class GcTracer;
+
+class HeapObject {
+ public:
+  virtual std::string print() const = 0;
+  virtual std::string inspect() const = 0;
+  /*!
+   * Mark each object this one refers to. Used by the collector, see GcTracer.
+   */
+  virtual void trace(GcTracer& tracer) const { (void)tracer; }
+  virtual ~HeapObject() = default;
+
+#ifdef GOOS_GC_HEAP
+  // the next object allocated by the same thread, and the mark bit for collect_garbage.
+  HeapObject* gc_next = nullptr;
+  bool gc_marked = false;
+#endif
+};
+
+#ifdef GOOS_GC_HEAP
+/*!
+ * A pointer to an object in the collected heap. Copying it doesn't do anything to the object, it
+ * just has the same interface as the std::shared_ptr it replaces.
+ */
+template <typename T>
+class GcPtr {
+ public:
+  GcPtr() = default;
+  GcPtr(std::nullptr_t) {}
+  explicit GcPtr(T* ptr) : m_ptr(ptr) {}
+  template <typename U, typename = std::enable_if_t<std::is_convertible<U*, T*>::value>>
+  GcPtr(const GcPtr<U>& other) : m_ptr(other.get()) {}
+
+  T* get() const { return m_ptr; }
+  T* operator->() const { return m_ptr; }
+  T& operator*() const { return *m_ptr; }
+  explicit operator bool() const { return m_ptr != nullptr; }
+  void reset() { m_ptr = nullptr; }
+
+  template <typename U>
+  bool operator==(const GcPtr<U>& other) const {
+    return m_ptr == other.get();
+  }
+  template <typename U>
+  bool operator!=(const GcPtr<U>& other) const {
+    return m_ptr != other.get();
+  }
+  bool operator==(std::nullptr_t) const { return m_ptr == nullptr; }
+  bool operator!=(std::nullptr_t) const { return m_ptr != nullptr; }
+
+ private:
+  T* m_ptr = nullptr;
+};
+
+template <typename T>
+using HeapPtr = GcPtr<T>;
+
+namespace heap {
+void add_object(HeapObject* obj);
+}
+
+/*!
+ * Allocate an object on the collected heap.
+ */
+template <typename T, typename... Args>
+HeapPtr<T> make_heap(Args&&... args) {
+  auto obj = new T(std::forward<Args>(args)...);
+  heap::add_object(obj);
+  return HeapPtr<T>(obj);
+}
+
+/*!
+ * Cast to a more specific type of heap object. The caller must already know the type.
+ */
+template <typename T, typename U>
+HeapPtr<T> heap_cast(const HeapPtr<U>& ptr) {
+  return HeapPtr<T>(static_cast<T*>(ptr.get()));
+}
+#else
+template <typename T>
+using HeapPtr = std::shared_ptr<T>;
+
+template <typename T, typename... Args>
+HeapPtr<T> make_heap(Args&&... args) {
+  return std::make_shared<T>(std::forward<Args>(args)...);
+}
+
+template <typename T, typename U>
+HeapPtr<T> heap_cast(const HeapPtr<U>& ptr) {
+  return std::static_pointer_cast<T>(ptr);
+}
+#endif
+
+/*!
+ * Marks objects as reachable during collect_garbage(). Objects are traced from a stack instead of
+ * recursively, so long lists don't overflow the C++ stack.
+ */
+class GcTracer {
+ public:
+  void mark(const Object& obj);
+  void mark(const HeapObject* obj);
+  template <typename T>
+  void mark(const HeapPtr<T>& obj) {
+    mark(static_cast<const HeapObject*>(obj.get()));
+  }
+
+ private:
+  friend size_t collect_garbage();
+  void trace_marked();
+  std::vector<const HeapObject*> m_stack;
+};
+
+/*!
+ * Registers objects that collect_garbage() must keep, for as long as this exists.
+ * trace is called to mark the roots. before_free, if set, is called after marking and before
+ * unmarked objects are freed, so things that refer to objects without keeping them (like the
+ * TextDb) can forget about the ones that are about to go away.
+ */
+class GcRoots {
+ public:
+  explicit GcRoots(std::function<void(GcTracer&)> trace,
+                   std::function<void()> before_free = nullptr);
+  ~GcRoots();
+  GcRoots(const GcRoots&) = delete;
+  GcRoots& operator=(const GcRoots&) = delete;
+
+  /*!
+   * Is this object going to be kept? Only meaningful in before_free.
+   */
+  static bool is_marked(const HeapObject* obj);
+
+ private:
+  friend size_t collect_garbage();
+  std::function<void(GcTracer&)> m_trace;
+  std::function<void()> m_before_free;
+};
+
+/*!
+ * Free all heap objects which can't be reached from a GcRoots. No other thread may be using GOOS
+ * objects while this runs. Returns the number of objects freed.
+ */
+size_t collect_garbage();
+
+/*!
+ * The number of objects on the collected heap, or 0 for the reference counted heap.
+ */
+size_t heap_object_count();
+
+}  // namespace goos
+
+#ifdef GOOS_GC_HEAP
+namespace std {
+template <typename T>
+struct hash<goos::GcPtr<T>> {
+  size_t operator()(const goos::GcPtr<T>& ptr) const { return std::hash<T*>()(ptr.get()); }
+};
+}  // namespace std
+#endif
@@ -8,7 +8,11 @@
 #include <third-party/fmt/core.h>
 
 namespace goos {
-Interpreter::Interpreter() {
+Interpreter::Interpreter()
+    : gc_roots([this](GcTracer& tracer) {
+        tracer.mark(global_environment);
+        tracer.mark(goal_env);
+      }) {
   // Interpreter startup:
   goal_to_goos.reset();
 
@@ -69,6 +73,18 @@ Interpreter::Interpreter() {
                    {"fmt", &Interpreter::eval_format},
                    {"error", &Interpreter::eval_error}};
 
+  // cache the forms and booleans on their symbols, so eval doesn't need to look up names.
+  for (auto& kv : special_forms) {
+    intern(kv.first).as_symbol()->special_form = s16(special_form_slots.size());
+    special_form_slots.push_back(kv.second);
+  }
+  for (auto& kv : builtin_forms) {
+    intern(kv.first).as_symbol()->builtin_form = s16(builtin_form_slots.size());
+    builtin_form_slots.push_back(kv.second);
+  }
+  intern("#t").as_symbol()->is_boolean = true;
+  intern("#f").as_symbol()->is_boolean = true;
+
   string_to_type = {{"empty-list", ObjectType::EMPTY_LIST},
                     {"integer", ObjectType::INTEGER},
                     {"float", ObjectType::FLOAT},
@@ -111,7 +127,7 @@ void Interpreter::load_goos_library() {
  * In env, set the variable named "name" to the value var.
  */
 void Interpreter::define_var_in_env(Object& env, Object& var, const std::string& name) {
-  env.as_env()->vars[intern(name).as_symbol()] = var;
+  env.as_env()->set(intern(name).as_symbol(), var);
 }
 
 /*!
@@ -153,21 +169,28 @@ void Interpreter::throw_eval_error(const Object& o, const std::string& err) {
  * evaluation error, there will be a print indicating there was an error in the evaluation of "obj",
  * and if possible what file/line "obj" comes from.
  */
-Object Interpreter::eval_with_rewind(const Object& obj,
-                                     const std::shared_ptr<EnvironmentObject>& env) {
+Object Interpreter::eval_with_rewind(const Object& obj, const HeapPtr<EnvironmentObject>& env) {
   Object result = EmptyListObject::make_new();
   try {
     result = eval(obj, env);
   } catch (std::runtime_error& e) {
-    if (!disable_printing) {
-      printf("-----------------------------------------\n");
-      printf("From object %s\nat %s\n", obj.inspect().c_str(), reader.db.get_info_for(obj).c_str());
-    }
+    print_error_context(obj);
     throw e;
   }
   return result;
 }
 
+/*!
+ * Print that there was an error in the evaluation of "obj", and if possible what file/line "obj"
+ * comes from.
+ */
+void Interpreter::print_error_context(const Object& obj) {
+  if (!disable_printing) {
+    printf("-----------------------------------------\n");
+    printf("From object %s\nat %s\n", obj.inspect().c_str(), reader.db.get_info_for(obj).c_str());
+  }
+}
+
 /*!
  * Sets dest to the global variable with the given name, if the variable exists.
  * Returns if the variable was found.
@@ -277,7 +300,7 @@ Arguments Interpreter::get_args(const Object& form, const Object& rest, const Ar
  *
  * Note that in varargs mode, all unnamed arguments are put in unnamed, not rest.
  */
-void Interpreter::eval_args(Arguments* args, const std::shared_ptr<EnvironmentObject>& env) {
+void Interpreter::eval_args(Arguments* args, const HeapPtr<EnvironmentObject>& env) {
   for (auto& arg : args->unnamed) {
     arg = eval_with_rewind(arg, env);
   }
@@ -317,6 +340,7 @@ ArgumentSpec Interpreter::parse_arg_spec(const Object& form, Object& rest) {
       }
 
       spec.rest = rest_name.as_symbol()->name;
+      spec.rest_symbol = rest_name.as_symbol();
 
       if (!current.as_pair()->cdr.is_empty_list()) {
         throw_eval_error(form, "rest must be the last argument");
@@ -363,6 +387,7 @@ ArgumentSpec Interpreter::parse_arg_spec(const Object& form, Object& rest) {
       }
     } else {
       spec.unnamed.push_back(arg.as_symbol()->name);
+      spec.unnamed_symbols.push_back(arg.as_symbol());
     }
 
     current = current.as_pair()->cdr;
@@ -427,16 +452,34 @@ void Interpreter::vararg_check(
  */
 Object Interpreter::eval_list_return_last(const Object& form,
                                           Object rest,
-                                          const std::shared_ptr<EnvironmentObject>& env) {
+                                          const HeapPtr<EnvironmentObject>& env) {
+  TailCall tail;
+  Object rv = eval_list_tail(form, std::move(rest), env, &tail);
+  return tail.pending ? eval_with_rewind(tail.form, tail.env) : rv;
+}
+
+/*!
+ * Evaluate all but the last form in a list. The last form is in tail position, and is returned
+ * in tail instead of being evaluated. An empty list evaluates to the empty list.
+ */
+Object Interpreter::eval_list_tail(const Object& form,
+                                   Object rest,
+                                   const HeapPtr<EnvironmentObject>& env,
+                                   TailCall* tail) {
   Object o = std::move(rest);
-  Object rv = EmptyListObject::make_new();
   for (;;) {
     if (o.is_pair()) {
       auto op = o.as_pair();
-      rv = eval_with_rewind(op->car, env);
+      if (op->cdr.is_empty_list()) {
+        tail->pending = true;
+        tail->form = op->car;
+        tail->env = env;
+        return Object();
+      }
+      eval_with_rewind(op->car, env);
       o = op->cdr;
     } else if (o.is_empty_list()) {
-      return rv;
+      return EmptyListObject::make_new();
     } else {
       throw_eval_error(form, "malformed body to evaluate");
     }
@@ -453,23 +496,67 @@ void Interpreter::expect_env(const Object& form, const Object& o) {
   }
 }
 
+namespace {
+/*!
+ * Count the depth of nested eval calls.
+ */
+class EvalDepthGuard {
+ public:
+  explicit EvalDepthGuard(int* depth) : m_depth(depth) { (*m_depth)++; }
+  ~EvalDepthGuard() { (*m_depth)--; }
+
+ private:
+  int* m_depth;
+};
+}  // namespace
+
 /*!
  * Highest-level evaluation dispatch.
+ * A form in tail position (the last form of a lambda body or cond case, or a macro expansion)
+ * replaces obj and env and goes around the loop again, so tail calls don't use the C++ stack.
+ * If a tail form has an error, it is printed like eval_with_rewind would. Only the innermost one
+ * is printed, because the tail forms before it are gone.
  */
-Object Interpreter::eval(Object obj, const std::shared_ptr<EnvironmentObject>& env) {
-  switch (obj.type) {
-    case ObjectType::SYMBOL:
-      return eval_symbol(obj, env);
-    case ObjectType::PAIR:
-      return eval_pair(obj, env);
-    case ObjectType::INTEGER:
-    case ObjectType::FLOAT:
-    case ObjectType::STRING:
-    case ObjectType::CHAR:
-      return obj;
-    default:
-      throw_eval_error(obj, "cannot evaluate this object");
-      return Object();
+Object Interpreter::eval(Object obj, const HeapPtr<EnvironmentObject>& env) {
+  EvalDepthGuard depth_guard(&eval_depth);
+  if (eval_depth > MAX_EVAL_DEPTH) {
+    throw_eval_error(obj, "evaluation is nested too deeply");
+  }
+
+  HeapPtr<EnvironmentObject> tail_env;
+  const HeapPtr<EnvironmentObject>* current_env = &env;
+  bool in_tail = false;  // is obj a tail form, not the form eval was called with?
+  for (;;) {
+    try {
+      switch (obj.type) {
+        case ObjectType::SYMBOL:
+          return eval_symbol(obj, *current_env);
+        case ObjectType::PAIR: {
+          TailCall tail;
+          Object result = eval_pair(obj, *current_env, &tail);
+          if (!tail.pending) {
+            return result;
+          }
+          obj = std::move(tail.form);
+          tail_env = std::move(tail.env);
+          current_env = &tail_env;
+          in_tail = true;
+        } break;
+        case ObjectType::INTEGER:
+        case ObjectType::FLOAT:
+        case ObjectType::STRING:
+        case ObjectType::CHAR:
+          return obj;
+        default:
+          throw_eval_error(obj, "cannot evaluate this object");
+          return Object();
+      }
+    } catch (std::runtime_error&) {
+      if (in_tail) {
+        print_error_context(obj);
+      }
+      throw;
+    }
   }
 }
 
@@ -479,38 +566,30 @@ namespace {
  * Try to find a symbol in an env or parent env. If successful, set dest and return true. Otherwise
  * return false.
  */
-bool try_symbol_lookup(const Object& sym,
-                       const std::shared_ptr<EnvironmentObject>& env,
-                       Object* dest) {
+bool try_symbol_lookup(const Object& sym, const HeapPtr<EnvironmentObject>& env, Object* dest) {
   // booleans are hard-coded here
-  if (sym.as_symbol()->name == "#t" || sym.as_symbol()->name == "#f") {
+  if (sym.as_symbol()->is_boolean) {
     *dest = sym;
     return true;
   }
 
   // loop up envs until we find it.
-  std::shared_ptr<EnvironmentObject> search_env = env;
-  for (;;) {
-    auto kv = search_env->vars.find(sym.as_symbol());
-    if (kv != search_env->vars.end()) {
-      *dest = kv->second;
+  auto symbol = sym.as_symbol();
+  for (auto search_env = env.get(); search_env; search_env = search_env->parent_env.get()) {
+    auto var = search_env->find(symbol);
+    if (var) {
+      *dest = *var;
       return true;
     }
-
-    auto pe = search_env->parent_env;
-    if (pe) {
-      search_env = pe;
-    } else {
-      return false;
-    }
   }
+  return false;
 }
 }  // namespace
 
 /*!
  * Evaluate a symbol by finding the closest scoped variable with matching name.
  */
-Object Interpreter::eval_symbol(const Object& sym, const std::shared_ptr<EnvironmentObject>& env) {
+Object Interpreter::eval_symbol(const Object& sym, const HeapPtr<EnvironmentObject>& env) {
   Object result;
   if (!try_symbol_lookup(sym, env, &result)) {
     throw_eval_error(sym, "symbol is not defined");
@@ -520,8 +599,11 @@ Object Interpreter::eval_symbol(const Object& sym, const std::shared_ptr<Environ
 
 /*!
  * Evaluate a pair, either as special form, builtin form, macro application, or lambda application.
+ * Lambda bodies, macro expansions and cond cases are returned in tail instead of being evaluated.
  */
-Object Interpreter::eval_pair(const Object& obj, const std::shared_ptr<EnvironmentObject>& env) {
+Object Interpreter::eval_pair(const Object& obj,
+                              const HeapPtr<EnvironmentObject>& env,
+                              TailCall* tail) {
   auto pair = obj.as_pair();
   Object head = pair->car;
   Object rest = pair->cdr;
@@ -531,18 +613,20 @@ Object Interpreter::eval_pair(const Object& obj, const std::shared_ptr<Environme
     auto head_sym = head.as_symbol();
 
     // try a special form first
-    auto kv_sf = special_forms.find(head_sym->name);
-    if (kv_sf != special_forms.end()) {
-      return ((*this).*(kv_sf->second))(obj, rest, env);
+    if (head_sym->special_form >= 0) {
+      auto special_form = special_form_slots[head_sym->special_form];
+      if (special_form == &Interpreter::eval_cond) {
+        return eval_cond_tail(obj, rest, env, tail);
+      }
+      return ((*this).*special_form)(obj, rest, env);
     }
 
     // try builtins next
-    auto kv_b = builtin_forms.find(head_sym->name);
-    if (kv_b != builtin_forms.end()) {
+    if (head_sym->builtin_form >= 0) {
       Arguments args = get_args(obj, rest, make_varargs());
       // all "built-in" forms expect arguments to be evaluated (that's why they aren't special)
       eval_args(&args, env);
-      return ((*this).*(kv_b->second))(obj, args, env);
+      return ((*this).*(builtin_form_slots[head_sym->builtin_form]))(obj, args, env);
     }
 
     // try macros next
@@ -551,12 +635,15 @@ Object Interpreter::eval_pair(const Object& obj, const std::shared_ptr<Environme
       auto macro = macro_obj.as_macro();
       Arguments args = get_args(obj, rest, macro->args);
 
-      auto mac_env_obj = EnvironmentObject::make_new();
+      // not 100% clear that the parent env is right
+      auto mac_env_obj = EnvironmentObject::make_frame(env, macro->args.frame_size());
       auto mac_env = mac_env_obj.as_env();
-      mac_env->parent_env = env;  // not 100% clear that this is right
       set_args_in_env(obj, args, macro->args, mac_env);
-      // expand the macro!
-      return eval_with_rewind(eval_list_return_last(macro->body, macro->body, mac_env), env);
+      // expand the macro, and evaluate the expansion as a tail call.
+      tail->pending = true;
+      tail->form = eval_list_return_last(macro->body, macro->body, mac_env);
+      tail->env = env;
+      return Object();
     }
   }
 
@@ -569,11 +656,10 @@ Object Interpreter::eval_pair(const Object& obj, const std::shared_ptr<Environme
   auto lam = eval_head.as_lambda();
   Arguments args = get_args(obj, rest, lam->args);
   eval_args(&args, env);
-  auto lam_env_obj = EnvironmentObject::make_new();
+  auto lam_env_obj = EnvironmentObject::make_frame(lam->parent_env, lam->args.frame_size());
   auto lam_env = lam_env_obj.as_env();
-  lam_env->parent_env = lam->parent_env;
   set_args_in_env(obj, args, lam->args, lam_env);
-  return eval_list_return_last(lam->body, lam->body, lam_env);
+  return eval_list_tail(lam->body, lam->body, lam_env, tail);
 }
 
 /*!
@@ -583,7 +669,7 @@ Object Interpreter::eval_pair(const Object& obj, const std::shared_ptr<Environme
 void Interpreter::set_args_in_env(const Object& form,
                                   const Arguments& args,
                                   const ArgumentSpec& arg_spec,
-                                  const std::shared_ptr<EnvironmentObject>& env) {
+                                  const HeapPtr<EnvironmentObject>& env) {
   if (arg_spec.rest.empty() && args.unnamed.size() != arg_spec.unnamed.size()) {
     throw_eval_error(form, "did not get the expected number of unnamed arguments (got " +
                                std::to_string(args.unnamed.size()) + ", expected " +
@@ -595,19 +681,22 @@ void Interpreter::set_args_in_env(const Object& form,
   }
 
   // unnamed args
+  bool have_symbols = arg_spec.unnamed_symbols.size() == arg_spec.unnamed.size();
   for (size_t i = 0; i < arg_spec.unnamed.size(); i++) {
-    env->vars[intern(arg_spec.unnamed.at(i)).as_symbol()] = args.unnamed.at(i);
+    env->set(have_symbols ? arg_spec.unnamed_symbols[i] : intern(arg_spec.unnamed[i]).as_symbol(),
+             args.unnamed.at(i));
   }
 
   // named args
   for (const auto& kv : arg_spec.named) {
-    env->vars[intern(kv.first).as_symbol()] = args.named.at(kv.first);
+    env->set(intern(kv.first).as_symbol(), args.named.at(kv.first));
   }
 
   // rest args
   if (!arg_spec.rest.empty()) {
     // will correctly handle the '() case
-    env->vars[intern(arg_spec.rest).as_symbol()] = build_list(args.rest);
+    env->set(arg_spec.rest_symbol ? arg_spec.rest_symbol : intern(arg_spec.rest).as_symbol(),
+             build_list(args.rest));
   } else {
     if (!args.rest.empty()) {
       throw_eval_error(form, "got too many arguments");
@@ -620,7 +709,7 @@ void Interpreter::set_args_in_env(const Object& form,
  */
 Object Interpreter::eval_define(const Object& form,
                                 const Object& rest,
-                                const std::shared_ptr<EnvironmentObject>& env) {
+                                const HeapPtr<EnvironmentObject>& env) {
   auto args = get_args(form, rest, make_varargs());
   vararg_check(form, args, {ObjectType::SYMBOL, {}}, {{"env", {false, {}}}});
 
@@ -632,7 +721,7 @@ Object Interpreter::eval_define(const Object& form,
   }
 
   Object value = eval_with_rewind(args.unnamed[1], env);
-  define_env->vars[args.unnamed[0].as_symbol()] = value;
+  define_env->set(args.unnamed[0].as_symbol(), value);
   return value;
 }
 
@@ -642,27 +731,22 @@ Object Interpreter::eval_define(const Object& form,
  */
 Object Interpreter::eval_set(const Object& form,
                              const Object& rest,
-                             const std::shared_ptr<EnvironmentObject>& env) {
+                             const HeapPtr<EnvironmentObject>& env) {
   auto args = get_args(form, rest, make_varargs());
   vararg_check(form, args, {ObjectType::SYMBOL, {}}, {});
   auto to_define = args.unnamed.at(0);
   Object to_set = eval_with_rewind(args.unnamed.at(1), env);
 
-  std::shared_ptr<EnvironmentObject> search_env = env;
-  for (;;) {
-    auto kv = search_env->vars.find(to_define.as_symbol());
-    if (kv != search_env->vars.end()) {
-      kv->second = to_set;
-      return kv->second;
-    }
-
-    auto pe = search_env->parent_env;
-    if (pe) {
-      search_env = pe;
-    } else {
-      throw_eval_error(to_define, "symbol is not defined");
+  auto symbol = to_define.as_symbol();
+  for (auto search_env = env.get(); search_env; search_env = search_env->parent_env.get()) {
+    auto var = search_env->find(symbol);
+    if (var) {
+      *var = to_set;
+      return *var;
     }
   }
+  throw_eval_error(to_define, "symbol is not defined");
+  return Object();
 }
 
 /*!
@@ -670,7 +754,7 @@ Object Interpreter::eval_set(const Object& form,
  */
 Object Interpreter::eval_lambda(const Object& form,
                                 const Object& rest,
-                                const std::shared_ptr<EnvironmentObject>& env) {
+                                const HeapPtr<EnvironmentObject>& env) {
   if (!rest.is_pair()) {
     throw_eval_error(form, "lambda must receive two arguments");
   }
@@ -699,7 +783,7 @@ Object Interpreter::eval_lambda(const Object& form,
  */
 Object Interpreter::eval_macro(const Object& form,
                                const Object& rest,
-                               const std::shared_ptr<EnvironmentObject>& env) {
+                               const HeapPtr<EnvironmentObject>& env) {
   if (!rest.is_pair()) {
     throw_eval_error(form, "macro must receive two arguments");
   }
@@ -728,7 +812,7 @@ Object Interpreter::eval_macro(const Object& form,
  */
 Object Interpreter::eval_quote(const Object& form,
                                const Object& rest,
-                               const std::shared_ptr<EnvironmentObject>& env) {
+                               const HeapPtr<EnvironmentObject>& env) {
   (void)env;
   auto args = get_args(form, rest, make_varargs());
   vararg_check(form, args, {{}}, {});
@@ -738,8 +822,7 @@ Object Interpreter::eval_quote(const Object& form,
 /*!
  * Recursive quasi-quote evaluation
  */
-Object Interpreter::quasiquote_helper(const Object& form,
-                                      const std::shared_ptr<EnvironmentObject>& env) {
+Object Interpreter::quasiquote_helper(const Object& form, const HeapPtr<EnvironmentObject>& env) {
   Object lst = form;
   std::vector<Object> result;
   for (;;) {
@@ -798,7 +881,7 @@ Object Interpreter::quasiquote_helper(const Object& form,
  */
 Object Interpreter::eval_quasiquote(const Object& form,
                                     const Object& rest,
-                                    const std::shared_ptr<EnvironmentObject>& env) {
+                                    const HeapPtr<EnvironmentObject>& env) {
   if (rest.type != ObjectType::PAIR || rest.as_pair()->cdr.type != ObjectType::EMPTY_LIST)
     throw_eval_error(form, "quasiquote must have one argument!");
   return quasiquote_helper(rest.as_pair()->car, env);
@@ -813,7 +896,19 @@ bool Interpreter::truthy(const Object& o) {
  */
 Object Interpreter::eval_cond(const Object& form,
                               const Object& rest,
-                              const std::shared_ptr<EnvironmentObject>& env) {
+                              const HeapPtr<EnvironmentObject>& env) {
+  TailCall tail;
+  Object result = eval_cond_tail(form, rest, env, &tail);
+  return tail.pending ? eval_with_rewind(tail.form, tail.env) : result;
+}
+
+/*!
+ * Scheme "cond" statement, with the last form of the matching case returned in tail.
+ */
+Object Interpreter::eval_cond_tail(const Object& form,
+                                   const Object& rest,
+                                   const HeapPtr<EnvironmentObject>& env,
+                                   TailCall* tail) {
   if (rest.type != ObjectType::PAIR)
     throw_eval_error(form, "cond must have at least one clause, which must be a form");
   Object result;
@@ -832,7 +927,7 @@ Object Interpreter::eval_cond(const Object& form,
           return condition_result;
         }
         // got a match!
-        return eval_list_return_last(current_case, current_case.as_pair()->cdr, env);
+        return eval_list_tail(current_case, current_case.as_pair()->cdr, env, tail);
       } else {
         // no match, continue.
         lst = lst.as_pair()->cdr;
@@ -850,7 +945,7 @@ Object Interpreter::eval_cond(const Object& form,
  */
 Object Interpreter::eval_or(const Object& form,
                             const Object& rest,
-                            const std::shared_ptr<EnvironmentObject>& env) {
+                            const HeapPtr<EnvironmentObject>& env) {
   if (rest.type != ObjectType::PAIR) {
     throw_eval_error(form, "or must have at least one argument!");
   }
@@ -876,7 +971,7 @@ Object Interpreter::eval_or(const Object& form,
  */
 Object Interpreter::eval_and(const Object& form,
                              const Object& rest,
-                             const std::shared_ptr<EnvironmentObject>& env) {
+                             const HeapPtr<EnvironmentObject>& env) {
   if (rest.type != ObjectType::PAIR) {
     throw_eval_error(form, "and must have at least one argument!");
   }
@@ -899,11 +994,11 @@ Object Interpreter::eval_and(const Object& form,
 }
 
 /*!
- * Cheating "while loop" because we do not have tail recursion optimization yet.
+ * "while loop". This could be written with tail calls now, but a C++ loop is faster.
  */
 Object Interpreter::eval_while(const Object& form,
                                const Object& rest,
-                               const std::shared_ptr<EnvironmentObject>& env) {
+                               const HeapPtr<EnvironmentObject>& env) {
   if (rest.type != ObjectType::PAIR) {
     throw_eval_error(form, "while must have condition and body");
   }
@@ -927,7 +1022,7 @@ Object Interpreter::eval_while(const Object& form,
  */
 Object Interpreter::eval_exit(const Object& form,
                               Arguments& args,
-                              const std::shared_ptr<EnvironmentObject>& env) {
+                              const HeapPtr<EnvironmentObject>& env) {
   (void)form;
   (void)args;
   (void)env;
@@ -940,7 +1035,7 @@ Object Interpreter::eval_exit(const Object& form,
  */
 Object Interpreter::eval_begin(const Object& form,
                                Arguments& args,
-                               const std::shared_ptr<EnvironmentObject>& env) {
+                               const HeapPtr<EnvironmentObject>& env) {
   (void)env;
   if (!args.named.empty()) {
     throw_eval_error(form, "begin form cannot have keyword arguments");
@@ -958,7 +1053,7 @@ Object Interpreter::eval_begin(const Object& form,
  */
 Object Interpreter::eval_read(const Object& form,
                               Arguments& args,
-                              const std::shared_ptr<EnvironmentObject>& env) {
+                              const HeapPtr<EnvironmentObject>& env) {
   (void)env;
   vararg_check(form, args, {ObjectType::STRING}, {});
 
@@ -976,7 +1071,7 @@ Object Interpreter::eval_read(const Object& form,
  */
 Object Interpreter::eval_read_file(const Object& form,
                                    Arguments& args,
-                                   const std::shared_ptr<EnvironmentObject>& env) {
+                                   const HeapPtr<EnvironmentObject>& env) {
   (void)env;
   vararg_check(form, args, {ObjectType::STRING}, {});
 
@@ -993,7 +1088,7 @@ Object Interpreter::eval_read_file(const Object& form,
  */
 Object Interpreter::eval_load_file(const Object& form,
                                    Arguments& args,
-                                   const std::shared_ptr<EnvironmentObject>& env) {
+                                   const HeapPtr<EnvironmentObject>& env) {
   (void)env;
   vararg_check(form, args, {ObjectType::STRING}, {});
 
@@ -1018,7 +1113,7 @@ Object Interpreter::eval_load_file(const Object& form,
  */
 Object Interpreter::eval_print(const Object& form,
                                Arguments& args,
-                               const std::shared_ptr<EnvironmentObject>& env) {
+                               const HeapPtr<EnvironmentObject>& env) {
   (void)env;
   vararg_check(form, args, {{}}, {});
 
@@ -1034,7 +1129,7 @@ Object Interpreter::eval_print(const Object& form,
  */
 Object Interpreter::eval_inspect(const Object& form,
                                  Arguments& args,
-                                 const std::shared_ptr<EnvironmentObject>& env) {
+                                 const HeapPtr<EnvironmentObject>& env) {
   (void)env;
   vararg_check(form, args, {{}}, {});
 
@@ -1050,7 +1145,7 @@ Object Interpreter::eval_inspect(const Object& form,
  */
 Object Interpreter::eval_equals(const Object& form,
                                 Arguments& args,
-                                const std::shared_ptr<EnvironmentObject>& env) {
+                                const HeapPtr<EnvironmentObject>& env) {
   (void)env;
   vararg_check(form, args, {{}, {}}, {});
   return SymbolObject::make_new(reader.symbolTable,
@@ -1109,7 +1204,7 @@ IntType Interpreter::number(const Object& obj) {
 template <typename T>
 Object Interpreter::num_plus(const Object& form,
                              Arguments& args,
-                             const std::shared_ptr<EnvironmentObject>& env) {
+                             const HeapPtr<EnvironmentObject>& env) {
   (void)env;
   (void)form;
   T result = 0;
@@ -1124,7 +1219,7 @@ Object Interpreter::num_plus(const Object& form,
  */
 Object Interpreter::eval_plus(const Object& form,
                               Arguments& args,
-                              const std::shared_ptr<EnvironmentObject>& env) {
+                              const HeapPtr<EnvironmentObject>& env) {
   if (!args.named.empty() || args.unnamed.empty()) {
     throw_eval_error(form, "+ must receive at least one unnamed argument!");
   }
@@ -1148,7 +1243,7 @@ Object Interpreter::eval_plus(const Object& form,
 template <typename T>
 Object Interpreter::num_times(const Object& form,
                               Arguments& args,
-                              const std::shared_ptr<EnvironmentObject>& env) {
+                              const HeapPtr<EnvironmentObject>& env) {
   (void)env;
   (void)form;
   T result = 1;
@@ -1163,7 +1258,7 @@ Object Interpreter::num_times(const Object& form,
  */
 Object Interpreter::eval_times(const Object& form,
                                Arguments& args,
-                               const std::shared_ptr<EnvironmentObject>& env) {
+                               const HeapPtr<EnvironmentObject>& env) {
   if (!args.named.empty() || args.unnamed.empty()) {
     throw_eval_error(form, "* must receive at least one unnamed argument!");
   }
@@ -1187,7 +1282,7 @@ Object Interpreter::eval_times(const Object& form,
 template <typename T>
 Object Interpreter::num_minus(const Object& form,
                               Arguments& args,
-                              const std::shared_ptr<EnvironmentObject>& env) {
+                              const HeapPtr<EnvironmentObject>& env) {
   (void)env;
   (void)form;
   T result;
@@ -1207,7 +1302,7 @@ Object Interpreter::num_minus(const Object& form,
  */
 Object Interpreter::eval_minus(const Object& form,
                                Arguments& args,
-                               const std::shared_ptr<EnvironmentObject>& env) {
+                               const HeapPtr<EnvironmentObject>& env) {
   if (!args.named.empty() || args.unnamed.empty()) {
     throw_eval_error(form, "- must receive at least one unnamed argument!");
   }
@@ -1231,7 +1326,7 @@ Object Interpreter::eval_minus(const Object& form,
 template <typename T>
 Object Interpreter::num_divide(const Object& form,
                                Arguments& args,
-                               const std::shared_ptr<EnvironmentObject>& env) {
+                               const HeapPtr<EnvironmentObject>& env) {
   (void)env;
   (void)form;
   T result = number<T>(args.unnamed[0]) / number<T>(args.unnamed[1]);
@@ -1243,7 +1338,7 @@ Object Interpreter::num_divide(const Object& form,
  */
 Object Interpreter::eval_divide(const Object& form,
                                 Arguments& args,
-                                const std::shared_ptr<EnvironmentObject>& env) {
+                                const HeapPtr<EnvironmentObject>& env) {
   vararg_check(form, args, {{}, {}}, {});
   switch (args.unnamed.front().type) {
     case ObjectType::INTEGER:
@@ -1263,7 +1358,7 @@ Object Interpreter::eval_divide(const Object& form,
  */
 Object Interpreter::eval_numequals(const Object& form,
                                    Arguments& args,
-                                   const std::shared_ptr<EnvironmentObject>& env) {
+                                   const HeapPtr<EnvironmentObject>& env) {
   (void)env;
   if (!args.named.empty() || args.unnamed.size() < 2) {
     throw_eval_error(form, "= must receive at least two unnamed arguments!");
@@ -1302,7 +1397,7 @@ Object Interpreter::eval_numequals(const Object& form,
 template <typename T>
 Object Interpreter::num_lt(const Object& form,
                            Arguments& args,
-                           const std::shared_ptr<EnvironmentObject>& env) {
+                           const HeapPtr<EnvironmentObject>& env) {
   (void)form;
   (void)env;
   T a = number<T>(args.unnamed[0]);
@@ -1312,7 +1407,7 @@ Object Interpreter::num_lt(const Object& form,
 
 Object Interpreter::eval_lt(const Object& form,
                             Arguments& args,
-                            const std::shared_ptr<EnvironmentObject>& env) {
+                            const HeapPtr<EnvironmentObject>& env) {
   vararg_check(form, args, {{}, {}}, {});
   switch (args.unnamed.front().type) {
     case ObjectType::INTEGER:
@@ -1330,7 +1425,7 @@ Object Interpreter::eval_lt(const Object& form,
 template <typename T>
 Object Interpreter::num_gt(const Object& form,
                            Arguments& args,
-                           const std::shared_ptr<EnvironmentObject>& env) {
+                           const HeapPtr<EnvironmentObject>& env) {
   (void)form;
   (void)env;
   T a = number<T>(args.unnamed[0]);
@@ -1340,7 +1435,7 @@ Object Interpreter::num_gt(const Object& form,
 
 Object Interpreter::eval_gt(const Object& form,
                             Arguments& args,
-                            const std::shared_ptr<EnvironmentObject>& env) {
+                            const HeapPtr<EnvironmentObject>& env) {
   vararg_check(form, args, {{}, {}}, {});
   switch (args.unnamed.front().type) {
     case ObjectType::INTEGER:
@@ -1358,7 +1453,7 @@ Object Interpreter::eval_gt(const Object& form,
 template <typename T>
 Object Interpreter::num_leq(const Object& form,
                             Arguments& args,
-                            const std::shared_ptr<EnvironmentObject>& env) {
+                            const HeapPtr<EnvironmentObject>& env) {
   (void)form;
   (void)env;
   T a = number<T>(args.unnamed[0]);
@@ -1368,7 +1463,7 @@ Object Interpreter::num_leq(const Object& form,
 
 Object Interpreter::eval_leq(const Object& form,
                              Arguments& args,
-                             const std::shared_ptr<EnvironmentObject>& env) {
+                             const HeapPtr<EnvironmentObject>& env) {
   vararg_check(form, args, {{}, {}}, {});
   switch (args.unnamed.front().type) {
     case ObjectType::INTEGER:
@@ -1386,7 +1481,7 @@ Object Interpreter::eval_leq(const Object& form,
 template <typename T>
 Object Interpreter::num_geq(const Object& form,
                             Arguments& args,
-                            const std::shared_ptr<EnvironmentObject>& env) {
+                            const HeapPtr<EnvironmentObject>& env) {
   (void)form;
   (void)env;
   T a = number<T>(args.unnamed[0]);
@@ -1396,7 +1491,7 @@ Object Interpreter::num_geq(const Object& form,
 
 Object Interpreter::eval_geq(const Object& form,
                              Arguments& args,
-                             const std::shared_ptr<EnvironmentObject>& env) {
+                             const HeapPtr<EnvironmentObject>& env) {
   vararg_check(form, args, {{}, {}}, {});
   switch (args.unnamed.front().type) {
     case ObjectType::INTEGER:
@@ -1413,14 +1508,14 @@ Object Interpreter::eval_geq(const Object& form,
 
 Object Interpreter::eval_eval(const Object& form,
                               Arguments& args,
-                              const std::shared_ptr<EnvironmentObject>& env) {
+                              const HeapPtr<EnvironmentObject>& env) {
   vararg_check(form, args, {{}}, {});
   return eval(args.unnamed[0], env);
 }
 
 Object Interpreter::eval_car(const Object& form,
                              Arguments& args,
-                             const std::shared_ptr<EnvironmentObject>& env) {
+                             const HeapPtr<EnvironmentObject>& env) {
   (void)env;
   vararg_check(form, args, {ObjectType::PAIR}, {});
   return args.unnamed[0].as_pair()->car;
@@ -1428,7 +1523,7 @@ Object Interpreter::eval_car(const Object& form,
 
 Object Interpreter::eval_set_car(const Object& form,
                                  Arguments& args,
-                                 const std::shared_ptr<EnvironmentObject>& env) {
+                                 const HeapPtr<EnvironmentObject>& env) {
   (void)env;
   vararg_check(form, args, {ObjectType::PAIR, {}}, {});
   args.unnamed[0].as_pair()->car = args.unnamed[1];
@@ -1437,7 +1532,7 @@ Object Interpreter::eval_set_car(const Object& form,
 
 Object Interpreter::eval_set_cdr(const Object& form,
                                  Arguments& args,
-                                 const std::shared_ptr<EnvironmentObject>& env) {
+                                 const HeapPtr<EnvironmentObject>& env) {
   (void)env;
   vararg_check(form, args, {ObjectType::PAIR, {}}, {});
   args.unnamed[0].as_pair()->cdr = args.unnamed[1];
@@ -1446,7 +1541,7 @@ Object Interpreter::eval_set_cdr(const Object& form,
 
 Object Interpreter::eval_cdr(const Object& form,
                              Arguments& args,
-                             const std::shared_ptr<EnvironmentObject>& env) {
+                             const HeapPtr<EnvironmentObject>& env) {
   (void)env;
   vararg_check(form, args, {ObjectType::PAIR}, {});
   return args.unnamed[0].as_pair()->cdr;
@@ -1454,7 +1549,7 @@ Object Interpreter::eval_cdr(const Object& form,
 
 Object Interpreter::eval_gensym(const Object& form,
                                 Arguments& args,
-                                const std::shared_ptr<EnvironmentObject>& env) {
+                                const HeapPtr<EnvironmentObject>& env) {
   (void)env;
   vararg_check(form, args, {}, {});
   return SymbolObject::make_new(reader.symbolTable, "gensym" + std::to_string(gensym_id++));
@@ -1462,7 +1557,7 @@ Object Interpreter::eval_gensym(const Object& form,
 
 Object Interpreter::eval_cons(const Object& form,
                               Arguments& args,
-                              const std::shared_ptr<EnvironmentObject>& env) {
+                              const HeapPtr<EnvironmentObject>& env) {
   (void)env;
   vararg_check(form, args, {{}, {}}, {});
   return PairObject::make_new(args.unnamed[0], args.unnamed[1]);
@@ -1470,7 +1565,7 @@ Object Interpreter::eval_cons(const Object& form,
 
 Object Interpreter::eval_null(const Object& form,
                               Arguments& args,
-                              const std::shared_ptr<EnvironmentObject>& env) {
+                              const HeapPtr<EnvironmentObject>& env) {
   (void)env;
   vararg_check(form, args, {{}}, {});
   return SymbolObject::make_new(reader.symbolTable, args.unnamed[0].is_empty_list() ? "#t" : "#f");
@@ -1478,7 +1573,7 @@ Object Interpreter::eval_null(const Object& form,
 
 Object Interpreter::eval_type(const Object& form,
                               Arguments& args,
-                              const std::shared_ptr<EnvironmentObject>& env) {
+                              const HeapPtr<EnvironmentObject>& env) {
   (void)env;
   vararg_check(form, args, {{ObjectType::SYMBOL}, {}}, {});
 
@@ -1496,7 +1591,7 @@ Object Interpreter::eval_type(const Object& form,
 
 Object Interpreter::eval_current_method_type(const Object& form,
                                              Arguments& args,
-                                             const std::shared_ptr<EnvironmentObject>& env) {
+                                             const HeapPtr<EnvironmentObject>& env) {
   (void)env;
   vararg_check(form, args, {}, {});
   return SymbolObject::make_new(reader.symbolTable, goal_to_goos.enclosing_method_type);
@@ -1504,7 +1599,7 @@ Object Interpreter::eval_current_method_type(const Object& form,
 
 Object Interpreter::eval_format(const Object& form,
                                 Arguments& args,
-                                const std::shared_ptr<EnvironmentObject>& env) {
+                                const HeapPtr<EnvironmentObject>& env) {
   (void)env;
   if (args.unnamed.size() < 2) {
     throw_eval_error(form, "format must get at least two arguments");
@@ -1545,7 +1640,7 @@ Object Interpreter::eval_format(const Object& form,
 
 Object Interpreter::eval_error(const Object& form,
                                Arguments& args,
-                               const std::shared_ptr<EnvironmentObject>& env) {
+                               const HeapPtr<EnvironmentObject>& env) {
   (void)env;
   vararg_check(form, args, {ObjectType::STRING}, {});
   throw_eval_error(form, "Error: " + args.unnamed.at(0).as_string()->data);
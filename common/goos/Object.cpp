@@ -4,8 +4,8 @@
  * There are different types of objects, as represented by ObjectType.
  * An "Object" is an efficient wrapper around any of these types.
  * Some types are "heap allocated", and have reference semantics, and others are
- * "fixed" and have value semantics.  Heap allocated objects implement reference counting with
- * std::shared_ptr.
+ * "fixed" and have value semantics.  Heap allocated objects are reference counted with
+ * std::shared_ptr, or collected by a mark-sweep collector, see Heap.h.
  *
  * To create a new Object for a heap allocated type, use the make_new static method of the type of
  * object you want to make. This will return a correctly setup Object. For fixed objects, use
@@ -43,9 +43,16 @@
 
 namespace goos {
 
-std::shared_ptr<EmptyListObject> gEmptyList = nullptr;
-std::shared_ptr<EmptyListObject>& get_empty_list() {
-  return gEmptyList;
+HeapPtr<EmptyListObject>& get_empty_list() {
+  // created on first use, which is thread safe for a static local.
+#ifdef GOOS_GC_HEAP
+  // not on the collected heap, so it's never freed.
+  static EmptyListObject empty_list_obj;
+  static HeapPtr<EmptyListObject> empty_list(&empty_list_obj);
+#else
+  static HeapPtr<EmptyListObject> empty_list = make_heap<EmptyListObject>();
+#endif
+  return empty_list;
 }
 
 /*!
@@ -131,6 +138,75 @@ Object SymbolObject::make_new(SymbolTable& st, const std::string& name) {
   return obj;
 }
 
+/*!
+ * Find a variable in this environment only (not the parents). Returns nullptr if it isn't here.
+ */
+Object* EnvironmentObject::find(const HeapPtr<SymbolObject>& sym) {
+  if (is_frame) {
+    for (auto& kv : frame) {
+      if (kv.first == sym) {
+        return &kv.second;
+      }
+    }
+    return nullptr;
+  }
+
+  auto kv = vars.find(sym);
+  return kv == vars.end() ? nullptr : &kv->second;
+}
+
+/*!
+ * Set a variable in this environment, creating it if it doesn't exist.
+ */
+void EnvironmentObject::set(const HeapPtr<SymbolObject>& sym, const Object& value) {
+  if (is_frame) {
+    auto existing = find(sym);
+    if (existing) {
+      *existing = value;
+    } else {
+      frame.emplace_back(sym, value);
+    }
+  } else {
+    vars[sym] = value;
+  }
+}
+
+/*!
+ * Mark the parent environment, and the names and values of the variables.
+ */
+void EnvironmentObject::trace(GcTracer& tracer) const {
+  tracer.mark(parent_env);
+  for (const auto& kv : frame) {
+    tracer.mark(kv.first);
+    tracer.mark(kv.second);
+  }
+  for (const auto& kv : vars) {
+    tracer.mark(kv.first);
+    tracer.mark(kv.second);
+  }
+}
+
+#ifndef GOOS_GC_HEAP
+/*!
+ * Free the rest of the list with a loop. Otherwise each pair frees the next one from its
+ * destructor, and a long list can overflow the stack.
+ */
+PairObject::~PairObject() {
+  if (cdr.type != ObjectType::PAIR) {
+    return;
+  }
+  auto next = std::move(cdr.heap_obj);
+  while (next.use_count() == 1) {
+    // take the next pair's cdr before freeing it, so its destructor has nothing left to free.
+    auto& next_cdr = static_cast<PairObject*>(next.get())->cdr;
+    if (next_cdr.type != ObjectType::PAIR) {
+      break;
+    }
+    next = std::move(next_cdr.heap_obj);
+  }
+}
+#endif
+
 /*!
  * Build a list of objects from a vector of objects.
  */
@@ -208,6 +284,19 @@ Object Object::make_number(IntType value) {
   return Object::make_integer(value);
 }
 
+/*!
+ * Mark the default values and the interned argument names.
+ */
+void ArgumentSpec::trace(GcTracer& tracer) const {
+  for (const auto& kv : named) {
+    tracer.mark(kv.second.default_value);
+  }
+  for (const auto& sym : unnamed_symbols) {
+    tracer.mark(sym);
+  }
+  tracer.mark(rest_symbol);
+}
+
 /*!
  * Debug print argument specification.
  */
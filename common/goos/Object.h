@@ -6,8 +6,8 @@
  * There are different types of objects, as represented by ObjectType.
  * An "Object" is an efficient wrapper around any of these types.
  * Some types are "heap allocated", and have reference semantics, and others are
- * "fixed" and have value semantics.  Heap allocated objects implement reference counting with
- * std::shared_ptr.
+ * "fixed" and have value semantics.  Heap allocated objects are reference counted with
+ * std::shared_ptr, or collected by a mark-sweep collector, see Heap.h.
  *
  * To create a new Object for a heap allocated type, use the make_new static method of the type of
  * object you want to make. This will return a correctly setup Object. For fixed objects, use
@@ -43,6 +43,7 @@
 #include <string>
 #include <cassert>
 #include <memory>
+#include <mutex>
 #include <unordered_map>
 #include <unordered_set>
 #include <utility>
@@ -50,6 +51,7 @@
 #include <stdexcept>
 #include <map>
 #include "common/common_types.h"
+#include "common/goos/Heap.h"
 
 namespace goos {
 
@@ -141,13 +143,6 @@ using CharObject = FixedObject<char>;
 
 // Other objects are separate allocated on the heap. These objects should be HeapObjects.
 
-class HeapObject {
- public:
-  virtual std::string print() const = 0;
-  virtual std::string inspect() const = 0;
-  virtual ~HeapObject() = default;
-};
-
 // forward declare all HeapObjects
 class PairObject;
 class EnvironmentObject;
@@ -160,13 +155,23 @@ class ArrayObject;
 // Wrapper Object class for all objects
 class Object {
  public:
-  std::shared_ptr<HeapObject> heap_obj = nullptr;
+#ifdef GOOS_GC_HEAP
+  // with no reference count to keep, the heap pointer can share space with the fixed objects.
+  union {
+    HeapPtr<HeapObject> heap_obj = nullptr;
+    IntegerObject integer_obj;
+    FloatObject float_obj;
+    CharObject char_obj;
+  };
+#else
+  HeapPtr<HeapObject> heap_obj = nullptr;
 
   union {
     IntegerObject integer_obj;
     FloatObject float_obj;
     CharObject char_obj;
   };
+#endif
 
   ObjectType type = ObjectType::INVALID;
 
@@ -220,59 +225,60 @@ class Object {
     return o;
   }
 
-  std::shared_ptr<PairObject> as_pair() const {
+  // the type is checked first, so these don't need a dynamic_cast.
+  HeapPtr<PairObject> as_pair() const {
     if (type != ObjectType::PAIR) {
       throw std::runtime_error("as_pair called on a " + object_type_to_string(type) + " " +
                                print());
     }
-    return std::dynamic_pointer_cast<PairObject>(heap_obj);
+    return heap_cast<PairObject>(heap_obj);
   }
 
-  std::shared_ptr<EnvironmentObject> as_env() const {
+  HeapPtr<EnvironmentObject> as_env() const {
     if (type != ObjectType::ENVIRONMENT) {
       throw std::runtime_error("as_env called on a " + object_type_to_string(type) + " " + print());
     }
-    return std::dynamic_pointer_cast<EnvironmentObject>(heap_obj);
+    return heap_cast<EnvironmentObject>(heap_obj);
   }
 
-  std::shared_ptr<SymbolObject> as_symbol() const {
+  HeapPtr<SymbolObject> as_symbol() const {
     if (type != ObjectType::SYMBOL) {
       throw std::runtime_error("as_symbol called on a " + object_type_to_string(type) + " " +
                                print());
     }
-    return std::dynamic_pointer_cast<SymbolObject>(heap_obj);
+    return heap_cast<SymbolObject>(heap_obj);
   }
 
-  std::shared_ptr<StringObject> as_string() const {
+  HeapPtr<StringObject> as_string() const {
     if (type != ObjectType::STRING) {
       throw std::runtime_error("as_string called on a " + object_type_to_string(type) + " " +
                                print());
     }
-    return std::dynamic_pointer_cast<StringObject>(heap_obj);
+    return heap_cast<StringObject>(heap_obj);
   }
 
-  std::shared_ptr<LambdaObject> as_lambda() const {
+  HeapPtr<LambdaObject> as_lambda() const {
     if (type != ObjectType::LAMBDA) {
       throw std::runtime_error("as_lambda called on a " + object_type_to_string(type) + " " +
                                print());
     }
-    return std::dynamic_pointer_cast<LambdaObject>(heap_obj);
+    return heap_cast<LambdaObject>(heap_obj);
   }
 
-  std::shared_ptr<MacroObject> as_macro() const {
+  HeapPtr<MacroObject> as_macro() const {
     if (type != ObjectType::MACRO) {
       throw std::runtime_error("as_macro called on a " + object_type_to_string(type) + " " +
                                print());
     }
-    return std::dynamic_pointer_cast<MacroObject>(heap_obj);
+    return heap_cast<MacroObject>(heap_obj);
   }
 
-  std::shared_ptr<ArrayObject> as_array() const {
+  HeapPtr<ArrayObject> as_array() const {
     if (type != ObjectType::ARRAY) {
       throw std::runtime_error("as_array called on a " + object_type_to_string(type) + " " +
                                print());
     }
-    return std::dynamic_pointer_cast<ArrayObject>(heap_obj);
+    return heap_cast<ArrayObject>(heap_obj);
   }
 
   IntType& as_int() {
@@ -329,9 +335,13 @@ class Object {
   bool operator!=(const Object& other) const { return !((*this) == other); }
 };
 
+#ifdef GOOS_GC_HEAP
+static_assert(sizeof(Object) == 16, "Object should be a pointer or fixed value and a type");
+#endif
+
 // There is a single heap allocated EmptyListObject.
 class EmptyListObject;
-std::shared_ptr<EmptyListObject>& get_empty_list();
+HeapPtr<EmptyListObject>& get_empty_list();
 
 class EmptyListObject : public HeapObject {
  public:
@@ -339,9 +349,6 @@ class EmptyListObject : public HeapObject {
   static Object make_new() {
     Object obj;
     obj.type = ObjectType::EMPTY_LIST;
-    if (!get_empty_list()) {
-      get_empty_list() = std::make_shared<EmptyListObject>();
-    }
     obj.heap_obj = get_empty_list();
     return obj;
   }
@@ -366,6 +373,14 @@ class SymbolTable;
 class SymbolObject : public HeapObject {
  public:
   std::string name;
+
+  // Filled in by the Interpreter which owns the symbol table, so evaluating a symbol or a form
+  // doesn't have to look up the name. The forms are indices into the Interpreter's form tables,
+  // or -1 if this isn't the name of a form.
+  s16 special_form = -1;
+  s16 builtin_form = -1;
+  bool is_boolean = false;  // #t or #f, which evaluate to themselves.
+
   explicit SymbolObject(std::string _name) : name(std::move(_name)) {}
   static Object make_new(SymbolTable& st, const std::string& name);
 
@@ -377,24 +392,37 @@ class SymbolObject : public HeapObject {
 };
 
 /*!
- * A Symbol Table, which holds all symbols.
+ * A Symbol Table, which holds all symbols. Interning is thread safe, so files can be read in
+ * parallel.
  */
 class SymbolTable {
  public:
-  std::shared_ptr<SymbolObject> intern(const std::string& name) {
+  HeapPtr<SymbolObject> intern(const std::string& name) {
+    std::lock_guard<std::mutex> lock(m_lock);
     auto kv = table.find(name);
     if (kv == table.end()) {
-      auto iter = table.insert({name, std::make_shared<SymbolObject>(name)});
+      auto iter = table.insert({name, make_heap<SymbolObject>(name)});
       return (*iter.first).second;
     } else {
       return kv->second;
     }
   }
 
+  /*!
+   * Mark every symbol, so they aren't collected while they're in the table.
+   */
+  void trace(GcTracer& tracer) {
+    std::lock_guard<std::mutex> lock(m_lock);
+    for (auto& kv : table) {
+      tracer.mark(kv.second);
+    }
+  }
+
   ~SymbolTable() = default;
 
  private:
-  std::unordered_map<std::string, std::shared_ptr<SymbolObject>> table;
+  std::mutex m_lock;
+  std::unordered_map<std::string, HeapPtr<SymbolObject>> table;
 };
 
 class StringObject : public HeapObject {
@@ -405,7 +433,7 @@ class StringObject : public HeapObject {
   static Object make_new(const std::string& text) {
     Object obj;
     obj.type = ObjectType::STRING;
-    obj.heap_obj = std::make_shared<StringObject>(text);
+    obj.heap_obj = make_heap<StringObject>(text);
     return obj;
   }
 
@@ -420,12 +448,12 @@ class PairObject : public HeapObject {
  public:
   Object car, cdr;
 
-  PairObject(Object car_, Object cdr_) : car(car_), cdr(cdr_) {}
+  PairObject(Object car_, Object cdr_) : car(std::move(car_)), cdr(std::move(cdr_)) {}
 
   static Object make_new(Object a, Object b) {
     Object obj;
     obj.type = ObjectType::PAIR;
-    obj.heap_obj = std::make_shared<PairObject>(a, b);
+    obj.heap_obj = make_heap<PairObject>(std::move(a), std::move(b));
     return obj;
   }
 
@@ -448,9 +476,9 @@ class PairObject : public HeapObject {
 
     for (;;) {
       if (to_print.type == ObjectType::PAIR) {
-        Object to_print_car = std::dynamic_pointer_cast<PairObject>(to_print.heap_obj)->car;
+        Object to_print_car = heap_cast<PairObject>(to_print.heap_obj)->car;
         result += to_print_car.print();
-        to_print = std::dynamic_pointer_cast<PairObject>(to_print.heap_obj)->cdr;
+        to_print = heap_cast<PairObject>(to_print.heap_obj)->cdr;
         if (to_print.type == ObjectType::EMPTY_LIST) {
           result += ")";
           return result;
@@ -468,35 +496,65 @@ class PairObject : public HeapObject {
 
   std::string inspect() const override { return "[pair] " + print() + "\n"; }
 
-  ~PairObject() = default;
+  void trace(GcTracer& tracer) const override {
+    tracer.mark(car);
+    tracer.mark(cdr);
+  }
+
+#ifndef GOOS_GC_HEAP
+  ~PairObject() override;
+#endif
 };
 
 class EnvironmentObject : public HeapObject {
  public:
   std::string name;
-  std::shared_ptr<EnvironmentObject> parent_env;
-  std::unordered_map<std::shared_ptr<SymbolObject>, Object> vars;
+  HeapPtr<EnvironmentObject> parent_env;
+  std::unordered_map<HeapPtr<SymbolObject>, Object> vars;
+
+  // The variables of a lambda or macro call frame. These only hold a few variables, so they are
+  // kept in a flat list in argument order and found by comparing symbol pointers, instead of
+  // hashing into vars.
+  bool is_frame = false;
+  std::vector<std::pair<HeapPtr<SymbolObject>, Object>> frame;
 
   EnvironmentObject() = default;
 
+  Object* find(const HeapPtr<SymbolObject>& sym);
+  void set(const HeapPtr<SymbolObject>& sym, const Object& value);
+
   static Object make_new() {
     Object obj;
     obj.type = ObjectType::ENVIRONMENT;
-    obj.heap_obj = std::make_shared<EnvironmentObject>();
+    obj.heap_obj = make_heap<EnvironmentObject>();
     return obj;
   }
 
   static Object make_new(std::string name,
-                         std::shared_ptr<EnvironmentObject> parent_env = nullptr) {
+                         HeapPtr<EnvironmentObject> parent_env = nullptr) {
     Object obj;
     obj.type = ObjectType::ENVIRONMENT;
-    auto env = std::make_shared<EnvironmentObject>();
+    auto env = make_heap<EnvironmentObject>();
     env->name = std::move(name);
     env->parent_env = std::move(parent_env);
     obj.heap_obj = std::move(env);
     return obj;
   }
 
+  /*!
+   * Make a call frame with room for size variables.
+   */
+  static Object make_frame(HeapPtr<EnvironmentObject> parent_env, size_t size) {
+    Object obj;
+    obj.type = ObjectType::ENVIRONMENT;
+    auto env = make_heap<EnvironmentObject>();
+    env->parent_env = std::move(parent_env);
+    env->is_frame = true;
+    env->frame.reserve(size);
+    obj.heap_obj = std::move(env);
+    return obj;
+  }
+
   std::string print() const override {
     if (name.empty()) {
       return "<unnamed environment>";
@@ -509,11 +567,16 @@ class EnvironmentObject : public HeapObject {
     std::string result = "[environment]\n  name: " + name +
                          "\n  parent: " + (parent_env ? parent_env->print() : "NONE") +
                          "\n  vars:\n";
+    for (const auto& kv : frame) {
+      result += "    " + kv.first->print() + ": " + kv.second.print() + "\n";
+    }
     for (const auto& kv : vars) {
       result += "    " + kv.first->print() + ": " + kv.second.print() + "\n";
     }
     return result;
   }
+
+  void trace(GcTracer& tracer) const override;
 };
 
 struct NamedArg {
@@ -526,7 +589,14 @@ struct ArgumentSpec {
   std::vector<std::string> unnamed;
   std::unordered_map<std::string, NamedArg> named;
   std::string rest;
+  // the symbols for unnamed and rest, interned by the Interpreter when it parses the spec, so
+  // calls don't have to intern them again. Empty/null for specs that weren't parsed.
+  std::vector<HeapPtr<SymbolObject>> unnamed_symbols;
+  HeapPtr<SymbolObject> rest_symbol;
   std::string print() const;
+  // the number of variables a call frame for this spec will have.
+  size_t frame_size() const { return unnamed.size() + named.size() + (rest.empty() ? 0 : 1); }
+  void trace(GcTracer& tracer) const;
 };
 
 ArgumentSpec make_varargs();
@@ -549,7 +619,7 @@ struct Arguments {
 class LambdaObject : public HeapObject {
  public:
   std::string name;
-  std::shared_ptr<EnvironmentObject> parent_env;
+  HeapPtr<EnvironmentObject> parent_env;
   Object body;
   ArgumentSpec args;
 
@@ -558,7 +628,7 @@ class LambdaObject : public HeapObject {
   static Object make_new() {
     Object obj;
     obj.type = ObjectType::LAMBDA;
-    obj.heap_obj = std::make_shared<LambdaObject>();
+    obj.heap_obj = make_heap<LambdaObject>();
     return obj;
   }
 
@@ -571,12 +641,18 @@ class LambdaObject : public HeapObject {
   }
 
   std::string inspect() const override { return "[lambda]\n  name: " + name + "\n" + args.print(); }
+
+  void trace(GcTracer& tracer) const override {
+    tracer.mark(parent_env);
+    tracer.mark(body);
+    args.trace(tracer);
+  }
 };
 
 class MacroObject : public HeapObject {
  public:
   std::string name;
-  std::shared_ptr<EnvironmentObject> parent_env;
+  HeapPtr<EnvironmentObject> parent_env;
   Object body;
   ArgumentSpec args;
 
@@ -585,7 +661,7 @@ class MacroObject : public HeapObject {
   static Object make_new() {
     Object obj;
     obj.type = ObjectType::MACRO;
-    obj.heap_obj = std::make_shared<MacroObject>();
+    obj.heap_obj = make_heap<MacroObject>();
     return obj;
   }
 
@@ -598,6 +674,12 @@ class MacroObject : public HeapObject {
   }
 
   std::string inspect() const override { return "[macro]\n  name: " + name + "\n" + args.print(); }
+
+  void trace(GcTracer& tracer) const override {
+    tracer.mark(parent_env);
+    tracer.mark(body);
+    args.trace(tracer);
+  }
 };
 
 class ArrayObject : public HeapObject {
@@ -607,7 +689,7 @@ class ArrayObject : public HeapObject {
   static Object make_new(std::vector<Object> objects) {
     Object obj;
     obj.type = ObjectType::ARRAY;
-    obj.heap_obj = std::make_shared<ArrayObject>(std::move(objects));
+    obj.heap_obj = make_heap<ArrayObject>(std::move(objects));
     return obj;
   }
 
@@ -627,6 +709,12 @@ class ArrayObject : public HeapObject {
     return "[array] size: " + std::to_string(data.size()) + " data: " + print() + "\n";
   }
 
+  void trace(GcTracer& tracer) const override {
+    for (const auto& obj : data) {
+      tracer.mark(obj);
+    }
+  }
+
   std::size_t size() const { return data.size(); }
 
   const Object& operator[](size_t idx) const { return data.at(idx); }
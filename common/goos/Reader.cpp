@@ -9,9 +9,11 @@
  * launching the compiler or the compiler test.
  */
 
+#include <charconv>
 #include "Reader.h"
 #include "third-party/linenoise.h"
 #include "common/util/FileUtil.h"
+#include "common/util/ThreadPool.h"
 #include "third-party/fmt/core.h"
 
 namespace goos {
@@ -41,7 +43,7 @@ bool hex_char(char c) {
 /*!
  * Does the given string contain c?
  */
-bool str_contains(const std::string& str, char c) {
+bool str_contains(std::string_view str, char c) {
   for (auto& x : str) {
     if (x == c) {
       return true;
@@ -101,11 +103,16 @@ void TextStream::seek_past_whitespace_and_comments() {
   }
 }
 
-Reader::Reader() {
+Reader::Reader()
+    : gc_roots([this](GcTracer& tracer) { symbolTable.trace(tracer); },
+               [this]() { db.remove_unmarked(); }) {
   // third-party library used for a fancy line in
   linenoise::SetHistoryMaxLen(400);
 
   // add default macros
+  for (auto& x : reader_macro_chars) {
+    x = false;
+  }
   add_reader_macro("'", "quote");
   add_reader_macro("`", "quasiquote");
   add_reader_macro(",", "unquote");
@@ -133,6 +140,15 @@ Reader::Reader() {
   for (const char* c = bonus; *c; c++) {
     valid_symbols_chars[(int)*c] = true;
   }
+
+  // setup table of which characters end a token
+  for (auto& x : token_end_chars) {
+    x = false;
+  }
+
+  for (const char* c = " \n\t();#"; *c; c++) {
+    token_end_chars[(int)*c] = true;
+  }
 }
 
 /*!
@@ -182,6 +198,17 @@ Object Reader::read_from_file(const std::vector<std::string>& file_path) {
   return result;
 }
 
+/*!
+ * Read many files in parallel. The result is the same as calling read_from_file on each file.
+ */
+std::vector<Object> Reader::read_from_files(const std::vector<std::vector<std::string>>& file_paths,
+                                            ThreadPool& pool) {
+  std::vector<Object> result(file_paths.size());
+  pool.parallel_for(file_paths.size(),
+                    [&](size_t i) { result.at(i) = read_from_file(file_paths.at(i)); });
+  return result;
+}
+
 /*!
  * Common read for a SourceText
  */
@@ -194,6 +221,7 @@ Object Reader::internal_read(std::shared_ptr<SourceText> text) {
 
   // read list!
   auto objs = read_list(ts, false);
+  db.link_all(ts.lists, text);
   return PairObject::make_new(SymbolObject::make_new(symbolTable, "top-level"), objs);
 }
 
@@ -206,41 +234,28 @@ Token Reader::get_next_token(TextStream& stream) {
   Token t;
   t.source_line = stream.line_count;
   t.source_offset = stream.seek;
-  t.source_text = stream.text;
 
   char first = stream.read();
-  t.text.push_back(first);
 
   // First - look for special tokens which end early:
-
-  // parens, double quotes, quotes, and backticks are tokens.
-  if (first == '(' || first == ')' || first == '"' || first == '\'' || first == '`')
-    return t;
-
-  // ",@" is its own token
-  if (first == ',' && stream.text_remains() && stream.peek() == '@') {
-    t.text.push_back(stream.read());
-    return t;
+  if (first == '(' || first == ')' || first == '"' || first == '\'' || first == '`') {
+    // parens, double quotes, quotes, and backticks are tokens.
   } else if (first == ',') {
-    // "," is its own token.
-    return t;
+    // "," and ",@" are tokens.
+    if (stream.text_remains() && stream.peek() == '@') {
+      stream.read();
+    }
   } else if (first == '#' && stream.text_remains() && stream.peek() == '(') {
-    t.text.push_back(stream.read());
-    return t;
-  }
-
-  // Second - not a special token, so we read until we get a character that ends the token.
-  while (stream.text_remains()) {
-    char next = stream.peek();
-    if (next == ' ' || next == '\n' || next == '\t' || next == ')' || next == ';' || next == '#' ||
-        next == '(') {
-      return t;
-    } else {
-      // not the end, so add to token.
-      t.text.push_back(stream.read());
+    stream.read();
+  } else {
+    // Second - not a special token, so we read until we get a character that ends the token.
+    while (stream.text_remains() && !token_end_chars[(u8)stream.peek()]) {
+      stream.read();
     }
   }
 
+  t.text = std::string_view(stream.text->get_text() + t.source_offset,
+                            stream.seek - t.source_offset);
   return t;
 }
 
@@ -250,6 +265,7 @@ Token Reader::get_next_token(TextStream& stream) {
  * These are used to make 'x turn into (quote x) and similar.
  */
 void Reader::add_reader_macro(const std::string& shortcut, std::string replacement) {
+  reader_macro_chars[(u8)shortcut.at(0)] = true;
   reader_macros[shortcut] = std::move(replacement);
 }
 
@@ -301,11 +317,12 @@ bool Reader::read_object(Token& tok, TextStream& ts, Object& obj) {
     }
 
     // try as symbol
-    if (try_token_as_symbol(tok, obj)) {
+    if (try_token_as_symbol(tok, ts, obj)) {
       return true;
     }
   } catch (std::exception& e) {
-    throw_reader_error(ts, "parsing token " + tok.text + " failed: " + e.what(), -1);
+    throw_reader_error(ts, "parsing token " + std::string(tok.text) + " failed: " + e.what(),
+                       -1);
   }
 
   return false;
@@ -336,7 +353,8 @@ bool Reader::read_array(TextStream& stream, Object& o) {
         stream.seek_past_whitespace_and_comments();
         objects.push_back(next_obj);
       } else {
-        throw_reader_error(stream, "invalid token encountered in array reader: " + tok.text,
+        throw_reader_error(stream,
+                           "invalid token encountered in array reader: " + std::string(tok.text),
                            -int(tok.text.size()));
       }
     }
@@ -356,7 +374,10 @@ bool Reader::read_array(TextStream& stream, Object& o) {
  */
 Object Reader::read_list(TextStream& ts, bool expect_close_paren) {
   ts.seek_past_whitespace_and_comments();
-  std::vector<Object> objects;
+  // the list is built in place, by adding pairs after the last one.
+  Object list = EmptyListObject::make_new();
+  PairObject* last = nullptr;
+  Object thing_after_dot;
 
   bool got_close_paren = false;      // does this list end?
   bool got_dot = false;              // did we get a . ?
@@ -370,8 +391,11 @@ Object Reader::read_list(TextStream& ts, bool expect_close_paren) {
     // reader macro thing:
     bool got_reader_macro = false;
 
-    std::string reader_macro_string;
-    auto kv = reader_macros.find(tok.text);
+    std::string_view reader_macro_string;  // points into reader_macros, so it outlives the read
+    auto kv = reader_macros.end();
+    if (reader_macro_chars[(u8)tok.text[0]]) {
+      kv = reader_macros.find(std::string(tok.text));
+    }
     if (kv != reader_macros.end()) {
       // we found a reader macro! Remember this, and get the next token.
       got_reader_macro = true;
@@ -401,16 +425,24 @@ Object Reader::read_list(TextStream& ts, bool expect_close_paren) {
 
       // create child list if we got a reader macro (ex 'x -> (quote x))
       if (got_reader_macro) {
-        objects.push_back(
-            build_list({SymbolObject::make_new(symbolTable, reader_macro_string), o}));
-      } else {
-        objects.push_back(o);
+        o = build_list({intern(ts, reader_macro_string), o});
       }
 
       // remember if we got an object after the dot
       if (got_dot) {
+        thing_after_dot = std::move(o);
         got_thing_after_dot = true;
+        return;
       }
+
+      auto next = PairObject::make_new(std::move(o), EmptyListObject::make_new());
+      auto next_pair = static_cast<PairObject*>(next.heap_obj.get());
+      if (last) {
+        last->cdr = std::move(next);
+      } else {
+        list = std::move(next);
+      }
+      last = next_pair;
     };
 
     if (tok.text.empty()) {
@@ -436,7 +468,7 @@ Object Reader::read_list(TextStream& ts, bool expect_close_paren) {
         ts.seek_past_whitespace_and_comments();
         insert_object(obj);
       } else {
-        throw_reader_error(ts, "invalid token encountered in reader: " + tok.text,
+        throw_reader_error(ts, "invalid token encountered in reader: " + std::string(tok.text),
                            -int(tok.text.size()));
       }
     }
@@ -455,42 +487,42 @@ Object Reader::read_list(TextStream& ts, bool expect_close_paren) {
     throw_reader_error(ts, "A list must have an entry after the dot", -1);
   }
 
-  // build up list or improper list, link it, and return!
+  // finish improper list, link it, and return!
   if (got_thing_after_dot) {
-    if (objects.size() < 2) {
+    if (!last) {
       throw_reader_error(ts, "A list with a dot must have at least one thing before the dot", -1);
     }
-    auto back = objects.back();
-    objects.pop_back();
-    auto rv = build_list(objects);
+    last->cdr = std::move(thing_after_dot);
+  }
+  if (!list.is_empty_list()) {
+    ts.lists.emplace_back(list, start_offset);
+  }
+  return list;
+}
 
-    auto lst = rv;
-    while (true) {
-      if (lst.as_pair()->cdr.is_empty_list()) {
-        lst.as_pair()->cdr = back;
-        break;
-      } else {
-        lst = lst.as_pair()->cdr;
-      }
-    }
-    db.link(rv, ts.text, start_offset);
-    return rv;
-  } else {
-    auto rv = build_list(objects);
-    db.link(rv, ts.text, start_offset);
-    return rv;
+/*!
+ * Get the symbol with the given name. Each name is only looked up in the SymbolTable the first
+ * time it is seen in the text.
+ */
+Object Reader::intern(TextStream& ts, std::string_view name) {
+  auto kv = ts.symbols.find(name);
+  if (kv != ts.symbols.end()) {
+    return kv->second;
   }
+  auto symbol = SymbolObject::make_new(symbolTable, std::string(name));
+  ts.symbols.insert({name, symbol});
+  return symbol;
 }
 
 /*!
  * Try decoding as symbol. Returns success.
  */
-bool Reader::try_token_as_symbol(const Token& tok, Object& obj) {
+bool Reader::try_token_as_symbol(const Token& tok, TextStream& ts, Object& obj) {
   // check start character is valid:
   assert(!tok.text.empty());
   char start = tok.text[0];
-  if (valid_symbols_chars[(int)start]) {
-    obj = SymbolObject::make_new(symbolTable, tok.text);
+  if (valid_symbols_chars[(u8)start]) {
+    obj = intern(ts, tok.text);
     return true;
   } else {
     return false;
@@ -576,7 +608,7 @@ bool Reader::try_token_as_float(const Token& tok, Object& obj) {
 
     try {
       std::size_t end = 0;
-      double v = std::stod(tok.text, &end);
+      double v = std::stod(std::string(tok.text), &end);
       if (end != tok.text.size())
         return false;
       obj = Object::make_float(v);
@@ -605,7 +637,7 @@ bool Reader::try_token_as_binary(const Token& tok, Object& obj) {
 
     for (uint32_t i = 2; i < tok.text.size(); i++) {
       if (value & (0x8000000000000000)) {
-        throw std::runtime_error("overflow in binary constant: " + tok.text);
+        throw std::runtime_error("overflow in binary constant: " + std::string(tok.text));
       }
 
       value <<= 1u;
@@ -627,8 +659,8 @@ bool Reader::try_token_as_binary(const Token& tok, Object& obj) {
  */
 bool Reader::try_token_as_hex(const Token& tok, Object& obj) {
   if (tok.text.size() >= 3 && tok.text[0] == '#' && tok.text[1] == 'x') {
-    // determine if we look like a number or not. If we look like a number, but stoll fails,
-    // it means that the number is too big or too small, and we should error
+    // determine if we look like a number or not. If we look like a number, but from_chars says
+    // it is out of range, the number is too big or too small, and we should error
     for (size_t offset = 2; offset < tok.text.size(); offset++) {
       char c = tok.text.at(offset);
       if (!hex_char(c)) {
@@ -637,16 +669,17 @@ bool Reader::try_token_as_hex(const Token& tok, Object& obj) {
     }
 
     uint64_t v = 0;
-    try {
-      std::size_t end = 0;
-      v = std::stoull(tok.text.substr(2), &end, 16);
-      if (end + 2 != tok.text.size())
-        return false;
-      obj = Object::make_integer(v);
-      return true;
-    } catch (std::exception& e) {
-      throw std::runtime_error("The number " + tok.text + " cannot be a hexadecimal constant");
+    auto end = tok.text.data() + tok.text.size();
+    auto result = std::from_chars(tok.text.data() + 2, end, v, 16);
+    if (result.ec == std::errc::result_out_of_range) {
+      throw std::runtime_error("The number " + std::string(tok.text) +
+                               " cannot be a hexadecimal constant");
     }
+    if (result.ec != std::errc() || result.ptr != end) {
+      return false;
+    }
+    obj = Object::make_integer(v);
+    return true;
   }
   return false;
 }
@@ -657,8 +690,8 @@ bool Reader::try_token_as_hex(const Token& tok, Object& obj) {
  */
 bool Reader::try_token_as_integer(const Token& tok, Object& obj) {
   if (decimal_start(tok.text[0]) && !str_contains(tok.text, '.')) {
-    // determine if we look like a number or not. If we look like a number, but stoll fails,
-    // it means that the number is too big or too small, and we should error
+    // determine if we look like a number or not. If we look like a number, but from_chars says
+    // it is out of range, the number is too big or too small, and we should error
     size_t offset = tok.text[0] == '-' ? 1 : 0;
     if (offset == 1 && tok.text.size() == 1) {
       return false;  // - by itself is not a number!
@@ -669,18 +702,18 @@ bool Reader::try_token_as_integer(const Token& tok, Object& obj) {
         return false;
       }
     }
-    uint64_t v = 0;
-    try {
-      std::size_t end = 0;
-      v = std::stoll(tok.text, &end);
-      if (end != tok.text.size()) {
-        return false;
-      }
-      obj = Object::make_integer(v);
-      return true;
-    } catch (std::exception& e) {
-      throw std::runtime_error("The number " + tok.text + " cannot be an integer constant");
+    int64_t v = 0;
+    auto end = tok.text.data() + tok.text.size();
+    auto result = std::from_chars(tok.text.data(), end, v);
+    if (result.ec == std::errc::result_out_of_range) {
+      throw std::runtime_error("The number " + std::string(tok.text) +
+                               " cannot be an integer constant");
     }
+    if (result.ec != std::errc() || result.ptr != end) {
+      return false;
+    }
+    obj = Object::make_integer(v);
+    return true;
   }
   return false;
 }
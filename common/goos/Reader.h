@@ -13,12 +13,15 @@
 
 #include <memory>
 #include <cassert>
+#include <string_view>
 #include <utility>
 #include <unordered_map>
 
 #include "common/goos/Object.h"
 #include "common/goos/TextDB.h"
 
+class ThreadPool;
+
 namespace goos {
 
 /*!
@@ -31,6 +34,12 @@ struct TextStream {
   int seek = 0;
   int line_count = 0;
 
+  // symbols already interned for this text, and lists read from it with their offsets. The lists
+  // are linked in the TextDb when the read is done, so the shared tables are locked once per
+  // symbol name and once per read instead of on every token.
+  std::unordered_map<std::string_view, Object> symbols;
+  std::vector<std::pair<Object, int>> lists;
+
   char peek() {
     assert(seek < text->get_size());
     return text->get_text()[seek];
@@ -55,13 +64,12 @@ struct TextStream {
 };
 
 /*!
- * A Token used for parsing.
+ * A Token used for parsing. The text points into the SourceText being read.
  */
 struct Token {
-  std::shared_ptr<SourceText> source_text;
   int source_offset;
   int source_line;
-  std::string text;
+  std::string_view text;
 };
 
 class Reader {
@@ -70,6 +78,10 @@ class Reader {
   Object read_from_string(const std::string& str);
   Object read_from_stdin(const std::string& prompt_name);
   Object read_from_file(const std::vector<std::string>& file_path);
+  // Nothing calls this yet: asm-file reads one file at a time. It's for future callers that know
+  // several files they'll need, like a build that reads all of its sources up front.
+  std::vector<Object> read_from_files(const std::vector<std::vector<std::string>>& file_paths,
+                                      ThreadPool& pool);
 
   std::string get_source_dir();
 
@@ -77,6 +89,9 @@ class Reader {
   TextDb db;
 
  private:
+  // keeps the symbols, and removes freed objects from the db.
+  GcRoots gc_roots;
+
   Object internal_read(std::shared_ptr<SourceText> text);
   Object read_list(TextStream& stream, bool expect_close_paren = true);
   bool read_object(Token& tok, TextStream& ts, Object& obj);
@@ -85,7 +100,8 @@ class Reader {
   void throw_reader_error(TextStream& here, const std::string& err, int seek_offset);
   Token get_next_token(TextStream& stream);
 
-  bool try_token_as_symbol(const Token& tok, Object& obj);
+  Object intern(TextStream& ts, std::string_view name);
+  bool try_token_as_symbol(const Token& tok, TextStream& ts, Object& obj);
   bool try_token_as_char(const Token& tok, Object& obj);
   bool try_token_as_float(const Token& tok, Object& obj);
   bool try_token_as_binary(const Token& tok, Object& obj);
@@ -95,6 +111,8 @@ class Reader {
   void add_reader_macro(const std::string& shortcut, std::string replacement);
 
   char valid_symbols_chars[256];
+  char token_end_chars[256];
+  char reader_macro_chars[256];  // first characters of reader macros
 
   std::unordered_map<std::string, std::string> reader_macros;
 };
@@ -11,6 +11,7 @@
  *   (+ 1 (+ a b)) ; compute the sum
  */
 
+#include <algorithm>
 #include "common/util/FileUtil.h"
 
 #include "TextDB.h"
@@ -88,6 +89,7 @@ FileText::FileText(std::string filename_) : filename(std::move(filename_)) {
  * Inform the TextDB about a source of text.
  */
 void TextDb::insert(const std::shared_ptr<SourceText>& frag) {
+  std::lock_guard<std::mutex> lock(m_lock);
   fragments.push_back(frag);
 }
 
@@ -99,10 +101,83 @@ void TextDb::link(const Object& o, std::shared_ptr<SourceText> frag, int offset)
   if (o.is_empty_list())
     return;
   assert(o.is_pair());
+  std::lock_guard<std::mutex> lock(m_lock);
+  link_locked(o, std::move(frag), offset);
+}
+
+/*!
+ * Link each (object, offset) pair to the given text fragment, taking the lock once for all of them.
+ * The objects must be pairs.
+ */
+void TextDb::link_all(const std::vector<std::pair<Object, int>>& objs,
+                      const std::shared_ptr<SourceText>& frag) {
+  std::lock_guard<std::mutex> lock(m_lock);
+  for (auto& obj : objs) {
+    assert(obj.first.is_pair());
+    link_locked(obj.first, frag, obj.second);
+  }
+}
+
+/*!
+ * Link an object to text, with the lock already held.
+ */
+void TextDb::link_locked(const Object& o, std::shared_ptr<SourceText> frag, int offset) {
+#ifndef GOOS_GC_HEAP
+  if (map.size() >= 2 * map_size_after_remove + 1024) {
+    remove_expired();
+  }
+#endif
   TextRef ref;
   ref.offset = offset;
   ref.frag = std::move(frag);
-  map[o.heap_obj] = ref;
+#ifndef GOOS_GC_HEAP
+  ref.obj = o.heap_obj;
+#endif
+  map[o.heap_obj.get()] = std::move(ref);
+}
+
+#ifndef GOOS_GC_HEAP
+/*!
+ * Forget objects which have been freed, and text which no remaining object came from.
+ */
+void TextDb::remove_expired() {
+  for (auto it = map.begin(); it != map.end();) {
+    if (it->second.obj.expired()) {
+      it = map.erase(it);
+    } else {
+      ++it;
+    }
+  }
+  map_size_after_remove = map.size();
+  remove_unused_fragments();
+}
+#endif
+
+/*!
+ * Forget objects which collect_garbage is about to free, and text which no remaining object came
+ * from.
+ */
+void TextDb::remove_unmarked() {
+  std::lock_guard<std::mutex> lock(m_lock);
+  for (auto it = map.begin(); it != map.end();) {
+    if (!GcRoots::is_marked(it->first)) {
+      it = map.erase(it);
+    } else {
+      ++it;
+    }
+  }
+  remove_unused_fragments();
+}
+
+/*!
+ * Forget text which no object in the map came from.
+ */
+void TextDb::remove_unused_fragments() {
+  fragments.erase(std::remove_if(fragments.begin(), fragments.end(),
+                                 [](const std::shared_ptr<SourceText>& frag) {
+                                   return frag.use_count() == 1;
+                                 }),
+                  fragments.end());
 }
 
 /*!
@@ -110,7 +185,8 @@ void TextDb::link(const Object& o, std::shared_ptr<SourceText> frag, int offset)
  */
 std::string TextDb::get_info_for(const Object& o) {
   if (o.is_pair()) {
-    auto kv = map.find(o.heap_obj);
+    std::lock_guard<std::mutex> lock(m_lock);
+    auto kv = map.find(o.heap_obj.get());
     if (kv != map.end()) {
       return get_info_for(kv->second.frag, kv->second.offset);
     } else {
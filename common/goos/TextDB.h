@@ -18,6 +18,7 @@
 #include <stdexcept>
 #include <unordered_map>
 #include <memory>
+#include <mutex>
 
 #include "common/goos/Object.h"
 
@@ -81,17 +82,35 @@ class FileText : public SourceText {
 struct TextRef {
   int offset;
   std::shared_ptr<SourceText> frag;
+#ifndef GOOS_GC_HEAP
+  // the linked object. This is weak so the database doesn't keep every form ever read alive.
+  std::weak_ptr<goos::HeapObject> obj;
+#endif
 };
 
 class TextDb {
  public:
   void insert(const std::shared_ptr<SourceText>& frag);
   void link(const Object& o, std::shared_ptr<SourceText> frag, int offset);
+  void link_all(const std::vector<std::pair<Object, int>>& objs,
+                const std::shared_ptr<SourceText>& frag);
   std::string get_info_for(const Object& o);
   std::string get_info_for(const std::shared_ptr<SourceText>& frag, int offset);
+  void remove_unmarked();
 
  private:
+#ifndef GOOS_GC_HEAP
+  void remove_expired();
+#endif
+  void remove_unused_fragments();
+  void link_locked(const Object& o, std::shared_ptr<SourceText> frag, int offset);
+
+  std::mutex m_lock;  // the Reader may read several files at once.
   std::vector<std::shared_ptr<SourceText>> fragments;
-  std::unordered_map<std::shared_ptr<goos::HeapObject>, TextRef> map;
+  // keyed by address. The weak_ptr in the TextRef keeps the allocation alive, so the address can't
+  // be reused by a different object while the entry exists. With the collected heap, entries are
+  // removed by remove_unmarked before their objects are freed.
+  std::unordered_map<const goos::HeapObject*, TextRef> map;
+  size_t map_size_after_remove = 0;
 };
 }  // namespace goos
@@ -0,0 +1,58 @@
+/*!
+ * @file goos_benchmark.cpp
+ * Times the GOOS interpreter on recursive functions and macros that build lists, which are the
+ * cases that tail call evaluation speeds up. For testing interpreter changes.
+ */
+
+#include <cstdio>
+#include <stdexcept>
+#include <string>
+#include "common/goos/Interpreter.h"
+#include "common/util/Timer.h"
+
+namespace {
+constexpr int REPEAT_COUNT = 50;
+
+/*!
+ * Evaluate code count times and print how long it took. Returns false if it had an error.
+ */
+bool run(goos::Interpreter& interp,
+         const char* name,
+         const std::string& code,
+         int count = REPEAT_COUNT) {
+  auto form = interp.reader.read_from_string(code);
+  Timer timer;
+  try {
+    for (int i = 0; i < count; i++) {
+      interp.eval(form, interp.global_environment.as_env());
+    }
+  } catch (std::runtime_error& e) {
+    printf(" %-40s error: %s\n", name, e.what());
+    return false;
+  }
+  printf(" %-40s %8.2f ms\n", name, timer.getMs());
+  return true;
+}
+}  // namespace
+
+int main() {
+  goos::Interpreter interp;
+  interp.disable_printfs();
+  interp.eval(interp.reader.read_from_string(
+                  "(begin"
+                  "  (desfun range (n acc) (if (= n 0) acc (range (- n 1) (cons n acc))))"
+                  "  (desfun rev (l acc) (if (null? l) acc (rev (cdr l) (cons (car l) acc))))"
+                  "  (defsmacro build-list (n)"
+                  "    (if (= n 0) (quote '()) `(cons ,n (build-list ,(- n 1)))))"
+                  "  (define big-list (range 2000 '())))"),
+              interp.global_environment.as_env());
+
+  printf("Benchmarking GOOS, %d runs each unless noted:\n", REPEAT_COUNT);
+  bool ok = true;
+  ok &= run(interp, "tail-recursive range of 2000", "(range 2000 '())");
+  ok &= run(interp, "tail-recursive reverse of 2000", "(rev big-list '())");
+  ok &= run(interp, "recursive list-building macro", "(build-list 500)");
+  // deep enough to overflow the C++ stack if tail calls recursed.
+  ok &= run(interp, "tail-recursive range of 100000 (1 run)", "(range 100000 '())", 1);
+  return ok ? 0 : 1;
+}
@@ -0,0 +1,176 @@
+/*!
+ * @file goos_heap_benchmark.cpp
+ * Reads all of goal_src and expands the GOAL macros in it the way the compiler does, several times
+ * in one interpreter, like rebuilding in a long REPL session. This is built as
+ * goos_heap_benchmark, with the reference counted heap, and goos_heap_benchmark_gc, with the
+ * mark-sweep heap, for comparing the heaps.
+ */
+
+#include <cstdio>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "common/goos/Interpreter.h"
+#include "common/util/Timer.h"
+
+#ifdef __linux__
+#include <sys/resource.h>
+#endif
+
+namespace {
+constexpr int PASS_COUNT = 5;
+
+size_t peak_rss_kb() {
+#ifdef __linux__
+  struct rusage usage = {};
+  getrusage(RUSAGE_SELF, &usage);
+  return usage.ru_maxrss;
+#else
+  return 0;
+#endif
+}
+
+/*!
+ * Expands GOAL macros in forms, like the compiler does before compiling them. GOOS code in seval
+ * forms is evaluated, so macros defined by the files are available to the forms after them.
+ */
+class Expander {
+ public:
+  explicit Expander(goos::Interpreter& interp) : m_interp(interp) {}
+
+  void expand(const goos::Object& form) {
+    if (!form.is_pair()) {
+      return;
+    }
+
+    auto& head = form.as_pair()->car;
+    if (head.is_symbol()) {
+      auto& name = head.as_symbol()->name;
+      if (name == "quote") {
+        return;
+      }
+
+      auto& rest = form.as_pair()->cdr;
+      if (name == "seval") {
+        for (auto it = rest; it.is_pair(); it = it.as_pair()->cdr) {
+          eval(it.as_pair()->car);
+        }
+        return;
+      }
+
+      if (name == "defglobalconstant" && rest.is_pair() && rest.as_pair()->cdr.is_pair()) {
+        // the compiler makes these available to GOOS.
+        m_interp.global_environment.as_env()->set(rest.as_pair()->car.as_symbol(),
+                                                  rest.as_pair()->cdr.as_pair()->car);
+        return;
+      }
+
+      // GOAL macros are only defined in the GOAL environment, which has no parent.
+      auto macro = m_interp.goal_env.as_env()->find(head.as_symbol());
+      if (macro && macro->is_macro()) {
+        goos::Object result;
+        if (expand_macro(form, rest, *macro, &result)) {
+          expand(result);
+        }
+        return;
+      }
+    }
+
+    for (auto it = form; it.is_pair(); it = it.as_pair()->cdr) {
+      expand(it.as_pair()->car);
+    }
+  }
+
+  int macro_count = 0;
+  int error_count = 0;
+
+ private:
+  bool expand_macro(const goos::Object& form,
+                    const goos::Object& rest,
+                    const goos::Object& macro_obj,
+                    goos::Object* result) {
+    macro_count++;
+    try {
+      auto macro = macro_obj.as_macro();
+      auto args = m_interp.get_args(form, rest, macro->args);
+      auto env = goos::EnvironmentObject::make_frame(m_interp.global_environment.as_env(),
+                                                     macro->args.frame_size());
+      m_interp.set_args_in_env(form, args, macro->args, env.as_env());
+      *result = m_interp.eval_list_return_last(macro->body, macro->body, env.as_env());
+      return true;
+    } catch (std::runtime_error&) {
+      // some macros can't be expanded without the compiler, so these are only counted.
+      error_count++;
+      return false;
+    }
+  }
+
+  void eval(const goos::Object& form) {
+    try {
+      m_interp.eval_with_rewind(form, m_interp.global_environment.as_env());
+    } catch (std::runtime_error&) {
+      error_count++;
+    }
+  }
+
+  goos::Interpreter& m_interp;
+};
+
+/*!
+ * Get the files of the game, in build order.
+ */
+std::vector<std::string> get_goal_files(goos::Interpreter& interp) {
+  std::vector<std::string> files = {"goal_src/goal-lib.gc", "goal_src/kernel-defs.gc"};
+  // (top-level (defglobalconstant all-goal-files ("file" ...)))
+  auto all_files = interp.reader.read_from_file({"goal_src", "build", "all_files.gc"});
+  auto list = all_files.as_pair()->cdr.as_pair()->car.as_pair()->cdr.as_pair()->cdr.as_pair()->car;
+  for (auto it = list; it.is_pair(); it = it.as_pair()->cdr) {
+    files.push_back(it.as_pair()->car.as_string()->data);
+  }
+  return files;
+}
+}  // namespace
+
+int main() {
+  goos::Interpreter interp;
+  interp.disable_printfs();
+  auto files = get_goal_files(interp);
+  Expander expander(interp);
+
+#ifdef GOOS_GC_HEAP
+  printf("Reading and expanding %d files with the mark-sweep heap:\n", int(files.size()));
+#else
+  printf("Reading and expanding %d files with the reference counted heap:\n", int(files.size()));
+#endif
+  printf(" pass     read ms   expand ms       gc ms  heap objects  peak rss kb\n");
+
+  double total_read_ms = 0, total_expand_ms = 0, total_gc_ms = 0;
+  for (int pass = 0; pass < PASS_COUNT; pass++) {
+    double read_ms = 0, expand_ms = 0, gc_ms = 0;
+    for (auto& file : files) {
+      Timer timer;
+      {
+        auto code = interp.reader.read_from_file({file});
+        read_ms += timer.getMs();
+        timer.start();
+        expander.expand(code);
+        expand_ms += timer.getMs();
+      }
+
+      // nothing from the file is needed after it's expanded, like after a REPL command.
+      timer.start();
+      goos::collect_garbage();
+      gc_ms += timer.getMs();
+    }
+    printf(" %4d %11.2f %11.2f %11.2f %13d %12d\n", pass, read_ms, expand_ms, gc_ms,
+           int(goos::heap_object_count()), int(peak_rss_kb()));
+    total_read_ms += read_ms;
+    total_expand_ms += expand_ms;
+    total_gc_ms += gc_ms;
+  }
+
+  printf(" all  %11.2f %11.2f %11.2f\n", total_read_ms, total_expand_ms, total_gc_ms);
+  printf("Expanded %d macros, %d errors\n", expander.macro_count / PASS_COUNT,
+         expander.error_count / PASS_COUNT);
+  return 0;
+}
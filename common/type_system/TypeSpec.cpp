@@ -3,66 +3,105 @@
  * A GOAL TypeSpec is a reference to a type or compound type.
  */
 
+#include <cstring>
+#include <mutex>
+#include <shared_mutex>
+#include <unordered_map>
 #include "TypeSpec.h"
 #include "Type.h"
 
-TypeSpec::TypeSpec(std::string type) : m_type(std::move(type)) {}
+namespace {
+/*!
+ * Key for the table of all TypeSpecs: the base type name, followed by the ids of the arguments.
+ */
+std::string make_key(const std::string& type, const std::vector<TypeSpec>& arguments) {
+  std::string key = type;
+  key.push_back('\0');
+  for (auto& arg : arguments) {
+    auto id = arg.id();
+    char bytes[sizeof(id)];
+    memcpy(bytes, &id, sizeof(id));
+    key.append(bytes, sizeof(id));
+  }
+  return key;
+}
+}  // namespace
+
+const TypeSpec::Node* TypeSpec::intern(const std::string& type,
+                                       const std::vector<TypeSpec>& arguments) {
+  // never destroyed, so TypeSpecs in other static objects stay valid.
+  static auto* lock = new std::shared_mutex;
+  static auto* nodes = new std::unordered_map<std::string, const Node*>;
+
+  auto key = make_key(type, arguments);
+  {
+    std::shared_lock<std::shared_mutex> lk(*lock);
+    auto kv = nodes->find(key);
+    if (kv != nodes->end()) {
+      return kv->second;
+    }
+  }
 
-TypeSpec::TypeSpec(std::string type, std::vector<TypeSpec> arguments)
-    : m_type(std::move(type)), m_arguments(std::move(arguments)) {}
+  std::unique_lock<std::shared_mutex> lk(*lock);
+  auto kv = nodes->find(key);
+  if (kv != nodes->end()) {
+    return kv->second;
+  }
 
-std::string TypeSpec::print() const {
-  if (m_arguments.empty()) {
-    return m_type;
+  auto node = new Node;
+  node->type = type;
+  node->arguments = arguments;
+  if (arguments.empty()) {
+    node->printed = type;
   } else {
-    std::string result = "(" + m_type;
-    for (auto& x : m_arguments) {
-      result += " " + x.print();
+    node->printed = "(" + type;
+    for (auto& x : arguments) {
+      node->printed += " " + x.print();
     }
-    return result + ")";
+    node->printed += ")";
   }
+  node->id = uint32_t(nodes->size());
+  (*nodes)[key] = node;
+  return node;
 }
 
-bool TypeSpec::operator!=(const TypeSpec& other) const {
-  return !(other == *this);
+TypeSpec::TypeSpec() {
+  static const Node* empty = intern("", {});
+  m_node = empty;
 }
 
-bool TypeSpec::operator==(const TypeSpec& other) const {
-  if (other.m_type != m_type || other.m_arguments.size() != m_arguments.size()) {
-    return false;
-  }
+TypeSpec::TypeSpec(const std::string& type) : m_node(intern(type, {})) {}
 
-  for (size_t i = 0; i < m_arguments.size(); i++) {
-    if (other.m_arguments[i] != m_arguments[i]) {
-      return false;
-    }
-  }
+TypeSpec::TypeSpec(const std::string& type, const std::vector<TypeSpec>& arguments)
+    : m_node(intern(type, arguments)) {}
 
-  return true;
+void TypeSpec::add_arg(const TypeSpec& ts) {
+  auto arguments = m_node->arguments;
+  arguments.push_back(ts);
+  m_node = intern(m_node->type, arguments);
 }
 
 TypeSpec TypeSpec::substitute_for_method_call(const std::string& method_type) const {
-  TypeSpec result;
-  result.m_type = (m_type == "_type_") ? method_type : m_type;
-  for (const auto& x : m_arguments) {
-    result.m_arguments.push_back(x.substitute_for_method_call(method_type));
+  std::vector<TypeSpec> arguments;
+  for (const auto& x : m_node->arguments) {
+    arguments.push_back(x.substitute_for_method_call(method_type));
   }
-  return result;
+  return TypeSpec(base_type() == "_type_" ? method_type : base_type(), arguments);
 }
 
 bool TypeSpec::is_compatible_child_method(const TypeSpec& implementation,
                                           const std::string& child_type) const {
-  bool ok = implementation.m_type == m_type ||
-            (m_type == "_type_" && implementation.m_type == child_type);
-  if (!ok || implementation.m_arguments.size() != m_arguments.size()) {
+  bool ok = implementation.base_type() == base_type() ||
+            (base_type() == "_type_" && implementation.base_type() == child_type);
+  if (!ok || implementation.arg_count() != arg_count()) {
     return false;
   }
 
-  for (size_t i = 0; i < m_arguments.size(); i++) {
-    if (!m_arguments[i].is_compatible_child_method(implementation.m_arguments[i], child_type)) {
+  for (size_t i = 0; i < arg_count(); i++) {
+    if (!get_arg(i).is_compatible_child_method(implementation.get_arg(i), child_type)) {
       return false;
     }
   }
 
   return true;
-}
\ No newline at end of file
+}
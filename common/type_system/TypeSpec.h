@@ -8,6 +8,8 @@
 #ifndef JAK_TYPESPEC_H
 #define JAK_TYPESPEC_H
 
+#include <cstdint>
+#include <functional>
 #include <vector>
 #include <string>
 #include <cassert>
@@ -21,45 +23,66 @@ class Type;
  *
  * A compound type contains a "root type", which must by a Type, and a list of "type
  * arguments", which are TypeSpecs.
+ *
+ * TypeSpecs are hash-consed: each distinct TypeSpec is stored once in a global table, and a
+ * TypeSpec is just a pointer to its entry. Copies are cheap, and two TypeSpecs are equal only if
+ * they point to the same entry. Entries are never freed, and the table is safe to use from
+ * multiple threads.
  */
 class TypeSpec {
  public:
   // create a typespec for a single type
-  TypeSpec() = default;
-  TypeSpec(std::string type);
-  TypeSpec(std::string type, std::vector<TypeSpec> arguments);
+  TypeSpec();
+  TypeSpec(const std::string& type);
+  TypeSpec(const std::string& type, const std::vector<TypeSpec>& arguments);
 
-  bool operator!=(const TypeSpec& other) const;
-  bool operator==(const TypeSpec& other) const;
+  bool operator!=(const TypeSpec& other) const { return m_node != other.m_node; }
+  bool operator==(const TypeSpec& other) const { return m_node == other.m_node; }
   bool is_compatible_child_method(const TypeSpec& implementation,
                                   const std::string& child_type) const;
-  std::string print() const;
+  std::string print() const { return m_node->printed; }
 
-  void add_arg(const TypeSpec& ts) { m_arguments.push_back(ts); }
+  void add_arg(const TypeSpec& ts);
 
-  const std::string base_type() const { return m_type; }
+  const std::string& base_type() const { return m_node->type; }
 
-  bool has_single_arg() const { return m_arguments.size() == 1; }
+  bool has_single_arg() const { return m_node->arguments.size() == 1; }
 
   const TypeSpec& get_single_arg() const {
-    assert(m_arguments.size() == 1);
-    return m_arguments.front();
+    assert(m_node->arguments.size() == 1);
+    return m_node->arguments.front();
   }
 
   TypeSpec substitute_for_method_call(const std::string& method_type) const;
 
-  size_t arg_count() const { return m_arguments.size(); }
+  size_t arg_count() const { return m_node->arguments.size(); }
 
-  const TypeSpec& get_arg(int idx) const { return m_arguments.at(idx); }
+  const TypeSpec& get_arg(int idx) const { return m_node->arguments.at(idx); }
   const TypeSpec& last_arg() const {
-    assert(!m_arguments.empty());
-    return m_arguments.back();
+    assert(!m_node->arguments.empty());
+    return m_node->arguments.back();
   }
 
+  /*!
+   * A unique number for this TypeSpec, in the order TypeSpecs were first created.
+   */
+  uint32_t id() const { return m_node->id; }
+
+  struct hash {
+    auto operator()(const TypeSpec& x) const { return std::hash<uint32_t>()(x.id()); }
+  };
+
  private:
-  friend class TypeSystem;
-  std::string m_type;
-  std::vector<TypeSpec> m_arguments;
+  struct Node {
+    std::string type;
+    std::vector<TypeSpec> arguments;
+    std::string printed;
+    uint32_t id = 0;
+  };
+
+  static const Node* intern(const std::string& type, const std::vector<TypeSpec>& arguments);
+
+  const Node* m_node = nullptr;
 };
 
 #endif  // JAK_TYPESPEC_H
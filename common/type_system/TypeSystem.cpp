@@ -5,6 +5,7 @@
  * access types, and reverse type lookups.
  */
 
+#include <algorithm>
 #include <cassert>
 #include <stdexcept>
 #include <third-party/fmt/core.h>
@@ -40,6 +41,9 @@ Type* TypeSystem::add_type(const std::string& name, std::unique_ptr<Type> type)
 
         // update the type
         m_types[name] = std::move(type);
+
+        // the parent may have changed, which moves all children of this type too.
+        rebuild_hierarchy();
       } else {
         throw std::runtime_error("Type was redefined with throw_on_redefine set.");
       }
@@ -64,6 +68,7 @@ Type* TypeSystem::add_type(const std::string& name, std::unique_ptr<Type> type)
 
     m_types[name] = std::move(type);
     m_forward_declared_types.erase(name);
+    add_to_hierarchy(name);
   }
 
   return m_types[name].get();
@@ -929,18 +934,18 @@ bool TypeSystem::typecheck(const TypeSpec& expected,
   }
 
   // next argument checks:
-  if (expected.m_arguments.size() == actual.m_arguments.size()) {
-    for (size_t i = 0; i < expected.m_arguments.size(); i++) {
+  if (expected.arg_count() == actual.arg_count()) {
+    for (size_t i = 0; i < expected.arg_count(); i++) {
       // don't print/throw because the error would be confusing. Better to fail only the
       // outer most check and print a single error message.
-      if (!typecheck(expected.m_arguments[i], actual.m_arguments[i], "", false, false)) {
+      if (!typecheck(expected.get_arg(i), actual.get_arg(i), "", false, false)) {
         success = false;
         break;
       }
     }
   } else {
     // different sizes of arguments.
-    if (expected.m_arguments.empty()) {
+    if (expected.arg_count() == 0) {
       // we expect zero arguments, but got some. The actual type is more specific, so this is fine.
     } else {
       // different sizes, and we expected arguments. No good!
@@ -974,45 +979,87 @@ bool TypeSystem::typecheck_base_types(const std::string& expected,
                                       const std::string& actual) const {
   // just to make sure it exists. (note - could there be a case when it just has to be forward
   // declared, but not defined?)
-  lookup_type(expected);
+  int expected_id = lookup_hierarchy_id(expected);
 
-  if (expected == actual || expected == lookup_type_allow_partial_def(actual)->get_name()) {
-    lookup_type_allow_partial_def(actual);  // make sure it exists
-    return true;
+  int actual_id = -1;
+  auto kv = m_hierarchy_ids.find(actual);
+  if (kv != m_hierarchy_ids.end()) {
+    actual_id = kv->second;
+  } else {
+    // not fully defined, but may be forward declared as a basic or structure.
+    actual_id = lookup_hierarchy_id(lookup_type_allow_partial_def(actual)->get_name());
   }
 
-  std::string actual_name = actual;
-  auto actual_type = lookup_type_allow_partial_def(actual_name);
-  while (actual_type->has_parent()) {
-    actual_name = actual_type->get_parent();
-    actual_type = lookup_type_allow_partial_def(actual_name);
-
-    if (expected == actual_name) {
-      return true;
-    }
+  if (expected == actual) {
+    return true;
   }
 
-  return false;
+  auto& actual_node = m_hierarchy.at(actual_id);
+  int expected_depth = m_hierarchy.at(expected_id).depth;
+  return actual_node.depth >= expected_depth &&
+         actual_node.ancestors.at(expected_depth) == expected_id;
 }
 
 /*!
  * Get a path from type to object.
  */
 std::vector<std::string> TypeSystem::get_path_up_tree(const std::string& type) {
-  auto parent = lookup_type(type)->get_parent();
-  std::vector<std::string> path = {type};
-  path.push_back(parent);
-  auto parent_type = lookup_type(parent);
-
-  while (parent_type->has_parent()) {
-    parent = parent_type->get_parent();
-    parent_type = lookup_type(parent);
-    path.push_back(parent);
+  auto& node = m_hierarchy.at(lookup_hierarchy_id(type));
+  std::vector<std::string> path;
+  for (auto it = node.ancestors.rbegin(); it != node.ancestors.rend(); it++) {
+    path.push_back(m_hierarchy.at(*it).name);
   }
-
   return path;
 }
 
+/*!
+ * Get the id of a fully defined type in the type hierarchy. Throws if it doesn't exist.
+ */
+int TypeSystem::lookup_hierarchy_id(const std::string& name) const {
+  auto kv = m_hierarchy_ids.find(name);
+  if (kv == m_hierarchy_ids.end()) {
+    lookup_type(name);  // prints an error and throws.
+    throw std::runtime_error("lookup_hierarchy_id failed");
+  }
+  return kv->second;
+}
+
+/*!
+ * Add a fully defined type to the type hierarchy, after its parents.
+ */
+int TypeSystem::add_to_hierarchy(const std::string& name) {
+  auto kv = m_hierarchy_ids.find(name);
+  if (kv != m_hierarchy_ids.end()) {
+    return kv->second;
+  }
+
+  auto type = lookup_type(name);
+  HierarchyNode node;
+  node.name = name;
+  if (type->has_parent()) {
+    int parent_id = add_to_hierarchy(type->get_parent());
+    node.ancestors = m_hierarchy.at(parent_id).ancestors;
+    node.depth = m_hierarchy.at(parent_id).depth + 1;
+  }
+
+  int id = int(m_hierarchy.size());
+  node.ancestors.push_back(id);
+  m_hierarchy.push_back(std::move(node));
+  m_hierarchy_ids[name] = id;
+  return id;
+}
+
+/*!
+ * Rebuild the type hierarchy from scratch. Only needed when a type is redefined.
+ */
+void TypeSystem::rebuild_hierarchy() {
+  m_hierarchy.clear();
+  m_hierarchy_ids.clear();
+  for (auto& kv : m_types) {
+    add_to_hierarchy(kv.first);
+  }
+}
+
 /*!
  * Lowest common ancestor of two base types.
  */
@@ -1025,25 +1072,25 @@ std::string TypeSystem::lca_base(const std::string& a, const std::string& b) {
     return "none";
   }
 
-  auto a_up = get_path_up_tree(a);
-  auto b_up = get_path_up_tree(b);
-
-  int ai = a_up.size() - 1;
-  int bi = b_up.size() - 1;
+  auto& a_node = m_hierarchy.at(lookup_hierarchy_id(a));
+  auto& b_node = m_hierarchy.at(lookup_hierarchy_id(b));
+  if (a_node.ancestors.front() != b_node.ancestors.front()) {
+    throw std::runtime_error("Types " + a + " and " + b + " have no common ancestor");
+  }
 
-  std::string* result = nullptr;
-  while (ai >= 0 && bi >= 0) {
-    if (a_up.at(ai) == b_up.at(bi)) {
-      result = &a_up.at(ai);
+  // the ancestors match up to some depth, then never match again. Find the deepest match.
+  int lo = 0;
+  int hi = std::min(a_node.depth, b_node.depth);
+  while (lo < hi) {
+    int mid = (lo + hi + 1) / 2;
+    if (a_node.ancestors.at(mid) == b_node.ancestors.at(mid)) {
+      lo = mid;
     } else {
-      break;
+      hi = mid - 1;
     }
-    ai--;
-    bi--;
   }
 
-  assert(result);
-  return *result;
+  return m_hierarchy.at(a_node.ancestors.at(lo)).name;
 }
 
 /*!
@@ -1053,15 +1100,18 @@ std::string TypeSystem::lca_base(const std::string& a, const std::string& b) {
  * (lca(a, b) lca(b, d)).
  */
 TypeSpec TypeSystem::lowest_common_ancestor(const TypeSpec& a, const TypeSpec& b) {
-  auto result = make_typespec(lca_base(a.base_type(), b.base_type()));
-  if (!a.m_arguments.empty() && !b.m_arguments.empty() &&
-      a.m_arguments.size() == b.m_arguments.size()) {
+  if (a == b) {
+    return a;
+  }
+  auto base = make_typespec(lca_base(a.base_type(), b.base_type()));
+  std::vector<TypeSpec> arguments;
+  if (a.arg_count() > 0 && a.arg_count() == b.arg_count()) {
     // recursively add arguments
-    for (size_t i = 0; i < a.m_arguments.size(); i++) {
-      result.add_arg(lowest_common_ancestor(a.m_arguments.at(i), b.m_arguments.at(i)));
+    for (size_t i = 0; i < a.arg_count(); i++) {
+      arguments.push_back(lowest_common_ancestor(a.get_arg(i), b.get_arg(i)));
     }
   }
-  return result;
+  return TypeSpec(base.base_type(), arguments);
 }
 
 /*!
@@ -61,6 +61,7 @@ class TypeSystem {
   TypeSystem();
 
   Type* add_type(const std::string& name, std::unique_ptr<Type> type);
+  void set_allow_redefinition(bool allow) { m_allow_redefinition = allow; }
   void forward_declare_type(const std::string& name);
   void forward_declare_type_as_basic(const std::string& name);
   void forward_declare_type_as_structure(const std::string& name);
@@ -159,11 +160,27 @@ class TypeSystem {
                                     RegKind reg = RegKind::GPR_64);
   void builtin_structure_inherit(StructureType* st);
 
+  int lookup_hierarchy_id(const std::string& name) const;
+  int add_to_hierarchy(const std::string& name);
+  void rebuild_hierarchy();
+
   enum ForwardDeclareKind { TYPE, STRUCTURE, BASIC };
 
+  /*!
+   * A fully defined type's position in the tree of types. This is kept up to date as types are
+   * added, so typecheck and lowest common ancestor don't have to walk up the tree.
+   */
+  struct HierarchyNode {
+    std::string name;
+    int depth = 0;               // 0 for a type with no parent.
+    std::vector<int> ancestors;  // ancestors[d] is the id of the ancestor at depth d (or this type)
+  };
+
   std::unordered_map<std::string, std::unique_ptr<Type>> m_types;
   std::unordered_map<std::string, ForwardDeclareKind> m_forward_declared_types;
   std::vector<std::unique_ptr<Type>> m_old_types;
+  std::vector<HierarchyNode> m_hierarchy;                // indexed by id
+  std::unordered_map<std::string, int> m_hierarchy_ids;  // type name to id
 
   bool m_allow_redefinition = false;
 };
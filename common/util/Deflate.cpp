@@ -0,0 +1,658 @@
+/*!
+ * @file Deflate.cpp
+ * A small built-in deflate (RFC 1951) compressor with the zlib (RFC 1950) wrapper, used for PNGs.
+ *
+ * Matches are found with hash chains over the whole input, the same way zlib does it. The input is
+ * split into blocks of a fixed number of symbols, and each block is written with whichever of the
+ * three block types is smallest.
+ */
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+#include "Deflate.h"
+
+namespace deflate {
+namespace {
+
+constexpr int WINDOW_SIZE = 32768;
+constexpr int MIN_MATCH = 3;
+constexpr int MAX_MATCH = 258;
+constexpr int HASH_BITS = 15;
+constexpr size_t MAX_STORED_BLOCK = 65535;
+constexpr size_t SYMBOLS_PER_BLOCK = 16384;
+
+constexpr int LITLEN_CODES = 286;
+constexpr int FIXED_LITLEN_CODES = 288;
+constexpr int DIST_CODES = 30;
+constexpr int CODELEN_CODES = 19;
+constexpr int END_OF_BLOCK = 256;
+constexpr int MAX_CODE_BITS = 15;
+constexpr int MAX_CODELEN_BITS = 7;
+
+const u16 kLengthBase[29] = {3,  4,  5,  6,  7,  8,  9,  10, 11,  13,  15,  17,  19,  23, 27,
+                             31, 35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258};
+const u8 kLengthExtra[29] = {0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2,
+                             2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0};
+const u16 kDistBase[30] = {1,   2,   3,   4,   5,   7,    9,    13,   17,   25,
+                           33,  49,  65,  97,  129, 193,  257,  385,  513,  769,
+                           1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577};
+const u8 kDistExtra[30] = {0, 0, 0, 0, 1, 1, 2, 2,  3,  3,  4,  4,  5,  5,  6,
+                           6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13};
+// the order code length code lengths are written in a dynamic block header.
+const u8 kCodeLengthOrder[CODELEN_CODES] = {16, 17, 18, 0, 8,  7, 9,  6, 10, 5,
+                                            11, 4,  12, 3, 13, 2, 14, 1, 15};
+
+/*!
+ * A single LZ77 symbol: a literal byte if dist is 0, otherwise a match of length bytes.
+ */
+struct Symbol {
+  u16 lit_or_length;
+  u16 dist;
+};
+
+/*!
+ * A Huffman code. Codes are stored bit reversed, so they can be written LSB first.
+ */
+struct Code {
+  std::vector<u8> lengths;
+  std::vector<u16> codes;
+};
+
+/*!
+ * Build the canonical codes for these code lengths.
+ */
+std::vector<u16> canonical_codes(const std::vector<u8>& lengths) {
+  int count[MAX_CODE_BITS + 1] = {0};
+  for (auto len : lengths) {
+    count[len]++;
+  }
+  count[0] = 0;
+
+  u16 next_code[MAX_CODE_BITS + 1] = {0};
+  u16 code = 0;
+  for (int bits = 1; bits <= MAX_CODE_BITS; bits++) {
+    code = (code + count[bits - 1]) << 1;
+    next_code[bits] = code;
+  }
+
+  std::vector<u16> codes(lengths.size(), 0);
+  for (size_t i = 0; i < lengths.size(); i++) {
+    int len = lengths[i];
+    if (len) {
+      u16 c = next_code[len]++;
+      u16 reversed = 0;
+      for (int bit = 0; bit < len; bit++) {
+        reversed = (reversed << 1) | ((c >> bit) & 1);
+      }
+      codes[i] = reversed;
+    }
+  }
+  return codes;
+}
+
+/*!
+ * Build a Huffman code for these frequencies, with no code longer than max_bits.
+ * At least two symbols always get a code, so the code is complete, even if fewer are used.
+ */
+Code build_code(const std::vector<u32>& freqs, int max_bits) {
+  // symbols with a code, sorted by frequency.
+  std::vector<int> symbols;
+  for (int i = 0; i < int(freqs.size()); i++) {
+    if (freqs[i]) {
+      symbols.push_back(i);
+    }
+  }
+  for (int i = 0; symbols.size() < 2; i++) {
+    if (!freqs[i]) {
+      symbols.push_back(i);
+    }
+  }
+  std::stable_sort(symbols.begin(), symbols.end(),
+                   [&](int a, int b) { return freqs[a] < freqs[b]; });
+
+  // build the tree with the two queue method. Leaves are 0 to n - 1, nodes are after that.
+  int n = int(symbols.size());
+  std::vector<u64> weight(2 * n - 1);
+  std::vector<int> parent(2 * n - 1, 0);
+  for (int i = 0; i < n; i++) {
+    weight[i] = freqs[symbols[i]];
+  }
+  int next_leaf = 0, next_node = n;
+  auto take = [&](int end_of_nodes) {
+    if (next_leaf < n && (next_node >= end_of_nodes || weight[next_leaf] <= weight[next_node])) {
+      return next_leaf++;
+    }
+    return next_node++;
+  };
+  for (int node = n; node < 2 * n - 1; node++) {
+    int a = take(node);
+    int b = take(node);
+    weight[node] = weight[a] + weight[b];
+    parent[a] = node;
+    parent[b] = node;
+  }
+
+  // count the leaves at each depth.
+  std::vector<int> depth(2 * n - 1, 0);
+  std::vector<int> count(std::max(n, max_bits) + 1, 0);
+  for (int i = 2 * n - 3; i >= 0; i--) {
+    depth[i] = depth[parent[i]] + 1;
+  }
+  for (int i = 0; i < n; i++) {
+    count[depth[i]]++;
+  }
+
+  // move codes that are too long to max_bits, then fix up the lengths until the code is complete
+  // again, by making a shorter code one bit longer for each extra code.
+  for (int len = max_bits + 1; len < int(count.size()); len++) {
+    count[max_bits] += count[len];
+    count[len] = 0;
+  }
+  u32 total = 0;
+  for (int len = max_bits; len > 0; len--) {
+    total += u32(count[len]) << (max_bits - len);
+  }
+  while (total != (1u << max_bits)) {
+    count[max_bits]--;
+    for (int len = max_bits - 1; len > 0; len--) {
+      if (count[len]) {
+        count[len]--;
+        count[len + 1] += 2;
+        break;
+      }
+    }
+    total--;
+  }
+
+  // the least frequent symbols get the longest codes.
+  Code result;
+  result.lengths.resize(freqs.size(), 0);
+  int idx = 0;
+  for (int len = max_bits; len > 0; len--) {
+    for (int i = 0; i < count[len]; i++) {
+      result.lengths[symbols[idx++]] = len;
+    }
+  }
+  result.codes = canonical_codes(result.lengths);
+  return result;
+}
+
+struct Tables {
+  u8 length_code[MAX_MATCH + 1];
+  u8 dist_code[WINDOW_SIZE + 1];
+  Code fixed_litlen;
+  Code fixed_dist;
+
+  Tables() {
+    for (int code = 0; code < 29; code++) {
+      int end = code == 28 ? MAX_MATCH + 1 : kLengthBase[code + 1];
+      for (int len = kLengthBase[code]; len < end; len++) {
+        length_code[len] = code;
+      }
+    }
+    for (int code = 0; code < DIST_CODES; code++) {
+      int end = code == DIST_CODES - 1 ? WINDOW_SIZE + 1 : kDistBase[code + 1];
+      for (int dist = kDistBase[code]; dist < end; dist++) {
+        dist_code[dist] = code;
+      }
+    }
+
+    fixed_litlen.lengths.resize(FIXED_LITLEN_CODES);
+    for (int i = 0; i < FIXED_LITLEN_CODES; i++) {
+      fixed_litlen.lengths[i] = i < 144 ? 8 : i < 256 ? 9 : i < 280 ? 7 : 8;
+    }
+    fixed_litlen.codes = canonical_codes(fixed_litlen.lengths);
+    fixed_dist.lengths.resize(32, 5);
+    fixed_dist.codes = canonical_codes(fixed_dist.lengths);
+  }
+};
+
+const Tables& tables() {
+  static Tables t;
+  return t;
+}
+
+/*!
+ * Writes bits LSB first, like deflate wants.
+ */
+class BitWriter {
+ public:
+  explicit BitWriter(std::vector<u8>* out) : m_out(out) {}
+
+  void put(u32 bits, int count) {
+    m_buffer |= u64(bits) << m_count;
+    m_count += count;
+    while (m_count >= 8) {
+      m_out->push_back(u8(m_buffer));
+      m_buffer >>= 8;
+      m_count -= 8;
+    }
+  }
+
+  void put_code(const Code& code, int symbol) { put(code.codes[symbol], code.lengths[symbol]); }
+
+  void align() {
+    if (m_count) {
+      put(0, 8 - m_count);
+    }
+  }
+
+  void put_bytes(const u8* data, size_t size) {
+    assert(m_count == 0);
+    m_out->insert(m_out->end(), data, data + size);
+  }
+
+ private:
+  std::vector<u8>* m_out = nullptr;
+  u64 m_buffer = 0;
+  int m_count = 0;
+};
+
+/*!
+ * How many bytes at a and b are the same, up to max_length. Compares 8 bytes at a time.
+ */
+int match_length(const u8* a, const u8* b, int max_length) {
+  int length = 0;
+  while (length + 8 <= max_length) {
+    u64 x, y;
+    memcpy(&x, a + length, 8);
+    memcpy(&y, b + length, 8);
+    if (x != y) {
+      break;
+    }
+    length += 8;
+  }
+  while (length < max_length && a[length] == b[length]) {
+    length++;
+  }
+  return length;
+}
+
+/*!
+ * Finds matches with earlier data using hash chains. Positions are added to the chains as the
+ * searches move forward, so matches are only found with earlier data.
+ */
+class Matcher {
+ public:
+  struct Settings {
+    int max_chain;    // most earlier positions to check
+    int good_length;  // once a match this long is found, only check a quarter as many
+    int nice_length;  // stop at a match this long
+    int max_insert;   // don't add the positions inside longer matches to the hash chains
+    bool lazy;        // check for a longer match at the next byte before taking a match
+  };
+
+  Matcher(const u8* data, size_t size, const Settings& settings)
+      : m_data(data),
+        m_size(size),
+        m_settings(settings),
+        m_head(1 << HASH_BITS, -1),
+        m_prev(size, -1) {}
+
+  /*!
+   * Find the longest match at pos. Returns the length, or 0 if there's no match.
+   */
+  int find(size_t pos, int* dist) {
+    insert_until(pos);
+    if (pos + MIN_MATCH > m_size) {
+      return 0;
+    }
+
+    const u8* current = m_data + pos;
+    int max_length = int(std::min(size_t(MAX_MATCH), m_size - pos));
+    int best = MIN_MATCH - 1;
+    int chain = m_settings.max_chain;
+    for (int candidate = m_head[hash(pos)];
+         candidate >= 0 && pos - candidate <= WINDOW_SIZE && chain > 0;
+         candidate = m_prev[candidate], chain--) {
+      const u8* prev = m_data + candidate;
+      // the byte that would make this match longer than the best one has to match.
+      if (prev[best] != current[best]) {
+        continue;
+      }
+      int length = match_length(prev, current, max_length);
+      if (length > best) {
+        if (best < m_settings.good_length && length >= m_settings.good_length) {
+          chain >>= 2;
+        }
+        best = length;
+        *dist = int(pos - candidate);
+        if (length >= m_settings.nice_length || length == max_length) {
+          break;
+        }
+      }
+    }
+    return best >= MIN_MATCH ? best : 0;
+  }
+
+  /*!
+   * Called after taking a match at pos which ends at end. Skips adding the positions inside long
+   * matches to the hash chains, which is faster, but may miss some later matches.
+   */
+  void matched(size_t pos, size_t end) {
+    if (int(end - pos) > m_settings.max_insert) {
+      insert_until(pos + 1);
+      m_inserted = std::max(m_inserted, end);
+    }
+  }
+
+ private:
+  u32 hash(size_t pos) const {
+    u32 x = m_data[pos] | (m_data[pos + 1] << 8) | (m_data[pos + 2] << 16);
+    return (x * 2654435761u) >> (32 - HASH_BITS);
+  }
+
+  void insert_until(size_t pos) {
+    size_t end = std::min(pos, m_size < MIN_MATCH ? 0 : m_size - MIN_MATCH + 1);
+    for (; m_inserted < end; m_inserted++) {
+      auto& head = m_head[hash(m_inserted)];
+      m_prev[m_inserted] = head;
+      head = int(m_inserted);
+    }
+  }
+
+  const u8* m_data = nullptr;
+  size_t m_size = 0;
+  Settings m_settings;
+  std::vector<int> m_head;
+  std::vector<int> m_prev;
+  size_t m_inserted = 0;
+};
+
+void write_stored(BitWriter& out, const u8* data, size_t size, bool last) {
+  do {
+    size_t chunk = std::min(size, MAX_STORED_BLOCK);
+    out.put(last && chunk == size, 1);
+    out.put(0, 2);
+    out.align();
+    out.put(u32(chunk), 16);
+    out.put(u32(~chunk) & 0xffff, 16);
+    out.put_bytes(data, chunk);
+    data += chunk;
+    size -= chunk;
+  } while (size > 0);
+}
+
+/*!
+ * The lengths to write in the header of a dynamic block, run length encoded with codes 16 to 18.
+ */
+struct CodeLengthSymbol {
+  u8 symbol;
+  u8 extra;
+};
+
+std::vector<CodeLengthSymbol> encode_code_lengths(const std::vector<u8>& lengths) {
+  std::vector<CodeLengthSymbol> result;
+  for (size_t i = 0; i < lengths.size();) {
+    u8 len = lengths[i];
+    size_t run = 1;
+    while (i + run < lengths.size() && lengths[i + run] == len) {
+      run++;
+    }
+    i += run;
+
+    if (len == 0) {
+      while (run >= 11) {
+        size_t n = std::min(run, size_t(138));
+        result.push_back({18, u8(n - 11)});
+        run -= n;
+      }
+      if (run >= 3) {
+        result.push_back({17, u8(run - 3)});
+        run = 0;
+      }
+    } else {
+      result.push_back({len, 0});
+      run--;
+      while (run >= 3) {
+        size_t n = std::min(run, size_t(6));
+        result.push_back({16, u8(n - 3)});
+        run -= n;
+      }
+    }
+    for (; run > 0; run--) {
+      result.push_back({len, 0});
+    }
+  }
+  return result;
+}
+
+void write_symbols(BitWriter& out,
+                   const std::vector<Symbol>& symbols,
+                   const Code& litlen,
+                   const Code& dist) {
+  auto& t = tables();
+  for (auto& sym : symbols) {
+    if (!sym.dist) {
+      out.put_code(litlen, sym.lit_or_length);
+    } else {
+      int length_code = t.length_code[sym.lit_or_length];
+      out.put_code(litlen, 257 + length_code);
+      out.put(sym.lit_or_length - kLengthBase[length_code], kLengthExtra[length_code]);
+      int dist_code = t.dist_code[sym.dist];
+      out.put_code(dist, dist_code);
+      out.put(sym.dist - kDistBase[dist_code], kDistExtra[dist_code]);
+    }
+  }
+  out.put_code(litlen, END_OF_BLOCK);
+}
+
+/*!
+ * Write the symbols for the given data as a single block (or several stored blocks), using the
+ * smallest block type.
+ */
+void write_block(BitWriter& out,
+                 const std::vector<Symbol>& symbols,
+                 const u8* data,
+                 size_t size,
+                 bool last) {
+  auto& t = tables();
+  std::vector<u32> litlen_freqs(LITLEN_CODES, 0);
+  std::vector<u32> dist_freqs(DIST_CODES, 0);
+  u64 extra_bits = 0;
+  for (auto& sym : symbols) {
+    if (!sym.dist) {
+      litlen_freqs[sym.lit_or_length]++;
+    } else {
+      int length_code = t.length_code[sym.lit_or_length];
+      int dist_code = t.dist_code[sym.dist];
+      litlen_freqs[257 + length_code]++;
+      dist_freqs[dist_code]++;
+      extra_bits += kLengthExtra[length_code] + kDistExtra[dist_code];
+    }
+  }
+  litlen_freqs[END_OF_BLOCK]++;
+
+  auto data_bits = [&](const Code& litlen, const Code& dist) {
+    u64 bits = extra_bits;
+    for (int i = 0; i < LITLEN_CODES; i++) {
+      bits += u64(litlen_freqs[i]) * litlen.lengths[i];
+    }
+    for (int i = 0; i < DIST_CODES; i++) {
+      bits += u64(dist_freqs[i]) * dist.lengths[i];
+    }
+    return bits;
+  };
+
+  // dynamic block
+  Code litlen = build_code(litlen_freqs, MAX_CODE_BITS);
+  Code dist = build_code(dist_freqs, MAX_CODE_BITS);
+  int hlit = LITLEN_CODES;
+  while (hlit > 257 && !litlen.lengths[hlit - 1]) {
+    hlit--;
+  }
+  int hdist = DIST_CODES;
+  while (hdist > 1 && !dist.lengths[hdist - 1]) {
+    hdist--;
+  }
+  std::vector<u8> all_lengths(litlen.lengths.begin(), litlen.lengths.begin() + hlit);
+  all_lengths.insert(all_lengths.end(), dist.lengths.begin(), dist.lengths.begin() + hdist);
+  auto header = encode_code_lengths(all_lengths);
+  std::vector<u32> codelen_freqs(CODELEN_CODES, 0);
+  for (auto& sym : header) {
+    codelen_freqs[sym.symbol]++;
+  }
+  Code codelen = build_code(codelen_freqs, MAX_CODELEN_BITS);
+  int hclen = CODELEN_CODES;
+  while (hclen > 4 && !codelen.lengths[kCodeLengthOrder[hclen - 1]]) {
+    hclen--;
+  }
+
+  u64 dynamic_bits = 3 + 5 + 5 + 4 + 3 * hclen + data_bits(litlen, dist);
+  for (auto& sym : header) {
+    dynamic_bits += codelen.lengths[sym.symbol];
+    dynamic_bits += sym.symbol == 16 ? 2 : sym.symbol == 17 ? 3 : sym.symbol == 18 ? 7 : 0;
+  }
+  u64 fixed_bits = 3 + data_bits(t.fixed_litlen, t.fixed_dist);
+  u64 stored_bits = 8 * size + 40 * (size / MAX_STORED_BLOCK + 1) + 7;
+
+  if (stored_bits <= dynamic_bits && stored_bits <= fixed_bits) {
+    write_stored(out, data, size, last);
+  } else if (fixed_bits <= dynamic_bits) {
+    out.put(last, 1);
+    out.put(1, 2);
+    write_symbols(out, symbols, t.fixed_litlen, t.fixed_dist);
+  } else {
+    out.put(last, 1);
+    out.put(2, 2);
+    out.put(hlit - 257, 5);
+    out.put(hdist - 1, 5);
+    out.put(hclen - 4, 4);
+    for (int i = 0; i < hclen; i++) {
+      out.put(codelen.lengths[kCodeLengthOrder[i]], 3);
+    }
+    for (auto& sym : header) {
+      out.put_code(codelen, sym.symbol);
+      if (sym.symbol == 16) {
+        out.put(sym.extra, 2);
+      } else if (sym.symbol == 17) {
+        out.put(sym.extra, 3);
+      } else if (sym.symbol == 18) {
+        out.put(sym.extra, 7);
+      }
+    }
+    write_symbols(out, symbols, litlen, dist);
+  }
+}
+
+void write_compressed(BitWriter& out, const u8* data, size_t size, Level level) {
+  // similar to zlib's levels 2 and 9.
+  Matcher::Settings settings = level == Level::BEST
+                                   ? Matcher::Settings{1024, 32, MAX_MATCH, MAX_MATCH, true}
+                                   : Matcher::Settings{8, 8, 32, 8, false};
+  Matcher matcher(data, size, settings);
+
+  std::vector<Symbol> symbols;
+  symbols.reserve(SYMBOLS_PER_BLOCK);
+  size_t block_start = 0;
+  size_t pos = 0;
+  int length = 0, dist = 0;
+  bool have_match = false;  // already searched at pos
+  while (pos < size) {
+    if (!have_match) {
+      length = matcher.find(pos, &dist);
+    }
+    have_match = false;
+
+    // lazy matching: if there's a longer match at the next byte, use that instead.
+    if (settings.lazy && length && length < settings.nice_length && pos + 1 < size) {
+      int next_dist = 0;
+      int next_length = matcher.find(pos + 1, &next_dist);
+      if (next_length > length) {
+        symbols.push_back({data[pos], 0});
+        pos++;
+        length = next_length;
+        dist = next_dist;
+        have_match = true;
+      }
+    }
+
+    if (!have_match) {
+      if (length) {
+        symbols.push_back({u16(length), u16(dist)});
+        matcher.matched(pos, pos + length);
+        pos += length;
+      } else {
+        symbols.push_back({data[pos], 0});
+        pos++;
+      }
+    }
+
+    // a pending match may cross the end of the block, so only split blocks between symbols.
+    if (symbols.size() >= SYMBOLS_PER_BLOCK && !have_match) {
+      write_block(out, symbols, data + block_start, pos - block_start, false);
+      symbols.clear();
+      block_start = pos;
+    }
+  }
+  write_block(out, symbols, data + block_start, pos - block_start, true);
+}
+
+}  // namespace
+
+std::vector<u8> zlib_compress(const u8* data, size_t size, Level level) {
+  std::vector<u8> result;
+  result.reserve(level == Level::STORED ? size + size / MAX_STORED_BLOCK * 5 + 16 : size / 2);
+  // 32 kB window, deflate. The second byte is the compression level hint and check bits.
+  result.push_back(0x78);
+  result.push_back(level == Level::BEST ? 0xda : 0x01);
+
+  BitWriter out(&result);
+  if (level == Level::STORED) {
+    write_stored(out, data, size, true);
+  } else {
+    write_compressed(out, data, size, level);
+  }
+  out.align();
+
+  u32 check = adler32(data, size);
+  for (int shift = 24; shift >= 0; shift -= 8) {
+    result.push_back(u8(check >> shift));
+  }
+  return result;
+}
+
+u32 adler32(const u8* data, size_t size, u32 adler) {
+  constexpr u32 MOD = 65521;
+  // the most bytes that can be summed before b can overflow.
+  constexpr size_t MAX_RUN = 5552;
+  u32 a = adler & 0xffff;
+  u32 b = adler >> 16;
+  while (size) {
+    size_t run = std::min(size, MAX_RUN);
+    size -= run;
+    for (size_t i = 0; i < run; i++) {
+      a += data[i];
+      b += a;
+    }
+    data += run;
+    a %= MOD;
+    b %= MOD;
+  }
+  return (b << 16) | a;
+}
+
+u32 zlib_crc32(const u8* data, size_t size, u32 crc) {
+  struct CrcTable {
+    u32 table[256];
+    CrcTable() {
+      for (u32 i = 0; i < 256; i++) {
+        u32 c = i;
+        for (int bit = 0; bit < 8; bit++) {
+          c = (c & 1) ? 0xedb88320u ^ (c >> 1) : c >> 1;
+        }
+        table[i] = c;
+      }
+    }
+  };
+  static const CrcTable crc_table;
+
+  crc = ~crc;
+  for (size_t i = 0; i < size; i++) {
+    crc = crc_table.table[(crc ^ data[i]) & 0xff] ^ (crc >> 8);
+  }
+  return ~crc;
+}
+
+}  // namespace deflate
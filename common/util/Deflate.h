@@ -0,0 +1,33 @@
+#pragma once
+
+/*!
+ * @file Deflate.h
+ * A small built-in deflate (RFC 1951) compressor with the zlib (RFC 1950) wrapper, used for PNGs.
+ */
+
+#include <cstddef>
+#include <vector>
+#include "common/common_types.h"
+
+namespace deflate {
+
+enum class Level {
+  STORED,  // no compression, just the deflate framing.
+  FAST,    // greedy matching with short hash chains.
+  BEST     // lazy matching with long hash chains.
+};
+
+/*!
+ * Compress data to a zlib stream. Each block uses stored, fixed Huffman or dynamic Huffman codes,
+ * whichever is smallest.
+ */
+std::vector<u8> zlib_compress(const u8* data, size_t size, Level level);
+
+u32 adler32(const u8* data, size_t size, u32 adler = 1);
+
+/*!
+ * The CRC-32 used by zlib and PNG. This is not the same as file_util::crc32.
+ */
+u32 zlib_crc32(const u8* data, size_t size, u32 crc = 0);
+
+}  // namespace deflate
@@ -4,15 +4,17 @@
  */
 
 #include "FileUtil.h"
+#include <algorithm>
 #include <iostream>
 #include <filesystem>
 #include <cstdio> /* defines FILENAME_MAX */
 #include <fstream>
 #include <sstream>
 #include <cassert>
+#include <cstdlib>
+#include <cstring>
 #include "BinaryWriter.h"
 #include "common/common_types.h"
-#include "third-party/svpng.h"
 
 #ifdef _WIN32
 #include <Windows.h>
@@ -83,15 +85,102 @@ void write_binary_file(const std::string& name, void* data, size_t size) {
   fclose(fp);
 }
 
-void write_rgba_png(const std::string& name, void* data, int w, int h) {
-  FILE* fp = fopen(name.c_str(), "wb");
-  if (!fp) {
-    throw std::runtime_error("couldn't open file " + name);
+namespace {
+u8 paeth_predictor(int a, int b, int c) {
+  int p = a + b - c;
+  int pa = std::abs(p - a), pb = std::abs(p - b), pc = std::abs(p - c);
+  if (pa <= pb && pa <= pc) {
+    return a;
+  }
+  return pb <= pc ? b : c;
+}
+
+/*!
+ * Apply a PNG filter to a row and return the sum of the differences, as signed bytes. prev is the
+ * unfiltered previous row, and predict(left, up, up_left) is the filter's predictor.
+ * Pixels are 4 bytes.
+ */
+template <typename Predict>
+u64 filter_row(const u8* row, const u8* prev, size_t size, u8* out, Predict predict) {
+  // the first pixel has nothing to the left.
+  for (size_t i = 0; i < 4 && i < size; i++) {
+    out[i] = row[i] - predict(0, prev[i], 0);
+  }
+  for (size_t i = 4; i < size; i++) {
+    out[i] = row[i] - predict(row[i - 4], prev[i], prev[i - 4]);
   }
+  u64 cost = 0;
+  for (size_t i = 0; i < size; i++) {
+    cost += std::abs(int(s8(out[i])));
+  }
+  return cost;
+}
 
-  svpng(fp, w, h, (const unsigned char*)data, 1);
+void append_u32_be(std::vector<u8>& out, u32 x) {
+  for (int shift = 24; shift >= 0; shift -= 8) {
+    out.push_back(u8(x >> shift));
+  }
+}
 
-  fclose(fp);
+void append_chunk(std::vector<u8>& out, const char* type, const std::vector<u8>& data) {
+  append_u32_be(out, u32(data.size()));
+  out.insert(out.end(), type, type + 4);
+  out.insert(out.end(), data.begin(), data.end());
+  u32 crc = deflate::zlib_crc32((const u8*)type, 4);
+  append_u32_be(out, deflate::zlib_crc32(data.data(), data.size(), crc));
+}
+}  // namespace
+
+std::vector<uint8_t> encode_rgba_png(const void* data, int w, int h, deflate::Level level) {
+  // filter each row. Stored images aren't compressed, so filtering wouldn't help.
+  // Otherwise, pick the filter with the smallest sum of differences, like libpng does.
+  size_t row_size = size_t(w) * 4;
+  std::vector<u8> filtered((row_size + 1) * h);
+  std::vector<u8> zero_row(row_size, 0);
+  std::vector<std::vector<u8>> candidates(5, std::vector<u8>(row_size));
+  for (int y = 0; y < h; y++) {
+    const u8* row = (const u8*)data + row_size * y;
+    const u8* prev = y ? row - row_size : zero_row.data();
+    u8* out = filtered.data() + (row_size + 1) * y;
+    out[0] = 0;
+    memcpy(out + 1, row, row_size);
+    if (level == deflate::Level::STORED) {
+      continue;
+    }
+
+    u64 costs[5];
+    costs[0] = filter_row(row, prev, row_size, candidates[0].data(),
+                          [](int, int, int) { return 0; });
+    costs[1] = filter_row(row, prev, row_size, candidates[1].data(),
+                          [](int left, int, int) { return left; });
+    costs[2] = filter_row(row, prev, row_size, candidates[2].data(),
+                          [](int, int up, int) { return up; });
+    costs[3] = filter_row(row, prev, row_size, candidates[3].data(),
+                          [](int left, int up, int) { return (left + up) >> 1; });
+    costs[4] = filter_row(row, prev, row_size, candidates[4].data(), paeth_predictor);
+    int best = int(std::min_element(costs, costs + 5) - costs);
+    out[0] = best;
+    memcpy(out + 1, candidates[best].data(), row_size);
+  }
+
+  std::vector<u8> header;
+  append_u32_be(header, w);
+  append_u32_be(header, h);
+  // 8 bits per channel, RGBA, deflate, standard filters, no interlacing.
+  for (u8 x : {8, 6, 0, 0, 0}) {
+    header.push_back(x);
+  }
+
+  std::vector<u8> result = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1a, '\n'};
+  append_chunk(result, "IHDR", header);
+  append_chunk(result, "IDAT", deflate::zlib_compress(filtered.data(), filtered.size(), level));
+  append_chunk(result, "IEND", {});
+  return result;
+}
+
+void write_rgba_png(const std::string& name, void* data, int w, int h, deflate::Level level) {
+  auto png = encode_rgba_png(data, w, h, level);
+  write_binary_file(name, png.data(), png.size());
 }
 
 void write_text_file(const std::string& file_name, const std::string& text) {
@@ -155,6 +244,48 @@ std::string base_name(const std::string& filename) {
   return filename.substr(pos);
 }
 
+/*!
+ * Does the name match the glob pattern? In the pattern, * matches any number of characters and ?
+ * matches any single character.
+ */
+bool glob_match(const std::string& pattern, const std::string& name) {
+  size_t p = 0, n = 0;
+  // position of the last * seen, and the character of name it's currently matched up to.
+  size_t star = std::string::npos, star_n = 0;
+  while (n < name.size()) {
+    if (p < pattern.size() && (pattern[p] == '?' || pattern[p] == name[n])) {
+      p++;
+      n++;
+    } else if (p < pattern.size() && pattern[p] == '*') {
+      star = p++;
+      star_n = n;
+    } else if (star != std::string::npos) {
+      // let the last * match one more character and try again from there.
+      p = star + 1;
+      n = ++star_n;
+    } else {
+      return false;
+    }
+  }
+
+  while (p < pattern.size() && pattern[p] == '*') {
+    p++;
+  }
+  return p == pattern.size();
+}
+
+/*!
+ * Does the name match any of the glob patterns?
+ */
+bool glob_match_any(const std::vector<std::string>& patterns, const std::string& name) {
+  for (auto& pattern : patterns) {
+    if (glob_match(pattern, name)) {
+      return true;
+    }
+  }
+  return false;
+}
+
 static bool sInitCrc = false;
 static uint32_t crc_table[0x100];
 
@@ -7,19 +7,27 @@
 
 #include <string>
 #include <vector>
+#include "Deflate.h"
 
 namespace file_util {
 std::string get_project_path();
 std::string get_file_path(const std::vector<std::string>& input);
 bool create_dir_if_needed(const std::string& path);
 void write_binary_file(const std::string& name, void* data, size_t size);
-void write_rgba_png(const std::string& name, void* data, int w, int h);
+std::vector<uint8_t> encode_rgba_png(const void* data, int w, int h, deflate::Level level);
+void write_rgba_png(const std::string& name,
+                    void* data,
+                    int w,
+                    int h,
+                    deflate::Level level = deflate::Level::FAST);
 void write_text_file(const std::string& file_name, const std::string& text);
 std::vector<uint8_t> read_binary_file(const std::string& filename);
 std::string read_text_file(const std::string& path);
 bool is_printable_char(char c);
 std::string combine_path(const std::string& parent, const std::string& child);
 std::string base_name(const std::string& filename);
+bool glob_match(const std::string& pattern, const std::string& name);
+bool glob_match_any(const std::vector<std::string>& patterns, const std::string& name);
 void init_crc();
 uint32_t crc32(const uint8_t* data, size_t size);
 uint32_t crc32(const std::vector<uint8_t>& data);
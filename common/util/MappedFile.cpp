@@ -0,0 +1,60 @@
+/*!
+ * @file MappedFile.cpp
+ * Read-only memory mapping of a file.
+ */
+
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <fcntl.h>
+#include <sys/stat.h>
+
+#ifdef __linux__
+#include <unistd.h>
+#include <sys/mman.h>
+#elif _WIN32
+#include <io.h>
+#include <third-party/mman/mman.h>
+#endif
+
+#include "MappedFile.h"
+
+MappedFile::MappedFile(const std::string& filename) : m_name(filename) {
+#ifdef _WIN32
+  int fd = _open(filename.c_str(), _O_RDONLY | _O_BINARY);
+#else
+  int fd = open(filename.c_str(), O_RDONLY);
+#endif
+  if (fd < 0) {
+    throw std::runtime_error("File " + filename +
+                             " cannot be opened: " + std::string(strerror(errno)));
+  }
+
+  struct stat info;
+  if (fstat(fd, &info) != 0) {
+    close(fd);
+    throw std::runtime_error("File " + filename +
+                             " cannot be read: " + std::string(strerror(errno)));
+  }
+  m_size = info.st_size;
+
+  // mmap doesn't allow empty mappings, so leave data as nullptr.
+  if (m_size) {
+    void* mem = mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (mem == MAP_FAILED) {
+      close(fd);
+      throw std::runtime_error("File " + filename +
+                               " cannot be mapped: " + std::string(strerror(errno)));
+    }
+    m_data = (const uint8_t*)mem;
+  }
+
+  // the mapping stays valid after closing the file.
+  close(fd);
+}
+
+MappedFile::~MappedFile() {
+  if (m_data) {
+    munmap(const_cast<uint8_t*>(m_data), m_size);
+  }
+}
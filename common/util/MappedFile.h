@@ -0,0 +1,32 @@
+#pragma once
+
+/*!
+ * @file MappedFile.h
+ * Read-only memory mapping of a file.
+ */
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+/*!
+ * A read-only memory mapping of an entire file.
+ * Pages are only read from disk when they are touched, and are backed by the file, so they can be
+ * dropped by the OS without swapping.
+ */
+class MappedFile {
+ public:
+  explicit MappedFile(const std::string& filename);
+  ~MappedFile();
+  MappedFile(const MappedFile&) = delete;
+  MappedFile& operator=(const MappedFile&) = delete;
+
+  const uint8_t* data() const { return m_data; }
+  size_t size() const { return m_size; }
+  const std::string& name() const { return m_name; }
+
+ private:
+  std::string m_name;
+  const uint8_t* m_data = nullptr;
+  size_t m_size = 0;
+};
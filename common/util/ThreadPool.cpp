@@ -0,0 +1,162 @@
+/*!
+ * @file ThreadPool.cpp
+ * A small work-stealing thread pool.
+ */
+
+#include "ThreadPool.h"
+
+namespace {
+// the pool and queue index of the current thread, if it is a worker.
+thread_local const ThreadPool* t_pool = nullptr;
+thread_local size_t t_queue_idx = 0;
+}  // namespace
+
+ThreadPool::ThreadPool(int thread_count) {
+  if (thread_count <= 0) {
+    thread_count = int(std::thread::hardware_concurrency());
+  }
+
+  // the thread waiting on the pool also runs tasks, so it counts as one of the threads.
+  for (int i = 1; i < thread_count; i++) {
+    m_queues.push_back(std::make_unique<Queue>());
+  }
+
+  for (int i = 1; i < thread_count; i++) {
+    m_workers.emplace_back(&ThreadPool::worker_loop, this, i - 1);
+  }
+}
+
+ThreadPool::~ThreadPool() {
+  {
+    std::lock_guard<std::mutex> lk(m_lock);
+    m_stop = true;
+  }
+  m_cv.notify_all();
+  for (auto& worker : m_workers) {
+    worker.join();
+  }
+}
+
+void ThreadPool::run(std::function<void()> task) {
+  if (m_workers.empty()) {
+    try {
+      task();
+    } catch (...) {
+      m_run_group.set_exception(std::current_exception());
+    }
+    return;
+  }
+
+  m_run_group.remaining++;
+  submit([this, task = std::move(task)]() {
+    try {
+      task();
+    } catch (...) {
+      m_run_group.set_exception(std::current_exception());
+    }
+    finish(m_run_group);
+  });
+}
+
+void ThreadPool::wait() {
+  help_until(m_run_group);
+  std::exception_ptr e;
+  {
+    std::lock_guard<std::mutex> lk(m_run_group.lock);
+    std::swap(e, m_run_group.exception);
+  }
+  if (e) {
+    std::rethrow_exception(e);
+  }
+}
+
+/*!
+ * Add a task to a queue. Workers add to their own queue, other threads spread tasks evenly.
+ */
+void ThreadPool::submit(std::function<void()> task) {
+  size_t idx = t_pool == this ? t_queue_idx : (m_next_queue++ % m_queues.size());
+  {
+    std::lock_guard<std::mutex> lk(m_queues.at(idx)->lock);
+    m_queues.at(idx)->tasks.push_back(std::move(task));
+  }
+
+  {
+    std::lock_guard<std::mutex> lk(m_lock);
+    m_queued++;
+  }
+  m_cv.notify_one();
+}
+
+/*!
+ * Mark a task in a group as done, waking up anybody waiting on the group if it was the last one.
+ */
+void ThreadPool::finish(Group& group) {
+  if (--group.remaining == 0) {
+    // take the lock so the notification can't slip in between a waiter's check and its wait.
+    { std::lock_guard<std::mutex> lk(m_lock); }
+    m_cv.notify_all();
+  }
+}
+
+/*!
+ * Run a single task. Workers check their own queue first (newest task), then steal the oldest
+ * task from other queues. Returns false if there was nothing to run.
+ */
+bool ThreadPool::try_run_one() {
+  std::function<void()> task;
+  size_t n_queues = m_queues.size();
+  size_t start = t_pool == this ? t_queue_idx : 0;
+
+  for (size_t i = 0; i < n_queues && !task; i++) {
+    auto& q = *m_queues.at((start + i) % n_queues);
+    std::lock_guard<std::mutex> lk(q.lock);
+    if (!q.tasks.empty()) {
+      if (i == 0 && t_pool == this) {
+        task = std::move(q.tasks.back());
+        q.tasks.pop_back();
+      } else {
+        task = std::move(q.tasks.front());
+        q.tasks.pop_front();
+      }
+    }
+  }
+
+  if (!task) {
+    return false;
+  }
+
+  {
+    std::lock_guard<std::mutex> lk(m_lock);
+    m_queued--;
+  }
+  task();
+  return true;
+}
+
+/*!
+ * Run tasks until everything in the group is done.
+ */
+void ThreadPool::help_until(Group& group) {
+  while (group.remaining) {
+    if (!try_run_one()) {
+      std::unique_lock<std::mutex> lk(m_lock);
+      m_cv.wait(lk, [&]() { return m_queued > 0 || group.remaining == 0; });
+    }
+  }
+}
+
+void ThreadPool::worker_loop(int idx) {
+  t_pool = this;
+  t_queue_idx = idx;
+  while (true) {
+    if (try_run_one()) {
+      continue;
+    }
+
+    std::unique_lock<std::mutex> lk(m_lock);
+    m_cv.wait(lk, [&]() { return m_stop || m_queued > 0; });
+    if (m_stop && m_queued == 0) {
+      return;
+    }
+  }
+}
@@ -0,0 +1,123 @@
+#pragma once
+
+/*!
+ * @file ThreadPool.h
+ * A small work-stealing thread pool.
+ */
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/*!
+ * A work-stealing thread pool.
+ * Each worker has its own queue of tasks. Workers take work from the back of their own queue and
+ * steal from the front of other queues when they run out. Tasks submitted from inside a task go on
+ * the current worker's queue.
+ *
+ * A thread waiting on the pool (wait or parallel_for) runs tasks while it waits, so it is safe to
+ * use parallel_for from inside a task.
+ *
+ * A pool with a thread count of 1 has no worker threads and runs everything on the calling thread,
+ * in submission order.
+ */
+class ThreadPool {
+ public:
+  /*!
+   * Create a pool which runs tasks on thread_count threads (including the waiting thread).
+   * If thread_count is <= 0, uses one thread per hardware thread.
+   */
+  explicit ThreadPool(int thread_count = 0);
+  ~ThreadPool();
+  ThreadPool(const ThreadPool&) = delete;
+  ThreadPool& operator=(const ThreadPool&) = delete;
+
+  /*!
+   * Submit a task to be run at some point. Use wait() to wait for it to finish.
+   */
+  void run(std::function<void()> task);
+
+  /*!
+   * Wait for all tasks submitted with run() to finish.
+   * If any of these threw, rethrows the first exception.
+   */
+  void wait();
+
+  /*!
+   * Call f(i) for i in [0, count), in parallel. Returns once all calls have finished.
+   * If any call threw, rethrows the first exception after all other calls have finished.
+   */
+  template <typename Func>
+  void parallel_for(size_t count, Func f) {
+    if (m_workers.empty()) {
+      for (size_t i = 0; i < count; i++) {
+        f(i);
+      }
+      return;
+    }
+
+    auto group = std::make_shared<Group>();
+    group->remaining = count;
+    for (size_t i = 0; i < count; i++) {
+      submit([this, group, &f, i]() {
+        try {
+          f(i);
+        } catch (...) {
+          group->set_exception(std::current_exception());
+        }
+        finish(*group);
+      });
+    }
+
+    help_until(*group);
+    if (group->exception) {
+      std::rethrow_exception(group->exception);
+    }
+  }
+
+  int thread_count() const { return int(m_workers.size()) + 1; }
+
+ private:
+  /*!
+   * A set of tasks which can be waited on together.
+   */
+  struct Group {
+    std::atomic<size_t> remaining = 0;
+    std::mutex lock;
+    std::exception_ptr exception;
+    void set_exception(std::exception_ptr e) {
+      std::lock_guard<std::mutex> lk(lock);
+      if (!exception) {
+        exception = e;
+      }
+    }
+  };
+
+  struct Queue {
+    std::mutex lock;
+    std::deque<std::function<void()>> tasks;
+  };
+
+  void submit(std::function<void()> task);
+  void finish(Group& group);
+  bool try_run_one();
+  void help_until(Group& group);
+  void worker_loop(int idx);
+
+  std::vector<std::thread> m_workers;
+  std::vector<std::unique_ptr<Queue>> m_queues;  // one per worker
+  std::atomic<size_t> m_next_queue = 0;
+
+  std::mutex m_lock;
+  std::condition_variable m_cv;
+  size_t m_queued = 0;  // tasks sitting in a queue, protected by m_lock
+  bool m_stop = false;
+
+  Group m_run_group;  // tasks from run()
+};
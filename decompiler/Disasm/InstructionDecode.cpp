@@ -880,9 +880,9 @@ static InstructionKind decode_cache(OpcodeFields fields) {
 }
 
 /*!
- * Top level opcode decode
+ * Top level opcode decode, using nested switches. The decode tables are built from this.
  */
-static InstructionKind decode_opcode(uint32_t code) {
+InstructionKind decode_opcode_reference(uint32_t code) {
   OpcodeFields fields(code);
   typedef InstructionKind IK;
   switch (fields.op()) {
@@ -1001,13 +1001,128 @@ static InstructionKind decode_opcode(uint32_t code) {
   }
 }
 
+//////////////////
+// DECODE TABLES
+//////////////////
+
+namespace {
+struct DecodeTable;
+
 /*!
- * Top level decode function.
+ * An entry in a decode table. Either the instruction kind, another table to look in, or a function
+ * to call for encodings which aren't decided by a single field.
  */
-Instruction decode_instruction(LinkedWord& word, LinkedObjectFile& file, int seg_id, int word_id) {
-  // determine the opcode, and get info for it
+struct DecodeEntry {
+  InstructionKind kind = InstructionKind::UNKNOWN;
+  const DecodeTable* table = nullptr;
+  InstructionKind (*decode)(OpcodeFields) = nullptr;
+};
+
+/*!
+ * A table of decode entries, indexed by one field of the instruction.
+ */
+struct DecodeTable {
+  uint32_t shift = 0;
+  uint32_t mask = 0;
+  DecodeEntry entries[64];
+
+  DecodeTable() = default;
+
+  /*!
+   * Fill the table from one of the switch decoders. The decoder is called with only the bits of
+   * this table's field set. Entries where the other fields matter must be replaced afterward.
+   */
+  DecodeTable(uint32_t _shift, uint32_t bits, InstructionKind (*decoder)(OpcodeFields))
+      : shift(_shift), mask((1 << bits) - 1) {
+    for (uint32_t i = 0; i <= mask; i++) {
+      entries[i].kind = decoder(OpcodeFields(i << shift));
+    }
+  }
+
+  void set_table(uint32_t idx, const DecodeTable* table) {
+    entries[idx] = DecodeEntry();
+    entries[idx].table = table;
+  }
+
+  void set_function(uint32_t idx, InstructionKind (*decode)(OpcodeFields)) {
+    entries[idx] = DecodeEntry();
+    entries[idx].decode = decode;
+  }
+};
+
+struct DecodeTables {
+  DecodeTable op;
+  DecodeTable special, regimm, cache;
+  DecodeTable cop1, bc1, cop1_s, cop1_w;
+  DecodeTable mmi, mmi0, mmi1, mmi2, mmi3, pmfhl;
+
+  DecodeTables()
+      : op(26, 6, [](OpcodeFields f) { return decode_opcode_reference(f.data); }),
+        special(0, 6, decode_special),
+        regimm(16, 5, decode_regimm),
+        cache(16, 5, decode_cache),
+        cop1(21, 5, decode_cop1),
+        bc1(16, 5, decode_BC1),
+        cop1_s(0, 6, decode_S),
+        cop1_w(0, 6, decode_W),
+        mmi(0, 6, decode_mmi),
+        mmi0(6, 5, decode_mmi0),
+        mmi1(6, 5, decode_mmi1),
+        mmi2(6, 5, decode_mmi2),
+        mmi3(6, 5, decode_mmi3),
+        pmfhl(6, 5, decode_pmfhl) {
+    op.set_table(0b000000, &special);
+    op.set_table(0b000001, &regimm);
+    op.set_table(0b010001, &cop1);
+    op.set_table(0b011100, &mmi);
+    op.set_table(0b101111, &cache);
+    // cop0 and cop2 have encodings which depend on several fields, so use the switch decoders.
+    op.set_function(0b010000, decode_cop0);
+    op.set_function(0b010010, decode_cop2);
+
+    special.set_function(0b001111, decode_sync);
+
+    cop1.set_table(0b01000, &bc1);
+    cop1.set_table(0b10000, &cop1_s);
+    cop1.set_table(0b10100, &cop1_w);
+
+    mmi.set_table(0b001000, &mmi0);
+    mmi.set_table(0b001001, &mmi2);
+    mmi.set_table(0b101000, &mmi1);
+    mmi.set_table(0b101001, &mmi3);
+    mmi.set_table(0b110000, &pmfhl);
+  }
+};
+
+const DecodeTables& get_decode_tables() {
+  static const DecodeTables tables;
+  return tables;
+}
+
+InstructionKind decode_opcode(const DecodeTables& tables, uint32_t code) {
+  const DecodeTable* table = &tables.op;
+  while (true) {
+    auto& entry = table->entries[(code >> table->shift) & table->mask];
+    if (entry.table) {
+      table = entry.table;
+    } else if (entry.decode) {
+      return entry.decode(OpcodeFields(code));
+    } else {
+      return entry.kind;
+    }
+  }
+}
+
+/*!
+ * Decode an instruction, once the opcode is known.
+ */
+Instruction decode_instruction(InstructionKind op,
+                               LinkedWord& word,
+                               LinkedObjectFile& file,
+                               int seg_id,
+                               int word_id) {
+  // get info for the opcode
   Instruction i;
-  auto op = decode_opcode(word.data);
   auto& info = gOpcodeInfo[(int)op];
   if (!info.defined) {
     return i;
@@ -1134,36 +1249,36 @@ Instruction decode_instruction(LinkedWord& word, LinkedObjectFile& file, int seg
     }
   }
 
-  if (word.kind == LinkedWord::SYM_OFFSET) {
+  if (word.kind() == LinkedWord::SYM_OFFSET) {
     bool fixed = false;
     for (int j = 0; j < i.n_src; j++) {
       if (i.src[j].kind == InstructionAtom::IMM) {
         fixed = true;
-        i.src[j].set_sym(word.symbol_name);
+        i.src[j].set_sym(file.get_symbol_name(word));
       }
     }
     assert(fixed);
   }
 
-  if (word.kind == LinkedWord::HI_PTR) {
+  if (word.kind() == LinkedWord::HI_PTR) {
     assert(i.kind == InstructionKind::LUI);
     bool fixed = false;
     for (int j = 0; j < i.n_src; j++) {
       if (i.src[j].kind == InstructionAtom::IMM) {
         fixed = true;
-        i.src[j].set_label(word.label_id);
+        i.src[j].set_label(word.label_id());
       }
     }
     assert(fixed);
   }
 
-  if (word.kind == LinkedWord::LO_PTR) {
+  if (word.kind() == LinkedWord::LO_PTR) {
     assert(i.kind == InstructionKind::ORI);
     bool fixed = false;
     for (int j = 0; j < i.n_src; j++) {
       if (i.src[j].kind == InstructionAtom::IMM) {
         fixed = true;
-        i.src[j].set_label(word.label_id);
+        i.src[j].set_label(word.label_id());
       }
     }
     assert(fixed);
@@ -1171,3 +1286,39 @@ Instruction decode_instruction(LinkedWord& word, LinkedObjectFile& file, int seg
 
   return i;
 }
+}  // namespace
+
+/*!
+ * Determine the kind of an instruction, using the decode tables.
+ */
+InstructionKind decode_opcode(uint32_t code) {
+  return decode_opcode(get_decode_tables(), code);
+}
+
+/*!
+ * Top level decode function.
+ */
+Instruction decode_instruction(LinkedWord& word, LinkedObjectFile& file, int seg_id, int word_id) {
+  return decode_instruction(decode_opcode(word.data), word, file, seg_id, word_id);
+}
+
+/*!
+ * Decode the words [start_word, end_word) of a segment.
+ */
+std::vector<Instruction> decode_instructions(LinkedObjectFile& file,
+                                             int seg_id,
+                                             int start_word,
+                                             int end_word) {
+  auto& tables = get_decode_tables();
+  auto& words = file.words_by_seg.at(seg_id);
+  assert(start_word >= 0 && start_word <= end_word && end_word <= int(words.size()));
+
+  std::vector<Instruction> result;
+  result.reserve(end_word - start_word);
+  for (int word_id = start_word; word_id < end_word; word_id++) {
+    auto& word = words[word_id];
+    result.push_back(
+        decode_instruction(decode_opcode(tables, word.data), word, file, seg_id, word_id));
+  }
+  return result;
+}
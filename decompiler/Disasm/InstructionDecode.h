@@ -9,11 +9,18 @@
 #ifndef NEXT_INSTRUCTIONDECODE_H
 #define NEXT_INSTRUCTIONDECODE_H
 
+#include <vector>
 #include "Instruction.h"
 
 class LinkedWord;
 class LinkedObjectFile;
 
 Instruction decode_instruction(LinkedWord& word, LinkedObjectFile& file, int seg_id, int word_id);
+std::vector<Instruction> decode_instructions(LinkedObjectFile& file,
+                                             int seg_id,
+                                             int start_word,
+                                             int end_word);
+InstructionKind decode_opcode(uint32_t code);
+InstructionKind decode_opcode_reference(uint32_t code);
 
 #endif  // NEXT_INSTRUCTIONDECODE_H
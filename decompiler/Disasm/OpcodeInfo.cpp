@@ -130,6 +130,10 @@ static OpcodeInfo& cd_dacc_svfs_svft(OpcodeInfo& info) {
 }
 
 void init_opcode_info() {
+  // start over if called again, otherwise the decode steps would be added twice.
+  for (auto& info : gOpcodeInfo) {
+    info = OpcodeInfo();
+  }
   gOpcodeInfo[0].name = ";; ??????";
 
   // RT, RS, SIMM
@@ -136,6 +136,7 @@ class Register {
   uint32_t get_vi() const;
   Reg::Cop0 get_cop0() const;
   uint32_t get_pcr() const;
+  uint16_t reg_id() const { return id; }
 
   bool operator==(const Register& other) const;
   bool operator!=(const Register& other) const;
@@ -1,7 +1,10 @@
 #include <cassert>
+#include <set>
 #include "common/goos/PrettyPrinter.h"
 #include "decompiler/Disasm/InstructionMatching.h"
 #include "decompiler/ObjectFile/LinkedObjectFile.h"
+#include "decompiler/util/OrderedLog.h"
+#include "third-party/fmt/core.h"
 #include "CfgVtx.h"
 #include "Function.h"
 
@@ -67,7 +70,7 @@ void CfgVtx::replace_succ_and_check(CfgVtx* old_succ, CfgVtx* new_succ) {
 void CfgVtx::replace_preds_with_and_check(std::vector<CfgVtx*> old_preds, CfgVtx* new_pred) {
   std::vector<bool> found(old_preds.size(), false);
 
-  std::vector<CfgVtx*> new_pred_list;
+  SmallVector<CfgVtx*, 4> new_pred_list;
 
   for (auto* existing_pred : pred) {
     bool match = false;
@@ -91,7 +94,7 @@ void CfgVtx::replace_preds_with_and_check(std::vector<CfgVtx*> old_preds, CfgVtx
     new_pred_list.push_back(new_pred);
   }
 
-  pred = new_pred_list;
+  pred = std::move(new_pred_list);
 
   for (auto x : found) {
     assert(x);
@@ -292,17 +295,26 @@ goos::Object Break::to_form() {
   return pretty_print::build_list(forms);
 }
 
+namespace {
+/*!
+ * Remember that a pattern match looked at vtx, if we're keeping track. Returns vtx.
+ */
+CfgVtx* depend(CfgDeps* deps, CfgVtx* vtx) {
+  if (deps && vtx) {
+    deps->push_back(vtx);
+  }
+  return vtx;
+}
+}  // namespace
+
 ControlFlowGraph::ControlFlowGraph() {
   // allocate the entry and exit vertices.
   m_entry = alloc<EntryVtx>();
   m_exit = alloc<ExitVtx>();
 }
 
-ControlFlowGraph::~ControlFlowGraph() {
-  for (auto* x : m_node_pool) {
-    delete x;
-  }
-}
+// all nodes are destroyed with the arena.
+ControlFlowGraph::~ControlFlowGraph() = default;
 
 /*!
  * Convert unresolved portion of CFG into a format that can be read by dot, a graph layout tool.
@@ -526,18 +538,19 @@ bool ControlFlowGraph::is_while_loop(CfgVtx* b0, CfgVtx* b1, CfgVtx* b2) {
     return false;
   assert(!b1->end_branch.has_branch);
   if (!b2->has_pred(b0)) {
-    printf("expect b2 (%s) to have pred b0 (%s)\n", b2->to_string().c_str(),
-           b0->to_string().c_str());
-    printf("but it doesn't! instead it has:\n");
+    ordered_log::print(fmt::format("expect b2 ({}) to have pred b0 ({})\n", b2->to_string(),
+                                   b0->to_string()));
+    ordered_log::print("but it doesn't! instead it has:\n");
     for (auto* x : b2->pred) {
-      printf(" %s\n", x->to_string().c_str());
+      ordered_log::print(fmt::format(" {}\n", x->to_string()));
     }
     if (b0->succ_ft) {
-      printf("b0's succ_ft: %s\n", b0->succ_ft->to_string().c_str());
+      ordered_log::print(fmt::format("b0's succ_ft: {}\n", b0->succ_ft->to_string()));
     }
     if (b0->succ_branch) {
-      printf("b0's succ_branch: %s\n", b0->succ_branch->to_string().c_str());
+      ordered_log::print(fmt::format("b0's succ_branch: {}\n", b0->succ_branch->to_string()));
     }
+    ordered_log::flush_captured();
   }
   assert(b2->has_pred(b0));
   assert(b2->has_pred(b1));
@@ -718,304 +731,311 @@ bool ControlFlowGraph::find_if_else_top_level() {
 }
  */
 
-bool ControlFlowGraph::find_while_loop_top_level() {
-  // B0 can start with whatever
-  // B0 ends in unconditional branch to B2 (condition).
-  // B2 has conditional non-likely branch to B1
-  // B1 falls through to B2 and nowhere else
-  // B2 can end with whatever
-  bool found_one = false;
-  bool needs_work = true;
-  while (needs_work) {
-    needs_work = false;
-    for_each_top_level_vtx([&](CfgVtx* vtx) {
-      auto* b0 = vtx;
-      auto* b1 = vtx->next;
-      auto* b2 = b1 ? b1->next : nullptr;
+/*!
+ * Match a while loop starting at vtx:
+ * B0 can start with whatever
+ * B0 ends in unconditional branch to B2 (condition).
+ * B2 has conditional non-likely branch to B1
+ * B1 falls through to B2 and nowhere else
+ * B2 can end with whatever
+ */
+CfgMatch ControlFlowGraph::match_while_loop(CfgVtx* vtx, bool apply, CfgDeps* deps) {
+  auto* b0 = depend(deps, vtx);
+  auto* b1 = depend(deps, vtx->next);
+  auto* b2 = depend(deps, b1 ? b1->next : nullptr);
 
-      if (is_while_loop(b0, b1, b2)) {
-        needs_work = true;
+  if (!is_while_loop(b0, b1, b2)) {
+    return CfgMatch::NO;
+  }
 
-        auto* new_vtx = alloc<WhileLoop>();
-        new_vtx->body = b1;
-        new_vtx->condition = b2;
+  if (!apply) {
+    return CfgMatch::YES;
+  }
 
-        b0->replace_succ_and_check(b2, new_vtx);
-        new_vtx->pred = {b0};
+  auto* new_vtx = alloc<WhileLoop>();
+  new_vtx->body = b1;
+  new_vtx->condition = b2;
 
-        assert(b2->succ_ft);
-        b2->succ_ft->replace_pred_and_check(b2, new_vtx);
-        new_vtx->succ_ft = b2->succ_ft;
-        // succ_branch is going back into the loop
+  b0->replace_succ_and_check(b2, new_vtx);
+  new_vtx->pred = {b0};
 
-        new_vtx->prev = b0;
-        b0->next = new_vtx;
+  assert(b2->succ_ft);
+  b2->succ_ft->replace_pred_and_check(b2, new_vtx);
+  new_vtx->succ_ft = b2->succ_ft;
+  // succ_branch is going back into the loop
 
-        new_vtx->next = b2->next;
-        if (new_vtx->next) {
-          new_vtx->next->prev = new_vtx;
-        }
+  new_vtx->prev = b0;
+  b0->next = new_vtx;
 
-        b1->parent_claim(new_vtx);
-        b2->parent_claim(new_vtx);
-        found_one = true;
-        return false;
-      } else {
-        return true;
-      }
-    });
+  new_vtx->next = b2->next;
+  if (new_vtx->next) {
+    new_vtx->next->prev = new_vtx;
   }
-  return found_one;
+
+  b1->parent_claim(new_vtx);
+  b2->parent_claim(new_vtx);
+  return CfgMatch::YES;
 }
 
-bool ControlFlowGraph::find_until_loop() {
-  // B2 has conditional non-likely branch to B1
-  // B1 falls through to B2 and nowhere else
-  // B2 can end with whatever
+bool ControlFlowGraph::find_while_loop_top_level() {
   bool found_one = false;
-  bool needs_work = true;
-  while (needs_work) {
-    needs_work = false;
-    for_each_top_level_vtx([&](CfgVtx* vtx) {
-      auto* b1 = vtx;
-      auto* b2 = b1 ? b1->next : nullptr;
+  while (apply_first_match(&ControlFlowGraph::match_while_loop)) {
+    found_one = true;
+  }
+  return found_one;
+}
 
-      if (is_until_loop(b1, b2)) {
-        needs_work = true;
+/*!
+ * Match an until loop starting at vtx:
+ * B2 has conditional non-likely branch to B1
+ * B1 falls through to B2 and nowhere else
+ * B2 can end with whatever
+ */
+CfgMatch ControlFlowGraph::match_until_loop(CfgVtx* vtx, bool apply, CfgDeps* deps) {
+  auto* b1 = depend(deps, vtx);
+  auto* b2 = depend(deps, b1 ? b1->next : nullptr);
 
-        auto* new_vtx = alloc<UntilLoop>();
-        new_vtx->body = b1;
-        new_vtx->condition = b2;
+  if (!is_until_loop(b1, b2)) {
+    return CfgMatch::NO;
+  }
 
-        for (auto* b0 : b1->pred) {
-          b0->replace_succ_and_check(b1, new_vtx);
-        }
+  if (!apply) {
+    return CfgMatch::YES;
+  }
 
-        new_vtx->pred = b1->pred;
-        new_vtx->replace_preds_with_and_check({b2}, nullptr);
+  auto* new_vtx = alloc<UntilLoop>();
+  new_vtx->body = b1;
+  new_vtx->condition = b2;
 
-        assert(b2->succ_ft);
-        b2->succ_ft->replace_pred_and_check(b2, new_vtx);
-        new_vtx->succ_ft = b2->succ_ft;
-        // succ_branch is going back into the loop
+  for (auto* b0 : b1->pred) {
+    b0->replace_succ_and_check(b1, new_vtx);
+  }
 
-        new_vtx->prev = b1->prev;
-        if (new_vtx->prev) {
-          new_vtx->prev->next = new_vtx;
-        }
+  new_vtx->pred = b1->pred;
+  new_vtx->replace_preds_with_and_check({b2}, nullptr);
 
-        new_vtx->next = b2->next;
-        if (new_vtx->next) {
-          new_vtx->next->prev = new_vtx;
-        }
+  assert(b2->succ_ft);
+  b2->succ_ft->replace_pred_and_check(b2, new_vtx);
+  new_vtx->succ_ft = b2->succ_ft;
+  // succ_branch is going back into the loop
 
-        b1->parent_claim(new_vtx);
-        b2->parent_claim(new_vtx);
-        found_one = true;
-        return false;
-      } else {
-        return true;
-      }
-    });
+  new_vtx->prev = b1->prev;
+  if (new_vtx->prev) {
+    new_vtx->prev->next = new_vtx;
   }
-  return found_one;
-}
 
-bool ControlFlowGraph::find_infinite_loop() {
-  bool found = false;
+  new_vtx->next = b2->next;
+  if (new_vtx->next) {
+    new_vtx->next->prev = new_vtx;
+  }
 
-  for_each_top_level_vtx([&](CfgVtx* vtx) {
-    if (vtx->succ_branch == vtx && !vtx->succ_ft) {
-      auto inf = alloc<InfiniteLoopBlock>();
-      inf->block = vtx;
-      inf->pred = vtx->pred;
-      inf->replace_preds_with_and_check({vtx}, nullptr);
-      for (auto* x : inf->pred) {
-        x->replace_succ_and_check(vtx, inf);
-      }
-      inf->prev = vtx->prev;
-      if (inf->prev) {
-        inf->prev->next = inf;
-      }
+  b1->parent_claim(new_vtx);
+  b2->parent_claim(new_vtx);
+  return CfgMatch::YES;
+}
 
-      inf->next = vtx->next;
-      if (inf->next) {
-        inf->succ_ft = inf->next;
-        inf->next->prev = inf;
-        inf->succ_ft->pred.push_back(inf);
-      }
+bool ControlFlowGraph::find_until_loop() {
+  bool found_one = false;
+  while (apply_first_match(&ControlFlowGraph::match_until_loop)) {
+    found_one = true;
+  }
+  return found_one;
+}
 
-      inf->succ_branch = nullptr;
-      vtx->parent_claim(inf);
+CfgMatch ControlFlowGraph::match_infinite_loop(CfgVtx* vtx, bool apply, CfgDeps* deps) {
+  depend(deps, vtx);
+  if (vtx->succ_branch != vtx || vtx->succ_ft) {
+    return CfgMatch::NO;
+  }
 
-      found = true;
-      return false;
-    }
+  if (!apply) {
+    return CfgMatch::YES;
+  }
 
-    return true;
-  });
+  auto inf = alloc<InfiniteLoopBlock>();
+  inf->block = vtx;
+  inf->pred = vtx->pred;
+  inf->replace_preds_with_and_check({vtx}, nullptr);
+  for (auto* x : inf->pred) {
+    x->replace_succ_and_check(vtx, inf);
+  }
+  inf->prev = vtx->prev;
+  if (inf->prev) {
+    inf->prev->next = inf;
+  }
 
-  return found;
-}
+  inf->next = vtx->next;
+  if (inf->next) {
+    inf->succ_ft = inf->next;
+    inf->next->prev = inf;
+    inf->succ_ft->pred.push_back(inf);
+  }
 
-bool ControlFlowGraph::find_until1_loop() {
-  bool found = false;
+  inf->succ_branch = nullptr;
+  vtx->parent_claim(inf);
+  return CfgMatch::YES;
+}
 
-  for_each_top_level_vtx([&](CfgVtx* vtx) {
-    if (vtx->succ_branch == vtx && vtx->succ_ft) {
-      auto loop = alloc<UntilLoop_single>();
-      loop->block = vtx;
-      loop->pred = vtx->pred;
-      loop->replace_preds_with_and_check({vtx}, nullptr);
-      for (auto* x : loop->pred) {
-        x->replace_succ_and_check(vtx, loop);
-      }
-      loop->prev = vtx->prev;
-      if (loop->prev) {
-        loop->prev->next = loop;
-      }
+bool ControlFlowGraph::find_infinite_loop() {
+  return apply_first_match(&ControlFlowGraph::match_infinite_loop);
+}
 
-      loop->next = vtx->next;
-      if (loop->next) {
-        loop->next->prev = loop;
-      }
+CfgMatch ControlFlowGraph::match_until1_loop(CfgVtx* vtx, bool apply, CfgDeps* deps) {
+  depend(deps, vtx);
+  if (vtx->succ_branch != vtx || !vtx->succ_ft) {
+    return CfgMatch::NO;
+  }
 
-      loop->succ_ft = vtx->succ_ft;
-      loop->succ_ft->replace_pred_and_check(vtx, loop);
+  if (!apply) {
+    return CfgMatch::YES;
+  }
 
-      vtx->parent_claim(loop);
+  auto loop = alloc<UntilLoop_single>();
+  loop->block = vtx;
+  loop->pred = vtx->pred;
+  loop->replace_preds_with_and_check({vtx}, nullptr);
+  for (auto* x : loop->pred) {
+    x->replace_succ_and_check(vtx, loop);
+  }
+  loop->prev = vtx->prev;
+  if (loop->prev) {
+    loop->prev->next = loop;
+  }
 
-      found = true;
-      return false;
-    }
+  loop->next = vtx->next;
+  if (loop->next) {
+    loop->next->prev = loop;
+  }
 
-    return true;
-  });
+  loop->succ_ft = vtx->succ_ft;
+  loop->succ_ft->replace_pred_and_check(vtx, loop);
 
-  return found;
+  vtx->parent_claim(loop);
+  return CfgMatch::YES;
 }
 
-bool ControlFlowGraph::find_goto_end() {
-  bool replaced = false;
-
-  for_each_top_level_vtx([&](CfgVtx* vtx) {
-    auto* b0 = vtx;
-    auto* b1 = vtx->next;
-    if (is_goto_end_and_unreachable(b0, b1)) {
-      replaced = true;
+bool ControlFlowGraph::find_until1_loop() {
+  return apply_first_match(&ControlFlowGraph::match_until1_loop);
+}
 
-      auto* new_goto = alloc<GotoEnd>();
-      new_goto->body = b0;
-      new_goto->unreachable_block = b1;
+CfgMatch ControlFlowGraph::match_goto_end(CfgVtx* vtx, bool apply, CfgDeps* deps) {
+  auto* b0 = depend(deps, vtx);
+  auto* b1 = depend(deps, vtx->next);
+  depend(deps, vtx->succ_branch);
+  if (!is_goto_end_and_unreachable(b0, b1)) {
+    return CfgMatch::NO;
+  }
 
-      for (auto* new_pred : b0->pred) {
-        //        printf("fix up pred %s of %s\n", new_pred->to_string().c_str(),
-        //        b0->to_string().c_str());
-        new_pred->replace_succ_and_check(b0, new_goto);
-      }
-      new_goto->pred = b0->pred;
+  if (!apply) {
+    return CfgMatch::YES;
+  }
 
-      for (auto* new_succ : b1->succs()) {
-        //        new_succ->replace_preds_with_and_check({b1}, nullptr);
-        new_succ->replace_pred_and_check(b1, new_goto);
-      }
-      // this is a lie, but ok
+  auto* new_goto = alloc<GotoEnd>();
+  new_goto->body = b0;
+  new_goto->unreachable_block = b1;
 
-      new_goto->succ_ft = b1->succ_ft;
-      new_goto->succ_branch = b1->succ_branch;
-      new_goto->end_branch = b1->end_branch;
+  for (auto* new_pred : b0->pred) {
+    //        printf("fix up pred %s of %s\n", new_pred->to_string().c_str(),
+    //        b0->to_string().c_str());
+    new_pred->replace_succ_and_check(b0, new_goto);
+  }
+  new_goto->pred = b0->pred;
 
-      //      if(b1->next) {
-      //        b1->next->pred.push_back(new_goto);
-      //      }
-      //      new_goto->succ_branch = b1->succ_branch;
-      //      new_goto->end_branch = b1->end_branch;
+  for (auto* new_succ : b1->succs()) {
+    //        new_succ->replace_preds_with_and_check({b1}, nullptr);
+    new_succ->replace_pred_and_check(b1, new_goto);
+  }
+  // this is a lie, but ok
 
-      new_goto->prev = b0->prev;
-      if (new_goto->prev) {
-        new_goto->prev->next = new_goto;
-      }
+  new_goto->succ_ft = b1->succ_ft;
+  new_goto->succ_branch = b1->succ_branch;
+  new_goto->end_branch = b1->end_branch;
 
-      new_goto->next = b1->next;
-      if (new_goto->next) {
-        new_goto->next->prev = new_goto;
-      }
+  //      if(b1->next) {
+  //        b1->next->pred.push_back(new_goto);
+  //      }
+  //      new_goto->succ_branch = b1->succ_branch;
+  //      new_goto->end_branch = b1->end_branch;
 
-      b0->succ_branch->replace_preds_with_and_check({b0}, nullptr);
-
-      b0->parent_claim(new_goto);
-      b1->parent_claim(new_goto);
+  new_goto->prev = b0->prev;
+  if (new_goto->prev) {
+    new_goto->prev->next = new_goto;
+  }
 
-      return false;
-    }
+  new_goto->next = b1->next;
+  if (new_goto->next) {
+    new_goto->next->prev = new_goto;
+  }
 
-    // keep looking
-    return true;
-  });
+  b0->succ_branch->replace_preds_with_and_check({b0}, nullptr);
 
-  return replaced;
+  b0->parent_claim(new_goto);
+  b1->parent_claim(new_goto);
+  return CfgMatch::YES;
 }
 
-bool ControlFlowGraph::find_goto_not_end() {
-  bool replaced = false;
-
-  for_each_top_level_vtx([&](CfgVtx* vtx) {
-    auto* b0 = vtx;
-    auto* b1 = vtx->next;
-    if (is_goto_not_end_and_unreachable(b0, b1)) {
-      replaced = true;
+bool ControlFlowGraph::find_goto_end() {
+  return apply_first_match(&ControlFlowGraph::match_goto_end);
+}
 
-      auto* new_goto = alloc<Break>();
-      new_goto->body = b0;
-      new_goto->unreachable_block = b1;
-      // todo set block number
+CfgMatch ControlFlowGraph::match_goto_not_end(CfgVtx* vtx, bool apply, CfgDeps* deps) {
+  auto* b0 = depend(deps, vtx);
+  auto* b1 = depend(deps, vtx->next);
+  if (!is_goto_not_end_and_unreachable(b0, b1)) {
+    return CfgMatch::NO;
+  }
 
-      for (auto* new_pred : b0->pred) {
-        //        printf("fix up pred %s of %s\n", new_pred->to_string().c_str(),
-        //        b0->to_string().c_str());
-        new_pred->replace_succ_and_check(b0, new_goto);
-      }
-      new_goto->pred = b0->pred;
+  if (!apply) {
+    return CfgMatch::YES;
+  }
 
-      for (auto* new_succ : b1->succs()) {
-        //        new_succ->replace_preds_with_and_check({b1}, nullptr);
-        new_succ->replace_pred_and_check(b1, new_goto);
-      }
-      // this is a lie, but ok
+  auto* new_goto = alloc<Break>();
+  new_goto->body = b0;
+  new_goto->unreachable_block = b1;
+  // todo set block number
 
-      new_goto->succ_ft = b1->succ_ft;
-      new_goto->succ_branch = b1->succ_branch;
-      new_goto->end_branch = b1->end_branch;
+  for (auto* new_pred : b0->pred) {
+    //        printf("fix up pred %s of %s\n", new_pred->to_string().c_str(),
+    //        b0->to_string().c_str());
+    new_pred->replace_succ_and_check(b0, new_goto);
+  }
+  new_goto->pred = b0->pred;
 
-      //      if(b1->next) {
-      //        b1->next->pred.push_back(new_goto);
-      //      }
-      //      new_goto->succ_branch = b1->succ_branch;
-      //      new_goto->end_branch = b1->end_branch;
+  for (auto* new_succ : b1->succs()) {
+    //        new_succ->replace_preds_with_and_check({b1}, nullptr);
+    new_succ->replace_pred_and_check(b1, new_goto);
+  }
+  // this is a lie, but ok
 
-      new_goto->prev = b0->prev;
-      if (new_goto->prev) {
-        new_goto->prev->next = new_goto;
-      }
+  new_goto->succ_ft = b1->succ_ft;
+  new_goto->succ_branch = b1->succ_branch;
+  new_goto->end_branch = b1->end_branch;
 
-      new_goto->next = b1->next;
-      if (new_goto->next) {
-        new_goto->next->prev = new_goto;
-      }
+  //      if(b1->next) {
+  //        b1->next->pred.push_back(new_goto);
+  //      }
+  //      new_goto->succ_branch = b1->succ_branch;
+  //      new_goto->end_branch = b1->end_branch;
 
-      b0->succ_branch->replace_preds_with_and_check({b0}, nullptr);
+  new_goto->prev = b0->prev;
+  if (new_goto->prev) {
+    new_goto->prev->next = new_goto;
+  }
 
-      b0->parent_claim(new_goto);
-      b1->parent_claim(new_goto);
+  new_goto->next = b1->next;
+  if (new_goto->next) {
+    new_goto->next->prev = new_goto;
+  }
 
-      return false;
-    }
+  b0->succ_branch->replace_preds_with_and_check({b0}, nullptr);
 
-    // keep looking
-    return true;
-  });
+  b0->parent_claim(new_goto);
+  b1->parent_claim(new_goto);
+  return CfgMatch::YES;
+}
 
-  return replaced;
+bool ControlFlowGraph::find_goto_not_end() {
+  return apply_first_match(&ControlFlowGraph::match_goto_not_end);
 }
 
 bool ControlFlowGraph::is_sequence(CfgVtx* b0, CfgVtx* b1) {
@@ -1090,132 +1110,142 @@ bool ControlFlowGraph::is_sequence_of_non_sequence_and_sequence(CfgVtx* b0, CfgV
 }
 
 /*!
- * Find and insert at most one sequence. Return true if sequence is inserted.
- * To generate more readable debug output, we should aim to run this as infrequent and as
- * late as possible, to avoid condition vertices with tons of extra junk packed in.
+ * Match a sequence starting at vtx. Sequences are combined with an existing sequence if possible.
  */
-bool ControlFlowGraph::find_seq_top_level() {
-  bool replaced = false;
-  for_each_top_level_vtx([&](CfgVtx* vtx) {
-    auto* b0 = vtx;
-    auto* b1 = vtx->next;
+CfgMatch ControlFlowGraph::match_seq(CfgVtx* vtx, bool apply, CfgDeps* deps) {
+  auto* b0 = depend(deps, vtx);
+  auto* b1 = depend(deps, vtx->next);
 
-    //    if (b0 && b1) {
-    //      printf("try seq %s %s\n", b0->to_string().c_str(), b1->to_string().c_str());
-    //    }
+  //    if (b0 && b1) {
+  //      printf("try seq %s %s\n", b0->to_string().c_str(), b1->to_string().c_str());
+  //    }
 
-    if (is_sequence_of_non_sequences(b0, b1)) {  // todo, avoid nesting sequences.
-      //      printf("make seq type 1 %s %s\n", b0->to_string().c_str(), b1->to_string().c_str());
-      replaced = true;
-
-      auto* new_seq = alloc<SequenceVtx>();
-      new_seq->seq.push_back(b0);
-      new_seq->seq.push_back(b1);
+  if (is_sequence_of_non_sequences(b0, b1)) {  // todo, avoid nesting sequences.
+    if (!apply) {
+      return CfgMatch::YES;
+    }
+    //      printf("make seq type 1 %s %s\n", b0->to_string().c_str(), b1->to_string().c_str());
 
-      for (auto* new_pred : b0->pred) {
-        new_pred->replace_succ_and_check(b0, new_seq);
-      }
-      new_seq->pred = b0->pred;
+    auto* new_seq = alloc<SequenceVtx>();
+    new_seq->seq.push_back(b0);
+    new_seq->seq.push_back(b1);
 
-      for (auto* new_succ : b1->succs()) {
-        new_succ->replace_pred_and_check(b1, new_seq);
-      }
-      new_seq->succ_ft = b1->succ_ft;
-      new_seq->succ_branch = b1->succ_branch;
+    for (auto* new_pred : b0->pred) {
+      new_pred->replace_succ_and_check(b0, new_seq);
+    }
+    new_seq->pred = b0->pred;
 
-      new_seq->prev = b0->prev;
-      if (new_seq->prev) {
-        new_seq->prev->next = new_seq;
-      }
-      new_seq->next = b1->next;
-      if (new_seq->next) {
-        new_seq->next->prev = new_seq;
-      }
+    for (auto* new_succ : b1->succs()) {
+      new_succ->replace_pred_and_check(b1, new_seq);
+    }
+    new_seq->succ_ft = b1->succ_ft;
+    new_seq->succ_branch = b1->succ_branch;
 
-      b0->parent_claim(new_seq);
-      b1->parent_claim(new_seq);
-      new_seq->end_branch = b1->end_branch;
-      return false;
+    new_seq->prev = b0->prev;
+    if (new_seq->prev) {
+      new_seq->prev->next = new_seq;
+    }
+    new_seq->next = b1->next;
+    if (new_seq->next) {
+      new_seq->next->prev = new_seq;
     }
 
-    if (is_sequence_of_sequence_and_non_sequence(b0, b1)) {
-      //      printf("make seq type 2 %s %s\n", b0->to_string().c_str(), b1->to_string().c_str());
-      replaced = true;
-      auto* seq = dynamic_cast<SequenceVtx*>(b0);
-      assert(seq);
+    b0->parent_claim(new_seq);
+    b1->parent_claim(new_seq);
+    new_seq->end_branch = b1->end_branch;
+    return CfgMatch::YES;
+  }
 
-      seq->seq.push_back(b1);
+  if (is_sequence_of_sequence_and_non_sequence(b0, b1)) {
+    if (!apply) {
+      return CfgMatch::YES;
+    }
+    //      printf("make seq type 2 %s %s\n", b0->to_string().c_str(), b1->to_string().c_str());
+    auto* seq = dynamic_cast<SequenceVtx*>(b0);
+    assert(seq);
 
-      for (auto* new_succ : b1->succs()) {
-        new_succ->replace_pred_and_check(b1, b0);
-      }
-      seq->succ_ft = b1->succ_ft;
-      seq->succ_branch = b1->succ_branch;
-      seq->next = b1->next;
-      if (seq->next) {
-        seq->next->prev = seq;
-      }
+    seq->seq.push_back(b1);
 
-      b1->parent_claim(seq);
-      seq->end_branch = b1->end_branch;
-      return false;
+    for (auto* new_succ : b1->succs()) {
+      new_succ->replace_pred_and_check(b1, b0);
+    }
+    seq->succ_ft = b1->succ_ft;
+    seq->succ_branch = b1->succ_branch;
+    seq->next = b1->next;
+    if (seq->next) {
+      seq->next->prev = seq;
     }
 
-    if (is_sequence_of_non_sequence_and_sequence(b0, b1)) {
-      replaced = true;
-      auto* seq = dynamic_cast<SequenceVtx*>(b1);
-      assert(seq);
-      seq->seq.insert(seq->seq.begin(), b0);
-
-      for (auto* p : b0->pred) {
-        p->replace_succ_and_check(b0, seq);
-      }
-      seq->pred = b0->pred;
-      seq->prev = b0->prev;
-      if (seq->prev) {
-        seq->prev->next = seq;
-      }
+    b1->parent_claim(seq);
+    seq->end_branch = b1->end_branch;
+    return CfgMatch::YES;
+  }
 
-      b0->parent_claim(seq);
-      return false;
+  if (is_sequence_of_non_sequence_and_sequence(b0, b1)) {
+    if (!apply) {
+      return CfgMatch::YES;
     }
+    auto* seq = dynamic_cast<SequenceVtx*>(b1);
+    assert(seq);
+    seq->seq.insert(seq->seq.begin(), b0);
 
-    if (is_sequence_of_sequence_and_sequence(b0, b1)) {
-      //      printf("make seq type 3 %s %s\n", b0->to_string().c_str(), b1->to_string().c_str());
-      replaced = true;
-      auto* seq = dynamic_cast<SequenceVtx*>(b0);
-      assert(seq);
+    for (auto* p : b0->pred) {
+      p->replace_succ_and_check(b0, seq);
+    }
+    seq->pred = b0->pred;
+    seq->prev = b0->prev;
+    if (seq->prev) {
+      seq->prev->next = seq;
+    }
 
-      auto* old_seq = dynamic_cast<SequenceVtx*>(b1);
-      assert(old_seq);
+    b0->parent_claim(seq);
+    return CfgMatch::YES;
+  }
 
-      for (auto* x : old_seq->seq) {
-        x->parent_claim(seq);
-        seq->seq.push_back(x);
-      }
+  if (is_sequence_of_sequence_and_sequence(b0, b1)) {
+    if (!apply) {
+      return CfgMatch::YES;
+    }
+    //      printf("make seq type 3 %s %s\n", b0->to_string().c_str(), b1->to_string().c_str());
+    auto* seq = dynamic_cast<SequenceVtx*>(b0);
+    assert(seq);
 
-      for (auto* x : old_seq->succs()) {
-        //        printf("fix preds of %s\n", x->to_string().c_str());
-        x->replace_pred_and_check(old_seq, seq);
-      }
-      seq->succ_branch = old_seq->succ_branch;
-      seq->succ_ft = old_seq->succ_ft;
-      seq->end_branch = old_seq->end_branch;
-      seq->next = old_seq->next;
-      if (seq->next) {
-        seq->next->prev = seq;
-      }
+    auto* old_seq = dynamic_cast<SequenceVtx*>(b1);
+    assert(old_seq);
 
-      // todo - proper trash?
-      old_seq->parent_claim(seq);
+    for (auto* x : old_seq->seq) {
+      x->parent_claim(seq);
+      seq->seq.push_back(x);
+    }
 
-      return false;
+    for (auto* x : old_seq->succs()) {
+      //        printf("fix preds of %s\n", x->to_string().c_str());
+      x->replace_pred_and_check(old_seq, seq);
+    }
+    seq->succ_branch = old_seq->succ_branch;
+    seq->succ_ft = old_seq->succ_ft;
+    seq->end_branch = old_seq->end_branch;
+    seq->next = old_seq->next;
+    if (seq->next) {
+      seq->next->prev = seq;
     }
 
-    return true;  // keep looking
-  });
+    // todo - proper trash?
+    old_seq->parent_claim(seq);
 
-  return replaced;
+    return CfgMatch::YES;
+  }
+
+  return CfgMatch::NO;  // keep looking
+}
+
+/*!
+ * Find and insert at most one sequence. Return true if sequence is inserted.
+ * To generate more readable debug output, we should aim to run this as infrequent and as
+ * late as possible, to avoid condition vertices with tons of extra junk packed in.
+ */
+bool ControlFlowGraph::find_seq_top_level() {
+  return apply_first_match(&ControlFlowGraph::match_seq);
 }
 
 namespace {
@@ -1234,435 +1264,438 @@ bool is_found_after(CfgVtx* a, CfgVtx* b) {
 
 }  // namespace
 
-bool ControlFlowGraph::find_cond_w_else() {
-  bool found = false;
-
-  for_each_top_level_vtx([&](CfgVtx* vtx) {
-    // determine where the "else" block would be
-    auto* c0 = vtx;       // first condition
-    auto* b0 = c0->next;  // first body
-    if (!b0) {
-      return true;
-    }
-
-    //        printf("cwe try %s %s\n", c0->to_string().c_str(), b0->to_string().c_str());
+CfgMatch ControlFlowGraph::match_cond_w_else(CfgVtx* vtx, bool apply, CfgDeps* deps) {
+  // determine where the "else" block would be
+  auto* c0 = depend(deps, vtx);       // first condition
+  auto* b0 = depend(deps, c0->next);  // first body
+  if (!b0) {
+    return CfgMatch::NO;
+  }
 
-    // first condition should have the _option_ to fall through to first body
-    if (c0->succ_ft != b0) {
-      return true;
-    }
+  //        printf("cwe try %s %s\n", c0->to_string().c_str(), b0->to_string().c_str());
 
-    // first body MUST unconditionally jump to else
-    if (b0->succ_ft || b0->end_branch.branch_likely) {
-      return true;
-    }
-
-    if (b0->pred.size() != 1) {
-      return true;
-    }
+  // first condition should have the _option_ to fall through to first body
+  if (c0->succ_ft != b0) {
+    return CfgMatch::NO;
+  }
 
-    assert(b0->end_branch.has_branch);
-    assert(b0->end_branch.branch_always);
-    assert(b0->succ_branch);
+  // first body MUST unconditionally jump to else
+  if (b0->succ_ft || b0->end_branch.branch_likely) {
+    return CfgMatch::NO;
+  }
 
-    // TODO - check what's in the delay slot!
-    auto* end_block = b0->succ_branch;
-    if (!end_block) {
-      return true;
-    }
+  if (b0->pred.size() != 1) {
+    return CfgMatch::NO;
+  }
 
-    if (!is_found_after(end_block, b0)) {
-      return true;
-    }
+  assert(b0->end_branch.has_branch);
+  assert(b0->end_branch.branch_always);
+  assert(b0->succ_branch);
 
-    auto* else_block = end_block->prev;
-    if (!else_block) {
-      return true;
-    }
+  // TODO - check what's in the delay slot!
+  auto* end_block = depend(deps, b0->succ_branch);
+  if (!end_block) {
+    return CfgMatch::NO;
+  }
 
-    if (!is_found_after(else_block, b0)) {
-      return true;
-    }
+  if (!is_found_after(end_block, b0)) {
+    return CfgMatch::NO;
+  }
 
-    if (else_block->succ_branch) {
-      return true;
-    }
+  auto* else_block = depend(deps, end_block->prev);
+  if (!else_block) {
+    return CfgMatch::NO;
+  }
 
-    if (else_block->succ_ft != end_block) {
-      return true;
-    }
-    assert(!else_block->end_branch.has_branch);
-
-    std::vector<CondWithElse::Entry> entries = {{c0, b0}};
-    auto* prev_condition = c0;
-    auto* prev_body = b0;
-
-    // loop to try to grab all the cases up to the else, or reject if the inside is not sufficiently
-    // compact or if this is not actually a cond with else Note, we are responsible for checking the
-    // branch of prev_condition, but not the fallthrough
-    while (true) {
-      auto* next = prev_body->next;
-      if (next == else_block) {
-        // TODO - check what's in the delay slot!
-        // we're done!
-        // check the prev_condition, prev_body blocks properly go to the else/end_block
-        // prev_condition should jump to else:
-        if (prev_condition->succ_branch != else_block || prev_condition->end_branch.branch_likely) {
-          return true;
-        }
+  if (!is_found_after(else_block, b0)) {
+    return CfgMatch::NO;
+  }
 
-        // prev_body should jump to end
-        if (prev_body->succ_branch != end_block) {
-          return true;
-        }
+  if (else_block->succ_branch) {
+    return CfgMatch::NO;
+  }
 
-        break;
-      } else {
-        auto* c = next;
-        auto* b = c->next;
-        if (!c || !b) {
-          ;
-          return true;
-        };
-        // attempt to add another
-
-        if (c->pred.size() != 1) {
-          return true;
-        }
+  if (else_block->succ_ft != end_block) {
+    return CfgMatch::NO;
+  }
+  assert(!else_block->end_branch.has_branch);
+
+  std::vector<CondWithElse::Entry> entries = {{c0, b0}};
+  auto* prev_condition = c0;
+  auto* prev_body = b0;
+
+  // loop to try to grab all the cases up to the else, or reject if the inside is not sufficiently
+  // compact or if this is not actually a cond with else Note, we are responsible for checking the
+  // branch of prev_condition, but not the fallthrough
+  while (true) {
+    auto* next = depend(deps, prev_body->next);
+    if (next == else_block) {
+      // TODO - check what's in the delay slot!
+      // we're done!
+      // check the prev_condition, prev_body blocks properly go to the else/end_block
+      // prev_condition should jump to else:
+      if (prev_condition->succ_branch != else_block || prev_condition->end_branch.branch_likely) {
+        return CfgMatch::NO;
+      }
 
-        if (b->pred.size() != 1) {
-          return true;
-        }
+      // prev_body should jump to end
+      if (prev_body->succ_branch != end_block) {
+        return CfgMatch::NO;
+      }
 
-        // how to get to cond
-        if (prev_condition->succ_branch != c || prev_condition->end_branch.branch_likely) {
-          return true;
-        }
+      break;
+    } else {
+      auto* c = next;
+      auto* b = depend(deps, c->next);
+      if (!c || !b) {
+        ;
+        return CfgMatch::NO;
+      };
+      // attempt to add another
+
+      if (c->pred.size() != 1) {
+        return CfgMatch::NO;
+      }
 
-        if (c->succ_ft != b) {
-          return true;  // condition should have the option to fall through if matched
-        }
+      if (b->pred.size() != 1) {
+        return CfgMatch::NO;
+      }
 
-        // TODO - check what's in the delay slot!
-        if (c->end_branch.branch_likely) {
-          return true;  // otherwise should go to next with a non-likely branch
-        }
+      // how to get to cond
+      if (prev_condition->succ_branch != c || prev_condition->end_branch.branch_likely) {
+        return CfgMatch::NO;
+      }
 
-        if (b->succ_ft || b->end_branch.branch_likely) {
-          return true;  // body should go straight to else
-        }
+      if (c->succ_ft != b) {
+        return CfgMatch::NO;  // condition should have the option to fall through if matched
+      }
 
-        if (b->succ_branch != end_block) {
-          return true;
-        }
+      // TODO - check what's in the delay slot!
+      if (c->end_branch.branch_likely) {
+        return CfgMatch::NO;  // otherwise should go to next with a non-likely branch
+      }
 
-        entries.emplace_back(c, b);
-        prev_body = b;
-        prev_condition = c;
+      if (b->succ_ft || b->end_branch.branch_likely) {
+        return CfgMatch::NO;  // body should go straight to else
       }
-    }
 
-    // now we need to add it
-    //    printf("got cwe\n");
-    auto new_cwe = alloc<CondWithElse>();
+      if (b->succ_branch != end_block) {
+        return CfgMatch::NO;
+      }
 
-    // link x <-> new_cwe
-    for (auto* npred : c0->pred) {
-      npred->replace_succ_and_check(c0, new_cwe);
-    }
-    new_cwe->pred = c0->pred;
-    new_cwe->prev = c0->prev;
-    if (new_cwe->prev) {
-      new_cwe->prev->next = new_cwe;
+      entries.emplace_back(c, b);
+      prev_body = b;
+      prev_condition = c;
     }
+  }
 
-    // link new_cwe <-> end
-    std::vector<CfgVtx*> to_replace;
-    to_replace.push_back(else_block);
-    for (const auto& x : entries) {
-      to_replace.push_back(x.body);
-    }
-    end_block->replace_preds_with_and_check(to_replace, new_cwe);
-    new_cwe->succ_ft = end_block;
-    new_cwe->next = end_block;
-    end_block->prev = new_cwe;
-
-    new_cwe->else_vtx = else_block;
-    new_cwe->entries = std::move(entries);
-
-    else_block->parent_claim(new_cwe);
-    for (const auto& x : new_cwe->entries) {
-      x.body->parent_claim(new_cwe);
-      x.condition->parent_claim(new_cwe);
-    }
-    found = true;
-    return false;
-  });
+  if (!apply) {
+    return CfgMatch::YES;
+  }
 
-  return found;
-}
+  // now we need to add it
+  //    printf("got cwe\n");
+  auto new_cwe = alloc<CondWithElse>();
 
-bool ControlFlowGraph::find_cond_n_else() {
-  bool found = false;
+  // link x <-> new_cwe
+  for (auto* npred : c0->pred) {
+    npred->replace_succ_and_check(c0, new_cwe);
+  }
+  new_cwe->pred = c0->pred;
+  new_cwe->prev = c0->prev;
+  if (new_cwe->prev) {
+    new_cwe->prev->next = new_cwe;
+  }
 
-  for_each_top_level_vtx([&](CfgVtx* vtx) {
-    auto* c0 = vtx;       // first condition
-    auto* b0 = c0->next;  // first body
-    if (!b0) {
-      //      printf("reject 0\n");
-      return true;
-    }
+  // link new_cwe <-> end
+  std::vector<CfgVtx*> to_replace;
+  to_replace.push_back(else_block);
+  for (const auto& x : entries) {
+    to_replace.push_back(x.body);
+  }
+  end_block->replace_preds_with_and_check(to_replace, new_cwe);
+  new_cwe->succ_ft = end_block;
+  new_cwe->next = end_block;
+  end_block->prev = new_cwe;
+
+  new_cwe->else_vtx = else_block;
+  new_cwe->entries = std::move(entries);
+
+  else_block->parent_claim(new_cwe);
+  for (const auto& x : new_cwe->entries) {
+    x.body->parent_claim(new_cwe);
+    x.condition->parent_claim(new_cwe);
+  }
+  return CfgMatch::YES;
+}
 
-    //            printf("cne: c0 %s b0 %s\n", c0->to_string().c_str(), b0->to_string().c_str());
+bool ControlFlowGraph::find_cond_w_else() {
+  return apply_first_match(&ControlFlowGraph::match_cond_w_else);
+}
 
-    // first condition should have the _option_ to fall through to first body
-    if (c0->succ_ft != b0) {
-      //      printf("reject 1\n");
-      return true;
-    }
+CfgMatch ControlFlowGraph::match_cond_n_else(CfgVtx* vtx, bool apply, CfgDeps* deps) {
+  auto* c0 = depend(deps, vtx);       // first condition
+  auto* b0 = depend(deps, c0->next);  // first body
+  if (!b0) {
+    //      printf("reject 0\n");
+    return CfgMatch::NO;
+  }
 
-    // first body MUST unconditionally jump to end
-    bool single_case = false;
-    if (b0->end_branch.has_branch) {
-      if (b0->succ_ft || b0->end_branch.branch_likely) {
-        //        printf("reject 2A\n");
-        return true;
-      }
-      assert(b0->end_branch.has_branch);
-      assert(b0->end_branch.branch_always);
-      assert(b0->succ_branch);
-    } else {
-      single_case = true;
-    }
+  //            printf("cne: c0 %s b0 %s\n", c0->to_string().c_str(), b0->to_string().c_str());
 
-    if (b0->pred.size() != 1) {
-      //      printf("reject 3\n");
-      return true;
-    }
+  // first condition should have the _option_ to fall through to first body
+  if (c0->succ_ft != b0) {
+    //      printf("reject 1\n");
+    return CfgMatch::NO;
+  }
 
-    // TODO - check what's in the delay slot!
-    auto* end_block = single_case ? b0->succ_ft : b0->succ_branch;
-    if (!end_block) {
-      //      printf("reject 4");
-      return true;
+  // first body MUST unconditionally jump to end
+  bool single_case = false;
+  if (b0->end_branch.has_branch) {
+    if (b0->succ_ft || b0->end_branch.branch_likely) {
+      //        printf("reject 2A\n");
+      return CfgMatch::NO;
     }
+    assert(b0->end_branch.has_branch);
+    assert(b0->end_branch.branch_always);
+    assert(b0->succ_branch);
+  } else {
+    single_case = true;
+  }
 
-    if (!is_found_after(end_block, b0)) {
-      //      printf("reject 5");
-      return true;
-    }
+  if (b0->pred.size() != 1) {
+    //      printf("reject 3\n");
+    return CfgMatch::NO;
+  }
 
-    std::vector<CondNoElse::Entry> entries = {{c0, b0}};
-    auto* prev_condition = c0;
-    auto* prev_body = b0;
-
-    // loop to try to grab all the cases up to the else, or reject if the inside is not sufficiently
-    // compact or if this is not actually a cond with else Note, we are responsible for checking the
-    // branch of prev_condition, but not the fallthrough
-    while (true) {
-      auto* next = prev_body->next;
-      if (next == end_block) {
-        // TODO - check what's in the delay slot!
-        // we're done!
-        // check the prev_condition, prev_body blocks properly go to the else/end_block
-        // prev_condition should jump to else:
-        if (prev_condition->succ_branch != end_block || prev_condition->end_branch.branch_likely) {
-          //          printf("reject 6\n");
-          return true;
-        }
+  // TODO - check what's in the delay slot!
+  auto* end_block = depend(deps, single_case ? b0->succ_ft : b0->succ_branch);
+  if (!end_block) {
+    //      printf("reject 4");
+    return CfgMatch::NO;
+  }
 
-        // prev_body should jump to end
-        if (!single_case && prev_body->succ_branch != end_block) {
-          //          printf("reject 7\n");
-          return true;
-        }
+  if (!is_found_after(end_block, b0)) {
+    //      printf("reject 5");
+    return CfgMatch::NO;
+  }
 
-        break;
-      } else {
-        auto* c = next;
-        auto* b = c->next;
-        if (!c || !b) {
-          //          printf("reject 8\n");
-          return true;
-        };
-        // attempt to add another
-        //        printf("  e %s %s\n", c->to_string().c_str(), b->to_string().c_str());
-
-        if (c->pred.size() != 1) {
-          //          printf("reject 9\n");
-          return true;
-        }
+  std::vector<CondNoElse::Entry> entries = {{c0, b0}};
+  auto* prev_condition = c0;
+  auto* prev_body = b0;
+
+  // loop to try to grab all the cases up to the else, or reject if the inside is not sufficiently
+  // compact or if this is not actually a cond with else Note, we are responsible for checking the
+  // branch of prev_condition, but not the fallthrough
+  while (true) {
+    auto* next = depend(deps, prev_body->next);
+    if (next == end_block) {
+      // TODO - check what's in the delay slot!
+      // we're done!
+      // check the prev_condition, prev_body blocks properly go to the else/end_block
+      // prev_condition should jump to else:
+      if (prev_condition->succ_branch != end_block || prev_condition->end_branch.branch_likely) {
+        //          printf("reject 6\n");
+        return CfgMatch::NO;
+      }
 
-        if (b->pred.size() != 1) {
-          //          printf("reject 10\n");
-          return true;
-        }
+      // prev_body should jump to end
+      if (!single_case && prev_body->succ_branch != end_block) {
+        //          printf("reject 7\n");
+        return CfgMatch::NO;
+      }
 
-        // how to get to cond
-        if (prev_condition->succ_branch != c || prev_condition->end_branch.branch_likely) {
-          //          printf("reject 11\n");
-          return true;
-        }
+      break;
+    } else {
+      auto* c = next;
+      auto* b = depend(deps, c->next);
+      if (!c || !b) {
+        //          printf("reject 8\n");
+        return CfgMatch::NO;
+      };
+      // attempt to add another
+      //        printf("  e %s %s\n", c->to_string().c_str(), b->to_string().c_str());
+
+      if (c->pred.size() != 1) {
+        //          printf("reject 9\n");
+        return CfgMatch::NO;
+      }
 
-        if (c->succ_ft != b) {
-          //          printf("reject 12\n");
-          return true;  // condition should have the option to fall through if matched
-        }
+      if (b->pred.size() != 1) {
+        //          printf("reject 10\n");
+        return CfgMatch::NO;
+      }
 
-        // TODO - check what's in the delay slot!
-        if (c->end_branch.branch_likely) {
-          //          printf("reject 13\n");
-          return true;  // otherwise should go to next with a non-likely branch
-        }
+      // how to get to cond
+      if (prev_condition->succ_branch != c || prev_condition->end_branch.branch_likely) {
+        //          printf("reject 11\n");
+        return CfgMatch::NO;
+      }
 
-        if (b->succ_ft || b->end_branch.branch_likely) {
-          //          printf("reject 14\n");
-          return true;  // body should go straight to else
-        }
+      if (c->succ_ft != b) {
+        //          printf("reject 12\n");
+        return CfgMatch::NO;  // condition should have the option to fall through if matched
+      }
 
-        if (b->succ_branch != end_block) {
-          //          printf("reject 14\n");
-          return true;
-        }
+      // TODO - check what's in the delay slot!
+      if (c->end_branch.branch_likely) {
+        //          printf("reject 13\n");
+        return CfgMatch::NO;  // otherwise should go to next with a non-likely branch
+      }
 
-        entries.emplace_back(c, b);
-        prev_body = b;
-        prev_condition = c;
+      if (b->succ_ft || b->end_branch.branch_likely) {
+        //          printf("reject 14\n");
+        return CfgMatch::NO;  // body should go straight to else
       }
-    }
 
-    // now we need to add it
-    //    printf("got cne\n");
-    auto new_cwe = alloc<CondNoElse>();
+      if (b->succ_branch != end_block) {
+        //          printf("reject 14\n");
+        return CfgMatch::NO;
+      }
 
-    // link x <-> new_cwe
-    for (auto* npred : c0->pred) {
-      //      printf("in %s, replace succ %s with %s\n", npred->to_string().c_str(),
-      //      c0->to_string().c_str(), new_cwe->to_string().c_str());
-      npred->replace_succ_and_check(c0, new_cwe);
-    }
-    new_cwe->pred = c0->pred;
-    new_cwe->prev = c0->prev;
-    if (new_cwe->prev) {
-      new_cwe->prev->next = new_cwe;
+      entries.emplace_back(c, b);
+      prev_body = b;
+      prev_condition = c;
     }
+  }
 
-    // link new_cwe <-> end
-    std::vector<CfgVtx*> to_replace;
-    for (const auto& x : entries) {
-      to_replace.push_back(x.body);
-    }
-    to_replace.push_back(entries.back().condition);
-    //    if(single_case) {
-    //      to_replace.push_back(c0);
-    //    }
-    end_block->replace_preds_with_and_check(to_replace, new_cwe);
-    new_cwe->succ_ft = end_block;
-    new_cwe->next = end_block;
-    end_block->prev = new_cwe;
-
-    new_cwe->entries = std::move(entries);
-
-    for (const auto& x : new_cwe->entries) {
-      x.body->parent_claim(new_cwe);
-      x.condition->parent_claim(new_cwe);
-    }
-    found = true;
+  if (!apply) {
+    return CfgMatch::YES;
+  }
 
-    //    printf("now %s\n", new_cwe->to_form()->toStringSimple().c_str());
-    //    printf("%s\n", to_dot().c_str());
-    return false;
-  });
+  // now we need to add it
+  //    printf("got cne\n");
+  auto new_cwe = alloc<CondNoElse>();
 
-  return found;
-}
+  // link x <-> new_cwe
+  for (auto* npred : c0->pred) {
+    //      printf("in %s, replace succ %s with %s\n", npred->to_string().c_str(),
+    //      c0->to_string().c_str(), new_cwe->to_string().c_str());
+    npred->replace_succ_and_check(c0, new_cwe);
+  }
+  new_cwe->pred = c0->pred;
+  new_cwe->prev = c0->prev;
+  if (new_cwe->prev) {
+    new_cwe->prev->next = new_cwe;
+  }
 
-bool ControlFlowGraph::find_short_circuits() {
-  bool found = false;
+  // link new_cwe <-> end
+  std::vector<CfgVtx*> to_replace;
+  for (const auto& x : entries) {
+    to_replace.push_back(x.body);
+  }
+  to_replace.push_back(entries.back().condition);
+  //    if(single_case) {
+  //      to_replace.push_back(c0);
+  //    }
+  end_block->replace_preds_with_and_check(to_replace, new_cwe);
+  new_cwe->succ_ft = end_block;
+  new_cwe->next = end_block;
+  end_block->prev = new_cwe;
+
+  new_cwe->entries = std::move(entries);
+
+  for (const auto& x : new_cwe->entries) {
+    x.body->parent_claim(new_cwe);
+    x.condition->parent_claim(new_cwe);
+  }
 
-  for_each_top_level_vtx([&](CfgVtx* vtx) {
-    std::vector<CfgVtx*> entries = {vtx};
-    auto* end = vtx->succ_branch;
-    auto* next = vtx->next;
+  //    printf("now %s\n", new_cwe->to_form()->toStringSimple().c_str());
+  //    printf("%s\n", to_dot().c_str());
+  return CfgMatch::YES;
+}
 
-    //    printf("try sc @ %s\n", vtx->to_string().c_str());
-    if (!end || !vtx->end_branch.branch_likely || next != vtx->succ_ft) {
-      //      printf("reject 1\n");
-      return true;
-    }
+bool ControlFlowGraph::find_cond_n_else() {
+  return apply_first_match(&ControlFlowGraph::match_cond_n_else);
+}
 
-    while (true) {
-      //      printf("loop sc %s, end %s\n", vtx->to_string().c_str(), end->to_string().c_str());
-      if (next == end) {
-        // one entry sc!
-        break;
-      }
+CfgMatch ControlFlowGraph::match_short_circuit(CfgVtx* vtx, bool apply, CfgDeps* deps) {
+  std::vector<CfgVtx*> entries = {depend(deps, vtx)};
+  auto* end = vtx->succ_branch;
+  auto* next = depend(deps, vtx->next);
 
-      if (next->next == end) {
-        // check 1 pred
-        if (next->pred.size() != 1) {
-          //          printf("reject 2\n");
-          return true;
-        }
-        entries.push_back(next);
+  //    printf("try sc @ %s\n", vtx->to_string().c_str());
+  if (!end || !vtx->end_branch.branch_likely || next != vtx->succ_ft) {
+    //      printf("reject 1\n");
+    return CfgMatch::NO;
+  }
 
-        // done!
-        break;
-      }
+  while (true) {
+    //      printf("loop sc %s, end %s\n", vtx->to_string().c_str(), end->to_string().c_str());
+    if (next == end) {
+      // one entry sc!
+      break;
+    }
 
+    if (next->next == end) {
       // check 1 pred
       if (next->pred.size() != 1) {
-        //        printf("reject 3\n");
-        return true;
+        //          printf("reject 2\n");
+        return CfgMatch::NO;
       }
+      entries.push_back(next);
 
-      // check branch to end
-      if (next->succ_branch != end || !next->end_branch.branch_likely) {
-        //        printf("reject 4\n");
-        return true;
-      }
+      // done!
+      break;
+    }
 
-      // check fallthrough to next
-      if (!next->succ_ft) {
-        //        printf("reject 5\n");
-        return false;
-      }
+    // check 1 pred
+    if (next->pred.size() != 1) {
+      //        printf("reject 3\n");
+      return CfgMatch::NO;
+    }
 
-      assert(next->succ_ft == next->next);  // bonus check
-      entries.push_back(next);
-      next = next->succ_ft;
+    // check branch to end
+    if (next->succ_branch != end || !next->end_branch.branch_likely) {
+      //        printf("reject 4\n");
+      return CfgMatch::NO;
     }
 
-    //    printf("got sc: \n");
-    //    for (auto* x : entries) {
-    //      printf("  %s\n", x->to_string().c_str());
-    //    }
+    // check fallthrough to next
+    if (!next->succ_ft) {
+      //        printf("reject 5\n");
+      // this stops the search for short circuits, even at later vertices.
+      return CfgMatch::STOP;
+    }
 
-    auto new_sc = alloc<ShortCircuit>();
+    assert(next->succ_ft == next->next);  // bonus check
+    entries.push_back(next);
+    next = depend(deps, next->succ_ft);
+  }
 
-    for (auto* npred : vtx->pred) {
-      npred->replace_succ_and_check(vtx, new_sc);
-    }
-    new_sc->pred = vtx->pred;
-    new_sc->prev = vtx->prev;
-    if (new_sc->prev) {
-      new_sc->prev->next = new_sc;
-    }
+  //    printf("got sc: \n");
+  //    for (auto* x : entries) {
+  //      printf("  %s\n", x->to_string().c_str());
+  //    }
 
-    end->replace_preds_with_and_check(entries, new_sc);
-    new_sc->succ_ft = end;
-    new_sc->next = end;
-    end->prev = new_sc;
-    new_sc->entries = std::move(entries);
-    for (auto* x : new_sc->entries) {
-      x->parent_claim(new_sc);
-    }
-    found = true;
+  if (!apply) {
+    return CfgMatch::YES;
+  }
 
-    return false;
-  });
+  auto new_sc = alloc<ShortCircuit>();
 
-  return found;
+  for (auto* npred : vtx->pred) {
+    npred->replace_succ_and_check(vtx, new_sc);
+  }
+  new_sc->pred = vtx->pred;
+  new_sc->prev = vtx->prev;
+  if (new_sc->prev) {
+    new_sc->prev->next = new_sc;
+  }
+
+  end->replace_preds_with_and_check(entries, new_sc);
+  new_sc->succ_ft = end;
+  new_sc->next = end;
+  end->prev = new_sc;
+  new_sc->entries = std::move(entries);
+  for (auto* x : new_sc->entries) {
+    x->parent_claim(new_sc);
+  }
+  return CfgMatch::YES;
+}
+
+bool ControlFlowGraph::find_short_circuits() {
+  return apply_first_match(&ControlFlowGraph::match_short_circuit);
 }
 
 /*!
@@ -1742,9 +1775,209 @@ void ControlFlowGraph::flag_early_exit(const std::vector<BasicBlock>& blocks) {
 }
 
 /*!
- * Build and resolve a Control Flow Graph as much as possible.
+ * Find the first top level vertex where the pattern matches, and apply it.
+ * Returns true if the graph was changed.
  */
-std::shared_ptr<ControlFlowGraph> build_cfg(const LinkedObjectFile& file, int seg, Function& func) {
+bool ControlFlowGraph::apply_first_match(Matcher matcher) {
+  bool found = false;
+  for_each_top_level_vtx([&](CfgVtx* vtx) {
+    auto result = (this->*matcher)(vtx, true, nullptr);
+    if (result == CfgMatch::NO) {
+      return true;  // keep looking
+    }
+    found = result == CfgMatch::YES;
+    return false;
+  });
+  return found;
+}
+
+namespace {
+struct CfgRule {
+  ControlFlowGraph::Matcher matcher;
+  bool repeat;  // apply as many times as possible before trying the other rules again
+};
+}  // namespace
+
+/*!
+ * Resolve the graph as much as possible, by collapsing patterns into structures.
+ *
+ * This gives exactly the same result as structure_reference: the rules are tried in the same
+ * priority order, and each is applied at the first matching vertex in order of creation. But
+ * instead of scanning every vertex after every change, it remembers which vertices each attempted
+ * match looked at, and only retries matches which looked at a vertex that changed. Each change only
+ * touches a small neighborhood, so this keeps large functions from taking quadratic time.
+ */
+void ControlFlowGraph::structure() {
+  const CfgRule rules[] = {{&ControlFlowGraph::match_cond_n_else, false},
+                           {&ControlFlowGraph::match_cond_w_else, false},
+                           {&ControlFlowGraph::match_while_loop, true},
+                           {&ControlFlowGraph::match_seq, false},
+                           {&ControlFlowGraph::match_short_circuit, false},
+                           {&ControlFlowGraph::match_goto_end, false},
+                           {&ControlFlowGraph::match_until_loop, true},
+                           {&ControlFlowGraph::match_until1_loop, false},
+                           {&ControlFlowGraph::match_infinite_loop, false},
+                           {&ControlFlowGraph::match_goto_not_end, false}};
+  constexpr int rule_count = sizeof(rules) / sizeof(rules[0]);
+
+  struct RuleState {
+    std::vector<CfgMatch> result;  // by uid, up to date unless dirty
+    std::vector<bool> dirty;       // by uid
+    std::vector<int> dirty_uids;
+    std::set<int> matches;  // uids with a result of YES or STOP
+  };
+  RuleState states[rule_count];
+
+  // for each vertex, the (rule, uid) matches which looked at it.
+  std::vector<std::vector<std::pair<int, int>>> watchers;
+
+  auto mark_dirty = [&](int rule, int uid) {
+    auto& state = states[rule];
+    if (int(state.dirty.size()) <= uid) {
+      state.dirty.resize(m_uid, false);
+      state.result.resize(m_uid, CfgMatch::NO);
+    }
+    if (!state.dirty[uid]) {
+      state.dirty[uid] = true;
+      state.dirty_uids.push_back(uid);
+    }
+  };
+
+  // vtx may have changed, so redo all matches which looked at it.
+  auto touch = [&](CfgVtx* vtx) {
+    for (int rule = 0; rule < rule_count; rule++) {
+      mark_dirty(rule, vtx->uid);
+    }
+    if (vtx->uid < int(watchers.size())) {
+      for (auto& watcher : watchers[vtx->uid]) {
+        mark_dirty(watcher.first, watcher.second);
+      }
+      watchers[vtx->uid].clear();
+    }
+  };
+
+  CfgDeps deps;
+  auto refresh = [&](int rule) {
+    auto& state = states[rule];
+    for (auto uid : state.dirty_uids) {
+      auto* vtx = m_node_pool.at(uid);
+      auto result = CfgMatch::NO;
+      if (!vtx->parent && vtx != entry() && vtx != exit()) {
+        deps.clear();
+        result = (this->*rules[rule].matcher)(vtx, false, &deps);
+        watchers.resize(m_uid);
+        for (auto* dep : deps) {
+          watchers.at(dep->uid).emplace_back(rule, uid);
+        }
+      }
+
+      state.dirty[uid] = false;
+      state.result[uid] = result;
+      if (result == CfgMatch::NO) {
+        state.matches.erase(uid);
+      } else {
+        state.matches.insert(uid);
+      }
+    }
+    state.dirty_uids.clear();
+  };
+
+  auto apply = [&](int rule, CfgVtx* vtx) {
+    // find everything the rewrite could change: the matched vertices and their neighbors.
+    deps.clear();
+    (this->*rules[rule].matcher)(vtx, false, &deps);
+    CfgDeps changed;
+    for (auto* dep : deps) {
+      changed.push_back(dep);
+      for (auto* neighbor : {dep->prev, dep->next, dep->succ_ft, dep->succ_branch}) {
+        if (neighbor) {
+          changed.push_back(neighbor);
+        }
+      }
+      for (auto* pred : dep->pred) {
+        changed.push_back(pred);
+      }
+    }
+
+    int first_new_uid = m_uid;
+    auto result = (this->*rules[rule].matcher)(vtx, true, nullptr);
+    assert(result == CfgMatch::YES);
+    (void)result;
+
+    for (auto* x : changed) {
+      touch(x);
+    }
+    for (int uid = first_new_uid; uid < m_uid; uid++) {
+      touch(m_node_pool.at(uid));
+    }
+  };
+
+  for (auto* vtx : m_node_pool) {
+    touch(vtx);
+  }
+
+  bool changed = true;
+  while (changed) {
+    changed = false;
+    for (int rule = 0; rule < rule_count && !changed; rule++) {
+      while (true) {
+        refresh(rule);
+        auto& state = states[rule];
+        if (state.matches.empty()) {
+          break;
+        }
+        int uid = *state.matches.begin();
+        if (state.result.at(uid) == CfgMatch::STOP) {
+          break;
+        }
+        apply(rule, m_node_pool.at(uid));
+        changed = true;
+        if (!rules[rule].repeat) {
+          break;
+        }
+      }
+    }
+  }
+}
+
+/*!
+ * Resolve the graph as much as possible, by trying each rule on every vertex until nothing
+ * changes. Slow, but simple. This is kept to check structure() against.
+ */
+void ControlFlowGraph::structure_reference() {
+  bool changed = true;
+  while (changed) {
+    changed = false;
+    // note - we should prioritize finding short-circuiting expressions.
+    //    printf("%s\n", cfg->to_dot().c_str());
+    //    printf("%s\n", cfg->to_form()->toStringPretty().c_str());
+
+    changed = changed || find_cond_n_else();
+    changed = changed || find_cond_w_else();
+
+    changed = changed || find_while_loop_top_level();
+    changed = changed || find_seq_top_level();
+    changed = changed || find_short_circuits();
+
+    if (!changed) {
+      changed = changed || find_goto_end();
+      changed = changed || find_until_loop();
+      changed = changed || find_until1_loop();
+      changed = changed || find_infinite_loop();
+    };
+
+    if (!changed) {
+      changed = changed || find_goto_not_end();
+    }
+  }
+}
+
+/*!
+ * Build a Control Flow Graph with a vertex for each basic block, without resolving it.
+ */
+std::shared_ptr<ControlFlowGraph> build_unstructured_cfg(const LinkedObjectFile& file,
+                                                         int seg,
+                                                         Function& func) {
   auto cfg = std::make_shared<ControlFlowGraph>();
 
   const auto& blocks = cfg->create_blocks(func.basic_blocks.size());
@@ -1822,32 +2055,15 @@ std::shared_ptr<ControlFlowGraph> build_cfg(const LinkedObjectFile& file, int se
   }
 
   cfg->flag_early_exit(func.basic_blocks);
+  return cfg;
+}
 
-  bool changed = true;
-  while (changed) {
-    changed = false;
-    // note - we should prioritize finding short-circuiting expressions.
-    //    printf("%s\n", cfg->to_dot().c_str());
-    //    printf("%s\n", cfg->to_form()->toStringPretty().c_str());
-
-    changed = changed || cfg->find_cond_n_else();
-    changed = changed || cfg->find_cond_w_else();
-
-    changed = changed || cfg->find_while_loop_top_level();
-    changed = changed || cfg->find_seq_top_level();
-    changed = changed || cfg->find_short_circuits();
-
-    if (!changed) {
-      changed = changed || cfg->find_goto_end();
-      changed = changed || cfg->find_until_loop();
-      changed = changed || cfg->find_until1_loop();
-      changed = changed || cfg->find_infinite_loop();
-    };
-
-    if (!changed) {
-      changed = changed || cfg->find_goto_not_end();
-    }
-  }
+/*!
+ * Build and resolve a Control Flow Graph as much as possible.
+ */
+std::shared_ptr<ControlFlowGraph> build_cfg(const LinkedObjectFile& file, int seg, Function& func) {
+  auto cfg = build_unstructured_cfg(file, seg, func);
+  cfg->structure();
 
   if (!cfg->is_fully_resolved()) {
     func.warnings += "Failed to fully resolve CFG\n";
@@ -3,9 +3,13 @@
 #ifndef JAK_DISASSEMBLER_CFGVTX_H
 #define JAK_DISASSEMBLER_CFGVTX_H
 
+#include <memory>
 #include <string>
 #include <vector>
 #include <cassert>
+#include <cstdint>
+#include "decompiler/util/Arena.h"
+#include "decompiler/util/SmallVector.h"
 
 namespace goos {
 class Object;
@@ -51,9 +55,10 @@ void replace_exactly_one_in(std::vector<T>& v, T old, T replace) {
  * structure.
  *
  * All CfgVtxs should be created from the ControlFlowGraph::alloc function, which allocates them
- * from a pool and cleans them up when the ControlFlowGraph is destroyed.  This approach avoids
- * circular reference issues from a referencing counting approach, but does mean that temporary
- * allocations aren't cleaned up until the entire graph is deleted, but this is probably fine.
+ * from an arena owned by the graph and cleans them all up at once when the ControlFlowGraph is
+ * destroyed.  This approach avoids circular reference issues from a referencing counting approach,
+ * but does mean that temporary allocations aren't cleaned up until the entire graph is deleted, but
+ * this is probably fine.
  *
  * Note - there are two special "top-level" vertices that are always present, called Entry and Exit.
  * These always exist and don't count toward making the graph unresolved.
@@ -73,7 +78,7 @@ class CfgVtx {
   CfgVtx* succ_ft = nullptr;      // possible successor from falling through, or NULL if impossible
   CfgVtx* next = nullptr;         // next code in memory
   CfgVtx* prev = nullptr;         // previous code in memory
-  std::vector<CfgVtx*> pred;      // all vertices which have us as succ_branch or succ_ft
+  SmallVector<CfgVtx*, 4> pred;   // all vertices which have us as succ_branch or succ_ft
   int uid = -1;
 
   struct {
@@ -264,6 +269,18 @@ class Break : public CfgVtx {
 
 struct BasicBlock;
 
+/*!
+ * The result of trying to match a pattern at a vertex.
+ */
+enum class CfgMatch : uint8_t {
+  NO,   // doesn't match here
+  YES,  // matches here
+  STOP  // doesn't match here, and don't try to match at any later vertex either
+};
+
+// vertices which were looked at when trying to match a pattern.
+using CfgDeps = std::vector<CfgVtx*>;
+
 /*!
  * The actual CFG class, which owns all the vertices.
  */
@@ -297,6 +314,16 @@ class ControlFlowGraph {
   bool find_infinite_loop();
   bool find_goto_not_end();
 
+  void structure();
+  void structure_reference();
+
+  /*!
+   * A pattern which can be collapsed into a single vertex. Tries to match the pattern with vtx as
+   * its first vertex, adding all the vertices it looks at to deps (if not null). If it matches and
+   * apply is set, replaces the matched vertices with a new vertex.
+   */
+  using Matcher = CfgMatch (ControlFlowGraph::*)(CfgVtx* vtx, bool apply, CfgDeps* deps);
+
   /*!
    * Apply a function f to each top-level vertex.
    * If f returns false, stops.
@@ -316,11 +343,11 @@ class ControlFlowGraph {
   ExitVtx* exit() { return m_exit; }
 
   /*!
-   * Allocate and construct a node of the specified type.
+   * Allocate and construct a node of the specified type, in this graph's arena.
    */
   template <typename T, class... Args>
   T* alloc(Args&&... args) {
-    T* new_obj = new T(std::forward<Args>(args)...);
+    T* new_obj = m_arena.make<T>(std::forward<Args>(args)...);
     m_node_pool.push_back(new_obj);
     new_obj->uid = m_uid++;
     return new_obj;
@@ -338,6 +365,20 @@ class ControlFlowGraph {
   bool is_until_loop(CfgVtx* b1, CfgVtx* b2);
   bool is_goto_end_and_unreachable(CfgVtx* b0, CfgVtx* b1);
   bool is_goto_not_end_and_unreachable(CfgVtx* b0, CfgVtx* b1);
+
+  bool apply_first_match(Matcher matcher);
+  CfgMatch match_cond_w_else(CfgVtx* vtx, bool apply, CfgDeps* deps);
+  CfgMatch match_cond_n_else(CfgVtx* vtx, bool apply, CfgDeps* deps);
+  CfgMatch match_seq(CfgVtx* vtx, bool apply, CfgDeps* deps);
+  CfgMatch match_while_loop(CfgVtx* vtx, bool apply, CfgDeps* deps);
+  CfgMatch match_until_loop(CfgVtx* vtx, bool apply, CfgDeps* deps);
+  CfgMatch match_until1_loop(CfgVtx* vtx, bool apply, CfgDeps* deps);
+  CfgMatch match_short_circuit(CfgVtx* vtx, bool apply, CfgDeps* deps);
+  CfgMatch match_goto_end(CfgVtx* vtx, bool apply, CfgDeps* deps);
+  CfgMatch match_infinite_loop(CfgVtx* vtx, bool apply, CfgDeps* deps);
+  CfgMatch match_goto_not_end(CfgVtx* vtx, bool apply, CfgDeps* deps);
+
+  Arena m_arena;                     // memory for all nodes, freed when the graph is destroyed
   std::vector<BlockVtx*> m_blocks;   // all block nodes, in order.
   std::vector<CfgVtx*> m_node_pool;  // all nodes allocated
   EntryVtx* m_entry;                 // the entry vertex
@@ -347,6 +388,9 @@ class ControlFlowGraph {
 
 class LinkedObjectFile;
 class Function;
+std::shared_ptr<ControlFlowGraph> build_unstructured_cfg(const LinkedObjectFile& file,
+                                                         int seg,
+                                                         Function& func);
 std::shared_ptr<ControlFlowGraph> build_cfg(const LinkedObjectFile& file, int seg, Function& func);
 
 #endif  // JAK_DISASSEMBLER_CFGVTX_H
@@ -5,6 +5,7 @@
 #include "decompiler/Disasm/InstructionMatching.h"
 #include "decompiler/ObjectFile/LinkedObjectFile.h"
 #include "decompiler/util/DecompilerTypeSystem.h"
+#include "decompiler/util/OrderedLog.h"
 #include "TypeInspector.h"
 #include "decompiler/IR/IR.h"
 
@@ -69,8 +70,9 @@ void Function::analyze_prologue(const LinkedObjectFile& file) {
       auto& instr = instructions.at(idx);
       // storing stack pointer on the stack is done by some ASM kernel functions
       if (instr.kind == InstructionKind::SW && instr.get_src(0).get_reg() == make_gpr(Reg::SP)) {
-        printf("[Warning] %s Suspected ASM function based on this instruction in prologue: %s\n",
-               guessed_name.to_string().c_str(), instr.to_string(file).c_str());
+        ordered_log::print(fmt::format(
+            "[Warning] {} Suspected ASM function based on this instruction in prologue: {}\n",
+            guessed_name.to_string(), instr.to_string(file)));
         warnings += "Flagged as ASM function because of " + instr.to_string(file) + "\n";
         suspected_asm = true;
         return;
@@ -92,8 +94,9 @@ void Function::analyze_prologue(const LinkedObjectFile& file) {
       // storing s7 on the stack is done by interrupt handlers, which we probably don't want to
       // support
       if (instr.kind == InstructionKind::SD && instr.get_src(0).get_reg() == make_gpr(Reg::S7)) {
-        spdlog::warn("{} Suspected ASM function based on this instruction in prologue: {}\n",
-                     guessed_name.to_string(), instr.to_string(file));
+        ordered_log::warn(
+            fmt::format("{} Suspected ASM function based on this instruction in prologue: {}\n",
+                        guessed_name.to_string(), instr.to_string(file)));
         warnings += "Flagged as ASM function because of " + instr.to_string(file) + "\n";
         suspected_asm = true;
         return;
@@ -130,10 +133,10 @@ void Function::analyze_prologue(const LinkedObjectFile& file) {
       // sometimes stack memory is zeroed immediately after gpr backups, and this fools the previous
       // check.
       if (store_reg == make_gpr(Reg::R0)) {
-        printf(
-            "[Warning] %s Stack Zeroing Detected in Function::analyze_prologue, prologue may be "
+        ordered_log::print(fmt::format(
+            "[Warning] {} Stack Zeroing Detected in Function::analyze_prologue, prologue may be "
             "wrong\n",
-            guessed_name.to_string().c_str());
+            guessed_name.to_string()));
         warnings += "Stack Zeroing Detected, prologue may be wrong\n";
         expect_nothing_after_gprs = true;
         break;
@@ -143,9 +146,9 @@ void Function::analyze_prologue(const LinkedObjectFile& file) {
       // avoid false positives here!
       if (store_reg == make_gpr(Reg::A0)) {
         suspected_asm = true;
-        printf(
-            "[Warning] %s Suspected ASM function because register $a0 was stored on the stack!\n",
-            guessed_name.to_string().c_str());
+        ordered_log::print(fmt::format(
+            "[Warning] {} Suspected ASM function because register $a0 was stored on the stack!\n",
+            guessed_name.to_string()));
         warnings += "a0 on stack detected, flagging as asm\n";
         return;
       }
@@ -162,9 +165,9 @@ void Function::analyze_prologue(const LinkedObjectFile& file) {
         assert(this_offset == prologue.gpr_backup_offset + 16 * i);
         if (this_reg != get_expected_gpr_backup(i, n_gpr_backups)) {
           suspected_asm = true;
-          printf("[Warning] %s Suspected asm function that isn't flagged due to stack store %s\n",
-                 guessed_name.to_string().c_str(),
-                 instructions.at(idx + i).to_string(file).c_str());
+          ordered_log::print(fmt::format(
+              "[Warning] {} Suspected asm function that isn't flagged due to stack store {}\n",
+              guessed_name.to_string(), instructions.at(idx + i).to_string(file)));
           warnings += "Suspected asm function due to stack store: " +
                       instructions.at(idx + i).to_string(file) + "\n";
           return;
@@ -192,9 +195,9 @@ void Function::analyze_prologue(const LinkedObjectFile& file) {
           assert(this_offset == prologue.fpr_backup_offset + 4 * i);
           if (this_reg != get_expected_fpr_backup(i, n_fpr_backups)) {
             suspected_asm = true;
-            printf("[Warning] %s Suspected asm function that isn't flagged due to stack store %s\n",
-                   guessed_name.to_string().c_str(),
-                   instructions.at(idx + i).to_string(file).c_str());
+            ordered_log::print(fmt::format(
+                "[Warning] {} Suspected asm function that isn't flagged due to stack store {}\n",
+                guessed_name.to_string(), instructions.at(idx + i).to_string(file)));
             warnings += "Suspected asm function due to stack store: " +
                         instructions.at(idx + i).to_string(file) + "\n";
             return;
@@ -329,7 +332,7 @@ std::string Function::Prologue::to_string(int indent) const {
 void Function::check_epilogue(const LinkedObjectFile& file) {
   (void)file;
   if (!prologue.decoded || suspected_asm) {
-    printf("not decoded, or suspected asm, skipping epilogue\n");
+    ordered_log::print("not decoded, or suspected asm, skipping epilogue\n");
     return;
   }
 
@@ -352,10 +355,10 @@ void Function::check_epilogue(const LinkedObjectFile& file) {
       idx--;
       assert(is_jr_ra(instructions.at(idx)));
       idx--;
-      printf(
-          "[Warning] %s Double Return Epilogue Hack!  This is probably an ASM function in "
+      ordered_log::print(fmt::format(
+          "[Warning] {} Double Return Epilogue Hack!  This is probably an ASM function in "
           "disguise\n",
-          guessed_name.to_string().c_str());
+          guessed_name.to_string()));
       warnings += "Double Return Epilogue - this is probably an ASM function\n";
     }
     // delay slot should be daddiu sp, sp, offset
@@ -659,7 +662,7 @@ void Function::find_type_defs(LinkedObjectFile& file, DecompilerTypeSystem& dts)
   }
 }
 
-void Function::add_basic_op(std::shared_ptr<IR> op, int start_instr, int end_instr) {
+void Function::add_basic_op(IR* op, int start_instr, int end_instr) {
   op->is_basic_op = true;
   assert(end_instr > start_instr);
 
@@ -679,7 +682,7 @@ bool Function::instr_starts_basic_op(int idx) {
   return false;
 }
 
-std::shared_ptr<IR> Function::get_basic_op_at_instr(int idx) {
+IR* Function::get_basic_op_at_instr(int idx) {
   return basic_ops.at(instruction_to_basic_op.at(idx));
 }
 
@@ -694,7 +697,7 @@ int Function::get_basic_op_count() {
 int Function::get_failed_basic_op_count() {
   int count = 0;
   for (auto& x : basic_ops) {
-    if (dynamic_cast<IR_Failed*>(x.get())) {
+    if (ir_cast<IR_Failed>(x)) {
       count++;
     }
   }
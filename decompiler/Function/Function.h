@@ -3,6 +3,7 @@
 #ifndef NEXT_FUNCTION_H
 #define NEXT_FUNCTION_H
 
+#include <memory>
 #include <string>
 #include <vector>
 #include <unordered_map>
@@ -10,11 +11,11 @@
 #include "decompiler/Disasm/Instruction.h"
 #include "BasicBlocks.h"
 #include "CfgVtx.h"
+#include "decompiler/util/Arena.h"
+#include "decompiler/util/TypeMap.h"
 #include "common/type_system/TypeSpec.h"
 
 class DecompilerTypeSystem;
-// Map of what type is in each register.
-using TypeMap = std::unordered_map<Register, TypeSpec, Register::hash>;
 class IR;
 
 struct FunctionName {
@@ -76,12 +77,13 @@ class Function {
   void find_global_function_defs(LinkedObjectFile& file, DecompilerTypeSystem& dts);
   void find_method_defs(LinkedObjectFile& file, DecompilerTypeSystem& dts);
   void find_type_defs(LinkedObjectFile& file, DecompilerTypeSystem& dts);
-  void add_basic_op(std::shared_ptr<IR> op, int start_instr, int end_instr);
+  void add_basic_op(IR* op, int start_instr, int end_instr);
   bool has_basic_ops() { return !basic_ops.empty(); }
   bool has_typemaps() { return !basic_op_typemaps.empty(); }
   bool instr_starts_basic_op(int idx);
-  std::shared_ptr<IR> get_basic_op_at_instr(int idx);
+  IR* get_basic_op_at_instr(int idx);
   const TypeMap& get_typemap_by_instr_idx(int idx);
+  const TypeSpec& get_typemap_type(TypeId id) { return typemap_type_ids->get(id); }
   int get_basic_op_count();
   int get_failed_basic_op_count();
   void run_type_analysis(const TypeSpec& my_type,
@@ -90,7 +92,9 @@ class Function {
 
   TypeSpec type;
 
-  std::shared_ptr<IR> ir = nullptr;
+  IR* ir = nullptr;
+  // owns the basic ops and the IR.
+  std::unique_ptr<Arena> ir_arena = std::make_unique<Arena>();
 
   int segment = -1;
   int start_word = -1;
@@ -144,11 +148,12 @@ class Function {
   } prologue;
 
   bool uses_fp_register = false;
-  std::vector<std::shared_ptr<IR>> basic_ops;
+  std::vector<IR*> basic_ops;
 
  private:
   void check_epilogue(const LinkedObjectFile& file);
   std::vector<TypeMap> basic_op_typemaps;
+  const TypeIdTable* typemap_type_ids = nullptr;  // the types in basic_op_typemaps
   std::unordered_map<int, int> instruction_to_basic_op;
   std::unordered_map<int, int> basic_op_to_instruction;
 };
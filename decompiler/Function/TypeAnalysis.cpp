@@ -16,6 +16,7 @@
  * the lowest common ancestor of the types.
  */
 
+#include <algorithm>
 #include <set>
 #include "Function.h"
 #include "decompiler/util/DecompilerTypeSystem.h"
@@ -31,36 +32,26 @@ namespace {
  * Returns if combined was changed.
  */
 bool lca_tm(TypeMap& combined, const TypeMap& add, DecompilerTypeSystem& dts) {
+  if (combined.shares_with(add)) {
+    return false;
+  }
+
   bool changed = false;
-  for (auto& kv : add) {
-    auto existing = combined.find(kv.first);
-    if (existing == combined.end()) {
+  for (int i = 0; i < TypeMap::SLOT_COUNT; i++) {
+    auto add_type = add.get_slot(i);
+    if (add_type == NO_TYPE) {
+      continue;
+    }
+    auto existing = combined.get_slot(i);
+    auto candidate =
+        existing == NO_TYPE ? add_type : dts.lowest_common_ancestor(add_type, existing);
+    if (candidate != existing) {
       changed = true;
-      combined[kv.first] = kv.second;
-    } else {
-      auto candidate = dts.ts.lowest_common_ancestor(kv.second, existing->second);
-      if (candidate != existing->second) {
-        changed = true;
-        combined[kv.first] = candidate;
-      }
+      combined.set_slot(i, candidate);
     }
   }
   return changed;
 }
-
-/*!
- * Debug print a TypeMap.
- */
-void print_tm(const TypeMap& tm) {
-  for (int i = 0; i < 32; i++) {
-    auto gpr = Register(Reg::RegisterKind::GPR, i);
-    auto kv = tm.find(gpr);
-    if (kv != tm.end()) {
-      fmt::print("{}: {}, ", gpr.to_charp(), kv->second.print());
-    }
-  }
-  fmt::print("\n");
-}
 }  // namespace
 
 /*!
@@ -77,11 +68,11 @@ void Function::run_type_analysis(const TypeSpec& my_type,
   std::vector<TypeMap> typemap_out;
   typemap_out.resize(basic_ops.size());
 
-  // can only run if our type makes sense and has arguments.
+  // can only run if our type makes sense. If the arguments are unknown, we can still get types
+  // for code that doesn't use them.
   assert(my_type.base_type() == "function");
-  assert(my_type.arg_count() > 0);
 
-  int n_args = int(my_type.arg_count()) - 1;
+  int n_args = std::max(0, int(my_type.arg_count()) - 1);
   // auto& return_type = my_type.get_arg(int(my_type.arg_count()) - 1);
 
   // all types at the entrance of each basic block.
@@ -110,21 +101,17 @@ void Function::run_type_analysis(const TypeSpec& my_type,
 
   // set up entry types for the first block
   for (int i = 0; i < n_args; i++) {
-    bb_entry_types.at(0)[arg_regs.at(i)] = my_type.get_arg(i);
+    bb_entry_types.at(0).set(arg_regs.at(i), dts.type_ids.intern(my_type.get_arg(i)));
   }
-  //  print_tm(bb_entry_types.at(0));
 
   bool changed = true;  // did we change anything in this round?
-  int round = 0;        // what round are we currently running
   while (changed) {
     changed = false;
-    fmt::print("--Starting round {}\n", round);
     while (!to_visit.empty()) {
       int block_id = to_visit.back();
       visited.insert(block_id);
       auto& block = basic_blocks.at(block_id);
       to_visit.pop_back();
-      fmt::print("-Visit {}\n", block_id);
 
       TypeMap current_types = bb_entry_types.at(block_id);
 
@@ -132,12 +119,10 @@ void Function::run_type_analysis(const TypeSpec& my_type,
       for (int i = block.start_word; i < block.end_word; i++) {
         if (instr_starts_basic_op(i)) {
           auto basic_op = get_basic_op_at_instr(i);
-          fmt::print("-Attempt prop on {}\n", basic_op->print(file));
           auto basic_idx = instruction_to_basic_op.at(i);
           typemap_out.at(basic_idx) = current_types;
           if (!basic_op->update_types(typemap_out.at(basic_idx), dts, file)) {
-            fmt::print("ERROR: Giving up on type analysis, could not prop types on {}\n",
-                       basic_op->print(file));
+            warnings += "Type analysis failed on " + basic_op->print(file) + "\n";
             return;
           }
           current_types = typemap_out.at(basic_idx);
@@ -149,9 +134,6 @@ void Function::run_type_analysis(const TypeSpec& my_type,
         if (succ != -1) {
           if (lca_tm(bb_entry_types.at(succ), current_types, dts)) {
             changed = true;  // need another round
-            fmt::print("Block {} entry types are now ", succ);
-            print_tm(bb_entry_types.at(succ));
-
             if (visited.find(succ) == visited.end()) {
               to_visit.push_back(succ);
             }
@@ -159,9 +141,8 @@ void Function::run_type_analysis(const TypeSpec& my_type,
         }
       }
     }
-
-    round++;
   }
 
   basic_op_typemaps = std::move(typemap_out);
+  typemap_type_ids = &dts.type_ids;
 }
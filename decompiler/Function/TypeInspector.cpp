@@ -5,6 +5,7 @@
 #include "decompiler/ObjectFile/LinkedObjectFile.h"
 #include "third-party/fmt/core.h"
 #include "decompiler/util/DecompilerTypeSystem.h"
+#include "decompiler/util/OrderedLog.h"
 #include "common/type_system/deftype.h"
 #include "decompiler/IR/IR.h"
 
@@ -132,25 +133,25 @@ FieldPrint get_field_print(const std::string& str) {
 }
 
 bool is_int(IR* ir, s64 value) {
-  auto as_int = dynamic_cast<IR_IntegerConstant*>(ir);
+  auto as_int = ir_cast<IR_IntegerConstant>(ir);
   return as_int && as_int->value == value;
 }
 
 bool is_reg(IR* ir, Register reg) {
-  auto as_reg = dynamic_cast<IR_Register*>(ir);
+  auto as_reg = ir_cast<IR_Register>(ir);
   return as_reg && as_reg->reg == reg;
 }
 
 bool is_math_reg_constant(IR* ir, IR_IntMath2::Kind kind, Register src0, s64 src1) {
-  auto as_math = dynamic_cast<IR_IntMath2*>(ir);
-  return as_math && as_math->kind == kind && is_reg(as_math->arg0.get(), src0) &&
-         is_int(as_math->arg1.get(), src1);
+  auto as_math = ir_cast<IR_IntMath2>(ir);
+  return as_math && as_math->kind == kind && is_reg(as_math->arg0, src0) &&
+         is_int(as_math->arg1, src1);
 }
 
 bool is_load_with_offset(IR* ir, IR_Load::Kind kind, int load_size, Register base, s64 offset) {
-  auto as_load = dynamic_cast<IR_Load*>(ir);
+  auto as_load = ir_cast<IR_Load>(ir);
   return as_load && as_load->kind == kind && as_load->size == load_size &&
-         is_math_reg_constant(as_load->location.get(), IR_IntMath2::ADD, base, offset);
+         is_math_reg_constant(as_load->location, IR_IntMath2::ADD, base, offset);
 }
 
 bool is_get_load_with_offset(IR* ir,
@@ -159,9 +160,9 @@ bool is_get_load_with_offset(IR* ir,
                              int load_size,
                              Register base,
                              s64 offset) {
-  auto as_set = dynamic_cast<IR_Set*>(ir);
-  return as_set && is_reg(as_set->dst.get(), dst) &&
-         is_load_with_offset(as_set->src.get(), kind, load_size, base, offset);
+  auto as_set = ir_cast<IR_Set>(ir);
+  return as_set && is_reg(as_set->dst, dst) &&
+         is_load_with_offset(as_set->src, kind, load_size, base, offset);
 }
 
 struct LoadInfo {
@@ -171,37 +172,37 @@ struct LoadInfo {
 };
 
 LoadInfo get_load_info_from_set(IR* load) {
-  auto as_set = dynamic_cast<IR_Set*>(load);
+  auto as_set = ir_cast<IR_Set>(load);
   assert(as_set);
-  auto as_load = dynamic_cast<IR_Load*>(as_set->src.get());
+  auto as_load = ir_cast<IR_Load>(as_set->src);
   assert(as_load);
   LoadInfo info;
   info.kind = as_load->kind;
   info.size = as_load->size;
-  if (dynamic_cast<IR_Register*>(as_load->location.get())) {
+  if (ir_cast<IR_Register>(as_load->location)) {
     info.offset = 0;
     return info;
   }
 
-  auto as_math = dynamic_cast<IR_IntMath2*>(as_load->location.get());
+  auto as_math = ir_cast<IR_IntMath2>(as_load->location);
   assert(as_math);
   assert(as_math->kind == IR_IntMath2::ADD);
-  auto as_int = dynamic_cast<IR_IntegerConstant*>(as_math->arg1.get());
+  auto as_int = ir_cast<IR_IntegerConstant>(as_math->arg1);
   assert(as_int);
   info.offset = as_int->value;
   return info;
 }
 
 Register get_base_of_load(IR_Load* load) {
-  auto as_reg = dynamic_cast<IR_Register*>(load->location.get());
+  auto as_reg = ir_cast<IR_Register>(load->location);
   if (as_reg) {
     return as_reg->reg;
   }
 
-  auto as_math = dynamic_cast<IR_IntMath2*>(load->location.get());
+  auto as_math = ir_cast<IR_IntMath2>(load->location);
   assert(as_math->kind == IR_IntMath2::ADD);
-  assert(dynamic_cast<IR_IntegerConstant*>(as_math->arg1.get()));
-  auto math_reg = dynamic_cast<IR_Register*>(as_math->arg0.get());
+  assert(ir_cast<IR_IntegerConstant>(as_math->arg1));
+  auto math_reg = ir_cast<IR_Register>(as_math->arg0);
   if (math_reg) {
     return math_reg->reg;
   } else {
@@ -211,57 +212,57 @@ Register get_base_of_load(IR_Load* load) {
 }
 
 bool is_load_with_base(IR* ir, Register base) {
-  auto as_load = dynamic_cast<IR_Load*>(ir);
+  auto as_load = ir_cast<IR_Load>(ir);
   return as_load && base == get_base_of_load(as_load);
 }
 
 bool is_get_load(IR* ir, Register dst, Register base) {
-  auto as_set = dynamic_cast<IR_Set*>(ir);
-  return as_set && is_reg(as_set->dst.get(), dst) && is_load_with_base(as_set->src.get(), base);
+  auto as_set = ir_cast<IR_Set>(ir);
+  return as_set && is_reg(as_set->dst, dst) && is_load_with_base(as_set->src, base);
 }
 
 bool is_reg_reg_move(IR* ir, Register dst, Register src) {
-  auto as_set = dynamic_cast<IR_Set*>(ir);
-  return as_set && is_reg(as_set->dst.get(), dst) && is_reg(as_set->src.get(), src);
+  auto as_set = ir_cast<IR_Set>(ir);
+  return as_set && is_reg(as_set->dst, dst) && is_reg(as_set->src, src);
 }
 
 bool is_sym_value(IR* ir, const std::string& sym_name) {
-  auto as_sym_value = dynamic_cast<IR_SymbolValue*>(ir);
+  auto as_sym_value = ir_cast<IR_SymbolValue>(ir);
   return as_sym_value && as_sym_value->name == sym_name;
 }
 
 bool is_sym(IR* ir, const std::string& sym_name) {
-  auto as_sym = dynamic_cast<IR_Symbol*>(ir);
+  auto as_sym = ir_cast<IR_Symbol>(ir);
   return as_sym && as_sym->name == sym_name;
 }
 
 bool is_get_sym_value(IR* ir, Register dst, const std::string& sym_name) {
-  auto as_set = dynamic_cast<IR_Set*>(ir);
-  return as_set && is_reg(as_set->dst.get(), dst) && is_sym_value(as_set->src.get(), sym_name);
+  auto as_set = ir_cast<IR_Set>(ir);
+  return as_set && is_reg(as_set->dst, dst) && is_sym_value(as_set->src, sym_name);
 }
 
 bool is_get_sym(IR* ir, Register dst, const std::string& sym_name) {
-  auto as_set = dynamic_cast<IR_Set*>(ir);
-  return as_set && is_reg(as_set->dst.get(), dst) && is_sym(as_set->src.get(), sym_name);
+  auto as_set = ir_cast<IR_Set>(ir);
+  return as_set && is_reg(as_set->dst, dst) && is_sym(as_set->src, sym_name);
 }
 
 bool is_label(IR* ir) {
-  return dynamic_cast<IR_StaticAddress*>(ir);
+  return ir_cast<IR_StaticAddress>(ir);
 }
 
 bool is_get_label(IR* ir, Register dst) {
-  auto as_set = dynamic_cast<IR_Set*>(ir);
-  return as_set && is_reg(as_set->dst.get(), dst) && is_label(as_set->src.get());
+  auto as_set = ir_cast<IR_Set>(ir);
+  return as_set && is_reg(as_set->dst, dst) && is_label(as_set->src);
 }
 
 int get_label_id_of_set(IR* ir) {
-  return dynamic_cast<IR_StaticAddress*>(dynamic_cast<IR_Set*>(ir)->src.get())->label_id;
+  return ir_cast<IR_StaticAddress>(ir_cast<IR_Set>(ir)->src)->label_id;
 }
 
 bool is_set_shift(IR* ir) {
-  auto as_set = dynamic_cast<IR_Set*>(ir);
+  auto as_set = ir_cast<IR_Set>(ir);
   if (as_set) {
-    auto as_math = dynamic_cast<IR_IntMath2*>(as_set->src.get());
+    auto as_math = ir_cast<IR_IntMath2>(as_set->src);
     if (as_math && (as_math->kind == IR_IntMath2::LEFT_SHIFT ||
                     as_math->kind == IR_IntMath2::RIGHT_SHIFT_LOGIC ||
                     as_math->kind == IR_IntMath2::RIGHT_SHIFT_ARITH)) {
@@ -269,16 +270,16 @@ bool is_set_shift(IR* ir) {
     }
   }
 
-  auto as_asm = dynamic_cast<IR_AsmOp*>(ir);
+  auto as_asm = ir_cast<IR_AsmOp>(ir);
   return as_asm && as_asm->name == "sllv";
 }
 
 bool get_ptr_offset_constant_nonzero(IR_IntMath2* math, Register base, int* result) {
-  if (!is_reg(math->arg0.get(), base)) {
+  if (!is_reg(math->arg0, base)) {
     return false;
   }
 
-  auto as_int = dynamic_cast<IR_IntegerConstant*>(math->arg1.get());
+  auto as_int = ir_cast<IR_IntegerConstant>(math->arg1);
   if (!as_int) {
     return false;
   }
@@ -288,7 +289,7 @@ bool get_ptr_offset_constant_nonzero(IR_IntMath2* math, Register base, int* resu
 }
 
 bool get_ptr_offset_zero(IR_IntMath2* math, Register base, int* result) {
-  if (!is_reg(math->arg0.get(), make_gpr(Reg::R0)) || !is_reg(math->arg1.get(), base)) {
+  if (!is_reg(math->arg0, make_gpr(Reg::R0)) || !is_reg(math->arg1, base)) {
     return false;
   }
   *result = 0;
@@ -296,16 +297,16 @@ bool get_ptr_offset_zero(IR_IntMath2* math, Register base, int* result) {
 }
 
 bool get_ptr_offset(IR* ir, Register dst, Register base, int* result) {
-  auto as_set = dynamic_cast<IR_Set*>(ir);
+  auto as_set = ir_cast<IR_Set>(ir);
   if (!as_set) {
     return false;
   }
 
-  if (!is_reg(as_set->dst.get(), dst)) {
+  if (!is_reg(as_set->dst, dst)) {
     return false;
   }
 
-  auto as_math = dynamic_cast<IR_IntMath2*>(as_set->src.get());
+  auto as_math = ir_cast<IR_IntMath2>(as_set->src);
   if (!as_math) {
     return false;
   }
@@ -349,44 +350,44 @@ int get_start_idx(Function& function,
   }
 
   auto& move_op = function.basic_ops.at(0);
-  if (!is_reg_reg_move(move_op.get(), make_gpr(Reg::GP), make_gpr(Reg::A0))) {
+  if (!is_reg_reg_move(move_op, make_gpr(Reg::GP), make_gpr(Reg::A0))) {
     result->warnings += "bad first move";
     return 0;
   }
 
   auto& get_format_op = function.basic_ops.at(1);
 
-  if (is_get_sym_value(get_format_op.get(), make_gpr(Reg::T9), "format")) {
+  if (is_get_sym_value(get_format_op, make_gpr(Reg::T9), "format")) {
     auto& get_true = function.basic_ops.at(2);
-    if (!is_get_sym(get_true.get(), make_gpr(Reg::A0), "#t")) {
+    if (!is_get_sym(get_true, make_gpr(Reg::A0), "#t")) {
       result->warnings += "bad get true";
       return 0;
     }
 
     auto& get_str = function.basic_ops.at(3);
-    if (!is_get_label(get_str.get(), make_gpr(Reg::A1))) {
+    if (!is_get_label(get_str, make_gpr(Reg::A1))) {
       result->warnings += "bad get label";
       return 0;
     }
 
-    auto str = file.get_goal_string_by_label(file.labels.at(get_label_id_of_set(get_str.get())));
+    auto str = file.get_goal_string_by_label(file.labels.at(get_label_id_of_set(get_str)));
     if (str != "[~8x] ~A~%") {
       result->warnings += "bad type dec string: " + str;
       return 0;
     }
 
     auto& move2_op = function.basic_ops.at(4);
-    if (!is_reg_reg_move(move2_op.get(), make_gpr(Reg::A2), make_gpr(Reg::GP))) {
+    if (!is_reg_reg_move(move2_op, make_gpr(Reg::A2), make_gpr(Reg::GP))) {
       result->warnings += "bad second move";
       return 0;
     }
 
     auto& load_op = function.basic_ops.at(5);
-    bool is_basic_load = is_get_load_with_offset(load_op.get(), make_gpr(Reg::A3),
+    bool is_basic_load = is_get_load_with_offset(load_op, make_gpr(Reg::A3),
                                                  IR_Load::UNSIGNED, 4, make_gpr(Reg::GP), -4);
     result->is_basic = is_basic_load;
 
-    bool is_struct_load = is_get_sym(load_op.get(), make_gpr(Reg::A3), function.method_of_type);
+    bool is_struct_load = is_get_sym(load_op, make_gpr(Reg::A3), function.method_of_type);
 
     if (!is_basic_load && !is_struct_load) {
       result->warnings += "bad load";
@@ -394,7 +395,7 @@ int get_start_idx(Function& function,
     }
 
     auto& call = function.basic_ops.at(6);
-    if (!dynamic_cast<IR_Call*>(call.get())) {
+    if (!ir_cast<IR_Call>(call)) {
       result->warnings += "bad call";
       return 0;
     }
@@ -402,23 +403,23 @@ int get_start_idx(Function& function,
     // okay!
     return 7;
   } else {
-    if (is_get_sym_value(get_format_op.get(), make_gpr(Reg::V1), parent_type)) {
+    if (is_get_sym_value(get_format_op, make_gpr(Reg::V1), parent_type)) {
       // now get the inspect method.
       auto& get_method_op = function.basic_ops.at(2);
-      if (!is_get_load_with_offset(get_method_op.get(), make_gpr(Reg::T9), IR_Load::UNSIGNED, 4,
+      if (!is_get_load_with_offset(get_method_op, make_gpr(Reg::T9), IR_Load::UNSIGNED, 4,
                                    make_gpr(Reg::V1), 28)) {
         result->warnings += "bad get method op " + get_method_op->print(file);
         return 0;
       }
 
       auto& move2_op = function.basic_ops.at(3);
-      if (!is_reg_reg_move(move2_op.get(), make_gpr(Reg::A0), make_gpr(Reg::GP))) {
+      if (!is_reg_reg_move(move2_op, make_gpr(Reg::A0), make_gpr(Reg::GP))) {
         result->warnings += "bad move2 op " + move2_op->print(file);
         return 0;
       }
 
       auto& call_op = function.basic_ops.at(4);
-      if (!dynamic_cast<IR_Call*>(call_op.get())) {
+      if (!ir_cast<IR_Call>(call_op)) {
         result->warnings += "bad call op " + call_op->print(file);
         return 0;
       }
@@ -441,7 +442,7 @@ int identify_basic_field(int idx,
                          TypeInspectorResult* result,
                          FieldPrint& print_info) {
   (void)file;
-  auto load_info = get_load_info_from_set(function.basic_ops.at(idx++).get());
+  auto load_info = get_load_info_from_set(function.basic_ops.at(idx++));
   assert(load_info.size == 4);
   assert(load_info.kind == IR_Load::UNSIGNED || load_info.kind == IR_Load::SIGNED);
 
@@ -465,7 +466,7 @@ int identify_pointer_field(int idx,
                            TypeInspectorResult* result,
                            FieldPrint& print_info) {
   (void)file;
-  auto load_info = get_load_info_from_set(function.basic_ops.at(idx++).get());
+  auto load_info = get_load_info_from_set(function.basic_ops.at(idx++));
   assert(load_info.size == 4);
   assert(load_info.kind == IR_Load::UNSIGNED);
 
@@ -486,8 +487,9 @@ int identify_array_field(int idx,
                          FieldPrint& print_info) {
   auto& get_op = function.basic_ops.at(idx++);
   int offset = 0;
-  if (!get_ptr_offset(get_op.get(), make_gpr(Reg::A2), make_gpr(Reg::GP), &offset)) {
-    printf("bad get ptr offset %s\n", get_op->print(file).c_str());
+  if (!get_ptr_offset(get_op, make_gpr(Reg::A2), make_gpr(Reg::GP), &offset)) {
+    ordered_log::print(fmt::format("bad get ptr offset {}\n", get_op->print(file)));
+    ordered_log::flush_captured();
     assert(false);
   }
   if (result->is_basic) {
@@ -509,13 +511,14 @@ int identify_float_field(int idx,
                          LinkedObjectFile& file,
                          TypeInspectorResult* result,
                          FieldPrint& print_info) {
-  auto load_info = get_load_info_from_set(function.basic_ops.at(idx++).get());
+  auto load_info = get_load_info_from_set(function.basic_ops.at(idx++));
   assert(load_info.size == 4);
   assert(load_info.kind == IR_Load::FLOAT);
 
   auto& float_move = function.basic_ops.at(idx++);
-  if (!is_reg_reg_move(float_move.get(), make_gpr(Reg::A2), make_fpr(0))) {
-    printf("bad float move: %s\n", float_move->print(file).c_str());
+  if (!is_reg_reg_move(float_move, make_gpr(Reg::A2), make_fpr(0))) {
+    ordered_log::print(fmt::format("bad float move: {}\n", float_move->print(file)));
+    ordered_log::flush_captured();
     assert(false);
   }
 
@@ -553,7 +556,7 @@ int identify_struct_not_inline_field(int idx,
                                      TypeInspectorResult* result,
                                      FieldPrint& print_info) {
   (void)file;
-  auto load_info = get_load_info_from_set(function.basic_ops.at(idx++).get());
+  auto load_info = get_load_info_from_set(function.basic_ops.at(idx++));
 
   if (!(load_info.size == 4 && load_info.kind == IR_Load::UNSIGNED)) {
     result->warnings += "field " + print_info.field_type_name + " is likely a value type";
@@ -575,8 +578,9 @@ int identify_struct_inline_field(int idx,
                                  FieldPrint& print_info) {
   auto& get_op = function.basic_ops.at(idx++);
   int offset = 0;
-  if (!get_ptr_offset(get_op.get(), make_gpr(Reg::A2), make_gpr(Reg::GP), &offset)) {
-    printf("bad get ptr offset %s\n", get_op->print(file).c_str());
+  if (!get_ptr_offset(get_op, make_gpr(Reg::A2), make_gpr(Reg::GP), &offset)) {
+    ordered_log::print(fmt::format("bad get ptr offset {}\n", get_op->print(file)));
+    ordered_log::flush_captured();
     assert(false);
   }
   if (result->is_basic) {
@@ -595,7 +599,7 @@ int identify_int_field(int idx,
                        TypeInspectorResult* result,
                        FieldPrint& print_info) {
   (void)file;
-  auto load_info = get_load_info_from_set(function.basic_ops.at(idx++).get());
+  auto load_info = get_load_info_from_set(function.basic_ops.at(idx++));
 
   std::string field_type_name;
   if (load_info.kind == IR_Load::UNSIGNED) {
@@ -653,42 +657,44 @@ int identify_int_field(int idx,
 
 int detect(int idx, Function& function, LinkedObjectFile& file, TypeInspectorResult* result) {
   auto& get_format_op = function.basic_ops.at(idx++);
-  if (!is_get_sym_value(get_format_op.get(), make_gpr(Reg::T9), "format")) {
-    printf("bad get format");
+  if (!is_get_sym_value(get_format_op, make_gpr(Reg::T9), "format")) {
+    ordered_log::print("bad get format");
+    ordered_log::flush_captured();
     assert(false);
   }
 
   auto& get_true = function.basic_ops.at(idx++);
-  if (!is_get_sym(get_true.get(), make_gpr(Reg::A0), "#t")) {
-    printf("bad get true");
+  if (!is_get_sym(get_true, make_gpr(Reg::A0), "#t")) {
+    ordered_log::print("bad get true");
+    ordered_log::flush_captured();
     assert(false);
   }
 
   auto& get_str = function.basic_ops.at(idx++);
-  if (!is_get_label(get_str.get(), make_gpr(Reg::A1))) {
+  if (!is_get_label(get_str, make_gpr(Reg::A1))) {
     result->warnings += "bad get label";
     return true;
   }
 
-  auto str = file.get_goal_string_by_label(file.labels.at(get_label_id_of_set(get_str.get())));
+  auto str = file.get_goal_string_by_label(file.labels.at(get_label_id_of_set(get_str)));
   auto info = get_field_print(str);
 
   auto& first_get_op = function.basic_ops.at(idx);
 
-  if (is_get_load(first_get_op.get(), make_gpr(Reg::A2), make_gpr(Reg::GP)) &&
+  if (is_get_load(first_get_op, make_gpr(Reg::A2), make_gpr(Reg::GP)) &&
       (info.format == 'D' || info.format == 'X' || info.format == 'e') && !info.has_array &&
       info.field_type_name.empty()) {
     idx = identify_int_field(idx, function, file, result, info);
     // it's a load!
-  } else if (is_get_load(first_get_op.get(), make_fpr(0), make_gpr(Reg::GP)) &&
+  } else if (is_get_load(first_get_op, make_fpr(0), make_gpr(Reg::GP)) &&
              (info.format == 'f' || info.format == 'm' || info.format == 'r' ||
               info.format == 'X') &&
              !info.has_array && info.field_type_name.empty()) {
     idx = identify_float_field(idx, function, file, result, info);
-  } else if (is_get_load(first_get_op.get(), make_gpr(Reg::A2), make_gpr(Reg::GP)) &&
+  } else if (is_get_load(first_get_op, make_gpr(Reg::A2), make_gpr(Reg::GP)) &&
              info.format == 'A' && !info.has_array && info.field_type_name.empty()) {
     idx = identify_basic_field(idx, function, file, result, info);
-  } else if (is_get_load(first_get_op.get(), make_gpr(Reg::A2), make_gpr(Reg::GP)) &&
+  } else if (is_get_load(first_get_op, make_gpr(Reg::A2), make_gpr(Reg::GP)) &&
              info.format == 'X' && !info.has_array && info.field_type_name.empty()) {
     idx = identify_pointer_field(idx, function, file, result, info);
   } else if (info.has_array && (info.format == 'X' || info.format == 'P') &&
@@ -697,7 +703,7 @@ int detect(int idx, Function& function, LinkedObjectFile& file, TypeInspectorRes
   } else if (!info.has_array && (info.format == 'X' || info.format == 'P') &&
              !info.field_type_name.empty()) {
     // structure.
-    if (is_get_load(first_get_op.get(), make_gpr(Reg::A2), make_gpr(Reg::GP))) {
+    if (is_get_load(first_get_op, make_gpr(Reg::A2), make_gpr(Reg::GP))) {
       // not inline
       idx = identify_struct_not_inline_field(idx, function, file, result, info);
     } else {
@@ -705,17 +711,18 @@ int detect(int idx, Function& function, LinkedObjectFile& file, TypeInspectorRes
     }
   }
 
-  else if (is_set_shift(first_get_op.get())) {
+  else if (is_set_shift(first_get_op)) {
     result->warnings += "likely a bitfield type";
     return -1;
   } else {
-    printf("couldn't do %s, %s\n", str.c_str(), first_get_op->print(file).c_str());
+    ordered_log::print(fmt::format("couldn't do {}, {}\n", str, first_get_op->print(file)));
     return -1;
   }
 
   auto& call_op = function.basic_ops.at(idx++);
-  if (!dynamic_cast<IR_Call*>(call_op.get())) {
-    printf("bad call\n");
+  if (!ir_cast<IR_Call>(call_op)) {
+    ordered_log::print("bad call\n");
+    ordered_log::flush_captured();
     assert(false);
   }
 
@@ -12,6 +12,8 @@
 #include "decompiler/Function/BasicBlocks.h"
 #include "decompiler/Disasm/InstructionMatching.h"
 #include "decompiler/IR/IR.h"
+#include "decompiler/util/OrderedLog.h"
+#include "third-party/fmt/core.h"
 
 namespace {
 
@@ -19,45 +21,43 @@ namespace {
  * Create a GOAL "set!" form.
  * These will later be compacted into more complicated nested expressions.
  */
-std::shared_ptr<IR_Set> make_set(IR_Set::Kind kind,
-                                 const std::shared_ptr<IR>& dst,
-                                 const std::shared_ptr<IR>& src) {
-  return std::make_shared<IR_Set>(kind, dst, src);
+IR_Set* make_set(IR_Set::Kind kind, IR* dst, IR* src) {
+  return make_ir<IR_Set>(kind, dst, src);
 }
 
 /*!
  * Create an IR representing a register at a certain point.  Idx is the instruction index.
  */
-std::shared_ptr<IR_Register> make_reg(Register reg, int idx) {
-  return std::make_shared<IR_Register>(reg, idx);
+IR_Register* make_reg(Register reg, int idx) {
+  return make_ir<IR_Register>(reg, idx);
 }
 
 /*!
  * Create an IR representing a symbol. The symbol itself ('thing), not the value.
  */
-std::shared_ptr<IR_Symbol> make_sym(const std::string& name) {
-  return std::make_shared<IR_Symbol>(name);
+IR_Symbol* make_sym(const std::string& name) {
+  return make_ir<IR_Symbol>(name);
 }
 
 /*!
  * Create an IR representing the value of a symbol. Can be read/written.
  */
-std::shared_ptr<IR_SymbolValue> make_sym_value(const std::string& name) {
-  return std::make_shared<IR_SymbolValue>(name);
+IR_SymbolValue* make_sym_value(const std::string& name) {
+  return make_ir<IR_SymbolValue>(name);
 }
 
 /*!
  * Create an integer constant.
  */
-std::shared_ptr<IR_IntegerConstant> make_int(int64_t x) {
-  return std::make_shared<IR_IntegerConstant>(x);
+IR_IntegerConstant* make_int(int64_t x) {
+  return make_ir<IR_IntegerConstant>(x);
 }
 
 /*!
  * Create an assembly passthrough in the form op dst, src, src
  */
-std::shared_ptr<IR> to_asm_reg_reg_reg(const std::string& str, Instruction& instr, int idx) {
-  auto result = std::make_shared<IR_AsmOp>(str);
+IR* to_asm_reg_reg_reg(const std::string& str, Instruction& instr, int idx) {
+  auto result = make_ir<IR_AsmOp>(str);
   result->dst = make_reg(instr.get_dst(0).get_reg(), idx);
   result->src0 = make_reg(instr.get_src(0).get_reg(), idx);
   result->src1 = make_reg(instr.get_src(1).get_reg(), idx);
@@ -67,8 +67,8 @@ std::shared_ptr<IR> to_asm_reg_reg_reg(const std::string& str, Instruction& inst
 /*!
  * Create an assembly passthrough for op src
  */
-std::shared_ptr<IR> to_asm_src_reg(const std::string& str, Instruction& instr, int idx) {
-  auto result = std::make_shared<IR_AsmOp>(str);
+IR* to_asm_src_reg(const std::string& str, Instruction& instr, int idx) {
+  auto result = make_ir<IR_AsmOp>(str);
   result->src0 = make_reg(instr.get_src(0).get_reg(), idx);
   return result;
 }
@@ -76,8 +76,8 @@ std::shared_ptr<IR> to_asm_src_reg(const std::string& str, Instruction& instr, i
 /*!
  * Create an assembly passthrough for op dst src
  */
-std::shared_ptr<IR> to_asm_dst_reg_src_reg(const std::string& str, Instruction& instr, int idx) {
-  auto result = std::make_shared<IR_AsmOp>(str);
+IR* to_asm_dst_reg_src_reg(const std::string& str, Instruction& instr, int idx) {
+  auto result = make_ir<IR_AsmOp>(str);
   result->dst = make_reg(instr.get_dst(0).get_reg(), idx);
   result->src0 = make_reg(instr.get_src(0).get_reg(), idx);
   return result;
@@ -86,14 +86,14 @@ std::shared_ptr<IR> to_asm_dst_reg_src_reg(const std::string& str, Instruction&
 /*!
  * Convert an instruction atom to IR.
  */
-std::shared_ptr<IR> instr_atom_to_ir(const InstructionAtom& ia, int idx) {
+IR* instr_atom_to_ir(const InstructionAtom& ia, int idx) {
   switch (ia.kind) {
     case InstructionAtom::REGISTER:
       return make_reg(ia.get_reg(), idx);
     case InstructionAtom::VU_Q:
-      return std::make_shared<IR_AsmReg>(IR_AsmReg::VU_Q);
+      return make_ir<IR_AsmReg>(IR_AsmReg::VU_Q);
     case InstructionAtom::VU_ACC:
-      return std::make_shared<IR_AsmReg>(IR_AsmReg::VU_ACC);
+      return make_ir<IR_AsmReg>(IR_AsmReg::VU_ACC);
     case InstructionAtom::IMM:
       return make_int(ia.get_imm());
     default:
@@ -101,8 +101,8 @@ std::shared_ptr<IR> instr_atom_to_ir(const InstructionAtom& ia, int idx) {
   }
 }
 
-std::shared_ptr<IR> to_asm_automatic(const std::string& str, Instruction& instr, int idx) {
-  auto result = std::make_shared<IR_AsmOp>(str);
+IR* to_asm_automatic(const std::string& str, Instruction& instr, int idx) {
+  auto result = make_ir<IR_AsmOp>(str);
   assert(instr.n_dst < 2);
   assert(instr.n_src < 4);
   if (instr.n_dst >= 1) {
@@ -124,21 +124,21 @@ std::shared_ptr<IR> to_asm_automatic(const std::string& str, Instruction& instr,
   return result;
 }
 
-std::shared_ptr<IR> try_subu(Instruction& instr, int idx) {
+IR* try_subu(Instruction& instr, int idx) {
   if (is_gpr_3(instr, InstructionKind::SUBU, {}, {}, {})) {
     return to_asm_reg_reg_reg("subu", instr, idx);
   }
   return nullptr;
 }
 
-std::shared_ptr<IR> try_sllv(Instruction& instr, int idx) {
+IR* try_sllv(Instruction& instr, int idx) {
   if (is_gpr_3(instr, InstructionKind::SLLV, {}, {}, make_gpr(Reg::R0))) {
     return to_asm_reg_reg_reg("sllv", instr, idx);
   }
   return nullptr;
 }
 
-std::shared_ptr<IR> try_or(Instruction& instr, int idx) {
+IR* try_or(Instruction& instr, int idx) {
   if (is_gpr_3(instr, InstructionKind::OR, {}, make_gpr(Reg::S7), make_gpr(Reg::R0))) {
     return make_set(IR_Set::REG_64, make_reg(instr.get_dst(0).get_reg(), idx), make_sym("#f"));
   } else if (is_gpr_3(instr, InstructionKind::OR, {}, {}, make_gpr(Reg::R0))) {
@@ -147,13 +147,13 @@ std::shared_ptr<IR> try_or(Instruction& instr, int idx) {
   } else {
     return make_set(
         IR_Set::REG_64, make_reg(instr.get_dst(0).get_reg(), idx),
-        std::make_shared<IR_IntMath2>(IR_IntMath2::OR, make_reg(instr.get_src(0).get_reg(), idx),
-                                      make_reg(instr.get_src(1).get_reg(), idx)));
+        make_ir<IR_IntMath2>(IR_IntMath2::OR, make_reg(instr.get_src(0).get_reg(), idx),
+                             make_reg(instr.get_src(1).get_reg(), idx)));
   }
   return nullptr;
 }
 
-std::shared_ptr<IR> try_ori(Instruction& instr, int idx) {
+IR* try_ori(Instruction& instr, int idx) {
   if (instr.kind == InstructionKind::ORI && instr.get_src(0).is_reg(make_gpr(Reg::R0)) &&
       instr.get_src(1).is_imm()) {
     return make_set(IR_Set::REG_64, make_reg(instr.get_dst(0).get_reg(), idx),
@@ -161,13 +161,13 @@ std::shared_ptr<IR> try_ori(Instruction& instr, int idx) {
   } else if (instr.kind == InstructionKind::ORI && instr.get_src(1).is_imm()) {
     return make_set(
         IR_Set::REG_64, make_reg(instr.get_dst(0).get_reg(), idx),
-        std::make_shared<IR_IntMath2>(IR_IntMath2::OR, make_reg(instr.get_src(0).get_reg(), idx),
-                                      make_int(instr.get_src(1).get_imm())));
+        make_ir<IR_IntMath2>(IR_IntMath2::OR, make_reg(instr.get_src(0).get_reg(), idx),
+                             make_int(instr.get_src(1).get_imm())));
   }
   return nullptr;
 }
 
-std::shared_ptr<IR> try_por(Instruction& instr, int idx) {
+IR* try_por(Instruction& instr, int idx) {
   if (is_gpr_3(instr, InstructionKind::POR, {}, {}, make_gpr(Reg::R0))) {
     return make_set(IR_Set::REG_I128, make_reg(instr.get_dst(0).get_reg(), idx),
                     make_reg(instr.get_src(0).get_reg(), idx));
@@ -175,7 +175,7 @@ std::shared_ptr<IR> try_por(Instruction& instr, int idx) {
   return nullptr;
 }
 
-std::shared_ptr<IR> try_mtc1(Instruction& instr, int idx) {
+IR* try_mtc1(Instruction& instr, int idx) {
   if (instr.kind == InstructionKind::MTC1) {
     return make_set(IR_Set::GPR_TO_FPR, make_reg(instr.get_dst(0).get_reg(), idx),
                     make_reg(instr.get_src(0).get_reg(), idx));
@@ -183,7 +183,7 @@ std::shared_ptr<IR> try_mtc1(Instruction& instr, int idx) {
   return nullptr;
 }
 
-std::shared_ptr<IR> try_mfc1(Instruction& instr, int idx) {
+IR* try_mfc1(Instruction& instr, int idx) {
   if (instr.kind == InstructionKind::MFC1) {
     return make_set(IR_Set::FPR_TO_GPR64, make_reg(instr.get_dst(0).get_reg(), idx),
                     make_reg(instr.get_src(0).get_reg(), idx));
@@ -191,248 +191,248 @@ std::shared_ptr<IR> try_mfc1(Instruction& instr, int idx) {
   return nullptr;
 }
 
-std::shared_ptr<IR> try_lwc1(Instruction& instr, int idx) {
+IR* try_lwc1(Instruction& instr, int idx) {
   if (instr.kind == InstructionKind::LWC1 && instr.get_dst(0).is_reg() &&
       instr.get_src(0).is_link_or_label() && instr.get_src(1).is_reg(make_gpr(Reg::FP))) {
     return make_set(
         IR_Set::LOAD, make_reg(instr.get_dst(0).get_reg(), idx),
-        std::make_shared<IR_Load>(
-            IR_Load::FLOAT, 4, std::make_shared<IR_StaticAddress>(instr.get_src(0).get_label())));
+        make_ir<IR_Load>(
+            IR_Load::FLOAT, 4, make_ir<IR_StaticAddress>(instr.get_src(0).get_label())));
   } else if (instr.kind == InstructionKind::LWC1 && instr.get_dst(0).is_reg() &&
              instr.get_src(0).is_imm() && instr.get_src(0).get_imm() == 0) {
     return make_set(
         IR_Set::LOAD, make_reg(instr.get_dst(0).get_reg(), idx),
-        std::make_shared<IR_Load>(IR_Load::FLOAT, 4, make_reg(instr.get_src(1).get_reg(), idx)));
+        make_ir<IR_Load>(IR_Load::FLOAT, 4, make_reg(instr.get_src(1).get_reg(), idx)));
   } else if (instr.kind == InstructionKind::LWC1 && instr.get_dst(0).is_reg() &&
              instr.get_src(0).is_imm()) {
     return make_set(IR_Set::LOAD, make_reg(instr.get_dst(0).get_reg(), idx),
-                    std::make_shared<IR_Load>(
+                    make_ir<IR_Load>(
                         IR_Load::FLOAT, 4,
-                        std::make_shared<IR_IntMath2>(
+                        make_ir<IR_IntMath2>(
                             IR_IntMath2::ADD, make_reg(instr.get_src(1).get_reg(), idx),
-                            std::make_shared<IR_IntegerConstant>(instr.get_src(0).get_imm()))));
+                            make_ir<IR_IntegerConstant>(instr.get_src(0).get_imm()))));
   }
   return nullptr;
 }
 
-std::shared_ptr<IR> try_lhu(Instruction& instr, int idx) {
+IR* try_lhu(Instruction& instr, int idx) {
   if (instr.kind == InstructionKind::LHU && instr.get_dst(0).is_reg() &&
       instr.get_src(0).is_link_or_label() && instr.get_src(1).is_reg(make_gpr(Reg::FP))) {
     return make_set(IR_Set::LOAD, make_reg(instr.get_dst(0).get_reg(), idx),
-                    std::make_shared<IR_Load>(
+                    make_ir<IR_Load>(
                         IR_Load::UNSIGNED, 2,
-                        std::make_shared<IR_StaticAddress>(instr.get_src(0).get_label())));
+                        make_ir<IR_StaticAddress>(instr.get_src(0).get_label())));
   } else if (instr.kind == InstructionKind::LHU && instr.get_dst(0).is_reg() &&
              instr.get_src(0).is_imm() && instr.get_src(0).get_imm() == 0) {
     return make_set(
         IR_Set::LOAD, make_reg(instr.get_dst(0).get_reg(), idx),
-        std::make_shared<IR_Load>(IR_Load::UNSIGNED, 2, make_reg(instr.get_src(1).get_reg(), idx)));
+        make_ir<IR_Load>(IR_Load::UNSIGNED, 2, make_reg(instr.get_src(1).get_reg(), idx)));
   } else if (instr.kind == InstructionKind::LHU && instr.get_dst(0).is_reg() &&
              instr.get_src(0).is_imm()) {
     return make_set(IR_Set::LOAD, make_reg(instr.get_dst(0).get_reg(), idx),
-                    std::make_shared<IR_Load>(
+                    make_ir<IR_Load>(
                         IR_Load::UNSIGNED, 2,
-                        std::make_shared<IR_IntMath2>(
+                        make_ir<IR_IntMath2>(
                             IR_IntMath2::ADD, make_reg(instr.get_src(1).get_reg(), idx),
-                            std::make_shared<IR_IntegerConstant>(instr.get_src(0).get_imm()))));
+                            make_ir<IR_IntegerConstant>(instr.get_src(0).get_imm()))));
   }
   return nullptr;
 }
 
-std::shared_ptr<IR> try_lh(Instruction& instr, int idx) {
+IR* try_lh(Instruction& instr, int idx) {
   if (instr.kind == InstructionKind::LH && instr.get_dst(0).is_reg() &&
       instr.get_src(0).is_link_or_label() && instr.get_src(1).is_reg(make_gpr(Reg::FP))) {
     return make_set(
         IR_Set::LOAD, make_reg(instr.get_dst(0).get_reg(), idx),
-        std::make_shared<IR_Load>(
-            IR_Load::SIGNED, 2, std::make_shared<IR_StaticAddress>(instr.get_src(0).get_label())));
+        make_ir<IR_Load>(
+            IR_Load::SIGNED, 2, make_ir<IR_StaticAddress>(instr.get_src(0).get_label())));
   } else if (instr.kind == InstructionKind::LH && instr.get_dst(0).is_reg() &&
              instr.get_src(0).is_imm() && instr.get_src(0).get_imm() == 0) {
     return make_set(
         IR_Set::LOAD, make_reg(instr.get_dst(0).get_reg(), idx),
-        std::make_shared<IR_Load>(IR_Load::SIGNED, 2, make_reg(instr.get_src(1).get_reg(), idx)));
+        make_ir<IR_Load>(IR_Load::SIGNED, 2, make_reg(instr.get_src(1).get_reg(), idx)));
   } else if (instr.kind == InstructionKind::LH && instr.get_dst(0).is_reg() &&
              instr.get_src(0).is_imm()) {
     return make_set(IR_Set::LOAD, make_reg(instr.get_dst(0).get_reg(), idx),
-                    std::make_shared<IR_Load>(
+                    make_ir<IR_Load>(
                         IR_Load::SIGNED, 2,
-                        std::make_shared<IR_IntMath2>(
+                        make_ir<IR_IntMath2>(
                             IR_IntMath2::ADD, make_reg(instr.get_src(1).get_reg(), idx),
-                            std::make_shared<IR_IntegerConstant>(instr.get_src(0).get_imm()))));
+                            make_ir<IR_IntegerConstant>(instr.get_src(0).get_imm()))));
   }
   return nullptr;
 }
 
-std::shared_ptr<IR> try_lb(Instruction& instr, int idx) {
+IR* try_lb(Instruction& instr, int idx) {
   if (instr.kind == InstructionKind::LB && instr.get_dst(0).is_reg() &&
       instr.get_src(0).is_link_or_label() && instr.get_src(1).is_reg(make_gpr(Reg::FP))) {
     return make_set(
         IR_Set::LOAD, make_reg(instr.get_dst(0).get_reg(), idx),
-        std::make_shared<IR_Load>(
-            IR_Load::SIGNED, 1, std::make_shared<IR_StaticAddress>(instr.get_src(0).get_label())));
+        make_ir<IR_Load>(
+            IR_Load::SIGNED, 1, make_ir<IR_StaticAddress>(instr.get_src(0).get_label())));
   } else if (instr.kind == InstructionKind::LB && instr.get_dst(0).is_reg() &&
              instr.get_src(0).is_imm() && instr.get_src(0).get_imm() == 0) {
     return make_set(
         IR_Set::LOAD, make_reg(instr.get_dst(0).get_reg(), idx),
-        std::make_shared<IR_Load>(IR_Load::SIGNED, 1, make_reg(instr.get_src(1).get_reg(), idx)));
+        make_ir<IR_Load>(IR_Load::SIGNED, 1, make_reg(instr.get_src(1).get_reg(), idx)));
   } else if (instr.kind == InstructionKind::LB && instr.get_dst(0).is_reg() &&
              instr.get_src(0).is_imm()) {
     return make_set(IR_Set::LOAD, make_reg(instr.get_dst(0).get_reg(), idx),
-                    std::make_shared<IR_Load>(
+                    make_ir<IR_Load>(
                         IR_Load::SIGNED, 1,
-                        std::make_shared<IR_IntMath2>(
+                        make_ir<IR_IntMath2>(
                             IR_IntMath2::ADD, make_reg(instr.get_src(1).get_reg(), idx),
-                            std::make_shared<IR_IntegerConstant>(instr.get_src(0).get_imm()))));
+                            make_ir<IR_IntegerConstant>(instr.get_src(0).get_imm()))));
   }
   return nullptr;
 }
 
-std::shared_ptr<IR> try_lbu(Instruction& instr, int idx) {
+IR* try_lbu(Instruction& instr, int idx) {
   if (instr.kind == InstructionKind::LBU && instr.get_dst(0).is_reg() &&
       instr.get_src(0).is_link_or_label() && instr.get_src(1).is_reg(make_gpr(Reg::FP))) {
     return make_set(IR_Set::LOAD, make_reg(instr.get_dst(0).get_reg(), idx),
-                    std::make_shared<IR_Load>(
+                    make_ir<IR_Load>(
                         IR_Load::UNSIGNED, 1,
-                        std::make_shared<IR_StaticAddress>(instr.get_src(0).get_label())));
+                        make_ir<IR_StaticAddress>(instr.get_src(0).get_label())));
   } else if (instr.kind == InstructionKind::LBU && instr.get_dst(0).is_reg() &&
              instr.get_src(0).is_imm() && instr.get_src(0).get_imm() == 0) {
     return make_set(
         IR_Set::LOAD, make_reg(instr.get_dst(0).get_reg(), idx),
-        std::make_shared<IR_Load>(IR_Load::UNSIGNED, 1, make_reg(instr.get_src(1).get_reg(), idx)));
+        make_ir<IR_Load>(IR_Load::UNSIGNED, 1, make_reg(instr.get_src(1).get_reg(), idx)));
   } else if (instr.kind == InstructionKind::LBU && instr.get_dst(0).is_reg() &&
              instr.get_src(0).is_imm()) {
     return make_set(IR_Set::LOAD, make_reg(instr.get_dst(0).get_reg(), idx),
-                    std::make_shared<IR_Load>(
+                    make_ir<IR_Load>(
                         IR_Load::UNSIGNED, 1,
-                        std::make_shared<IR_IntMath2>(
+                        make_ir<IR_IntMath2>(
                             IR_IntMath2::ADD, make_reg(instr.get_src(1).get_reg(), idx),
-                            std::make_shared<IR_IntegerConstant>(instr.get_src(0).get_imm()))));
+                            make_ir<IR_IntegerConstant>(instr.get_src(0).get_imm()))));
   }
   return nullptr;
 }
 
-std::shared_ptr<IR> try_lwu(Instruction& instr, int idx) {
+IR* try_lwu(Instruction& instr, int idx) {
   if (instr.kind == InstructionKind::LWU && instr.get_dst(0).is_reg() &&
       instr.get_src(0).is_link_or_label() && instr.get_src(1).is_reg(make_gpr(Reg::FP))) {
     return make_set(IR_Set::LOAD, make_reg(instr.get_dst(0).get_reg(), idx),
-                    std::make_shared<IR_Load>(
+                    make_ir<IR_Load>(
                         IR_Load::UNSIGNED, 4,
-                        std::make_shared<IR_StaticAddress>(instr.get_src(0).get_label())));
+                        make_ir<IR_StaticAddress>(instr.get_src(0).get_label())));
   } else if (instr.kind == InstructionKind::LWU && instr.get_dst(0).is_reg() &&
              instr.get_src(0).is_imm() && instr.get_src(0).get_imm() == 0) {
     return make_set(
         IR_Set::LOAD, make_reg(instr.get_dst(0).get_reg(), idx),
-        std::make_shared<IR_Load>(IR_Load::UNSIGNED, 4, make_reg(instr.get_src(1).get_reg(), idx)));
+        make_ir<IR_Load>(IR_Load::UNSIGNED, 4, make_reg(instr.get_src(1).get_reg(), idx)));
   } else if (instr.kind == InstructionKind::LWU && instr.get_dst(0).is_reg() &&
              instr.get_src(0).is_imm()) {
     return make_set(IR_Set::LOAD, make_reg(instr.get_dst(0).get_reg(), idx),
-                    std::make_shared<IR_Load>(
+                    make_ir<IR_Load>(
                         IR_Load::UNSIGNED, 4,
-                        std::make_shared<IR_IntMath2>(
+                        make_ir<IR_IntMath2>(
                             IR_IntMath2::ADD, make_reg(instr.get_src(1).get_reg(), idx),
-                            std::make_shared<IR_IntegerConstant>(instr.get_src(0).get_imm()))));
+                            make_ir<IR_IntegerConstant>(instr.get_src(0).get_imm()))));
   }
   return nullptr;
 }
 
-std::shared_ptr<IR> try_ld(Instruction& instr, int idx) {
+IR* try_ld(Instruction& instr, int idx) {
   if (instr.kind == InstructionKind::LD && instr.get_dst(0).is_reg() &&
       instr.get_src(0).is_link_or_label() && instr.get_src(1).is_reg(make_gpr(Reg::FP))) {
     return make_set(IR_Set::LOAD, make_reg(instr.get_dst(0).get_reg(), idx),
-                    std::make_shared<IR_Load>(
+                    make_ir<IR_Load>(
                         IR_Load::UNSIGNED, 8,
-                        std::make_shared<IR_StaticAddress>(instr.get_src(0).get_label())));
+                        make_ir<IR_StaticAddress>(instr.get_src(0).get_label())));
   } else if (instr.kind == InstructionKind::LD && instr.get_dst(0).is_reg() &&
              instr.get_src(0).is_imm() && instr.get_src(0).get_imm() == 0) {
     return make_set(
         IR_Set::LOAD, make_reg(instr.get_dst(0).get_reg(), idx),
-        std::make_shared<IR_Load>(IR_Load::UNSIGNED, 8, make_reg(instr.get_src(1).get_reg(), idx)));
+        make_ir<IR_Load>(IR_Load::UNSIGNED, 8, make_reg(instr.get_src(1).get_reg(), idx)));
   } else if (instr.kind == InstructionKind::LD && instr.get_dst(0).is_reg() &&
              instr.get_src(0).is_imm()) {
     return make_set(IR_Set::LOAD, make_reg(instr.get_dst(0).get_reg(), idx),
-                    std::make_shared<IR_Load>(
+                    make_ir<IR_Load>(
                         IR_Load::UNSIGNED, 8,
-                        std::make_shared<IR_IntMath2>(
+                        make_ir<IR_IntMath2>(
                             IR_IntMath2::ADD, make_reg(instr.get_src(1).get_reg(), idx),
-                            std::make_shared<IR_IntegerConstant>(instr.get_src(0).get_imm()))));
+                            make_ir<IR_IntegerConstant>(instr.get_src(0).get_imm()))));
   }
   return nullptr;
 }
 
-std::shared_ptr<IR> try_dsll(Instruction& instr, int idx) {
+IR* try_dsll(Instruction& instr, int idx) {
   if (is_gpr_2_imm_int(instr, InstructionKind::DSLL, {}, {}, {})) {
     return make_set(IR_Set::REG_64, make_reg(instr.get_dst(0).get_reg(), idx),
-                    std::make_shared<IR_IntMath2>(IR_IntMath2::LEFT_SHIFT,
-                                                  make_reg(instr.get_src(0).get_reg(), idx),
-                                                  make_int(instr.get_src(1).get_imm())));
+                    make_ir<IR_IntMath2>(IR_IntMath2::LEFT_SHIFT,
+                                         make_reg(instr.get_src(0).get_reg(), idx),
+                                         make_int(instr.get_src(1).get_imm())));
   }
   return nullptr;
 }
 
-std::shared_ptr<IR> try_dsll32(Instruction& instr, int idx) {
+IR* try_dsll32(Instruction& instr, int idx) {
   if (is_gpr_2_imm_int(instr, InstructionKind::DSLL32, {}, {}, {})) {
     return make_set(IR_Set::REG_64, make_reg(instr.get_dst(0).get_reg(), idx),
-                    std::make_shared<IR_IntMath2>(IR_IntMath2::LEFT_SHIFT,
-                                                  make_reg(instr.get_src(0).get_reg(), idx),
-                                                  make_int(32 + instr.get_src(1).get_imm())));
+                    make_ir<IR_IntMath2>(IR_IntMath2::LEFT_SHIFT,
+                                         make_reg(instr.get_src(0).get_reg(), idx),
+                                         make_int(32 + instr.get_src(1).get_imm())));
   }
   return nullptr;
 }
 
-std::shared_ptr<IR> try_dsra(Instruction& instr, int idx) {
+IR* try_dsra(Instruction& instr, int idx) {
   if (is_gpr_2_imm_int(instr, InstructionKind::DSRA, {}, {}, {})) {
     return make_set(IR_Set::REG_64, make_reg(instr.get_dst(0).get_reg(), idx),
-                    std::make_shared<IR_IntMath2>(IR_IntMath2::RIGHT_SHIFT_ARITH,
-                                                  make_reg(instr.get_src(0).get_reg(), idx),
-                                                  make_int(instr.get_src(1).get_imm())));
+                    make_ir<IR_IntMath2>(IR_IntMath2::RIGHT_SHIFT_ARITH,
+                                         make_reg(instr.get_src(0).get_reg(), idx),
+                                         make_int(instr.get_src(1).get_imm())));
   }
   return nullptr;
 }
 
-std::shared_ptr<IR> try_dsra32(Instruction& instr, int idx) {
+IR* try_dsra32(Instruction& instr, int idx) {
   if (is_gpr_2_imm_int(instr, InstructionKind::DSRA32, {}, {}, {})) {
     return make_set(IR_Set::REG_64, make_reg(instr.get_dst(0).get_reg(), idx),
-                    std::make_shared<IR_IntMath2>(IR_IntMath2::RIGHT_SHIFT_ARITH,
-                                                  make_reg(instr.get_src(0).get_reg(), idx),
-                                                  make_int(32 + instr.get_src(1).get_imm())));
+                    make_ir<IR_IntMath2>(IR_IntMath2::RIGHT_SHIFT_ARITH,
+                                         make_reg(instr.get_src(0).get_reg(), idx),
+                                         make_int(32 + instr.get_src(1).get_imm())));
   }
   return nullptr;
 }
 
-std::shared_ptr<IR> try_dsrl(Instruction& instr, int idx) {
+IR* try_dsrl(Instruction& instr, int idx) {
   if (is_gpr_2_imm_int(instr, InstructionKind::DSRL, {}, {}, {})) {
     return make_set(IR_Set::REG_64, make_reg(instr.get_dst(0).get_reg(), idx),
-                    std::make_shared<IR_IntMath2>(IR_IntMath2::RIGHT_SHIFT_LOGIC,
-                                                  make_reg(instr.get_src(0).get_reg(), idx),
-                                                  make_int(instr.get_src(1).get_imm())));
+                    make_ir<IR_IntMath2>(IR_IntMath2::RIGHT_SHIFT_LOGIC,
+                                         make_reg(instr.get_src(0).get_reg(), idx),
+                                         make_int(instr.get_src(1).get_imm())));
   }
   return nullptr;
 }
 
-std::shared_ptr<IR> try_dsrl32(Instruction& instr, int idx) {
+IR* try_dsrl32(Instruction& instr, int idx) {
   if (is_gpr_2_imm_int(instr, InstructionKind::DSRL32, {}, {}, {})) {
     return make_set(IR_Set::REG_64, make_reg(instr.get_dst(0).get_reg(), idx),
-                    std::make_shared<IR_IntMath2>(IR_IntMath2::RIGHT_SHIFT_LOGIC,
-                                                  make_reg(instr.get_src(0).get_reg(), idx),
-                                                  make_int(32 + instr.get_src(1).get_imm())));
+                    make_ir<IR_IntMath2>(IR_IntMath2::RIGHT_SHIFT_LOGIC,
+                                         make_reg(instr.get_src(0).get_reg(), idx),
+                                         make_int(32 + instr.get_src(1).get_imm())));
   }
   return nullptr;
 }
 
-std::shared_ptr<IR> try_float_math_2(Instruction& instr,
-                                     int idx,
-                                     InstructionKind instr_kind,
-                                     IR_FloatMath2::Kind ir_kind) {
+IR* try_float_math_2(Instruction& instr,
+                     int idx,
+                     InstructionKind instr_kind,
+                     IR_FloatMath2::Kind ir_kind) {
   if (is_gpr_3(instr, instr_kind, {}, {}, {})) {
     return make_set(
         IR_Set::REG_FLT, make_reg(instr.get_dst(0).get_reg(), idx),
-        std::make_shared<IR_FloatMath2>(ir_kind, make_reg(instr.get_src(0).get_reg(), idx),
-                                        make_reg(instr.get_src(1).get_reg(), idx)));
+        make_ir<IR_FloatMath2>(ir_kind, make_reg(instr.get_src(0).get_reg(), idx),
+                               make_reg(instr.get_src(1).get_reg(), idx)));
   }
   return nullptr;
 }
 
-std::shared_ptr<IR> try_daddiu(Instruction& instr, int idx) {
+IR* try_daddiu(Instruction& instr, int idx) {
   if (instr.kind == InstructionKind::DADDIU && instr.get_src(0).is_reg(make_gpr(Reg::S7)) &&
       instr.get_src(1).kind == InstructionAtom::IMM_SYM) {
     return make_set(IR_Set::REG_64, make_reg(instr.get_dst(0).get_reg(), idx),
@@ -440,17 +440,17 @@ std::shared_ptr<IR> try_daddiu(Instruction& instr, int idx) {
   } else if (instr.kind == InstructionKind::DADDIU && instr.get_src(0).is_reg(make_gpr(Reg::FP)) &&
              instr.get_src(1).kind == InstructionAtom::LABEL) {
     return make_set(IR_Set::REG_64, make_reg(instr.get_dst(0).get_reg(), idx),
-                    std::make_shared<IR_StaticAddress>(instr.get_src(1).get_label()));
+                    make_ir<IR_StaticAddress>(instr.get_src(1).get_label()));
   } else if (instr.kind == InstructionKind::DADDIU) {
     return make_set(
         IR_Set::REG_64, make_reg(instr.get_dst(0).get_reg(), idx),
-        std::make_shared<IR_IntMath2>(IR_IntMath2::ADD, make_reg(instr.get_src(0).get_reg(), idx),
-                                      make_int(instr.get_src(1).get_imm())));
+        make_ir<IR_IntMath2>(IR_IntMath2::ADD, make_reg(instr.get_src(0).get_reg(), idx),
+                             make_int(instr.get_src(1).get_imm())));
   }
   return nullptr;
 }
 
-std::shared_ptr<IR> try_lw(Instruction& instr, int idx) {
+IR* try_lw(Instruction& instr, int idx) {
   if (instr.kind == InstructionKind::LW && instr.get_src(1).is_reg(make_gpr(Reg::S7)) &&
       instr.get_src(0).kind == InstructionAtom::IMM_SYM) {
     return make_set(IR_Set::SYM_LOAD, make_reg(instr.get_dst(0).get_reg(), idx),
@@ -459,162 +459,162 @@ std::shared_ptr<IR> try_lw(Instruction& instr, int idx) {
              instr.get_src(0).is_link_or_label() && instr.get_src(1).is_reg(make_gpr(Reg::FP))) {
     return make_set(
         IR_Set::LOAD, make_reg(instr.get_dst(0).get_reg(), idx),
-        std::make_shared<IR_Load>(
-            IR_Load::SIGNED, 4, std::make_shared<IR_StaticAddress>(instr.get_src(0).get_label())));
+        make_ir<IR_Load>(
+            IR_Load::SIGNED, 4, make_ir<IR_StaticAddress>(instr.get_src(0).get_label())));
   } else if (instr.kind == InstructionKind::LW && instr.get_dst(0).is_reg() &&
              instr.get_src(0).is_imm() && instr.get_src(0).get_imm() == 0) {
     return make_set(
         IR_Set::LOAD, make_reg(instr.get_dst(0).get_reg(), idx),
-        std::make_shared<IR_Load>(IR_Load::SIGNED, 4, make_reg(instr.get_src(1).get_reg(), idx)));
+        make_ir<IR_Load>(IR_Load::SIGNED, 4, make_reg(instr.get_src(1).get_reg(), idx)));
   } else if (instr.kind == InstructionKind::LW && instr.get_dst(0).is_reg() &&
              instr.get_src(0).is_imm()) {
     return make_set(IR_Set::LOAD, make_reg(instr.get_dst(0).get_reg(), idx),
-                    std::make_shared<IR_Load>(
+                    make_ir<IR_Load>(
                         IR_Load::SIGNED, 4,
-                        std::make_shared<IR_IntMath2>(
+                        make_ir<IR_IntMath2>(
                             IR_IntMath2::ADD, make_reg(instr.get_src(1).get_reg(), idx),
-                            std::make_shared<IR_IntegerConstant>(instr.get_src(0).get_imm()))));
+                            make_ir<IR_IntegerConstant>(instr.get_src(0).get_imm()))));
   }
   return nullptr;
 }
 
-std::shared_ptr<IR> try_lq(Instruction& instr, int idx) {
+IR* try_lq(Instruction& instr, int idx) {
   if (instr.kind == InstructionKind::LQ && instr.get_src(1).is_reg(make_gpr(Reg::S7)) &&
       instr.get_src(0).kind == InstructionAtom::IMM_SYM) {
     assert(false);
   } else if (instr.kind == InstructionKind::LQ && instr.get_dst(0).is_reg() &&
              instr.get_src(0).is_link_or_label() && instr.get_src(1).is_reg(make_gpr(Reg::FP))) {
     return make_set(IR_Set::LOAD, make_reg(instr.get_dst(0).get_reg(), idx),
-                    std::make_shared<IR_Load>(
+                    make_ir<IR_Load>(
                         IR_Load::UNSIGNED, 16,
-                        std::make_shared<IR_StaticAddress>(instr.get_src(0).get_label())));
+                        make_ir<IR_StaticAddress>(instr.get_src(0).get_label())));
   } else if (instr.kind == InstructionKind::LQ && instr.get_dst(0).is_reg() &&
              instr.get_src(0).is_imm() && instr.get_src(0).get_imm() == 0) {
     return make_set(IR_Set::LOAD, make_reg(instr.get_dst(0).get_reg(), idx),
-                    std::make_shared<IR_Load>(IR_Load::UNSIGNED, 16,
-                                              make_reg(instr.get_src(1).get_reg(), idx)));
+                    make_ir<IR_Load>(IR_Load::UNSIGNED, 16,
+                                     make_reg(instr.get_src(1).get_reg(), idx)));
   } else if (instr.kind == InstructionKind::LQ && instr.get_dst(0).is_reg() &&
              instr.get_src(0).is_imm()) {
     return make_set(IR_Set::LOAD, make_reg(instr.get_dst(0).get_reg(), idx),
-                    std::make_shared<IR_Load>(
+                    make_ir<IR_Load>(
                         IR_Load::UNSIGNED, 16,
-                        std::make_shared<IR_IntMath2>(
+                        make_ir<IR_IntMath2>(
                             IR_IntMath2::ADD, make_reg(instr.get_src(1).get_reg(), idx),
-                            std::make_shared<IR_IntegerConstant>(instr.get_src(0).get_imm()))));
+                            make_ir<IR_IntegerConstant>(instr.get_src(0).get_imm()))));
   }
   return nullptr;
 }
 
-std::shared_ptr<IR> try_daddu(Instruction& instr, int idx) {
+IR* try_daddu(Instruction& instr, int idx) {
   if (is_gpr_3(instr, InstructionKind::DADDU, {}, {}, {}) &&
       !instr.get_src(0).is_reg(make_gpr(Reg::S7)) && !instr.get_src(1).is_reg(make_gpr(Reg::S7))) {
     return make_set(
         IR_Set::REG_64, make_reg(instr.get_dst(0).get_reg(), idx),
-        std::make_shared<IR_IntMath2>(IR_IntMath2::ADD, make_reg(instr.get_src(0).get_reg(), idx),
-                                      make_reg(instr.get_src(1).get_reg(), idx)));
+        make_ir<IR_IntMath2>(IR_IntMath2::ADD, make_reg(instr.get_src(0).get_reg(), idx),
+                             make_reg(instr.get_src(1).get_reg(), idx)));
   }
   return to_asm_reg_reg_reg("daddu", instr, idx);
 }
 
-std::shared_ptr<IR> try_dsubu(Instruction& instr, int idx) {
+IR* try_dsubu(Instruction& instr, int idx) {
   if (is_gpr_3(instr, InstructionKind::DSUBU, {}, make_gpr(Reg::R0), {}) &&
       !instr.get_src(0).is_reg(make_gpr(Reg::S7)) && !instr.get_src(1).is_reg(make_gpr(Reg::S7))) {
     return make_set(
         IR_Set::REG_64, make_reg(instr.get_dst(0).get_reg(), idx),
-        std::make_shared<IR_IntMath1>(IR_IntMath1::NEG, make_reg(instr.get_src(1).get_reg(), idx)));
+        make_ir<IR_IntMath1>(IR_IntMath1::NEG, make_reg(instr.get_src(1).get_reg(), idx)));
   } else if (is_gpr_3(instr, InstructionKind::DSUBU, {}, {}, {}) &&
              !instr.get_src(0).is_reg(make_gpr(Reg::S7)) &&
              !instr.get_src(1).is_reg(make_gpr(Reg::S7))) {
     return make_set(
         IR_Set::REG_64, make_reg(instr.get_dst(0).get_reg(), idx),
-        std::make_shared<IR_IntMath2>(IR_IntMath2::SUB, make_reg(instr.get_src(0).get_reg(), idx),
-                                      make_reg(instr.get_src(1).get_reg(), idx)));
+        make_ir<IR_IntMath2>(IR_IntMath2::SUB, make_reg(instr.get_src(0).get_reg(), idx),
+                             make_reg(instr.get_src(1).get_reg(), idx)));
   }
   return nullptr;
 }
 
-std::shared_ptr<IR> try_mult3(Instruction& instr, int idx) {
+IR* try_mult3(Instruction& instr, int idx) {
   if (is_gpr_3(instr, InstructionKind::MULT3, {}, {}, {}) &&
       !instr.get_src(0).is_reg(make_gpr(Reg::S7)) && !instr.get_src(1).is_reg(make_gpr(Reg::S7))) {
     return make_set(IR_Set::REG_64, make_reg(instr.get_dst(0).get_reg(), idx),
-                    std::make_shared<IR_IntMath2>(IR_IntMath2::MUL_SIGNED,
-                                                  make_reg(instr.get_src(0).get_reg(), idx),
-                                                  make_reg(instr.get_src(1).get_reg(), idx)));
+                    make_ir<IR_IntMath2>(IR_IntMath2::MUL_SIGNED,
+                                         make_reg(instr.get_src(0).get_reg(), idx),
+                                         make_reg(instr.get_src(1).get_reg(), idx)));
   }
   return nullptr;
 }
 
-std::shared_ptr<IR> try_multu3(Instruction& instr, int idx) {
+IR* try_multu3(Instruction& instr, int idx) {
   if (is_gpr_3(instr, InstructionKind::MULTU3, {}, {}, {}) &&
       !instr.get_src(0).is_reg(make_gpr(Reg::S7)) && !instr.get_src(1).is_reg(make_gpr(Reg::S7))) {
     return make_set(IR_Set::REG_64, make_reg(instr.get_dst(0).get_reg(), idx),
-                    std::make_shared<IR_IntMath2>(IR_IntMath2::MUL_UNSIGNED,
-                                                  make_reg(instr.get_src(0).get_reg(), idx),
-                                                  make_reg(instr.get_src(1).get_reg(), idx)));
+                    make_ir<IR_IntMath2>(IR_IntMath2::MUL_UNSIGNED,
+                                         make_reg(instr.get_src(0).get_reg(), idx),
+                                         make_reg(instr.get_src(1).get_reg(), idx)));
   }
   return nullptr;
 }
 
-std::shared_ptr<IR> try_and(Instruction& instr, int idx) {
+IR* try_and(Instruction& instr, int idx) {
   if (is_gpr_3(instr, InstructionKind::AND, {}, {}, {}) &&
       !instr.get_src(0).is_reg(make_gpr(Reg::S7)) && !instr.get_src(1).is_reg(make_gpr(Reg::S7))) {
     return make_set(
         IR_Set::REG_64, make_reg(instr.get_dst(0).get_reg(), idx),
-        std::make_shared<IR_IntMath2>(IR_IntMath2::AND, make_reg(instr.get_src(0).get_reg(), idx),
-                                      make_reg(instr.get_src(1).get_reg(), idx)));
+        make_ir<IR_IntMath2>(IR_IntMath2::AND, make_reg(instr.get_src(0).get_reg(), idx),
+                             make_reg(instr.get_src(1).get_reg(), idx)));
   }
   return nullptr;
 }
 
-std::shared_ptr<IR> try_andi(Instruction& instr, int idx) {
+IR* try_andi(Instruction& instr, int idx) {
   if (instr.kind == InstructionKind::ANDI) {
     return make_set(
         IR_Set::REG_64, make_reg(instr.get_dst(0).get_reg(), idx),
-        std::make_shared<IR_IntMath2>(IR_IntMath2::AND, make_reg(instr.get_src(0).get_reg(), idx),
-                                      make_int(instr.get_src(1).get_imm())));
+        make_ir<IR_IntMath2>(IR_IntMath2::AND, make_reg(instr.get_src(0).get_reg(), idx),
+                             make_int(instr.get_src(1).get_imm())));
   }
   return nullptr;
 }
 
-std::shared_ptr<IR> try_xori(Instruction& instr, int idx) {
+IR* try_xori(Instruction& instr, int idx) {
   if (instr.kind == InstructionKind::XORI) {
     return make_set(
         IR_Set::REG_64, make_reg(instr.get_dst(0).get_reg(), idx),
-        std::make_shared<IR_IntMath2>(IR_IntMath2::XOR, make_reg(instr.get_src(0).get_reg(), idx),
-                                      make_int(instr.get_src(1).get_imm())));
+        make_ir<IR_IntMath2>(IR_IntMath2::XOR, make_reg(instr.get_src(0).get_reg(), idx),
+                             make_int(instr.get_src(1).get_imm())));
   }
   return nullptr;
 }
 
-std::shared_ptr<IR> try_nor(Instruction& instr, int idx) {
+IR* try_nor(Instruction& instr, int idx) {
   if (is_gpr_3(instr, InstructionKind::NOR, {}, {}, {}) &&
       !instr.get_src(0).is_reg(make_gpr(Reg::S7)) && instr.get_src(1).is_reg(make_gpr(Reg::R0))) {
     return make_set(
         IR_Set::REG_64, make_reg(instr.get_dst(0).get_reg(), idx),
-        std::make_shared<IR_IntMath1>(IR_IntMath1::NOT, make_reg(instr.get_src(0).get_reg(), idx)));
+        make_ir<IR_IntMath1>(IR_IntMath1::NOT, make_reg(instr.get_src(0).get_reg(), idx)));
   } else if (is_gpr_3(instr, InstructionKind::NOR, {}, {}, {}) &&
              !instr.get_src(0).is_reg(make_gpr(Reg::S7)) &&
              !instr.get_src(1).is_reg(make_gpr(Reg::S7))) {
     return make_set(
         IR_Set::REG_64, make_reg(instr.get_dst(0).get_reg(), idx),
-        std::make_shared<IR_IntMath2>(IR_IntMath2::NOR, make_reg(instr.get_src(0).get_reg(), idx),
-                                      make_reg(instr.get_src(1).get_reg(), idx)));
+        make_ir<IR_IntMath2>(IR_IntMath2::NOR, make_reg(instr.get_src(0).get_reg(), idx),
+                             make_reg(instr.get_src(1).get_reg(), idx)));
   }
   return nullptr;
 }
 
-std::shared_ptr<IR> try_xor(Instruction& instr, int idx) {
+IR* try_xor(Instruction& instr, int idx) {
   if (is_gpr_3(instr, InstructionKind::XOR, {}, {}, {}) &&
       !instr.get_src(0).is_reg(make_gpr(Reg::S7)) && !instr.get_src(1).is_reg(make_gpr(Reg::S7))) {
     return make_set(
         IR_Set::REG_64, make_reg(instr.get_dst(0).get_reg(), idx),
-        std::make_shared<IR_IntMath2>(IR_IntMath2::XOR, make_reg(instr.get_src(0).get_reg(), idx),
-                                      make_reg(instr.get_src(1).get_reg(), idx)));
+        make_ir<IR_IntMath2>(IR_IntMath2::XOR, make_reg(instr.get_src(0).get_reg(), idx),
+                             make_reg(instr.get_src(1).get_reg(), idx)));
   }
   return nullptr;
 }
 
-std::shared_ptr<IR> try_addiu(Instruction& instr, int idx) {
+IR* try_addiu(Instruction& instr, int idx) {
   if (instr.kind == InstructionKind::ADDIU && instr.get_src(0).is_reg(make_gpr(Reg::R0))) {
     return make_set(IR_Set::REG_64, make_reg(instr.get_dst(0).get_reg(), idx),
                     make_int(instr.get_src(1).get_imm()));
@@ -622,7 +622,7 @@ std::shared_ptr<IR> try_addiu(Instruction& instr, int idx) {
   return nullptr;
 }
 
-std::shared_ptr<IR> try_lui(Instruction& instr, int idx) {
+IR* try_lui(Instruction& instr, int idx) {
   if (instr.kind == InstructionKind::LUI && instr.get_src(0).is_imm()) {
     return make_set(IR_Set::REG_64, make_reg(instr.get_dst(0).get_reg(), idx),
                     make_int(instr.get_src(0).get_imm() << 16));
@@ -630,154 +630,154 @@ std::shared_ptr<IR> try_lui(Instruction& instr, int idx) {
   return nullptr;
 }
 
-std::shared_ptr<IR> try_sll(Instruction& instr, int idx) {
+IR* try_sll(Instruction& instr, int idx) {
   (void)idx;
   if (is_nop(instr)) {
-    return std::make_shared<IR_Nop>();
+    return make_ir<IR_Nop>();
   }
   return nullptr;
 }
 
-std::shared_ptr<IR> try_dsrav(Instruction& instr, int idx) {
+IR* try_dsrav(Instruction& instr, int idx) {
   if (is_gpr_3(instr, InstructionKind::DSRAV, {}, {}, {}) &&
       !instr.get_src(0).is_reg(make_gpr(Reg::S7)) && !instr.get_src(1).is_reg(make_gpr(Reg::S7))) {
     return make_set(IR_Set::REG_64, make_reg(instr.get_dst(0).get_reg(), idx),
-                    std::make_shared<IR_IntMath2>(IR_IntMath2::RIGHT_SHIFT_ARITH,
-                                                  make_reg(instr.get_src(0).get_reg(), idx),
-                                                  make_reg(instr.get_src(1).get_reg(), idx)));
+                    make_ir<IR_IntMath2>(IR_IntMath2::RIGHT_SHIFT_ARITH,
+                                         make_reg(instr.get_src(0).get_reg(), idx),
+                                         make_reg(instr.get_src(1).get_reg(), idx)));
   }
   return nullptr;
 }
 
-std::shared_ptr<IR> try_dsrlv(Instruction& instr, int idx) {
+IR* try_dsrlv(Instruction& instr, int idx) {
   if (is_gpr_3(instr, InstructionKind::DSRLV, {}, {}, {}) &&
       !instr.get_src(0).is_reg(make_gpr(Reg::S7)) && !instr.get_src(1).is_reg(make_gpr(Reg::S7))) {
     return make_set(IR_Set::REG_64, make_reg(instr.get_dst(0).get_reg(), idx),
-                    std::make_shared<IR_IntMath2>(IR_IntMath2::RIGHT_SHIFT_LOGIC,
-                                                  make_reg(instr.get_src(0).get_reg(), idx),
-                                                  make_reg(instr.get_src(1).get_reg(), idx)));
+                    make_ir<IR_IntMath2>(IR_IntMath2::RIGHT_SHIFT_LOGIC,
+                                         make_reg(instr.get_src(0).get_reg(), idx),
+                                         make_reg(instr.get_src(1).get_reg(), idx)));
   }
   return nullptr;
 }
 
-std::shared_ptr<IR> try_dsllv(Instruction& instr, int idx) {
+IR* try_dsllv(Instruction& instr, int idx) {
   if (is_gpr_3(instr, InstructionKind::DSLLV, {}, {}, {}) &&
       !instr.get_src(0).is_reg(make_gpr(Reg::S7)) && !instr.get_src(1).is_reg(make_gpr(Reg::S7))) {
     return make_set(IR_Set::REG_64, make_reg(instr.get_dst(0).get_reg(), idx),
-                    std::make_shared<IR_IntMath2>(IR_IntMath2::LEFT_SHIFT,
-                                                  make_reg(instr.get_src(0).get_reg(), idx),
-                                                  make_reg(instr.get_src(1).get_reg(), idx)));
+                    make_ir<IR_IntMath2>(IR_IntMath2::LEFT_SHIFT,
+                                         make_reg(instr.get_src(0).get_reg(), idx),
+                                         make_reg(instr.get_src(1).get_reg(), idx)));
   }
   return nullptr;
 }
 
-std::shared_ptr<IR> try_sw(Instruction& instr, int idx) {
+IR* try_sw(Instruction& instr, int idx) {
   if (instr.kind == InstructionKind::SW && instr.get_src(1).is_sym() &&
       instr.get_src(2).is_reg(make_gpr(Reg::S7))) {
-    return std::make_shared<IR_Set>(IR_Set::SYM_STORE, make_sym_value(instr.get_src(1).get_sym()),
-                                    make_reg(instr.get_src(0).get_reg(), idx));
+    return make_ir<IR_Set>(IR_Set::SYM_STORE, make_sym_value(instr.get_src(1).get_sym()),
+                           make_reg(instr.get_src(0).get_reg(), idx));
   } else if (instr.kind == InstructionKind::SW && instr.get_src(1).is_imm()) {
-    return std::make_shared<IR_Store>(
+    return make_ir<IR_Store>(
         IR_Store::INTEGER,
-        std::make_shared<IR_IntMath2>(
+        make_ir<IR_IntMath2>(
             IR_IntMath2::ADD, make_reg(instr.get_src(2).get_reg(), idx),
-            std::make_shared<IR_IntegerConstant>(instr.get_src(1).get_imm())),
+            make_ir<IR_IntegerConstant>(instr.get_src(1).get_imm())),
         make_reg(instr.get_src(0).get_reg(), idx), 4);
   }
   return nullptr;
 }
 
-std::shared_ptr<IR> try_sb(Instruction& instr, int idx) {
+IR* try_sb(Instruction& instr, int idx) {
   if (instr.kind == InstructionKind::SB && instr.get_src(1).is_imm()) {
-    return std::make_shared<IR_Store>(
+    return make_ir<IR_Store>(
         IR_Store::INTEGER,
-        std::make_shared<IR_IntMath2>(
+        make_ir<IR_IntMath2>(
             IR_IntMath2::ADD, make_reg(instr.get_src(2).get_reg(), idx),
-            std::make_shared<IR_IntegerConstant>(instr.get_src(1).get_imm())),
+            make_ir<IR_IntegerConstant>(instr.get_src(1).get_imm())),
         make_reg(instr.get_src(0).get_reg(), idx), 1);
   }
   return nullptr;
 }
 
-std::shared_ptr<IR> try_sh(Instruction& instr, int idx) {
+IR* try_sh(Instruction& instr, int idx) {
   if (instr.kind == InstructionKind::SH && instr.get_src(1).is_imm()) {
-    return std::make_shared<IR_Store>(
+    return make_ir<IR_Store>(
         IR_Store::INTEGER,
-        std::make_shared<IR_IntMath2>(
+        make_ir<IR_IntMath2>(
             IR_IntMath2::ADD, make_reg(instr.get_src(2).get_reg(), idx),
-            std::make_shared<IR_IntegerConstant>(instr.get_src(1).get_imm())),
+            make_ir<IR_IntegerConstant>(instr.get_src(1).get_imm())),
         make_reg(instr.get_src(0).get_reg(), idx), 2);
   }
   return nullptr;
 }
 
-std::shared_ptr<IR> try_sd(Instruction& instr, int idx) {
+IR* try_sd(Instruction& instr, int idx) {
   if (instr.kind == InstructionKind::SD && instr.get_src(1).is_imm()) {
-    return std::make_shared<IR_Store>(
+    return make_ir<IR_Store>(
         IR_Store::INTEGER,
-        std::make_shared<IR_IntMath2>(
+        make_ir<IR_IntMath2>(
             IR_IntMath2::ADD, make_reg(instr.get_src(2).get_reg(), idx),
-            std::make_shared<IR_IntegerConstant>(instr.get_src(1).get_imm())),
+            make_ir<IR_IntegerConstant>(instr.get_src(1).get_imm())),
         make_reg(instr.get_src(0).get_reg(), idx), 8);
   }
   return nullptr;
 }
 
-std::shared_ptr<IR> try_sq(Instruction& instr, int idx) {
+IR* try_sq(Instruction& instr, int idx) {
   if (instr.kind == InstructionKind::SQ && instr.get_src(1).is_imm()) {
-    return std::make_shared<IR_Store>(
+    return make_ir<IR_Store>(
         IR_Store::INTEGER,
-        std::make_shared<IR_IntMath2>(
+        make_ir<IR_IntMath2>(
             IR_IntMath2::ADD, make_reg(instr.get_src(2).get_reg(), idx),
-            std::make_shared<IR_IntegerConstant>(instr.get_src(1).get_imm())),
+            make_ir<IR_IntegerConstant>(instr.get_src(1).get_imm())),
         make_reg(instr.get_src(0).get_reg(), idx), 16);
   }
   return nullptr;
 }
 
-std::shared_ptr<IR> try_swc1(Instruction& instr, int idx) {
+IR* try_swc1(Instruction& instr, int idx) {
   if (instr.kind == InstructionKind::SWC1 && instr.get_src(1).is_imm()) {
-    return std::make_shared<IR_Store>(
+    return make_ir<IR_Store>(
         IR_Store::FLOAT,
-        std::make_shared<IR_IntMath2>(
+        make_ir<IR_IntMath2>(
             IR_IntMath2::ADD, make_reg(instr.get_src(2).get_reg(), idx),
-            std::make_shared<IR_IntegerConstant>(instr.get_src(1).get_imm())),
+            make_ir<IR_IntegerConstant>(instr.get_src(1).get_imm())),
         make_reg(instr.get_src(0).get_reg(), idx), 4);
   }
   return nullptr;
 }
 
-std::shared_ptr<IR> try_cvtws(Instruction& instr, int idx) {
+IR* try_cvtws(Instruction& instr, int idx) {
   if (instr.kind == InstructionKind::CVTWS) {
     return make_set(IR_Set::REG_FLT, make_reg(instr.get_dst(0).get_reg(), idx),
-                    std::make_shared<IR_FloatMath1>(IR_FloatMath1::FLOAT_TO_INT,
-                                                    make_reg(instr.get_src(0).get_reg(), idx)));
+                    make_ir<IR_FloatMath1>(IR_FloatMath1::FLOAT_TO_INT,
+                                           make_reg(instr.get_src(0).get_reg(), idx)));
   }
   return nullptr;
 }
 
-std::shared_ptr<IR> try_cvtsw(Instruction& instr, int idx) {
+IR* try_cvtsw(Instruction& instr, int idx) {
   if (instr.kind == InstructionKind::CVTSW) {
     return make_set(IR_Set::REG_FLT, make_reg(instr.get_dst(0).get_reg(), idx),
-                    std::make_shared<IR_FloatMath1>(IR_FloatMath1::INT_TO_FLOAT,
-                                                    make_reg(instr.get_src(0).get_reg(), idx)));
+                    make_ir<IR_FloatMath1>(IR_FloatMath1::INT_TO_FLOAT,
+                                           make_reg(instr.get_src(0).get_reg(), idx)));
   }
   return nullptr;
 }
 
-std::shared_ptr<IR> try_float_math_1(Instruction& instr,
-                                     int idx,
-                                     InstructionKind ikind,
-                                     IR_FloatMath1::Kind irkind) {
+IR* try_float_math_1(Instruction& instr,
+                     int idx,
+                     InstructionKind ikind,
+                     IR_FloatMath1::Kind irkind) {
   if (instr.kind == ikind) {
     return make_set(
         IR_Set::REG_FLT, make_reg(instr.get_dst(0).get_reg(), idx),
-        std::make_shared<IR_FloatMath1>(irkind, make_reg(instr.get_src(0).get_reg(), idx)));
+        make_ir<IR_FloatMath1>(irkind, make_reg(instr.get_src(0).get_reg(), idx)));
   }
   return nullptr;
 }
 
-std::shared_ptr<IR> try_movs(Instruction& instr, int idx) {
+IR* try_movs(Instruction& instr, int idx) {
   if (instr.kind == InstructionKind::MOVS) {
     return make_set(IR_Set::REG_FLT, make_reg(instr.get_dst(0).get_reg(), idx),
                     make_reg(instr.get_src(0).get_reg(), idx));
@@ -785,67 +785,67 @@ std::shared_ptr<IR> try_movs(Instruction& instr, int idx) {
   return nullptr;
 }
 
-std::shared_ptr<IR> try_movn(Instruction& instr, int idx) {
+IR* try_movn(Instruction& instr, int idx) {
   if (is_gpr_3(instr, InstructionKind::MOVN, {}, make_gpr(Reg::S7), {})) {
     return make_set(IR_Set::REG_64, make_reg(instr.get_dst(0).get_reg(), idx),
-                    std::make_shared<IR_CMoveF>(make_reg(instr.get_src(1).get_reg(), idx), false));
+                    make_ir<IR_CMoveF>(make_reg(instr.get_src(1).get_reg(), idx), false));
   }
   return nullptr;
 }
 
-std::shared_ptr<IR> try_movz(Instruction& instr, int idx) {
+IR* try_movz(Instruction& instr, int idx) {
   if (is_gpr_3(instr, InstructionKind::MOVZ, {}, make_gpr(Reg::S7), {})) {
     return make_set(IR_Set::REG_64, make_reg(instr.get_dst(0).get_reg(), idx),
-                    std::make_shared<IR_CMoveF>(make_reg(instr.get_src(1).get_reg(), idx), true));
+                    make_ir<IR_CMoveF>(make_reg(instr.get_src(1).get_reg(), idx), true));
   }
   return nullptr;
 }
 
 // TWO Instructions
-std::shared_ptr<IR> try_div(Instruction& instr, Instruction& next_instr, int idx) {
+IR* try_div(Instruction& instr, Instruction& next_instr, int idx) {
   if (instr.kind == InstructionKind::DIV && instr.get_src(0).is_reg() &&
       instr.get_src(1).is_reg() && next_instr.kind == InstructionKind::MFLO &&
       next_instr.get_dst(0).is_reg()) {
     return make_set(IR_Set::REG_64, make_reg(next_instr.get_dst(0).get_reg(), idx),
-                    std::make_shared<IR_IntMath2>(IR_IntMath2::DIV_SIGNED,
-                                                  make_reg(instr.get_src(0).get_reg(), idx),
-                                                  make_reg(instr.get_src(1).get_reg(), idx)));
+                    make_ir<IR_IntMath2>(IR_IntMath2::DIV_SIGNED,
+                                         make_reg(instr.get_src(0).get_reg(), idx),
+                                         make_reg(instr.get_src(1).get_reg(), idx)));
   } else if (instr.kind == InstructionKind::DIV && instr.get_src(0).is_reg() &&
              instr.get_src(1).is_reg() && next_instr.kind == InstructionKind::MFHI &&
              next_instr.get_dst(0).is_reg()) {
     return make_set(IR_Set::REG_64, make_reg(next_instr.get_dst(0).get_reg(), idx),
-                    std::make_shared<IR_IntMath2>(IR_IntMath2::MOD_SIGNED,
-                                                  make_reg(instr.get_src(0).get_reg(), idx),
-                                                  make_reg(instr.get_src(1).get_reg(), idx)));
+                    make_ir<IR_IntMath2>(IR_IntMath2::MOD_SIGNED,
+                                         make_reg(instr.get_src(0).get_reg(), idx),
+                                         make_reg(instr.get_src(1).get_reg(), idx)));
   }
   return nullptr;
 }
 
-std::shared_ptr<IR> try_divu(Instruction& instr, Instruction& next_instr, int idx) {
+IR* try_divu(Instruction& instr, Instruction& next_instr, int idx) {
   if (instr.kind == InstructionKind::DIVU && instr.get_src(0).is_reg() &&
       instr.get_src(1).is_reg() && next_instr.kind == InstructionKind::MFLO &&
       next_instr.get_dst(0).is_reg()) {
     return make_set(IR_Set::REG_64, make_reg(next_instr.get_dst(0).get_reg(), idx),
-                    std::make_shared<IR_IntMath2>(IR_IntMath2::DIV_UNSIGNED,
-                                                  make_reg(instr.get_src(0).get_reg(), idx),
-                                                  make_reg(instr.get_src(1).get_reg(), idx)));
+                    make_ir<IR_IntMath2>(IR_IntMath2::DIV_UNSIGNED,
+                                         make_reg(instr.get_src(0).get_reg(), idx),
+                                         make_reg(instr.get_src(1).get_reg(), idx)));
   } else if (instr.kind == InstructionKind::DIVU && instr.get_src(0).is_reg() &&
              instr.get_src(1).is_reg() && next_instr.kind == InstructionKind::MFHI &&
              next_instr.get_dst(0).is_reg()) {
     return make_set(IR_Set::REG_64, make_reg(next_instr.get_dst(0).get_reg(), idx),
-                    std::make_shared<IR_IntMath2>(IR_IntMath2::MOD_UNSIGNED,
-                                                  make_reg(instr.get_src(0).get_reg(), idx),
-                                                  make_reg(instr.get_src(1).get_reg(), idx)));
+                    make_ir<IR_IntMath2>(IR_IntMath2::MOD_UNSIGNED,
+                                         make_reg(instr.get_src(0).get_reg(), idx),
+                                         make_reg(instr.get_src(1).get_reg(), idx)));
   }
   return nullptr;
 }
 
-std::shared_ptr<IR> try_jalr(Instruction& instr, Instruction& next_instr, int idx) {
+IR* try_jalr(Instruction& instr, Instruction& next_instr, int idx) {
   (void)idx;
   if (instr.kind == InstructionKind::JALR && instr.get_dst(0).is_reg(make_gpr(Reg::RA)) &&
       instr.get_src(0).is_reg(make_gpr(Reg::T9)) &&
       is_gpr_2_imm_int(next_instr, InstructionKind::SLL, make_gpr(Reg::V0), make_gpr(Reg::RA), 0)) {
-    return std::make_shared<IR_Call>();
+    return make_ir<IR_Call>();
   }
   return nullptr;
 }
@@ -894,17 +894,17 @@ BranchDelay get_branch_delay(Instruction& i, int idx) {
   return b;
 }
 
-std::shared_ptr<IR> try_bne(Instruction& instr, Instruction& next_instr, int idx) {
+IR* try_bne(Instruction& instr, Instruction& next_instr, int idx) {
   if (instr.kind == InstructionKind::BNE && instr.get_src(1).is_reg(make_gpr(Reg::R0))) {
-    return std::make_shared<IR_Branch>(
+    return make_ir<IR_Branch>(
         Condition(Condition::NONZERO, make_reg(instr.get_src(0).get_reg(), idx), nullptr, nullptr),
         instr.get_src(2).get_label(), get_branch_delay(next_instr, idx), false);
   } else if (instr.kind == InstructionKind::BNE && instr.get_src(0).is_reg(make_gpr(Reg::S7))) {
-    return std::make_shared<IR_Branch>(
+    return make_ir<IR_Branch>(
         Condition(Condition::TRUTHY, make_reg(instr.get_src(1).get_reg(), idx), nullptr, nullptr),
         instr.get_src(2).get_label(), get_branch_delay(next_instr, idx), false);
   } else if (instr.kind == InstructionKind::BNE) {
-    return std::make_shared<IR_Branch>(
+    return make_ir<IR_Branch>(
         Condition(Condition::NOT_EQUAL, make_reg(instr.get_src(0).get_reg(), idx),
                   make_reg(instr.get_src(1).get_reg(), idx), nullptr),
         instr.get_src(2).get_label(), get_branch_delay(next_instr, idx), false);
@@ -912,17 +912,17 @@ std::shared_ptr<IR> try_bne(Instruction& instr, Instruction& next_instr, int idx
   return nullptr;
 }
 
-std::shared_ptr<IR> try_bnel(Instruction& instr, Instruction& next_instr, int idx) {
+IR* try_bnel(Instruction& instr, Instruction& next_instr, int idx) {
   if (instr.kind == InstructionKind::BNEL && instr.get_src(0).is_reg(make_gpr(Reg::S7))) {
-    return std::make_shared<IR_Branch>(
+    return make_ir<IR_Branch>(
         Condition(Condition::TRUTHY, make_reg(instr.get_src(1).get_reg(), idx), nullptr, nullptr),
         instr.get_src(2).get_label(), get_branch_delay(next_instr, idx), true);
   } else if (instr.kind == InstructionKind::BNEL && instr.get_src(1).is_reg(make_gpr(Reg::R0))) {
-    return std::make_shared<IR_Branch>(
+    return make_ir<IR_Branch>(
         Condition(Condition::NONZERO, make_reg(instr.get_src(0).get_reg(), idx), nullptr, nullptr),
         instr.get_src(2).get_label(), get_branch_delay(next_instr, idx), true);
   } else if (instr.kind == InstructionKind::BNEL) {
-    //    return std::make_shared<IR_Branch2>(IR_Branch2::NOT_EQUAL, instr.get_src(2).get_label(),
+    //    return make_ir<IR_Branch2>(IR_Branch2::NOT_EQUAL, instr.get_src(2).get_label(),
     //                                        make_reg(instr.get_src(0).get_reg(), idx),
     //                                        make_reg(instr.get_src(1).get_reg(), idx),
     //                                        get_branch_delay(next_instr, idx), true);
@@ -930,19 +930,19 @@ std::shared_ptr<IR> try_bnel(Instruction& instr, Instruction& next_instr, int id
   return nullptr;
 }
 
-std::shared_ptr<IR> try_beql(Instruction& instr, Instruction& next_instr, int idx) {
+IR* try_beql(Instruction& instr, Instruction& next_instr, int idx) {
   if (instr.kind == InstructionKind::BEQL && instr.get_src(0).is_reg(make_gpr(Reg::S7))) {
-    return std::make_shared<IR_Branch>(
+    return make_ir<IR_Branch>(
         Condition(Condition::FALSE, make_reg(instr.get_src(1).get_reg(), idx), nullptr, nullptr),
         instr.get_src(2).get_label(), get_branch_delay(next_instr, idx), true);
   } else if (instr.kind == InstructionKind::BEQL && instr.get_src(1).is_reg(make_gpr(Reg::R0))) {
-    return std::make_shared<IR_Branch>(
+    return make_ir<IR_Branch>(
         Condition(Condition::ZERO, make_reg(instr.get_src(0).get_reg(), idx), nullptr, nullptr),
         instr.get_src(2).get_label(), get_branch_delay(next_instr, idx), true);
   }
 
   else if (instr.kind == InstructionKind::BEQL) {
-    return std::make_shared<IR_Branch>(
+    return make_ir<IR_Branch>(
         Condition(Condition::EQUAL, make_reg(instr.get_src(0).get_reg(), idx),
                   make_reg(instr.get_src(1).get_reg(), idx), nullptr),
         instr.get_src(2).get_label(), get_branch_delay(next_instr, idx), true);
@@ -950,18 +950,18 @@ std::shared_ptr<IR> try_beql(Instruction& instr, Instruction& next_instr, int id
   return nullptr;
 }
 
-std::shared_ptr<IR> try_beq(Instruction& instr, Instruction& next_instr, int idx) {
+IR* try_beq(Instruction& instr, Instruction& next_instr, int idx) {
   if (instr.kind == InstructionKind::BEQ && instr.get_src(0).is_reg(make_gpr(Reg::R0)) &&
       instr.get_src(1).is_reg(make_gpr(Reg::R0))) {
-    return std::make_shared<IR_Branch>(Condition(Condition::ALWAYS, nullptr, nullptr, nullptr),
-                                       instr.get_src(2).get_label(),
-                                       get_branch_delay(next_instr, idx), false);
+    return make_ir<IR_Branch>(Condition(Condition::ALWAYS, nullptr, nullptr, nullptr),
+                              instr.get_src(2).get_label(),
+                              get_branch_delay(next_instr, idx), false);
   } else if (instr.kind == InstructionKind::BEQ && instr.get_src(0).is_reg(make_gpr(Reg::S7))) {
-    return std::make_shared<IR_Branch>(
+    return make_ir<IR_Branch>(
         Condition(Condition::FALSE, make_reg(instr.get_src(1).get_reg(), idx), nullptr, nullptr),
         instr.get_src(2).get_label(), get_branch_delay(next_instr, idx), false);
   } else if (instr.kind == InstructionKind::BEQ) {
-    return std::make_shared<IR_Branch>(
+    return make_ir<IR_Branch>(
         Condition(Condition::EQUAL, make_reg(instr.get_src(0).get_reg(), idx),
                   make_reg(instr.get_src(1).get_reg(), idx), nullptr),
         instr.get_src(2).get_label(), get_branch_delay(next_instr, idx), false);
@@ -969,9 +969,9 @@ std::shared_ptr<IR> try_beq(Instruction& instr, Instruction& next_instr, int idx
   return nullptr;
 }
 
-std::shared_ptr<IR> try_bgtzl(Instruction& instr, Instruction& next_instr, int idx) {
+IR* try_bgtzl(Instruction& instr, Instruction& next_instr, int idx) {
   if (instr.kind == InstructionKind::BGTZL) {
-    return std::make_shared<IR_Branch>(
+    return make_ir<IR_Branch>(
         Condition(Condition::GREATER_THAN_ZERO_SIGNED, make_reg(instr.get_src(0).get_reg(), idx),
                   nullptr, nullptr),
         instr.get_src(1).get_label(), get_branch_delay(next_instr, idx), true);
@@ -979,9 +979,9 @@ std::shared_ptr<IR> try_bgtzl(Instruction& instr, Instruction& next_instr, int i
   return nullptr;
 }
 
-std::shared_ptr<IR> try_bgezl(Instruction& instr, Instruction& next_instr, int idx) {
+IR* try_bgezl(Instruction& instr, Instruction& next_instr, int idx) {
   if (instr.kind == InstructionKind::BGEZL) {
-    return std::make_shared<IR_Branch>(
+    return make_ir<IR_Branch>(
         Condition(Condition::GEQ_ZERO_SIGNED, make_reg(instr.get_src(0).get_reg(), idx), nullptr,
                   nullptr),
         instr.get_src(1).get_label(), get_branch_delay(next_instr, idx), true);
@@ -989,9 +989,9 @@ std::shared_ptr<IR> try_bgezl(Instruction& instr, Instruction& next_instr, int i
   return nullptr;
 }
 
-std::shared_ptr<IR> try_bltzl(Instruction& instr, Instruction& next_instr, int idx) {
+IR* try_bltzl(Instruction& instr, Instruction& next_instr, int idx) {
   if (instr.kind == InstructionKind::BLTZL) {
-    return std::make_shared<IR_Branch>(
+    return make_ir<IR_Branch>(
         Condition(Condition::LESS_THAN_ZERO, make_reg(instr.get_src(0).get_reg(), idx), nullptr,
                   nullptr),
         instr.get_src(1).get_label(), get_branch_delay(next_instr, idx), true);
@@ -999,7 +999,7 @@ std::shared_ptr<IR> try_bltzl(Instruction& instr, Instruction& next_instr, int i
   return nullptr;
 }
 
-std::shared_ptr<IR> try_daddiu(Instruction& i0, Instruction& i1, int idx) {
+IR* try_daddiu(Instruction& i0, Instruction& i1, int idx) {
   if (i0.kind == InstructionKind::DADDIU && i1.kind == InstructionKind::MOVN &&
       i0.get_src(0).get_reg() == make_gpr(Reg::S7)) {
     auto dst_reg = i0.get_dst(0).get_reg();
@@ -1009,7 +1009,7 @@ std::shared_ptr<IR> try_daddiu(Instruction& i0, Instruction& i1, int idx) {
     assert(i1.get_dst(0).get_reg() == dst_reg);
     assert(i1.get_src(0).get_reg() == make_gpr(Reg::S7));
     return make_set(IR_Set::REG_64, make_reg(dst_reg, idx),
-                    std::make_shared<IR_Compare>(
+                    make_ir<IR_Compare>(
                         Condition(Condition::ZERO, make_reg(src_reg, idx), nullptr, nullptr)));
   } else if (i0.kind == InstructionKind::DADDIU && i1.kind == InstructionKind::MOVZ &&
              i0.get_src(0).get_reg() == make_gpr(Reg::S7)) {
@@ -1020,19 +1020,19 @@ std::shared_ptr<IR> try_daddiu(Instruction& i0, Instruction& i1, int idx) {
     assert(i1.get_dst(0).get_reg() == dst_reg);
     assert(i1.get_src(0).get_reg() == make_gpr(Reg::S7));
     return make_set(IR_Set::REG_64, make_reg(dst_reg, idx),
-                    std::make_shared<IR_Compare>(
+                    make_ir<IR_Compare>(
                         Condition(Condition::NONZERO, make_reg(src_reg, idx), nullptr, nullptr)));
   }
   return nullptr;
 }
 
-std::shared_ptr<IR> try_lui(Instruction& i0, Instruction& i1, int idx) {
+IR* try_lui(Instruction& i0, Instruction& i1, int idx) {
   if (i0.kind == InstructionKind::LUI && i1.kind == InstructionKind::ORI &&
       i0.get_src(0).is_label() && i1.get_src(1).is_label()) {
     assert(i0.get_dst(0).get_reg() == i1.get_src(0).get_reg());
     assert(i0.get_src(0).get_label() == i1.get_src(1).get_label());
     auto op = make_set(IR_Set::REG_64, make_reg(i1.get_dst(0).get_reg(), idx),
-                       std::make_shared<IR_StaticAddress>(i0.get_src(0).get_label()));
+                       make_ir<IR_StaticAddress>(i0.get_src(0).get_label()));
     if (i0.get_dst(0).get_reg() != i1.get_dst(0).get_reg()) {
       op->clobber = make_reg(i0.get_dst(0).get_reg(), idx);
     }
@@ -1051,7 +1051,7 @@ std::shared_ptr<IR> try_lui(Instruction& i0, Instruction& i1, int idx) {
   return nullptr;
 }
 
-std::shared_ptr<IR> try_slt(Instruction& i0, Instruction& i1, int idx) {
+IR* try_slt(Instruction& i0, Instruction& i1, int idx) {
   if (is_gpr_3(i0, InstructionKind::SLT, {}, {}, {})) {
     auto temp = i0.get_dst(0).get_reg();
     auto left = i0.get_src(0).get_reg();
@@ -1060,8 +1060,8 @@ std::shared_ptr<IR> try_slt(Instruction& i0, Instruction& i1, int idx) {
       // success!
       auto result =
           make_set(IR_Set::REG_64, make_reg(left, idx),
-                   std::make_shared<IR_IntMath2>(IR_IntMath2::MIN_SIGNED, make_reg(left, idx),
-                                                 make_reg(right, idx)));
+                   make_ir<IR_IntMath2>(IR_IntMath2::MIN_SIGNED, make_reg(left, idx),
+                                        make_reg(right, idx)));
       result->clobber = make_reg(temp, idx);
       return result;
     }
@@ -1070,8 +1070,8 @@ std::shared_ptr<IR> try_slt(Instruction& i0, Instruction& i1, int idx) {
       // success!
       auto result =
           make_set(IR_Set::REG_64, make_reg(left, idx),
-                   std::make_shared<IR_IntMath2>(IR_IntMath2::MAX_SIGNED, make_reg(left, idx),
-                                                 make_reg(right, idx)));
+                   make_ir<IR_IntMath2>(IR_IntMath2::MAX_SIGNED, make_reg(left, idx),
+                                        make_reg(right, idx)));
       result->clobber = make_reg(temp, idx);
       return result;
     }
@@ -1080,7 +1080,7 @@ std::shared_ptr<IR> try_slt(Instruction& i0, Instruction& i1, int idx) {
 }
 
 // THREE OP
-std::shared_ptr<IR> try_lui(Instruction& i0, Instruction& i1, Instruction& i2, int idx) {
+IR* try_lui(Instruction& i0, Instruction& i1, Instruction& i2, int idx) {
   if (i0.kind == InstructionKind::LUI && i1.kind == InstructionKind::ORI &&
       i0.get_src(0).is_label() && i1.get_src(1).is_label() &&
       is_gpr_3(i2, InstructionKind::ADDU, {}, make_gpr(Reg::FP), {})) {
@@ -1089,7 +1089,7 @@ std::shared_ptr<IR> try_lui(Instruction& i0, Instruction& i1, Instruction& i2, i
     assert(i2.get_dst(0).get_reg() == i2.get_src(1).get_reg());
     assert(i2.get_dst(0).get_reg() == i1.get_dst(0).get_reg());
     auto op = make_set(IR_Set::REG_64, make_reg(i1.get_dst(0).get_reg(), idx),
-                       std::make_shared<IR_StaticAddress>(i0.get_src(0).get_label()));
+                       make_ir<IR_StaticAddress>(i0.get_src(0).get_label()));
     if (i0.get_dst(0).get_reg() != i1.get_dst(0).get_reg()) {
       op->clobber = make_reg(i0.get_dst(0).get_reg(), idx);
     }
@@ -1098,7 +1098,7 @@ std::shared_ptr<IR> try_lui(Instruction& i0, Instruction& i1, Instruction& i2, i
   return nullptr;
 }
 
-std::shared_ptr<IR> try_dsubu(Instruction& i0, Instruction& i1, Instruction& i2, int idx) {
+IR* try_dsubu(Instruction& i0, Instruction& i1, Instruction& i2, int idx) {
   if (i0.kind == InstructionKind::DSUBU && i1.kind == InstructionKind::DADDIU &&
       i2.kind == InstructionKind::MOVN) {
     // check for equality
@@ -1112,7 +1112,7 @@ std::shared_ptr<IR> try_dsubu(Instruction& i0, Instruction& i1, Instruction& i2,
     assert(i2.get_src(0).get_reg() == make_gpr(Reg::S7));
     assert(i2.get_src(1).get_reg() == clobber_reg);
     return make_set(IR_Set::REG_64, make_reg(dst_reg, idx),
-                    std::make_shared<IR_Compare>(
+                    make_ir<IR_Compare>(
                         Condition(Condition::EQUAL, make_reg(src0_reg, idx),
                                   make_reg(src1_reg, idx), make_reg(clobber_reg, idx))));
   } else if (i0.kind == InstructionKind::DSUBU && i1.kind == InstructionKind::DADDIU &&
@@ -1130,21 +1130,21 @@ std::shared_ptr<IR> try_dsubu(Instruction& i0, Instruction& i1, Instruction& i2,
       return nullptr;  // TODO!
     }
     return make_set(IR_Set::REG_64, make_reg(dst_reg, idx),
-                    std::make_shared<IR_Compare>(
+                    make_ir<IR_Compare>(
                         Condition(Condition::NOT_EQUAL, make_reg(src0_reg, idx),
                                   make_reg(src1_reg, idx), make_reg(clobber_reg, idx))));
   }
   return nullptr;
 }
 
-std::shared_ptr<IR> try_slt(Instruction& i0, Instruction& i1, Instruction& i2, int idx) {
+IR* try_slt(Instruction& i0, Instruction& i1, Instruction& i2, int idx) {
   if (i0.kind == InstructionKind::SLT && i1.kind == InstructionKind::BNE) {
     auto clobber_reg = i0.get_dst(0).get_reg();
     auto src0_reg = i0.get_src(0).get_reg();
     auto src1_reg = i0.get_src(1).get_reg();
     assert(i1.get_src(0).get_reg() == clobber_reg);
     assert(i1.get_src(1).get_reg() == make_gpr(Reg::R0));
-    return std::make_shared<IR_Branch>(
+    return make_ir<IR_Branch>(
         Condition(Condition::LESS_THAN_SIGNED, make_reg(src0_reg, idx), make_reg(src1_reg, idx),
                   make_reg(clobber_reg, idx)),
         i1.get_src(2).get_label(), get_branch_delay(i2, idx), false);
@@ -1162,7 +1162,7 @@ std::shared_ptr<IR> try_slt(Instruction& i0, Instruction& i1, Instruction& i2, i
       return nullptr;  // TODO!
     }
     return make_set(IR_Set::REG_64, make_reg(dst_reg, idx),
-                    std::make_shared<IR_Compare>(
+                    make_ir<IR_Compare>(
                         Condition(Condition::LESS_THAN_SIGNED, make_reg(src0_reg, idx),
                                   make_reg(src1_reg, idx), make_reg(clobber_reg, idx))));
   } else if (i0.kind == InstructionKind::SLT && i1.kind == InstructionKind::BEQ) {
@@ -1171,7 +1171,7 @@ std::shared_ptr<IR> try_slt(Instruction& i0, Instruction& i1, Instruction& i2, i
     auto src1_reg = i0.get_src(1).get_reg();
     assert(i1.get_src(0).get_reg() == clobber_reg);
     assert(i1.get_src(1).get_reg() == make_gpr(Reg::R0));
-    return std::make_shared<IR_Branch>(
+    return make_ir<IR_Branch>(
         Condition(Condition::GEQ_SIGNED, make_reg(src0_reg, idx), make_reg(src1_reg, idx),
                   make_reg(clobber_reg, idx)),
         i1.get_src(2).get_label(), get_branch_delay(i2, idx), false);
@@ -1189,21 +1189,21 @@ std::shared_ptr<IR> try_slt(Instruction& i0, Instruction& i1, Instruction& i2, i
       return nullptr;  // TODO!
     }
     return make_set(IR_Set::REG_64, make_reg(dst_reg, idx),
-                    std::make_shared<IR_Compare>(
+                    make_ir<IR_Compare>(
                         Condition(Condition::GEQ_SIGNED, make_reg(src0_reg, idx),
                                   make_reg(src1_reg, idx), make_reg(clobber_reg, idx))));
   }
   return nullptr;
 }
 
-std::shared_ptr<IR> try_slti(Instruction& i0, Instruction& i1, Instruction& i2, int idx) {
+IR* try_slti(Instruction& i0, Instruction& i1, Instruction& i2, int idx) {
   auto src1 = make_int(i0.get_src(1).get_imm());
   if (i0.kind == InstructionKind::SLTI && i1.kind == InstructionKind::BNE) {
     auto clobber_reg = i0.get_dst(0).get_reg();
     auto src0_reg = i0.get_src(0).get_reg();
     assert(i1.get_src(0).get_reg() == clobber_reg);
     assert(i1.get_src(1).get_reg() == make_gpr(Reg::R0));
-    return std::make_shared<IR_Branch>(
+    return make_ir<IR_Branch>(
         Condition(Condition::LESS_THAN_SIGNED, make_reg(src0_reg, idx), src1,
                   make_reg(clobber_reg, idx)),
         i1.get_src(2).get_label(), get_branch_delay(i2, idx), false);
@@ -1221,14 +1221,14 @@ std::shared_ptr<IR> try_slti(Instruction& i0, Instruction& i1, Instruction& i2,
     }
     return make_set(
         IR_Set::REG_64, make_reg(dst_reg, idx),
-        std::make_shared<IR_Compare>(Condition(Condition::LESS_THAN_SIGNED, make_reg(src0_reg, idx),
-                                               src1, make_reg(clobber_reg, idx))));
+        make_ir<IR_Compare>(Condition(Condition::LESS_THAN_SIGNED, make_reg(src0_reg, idx),
+                                      src1, make_reg(clobber_reg, idx))));
   } else if (i0.kind == InstructionKind::SLTI && i1.kind == InstructionKind::BEQ) {
     auto clobber_reg = i0.get_dst(0).get_reg();
     auto src0_reg = i0.get_src(0).get_reg();
     assert(i1.get_src(0).get_reg() == clobber_reg);
     assert(i1.get_src(1).get_reg() == make_gpr(Reg::R0));
-    return std::make_shared<IR_Branch>(
+    return make_ir<IR_Branch>(
         Condition(Condition::GEQ_SIGNED, make_reg(src0_reg, idx), src1, make_reg(clobber_reg, idx)),
         i1.get_src(2).get_label(), get_branch_delay(i2, idx), false);
   } else if (i0.kind == InstructionKind::SLTI && i1.kind == InstructionKind::DADDIU &&
@@ -1245,20 +1245,20 @@ std::shared_ptr<IR> try_slti(Instruction& i0, Instruction& i1, Instruction& i2,
     }
     return make_set(
         IR_Set::REG_64, make_reg(dst_reg, idx),
-        std::make_shared<IR_Compare>(Condition(Condition::GEQ_SIGNED, make_reg(src0_reg, idx), src1,
-                                               make_reg(clobber_reg, idx))));
+        make_ir<IR_Compare>(Condition(Condition::GEQ_SIGNED, make_reg(src0_reg, idx), src1,
+                                      make_reg(clobber_reg, idx))));
   }
   return nullptr;
 }
 
-std::shared_ptr<IR> try_sltiu(Instruction& i0, Instruction& i1, Instruction& i2, int idx) {
+IR* try_sltiu(Instruction& i0, Instruction& i1, Instruction& i2, int idx) {
   auto src1 = make_int(i0.get_src(1).get_imm());
   if (i0.kind == InstructionKind::SLTIU && i1.kind == InstructionKind::BNE) {
     auto clobber_reg = i0.get_dst(0).get_reg();
     auto src0_reg = i0.get_src(0).get_reg();
     assert(i1.get_src(0).get_reg() == clobber_reg);
     assert(i1.get_src(1).get_reg() == make_gpr(Reg::R0));
-    return std::make_shared<IR_Branch>(
+    return make_ir<IR_Branch>(
         Condition(Condition::LESS_THAN_UNSIGNED, make_reg(src0_reg, idx), src1,
                   make_reg(clobber_reg, idx)),
         i1.get_src(2).get_label(), get_branch_delay(i2, idx), false);
@@ -1275,16 +1275,16 @@ std::shared_ptr<IR> try_sltiu(Instruction& i0, Instruction& i1, Instruction& i2,
       return nullptr;  // TODO!
     }
     return make_set(IR_Set::REG_64, make_reg(dst_reg, idx),
-                    std::make_shared<IR_Compare>(Condition(Condition::LESS_THAN_UNSIGNED,
-                                                           make_reg(src0_reg, idx), src1,
-                                                           make_reg(clobber_reg, idx))));
+                    make_ir<IR_Compare>(Condition(Condition::LESS_THAN_UNSIGNED,
+                                                  make_reg(src0_reg, idx), src1,
+                                                  make_reg(clobber_reg, idx))));
   } else if (i0.kind == InstructionKind::SLTIU && i1.kind == InstructionKind::BEQ) {
     auto clobber_reg = i0.get_dst(0).get_reg();
     auto src0_reg = i0.get_src(0).get_reg();
     assert(i1.get_src(0).get_reg() == clobber_reg);
     assert(i1.get_src(1).get_reg() == make_gpr(Reg::R0));
-    return std::make_shared<IR_Branch>(Condition(Condition::GEQ_UNSIGNED, make_reg(src0_reg, idx),
-                                                 src1, make_reg(clobber_reg, idx)),
+    return make_ir<IR_Branch>(Condition(Condition::GEQ_UNSIGNED, make_reg(src0_reg, idx),
+                                        src1, make_reg(clobber_reg, idx)),
                                        i1.get_src(2).get_label(), get_branch_delay(i2, idx), false);
   } else if (i0.kind == InstructionKind::SLTIU && i1.kind == InstructionKind::DADDIU &&
              i2.kind == InstructionKind::MOVN) {
@@ -1300,20 +1300,20 @@ std::shared_ptr<IR> try_sltiu(Instruction& i0, Instruction& i1, Instruction& i2,
     }
     return make_set(
         IR_Set::REG_64, make_reg(dst_reg, idx),
-        std::make_shared<IR_Compare>(Condition(Condition::GEQ_UNSIGNED, make_reg(src0_reg, idx),
-                                               src1, make_reg(clobber_reg, idx))));
+        make_ir<IR_Compare>(Condition(Condition::GEQ_UNSIGNED, make_reg(src0_reg, idx),
+                                      src1, make_reg(clobber_reg, idx))));
   }
   return nullptr;
 }
 
-std::shared_ptr<IR> try_ceqs(Instruction& i0, Instruction& i1, Instruction& i2, int idx) {
+IR* try_ceqs(Instruction& i0, Instruction& i1, Instruction& i2, int idx) {
   if (i0.kind == InstructionKind::CEQS && i1.kind == InstructionKind::BC1T) {
-    return std::make_shared<IR_Branch>(
+    return make_ir<IR_Branch>(
         Condition(Condition::FLOAT_EQUAL, make_reg(i0.get_src(0).get_reg(), idx),
                   make_reg(i0.get_src(1).get_reg(), idx), nullptr),
         i1.get_src(0).get_label(), get_branch_delay(i2, idx), false);
   } else if (i0.kind == InstructionKind::CEQS && i1.kind == InstructionKind::BC1F) {
-    return std::make_shared<IR_Branch>(
+    return make_ir<IR_Branch>(
         Condition(Condition::FLOAT_NOT_EQUAL, make_reg(i0.get_src(0).get_reg(), idx),
                   make_reg(i0.get_src(1).get_reg(), idx), nullptr),
         i1.get_src(0).get_label(), get_branch_delay(i2, idx), false);
@@ -1321,14 +1321,14 @@ std::shared_ptr<IR> try_ceqs(Instruction& i0, Instruction& i1, Instruction& i2,
   return nullptr;
 }
 
-std::shared_ptr<IR> try_clts(Instruction& i0, Instruction& i1, Instruction& i2, int idx) {
+IR* try_clts(Instruction& i0, Instruction& i1, Instruction& i2, int idx) {
   if (i0.kind == InstructionKind::CLTS && i1.kind == InstructionKind::BC1T) {
-    return std::make_shared<IR_Branch>(
+    return make_ir<IR_Branch>(
         Condition(Condition::FLOAT_LESS_THAN, make_reg(i0.get_src(0).get_reg(), idx),
                   make_reg(i0.get_src(1).get_reg(), idx), nullptr),
         i1.get_src(0).get_label(), get_branch_delay(i2, idx), false);
   } else if (i0.kind == InstructionKind::CLTS && i1.kind == InstructionKind::BC1F) {
-    return std::make_shared<IR_Branch>(
+    return make_ir<IR_Branch>(
         Condition(Condition::FLOAT_GEQ, make_reg(i0.get_src(0).get_reg(), idx),
                   make_reg(i0.get_src(1).get_reg(), idx), nullptr),
         i1.get_src(0).get_label(), get_branch_delay(i2, idx), false);
@@ -1336,14 +1336,14 @@ std::shared_ptr<IR> try_clts(Instruction& i0, Instruction& i1, Instruction& i2,
   return nullptr;
 }
 
-std::shared_ptr<IR> try_cles(Instruction& i0, Instruction& i1, Instruction& i2, int idx) {
+IR* try_cles(Instruction& i0, Instruction& i1, Instruction& i2, int idx) {
   if (i0.kind == InstructionKind::CLES && i1.kind == InstructionKind::BC1T) {
-    return std::make_shared<IR_Branch>(
+    return make_ir<IR_Branch>(
         Condition(Condition::FLOAT_LEQ, make_reg(i0.get_src(0).get_reg(), idx),
                   make_reg(i0.get_src(1).get_reg(), idx), nullptr),
         i1.get_src(0).get_label(), get_branch_delay(i2, idx), false);
   } else if (i0.kind == InstructionKind::CLES && i1.kind == InstructionKind::BC1F) {
-    return std::make_shared<IR_Branch>(
+    return make_ir<IR_Branch>(
         Condition(Condition::FLOAT_GREATER_THAN, make_reg(i0.get_src(0).get_reg(), idx),
                   make_reg(i0.get_src(1).get_reg(), idx), nullptr),
         i1.get_src(0).get_label(), get_branch_delay(i2, idx), false);
@@ -1351,14 +1351,14 @@ std::shared_ptr<IR> try_cles(Instruction& i0, Instruction& i1, Instruction& i2,
   return nullptr;
 }
 
-std::shared_ptr<IR> try_sltu(Instruction& i0, Instruction& i1, Instruction& i2, int idx) {
+IR* try_sltu(Instruction& i0, Instruction& i1, Instruction& i2, int idx) {
   if (i0.kind == InstructionKind::SLTU && i1.kind == InstructionKind::BNE) {
     auto clobber_reg = i0.get_dst(0).get_reg();
     auto src0_reg = i0.get_src(0).get_reg();
     auto src1_reg = i0.get_src(1).get_reg();
     assert(i1.get_src(0).get_reg() == clobber_reg);
     assert(i1.get_src(1).get_reg() == make_gpr(Reg::R0));
-    return std::make_shared<IR_Branch>(
+    return make_ir<IR_Branch>(
         Condition(Condition::LESS_THAN_UNSIGNED, make_reg(src0_reg, idx), make_reg(src1_reg, idx),
                   make_reg(clobber_reg, idx)),
         i1.get_src(2).get_label(), get_branch_delay(i2, idx), false);
@@ -1376,7 +1376,7 @@ std::shared_ptr<IR> try_sltu(Instruction& i0, Instruction& i1, Instruction& i2,
       return nullptr;  // TODO!
     }
     return make_set(IR_Set::REG_64, make_reg(dst_reg, idx),
-                    std::make_shared<IR_Compare>(
+                    make_ir<IR_Compare>(
                         Condition(Condition::LESS_THAN_UNSIGNED, make_reg(src0_reg, idx),
                                   make_reg(src1_reg, idx), make_reg(clobber_reg, idx))));
   } else if (i0.kind == InstructionKind::SLTU && i1.kind == InstructionKind::BEQ) {
@@ -1385,7 +1385,7 @@ std::shared_ptr<IR> try_sltu(Instruction& i0, Instruction& i1, Instruction& i2,
     auto src1_reg = i0.get_src(1).get_reg();
     assert(i1.get_src(0).get_reg() == clobber_reg);
     assert(i1.get_src(1).get_reg() == make_gpr(Reg::R0));
-    return std::make_shared<IR_Branch>(
+    return make_ir<IR_Branch>(
         Condition(Condition::GEQ_UNSIGNED, make_reg(src0_reg, idx), make_reg(src1_reg, idx),
                   make_reg(clobber_reg, idx)),
         i1.get_src(2).get_label(), get_branch_delay(i2, idx), false);
@@ -1403,7 +1403,7 @@ std::shared_ptr<IR> try_sltu(Instruction& i0, Instruction& i1, Instruction& i2,
       return nullptr;  // TODO!
     }
     return make_set(IR_Set::REG_64, make_reg(dst_reg, idx),
-                    std::make_shared<IR_Compare>(
+                    make_ir<IR_Compare>(
                         Condition(Condition::GEQ_UNSIGNED, make_reg(src0_reg, idx),
                                   make_reg(src1_reg, idx), make_reg(clobber_reg, idx))));
   }
@@ -1411,12 +1411,12 @@ std::shared_ptr<IR> try_sltu(Instruction& i0, Instruction& i1, Instruction& i2,
 }
 
 // five op
-std::shared_ptr<IR> try_lwu(Instruction& i0,
-                            Instruction& i1,
-                            Instruction& i2,
-                            Instruction& i3,
-                            Instruction& i4,
-                            int idx) {
+IR* try_lwu(Instruction& i0,
+            Instruction& i1,
+            Instruction& i2,
+            Instruction& i3,
+            Instruction& i4,
+            int idx) {
   (void)idx;
   auto s6 = make_gpr(Reg::S6);
   if (i0.kind == InstructionKind::LWU && i0.get_dst(0).is_reg(s6) &&
@@ -1426,7 +1426,7 @@ std::shared_ptr<IR> try_lwu(Instruction& i0,
       i2.get_src(0).get_imm() == 12 && i2.get_src(1).is_reg(s6) &&
       i3.kind == InstructionKind::JALR && i3.get_dst(0).is_reg(make_gpr(Reg::RA)) &&
       i3.get_src(0).is_reg(s6) && i4.kind == InstructionKind::MFLO1 && i4.get_dst(0).is_reg(s6)) {
-    return std::make_shared<IR_Suspend>();
+    return make_ir<IR_Suspend>();
   }
   return nullptr;
 }
@@ -1435,12 +1435,13 @@ std::shared_ptr<IR> try_lwu(Instruction& i0,
 
 void add_basic_ops_to_block(Function* func, const BasicBlock& block, LinkedObjectFile* file) {
   (void)file;
+  IR_ArenaScope arena_scope(func->ir_arena.get());
   for (int instr = block.start_word; instr < block.end_word; instr++) {
     auto& i = func->instructions.at(instr);
 
     int length = 0;
 
-    std::shared_ptr<IR> result = nullptr;
+    IR* result = nullptr;
     if (instr + 4 < block.end_word) {
       auto& i1 = func->instructions.at(instr + 1);
       auto& i2 = func->instructions.at(instr + 2);
@@ -1901,10 +1902,11 @@ void add_basic_ops_to_block(Function* func, const BasicBlock& block, LinkedObjec
     // everything failed
     if (!result) {
       // temp hack for debug:
-      printf("Instruction -> BasicOp failed on %s\n", i.to_string(*file).c_str());
-      func->add_basic_op(std::make_shared<IR_Failed>(), instr, instr + 1);
+      ordered_log::print(
+          fmt::format("Instruction -> BasicOp failed on {}\n", i.to_string(*file)));
+      func->add_basic_op(make_ir<IR_Failed>(), instr, instr + 1);
     } else {
-      if (!func->contains_asm_ops && dynamic_cast<IR_AsmOp*>(result.get())) {
+      if (!func->contains_asm_ops && ir_cast<IR_AsmOp>(result)) {
         func->warnings += "Function contains asm op";
         func->contains_asm_ops = true;
       }
@@ -9,7 +9,7 @@
 
 namespace {
 
-std::shared_ptr<IR> cfg_to_ir(Function& f, LinkedObjectFile& file, CfgVtx* vtx);
+IR* cfg_to_ir(Function& f, LinkedObjectFile& file, CfgVtx* vtx);
 
 /*!
  * This adds a single CfgVtx* to a list of IR's by converting it with cfg to IR.
@@ -18,7 +18,7 @@ std::shared_ptr<IR> cfg_to_ir(Function& f, LinkedObjectFile& file, CfgVtx* vtx);
  */
 void insert_cfg_into_list(Function& f,
                           LinkedObjectFile& file,
-                          std::vector<std::shared_ptr<IR>>* output,
+                          std::vector<IR*>* output,
                           CfgVtx* vtx) {
   auto as_sequence = dynamic_cast<SequenceVtx*>(vtx);
   auto as_block = dynamic_cast<BlockVtx*>(vtx);
@@ -31,16 +31,16 @@ void insert_cfg_into_list(Function& f,
     IR* last = nullptr;
     for (int instr = block.start_word; instr < block.end_word; instr++) {
       auto got = f.get_basic_op_at_instr(instr);
-      if (got.get() == last) {
+      if (got == last) {
         continue;
       }
-      last = got.get();
+      last = got;
       output->push_back(got);
     }
   } else {
     // doesn't look like we're going to get something that can be inlined, so try as usual
     auto ir = cfg_to_ir(f, file, vtx);
-    auto ir_as_begin = dynamic_cast<IR_Begin*>(ir.get());
+    auto ir_as_begin = ir_cast<IR_Begin>(ir);
     if (ir_as_begin) {
       // we unexpectedly got a begin, even though we didn't think we would.  This is okay, but we
       // should inline this begin to avoid nested begins.  This happens in the case where an entire
@@ -61,10 +61,10 @@ void insert_cfg_into_list(Function& f,
  * Otherwise returns nullptr.  Useful to modify or remove branches found at the end of blocks,
  * and inline things into the begin they were found in.
  */
-std::pair<IR_Branch*, std::vector<std::shared_ptr<IR>>*> get_condition_branch_as_vector(IR* in) {
-  auto as_seq = dynamic_cast<IR_Begin*>(in);
+std::pair<IR_Branch*, std::vector<IR*>*> get_condition_branch_as_vector(IR* in) {
+  auto as_seq = ir_cast<IR_Begin>(in);
   if (as_seq) {
-    auto irb = dynamic_cast<IR_Branch*>(as_seq->forms.back().get());
+    auto irb = ir_cast<IR_Branch>(as_seq->forms.back());
     auto loc = &as_seq->forms;
     assert(irb);
     return std::make_pair(irb, loc);
@@ -76,27 +76,27 @@ std::pair<IR_Branch*, std::vector<std::shared_ptr<IR>>*> get_condition_branch_as
  * Given an IR, find a branch IR at the end, and also the location of it so it can be patched.
  * Returns nullptr as the first item in the pair if it didn't work.
  */
-std::pair<IR_Branch*, std::shared_ptr<IR>*> get_condition_branch(std::shared_ptr<IR>* in) {
-  IR_Branch* condition_branch = dynamic_cast<IR_Branch*>(in->get());
-  std::shared_ptr<IR>* condition_branch_location = in;
+std::pair<IR_Branch*, IR**> get_condition_branch(IR** in) {
+  IR_Branch* condition_branch = ir_cast<IR_Branch>(*in);
+  IR** condition_branch_location = in;
   if (!condition_branch) {
     // not 100% sure this will always work
-    auto as_seq = dynamic_cast<IR_Begin*>(in->get());
+    auto as_seq = ir_cast<IR_Begin>(*in);
     if (as_seq) {
-      condition_branch = dynamic_cast<IR_Branch*>(as_seq->forms.back().get());
+      condition_branch = ir_cast<IR_Branch>(as_seq->forms.back());
       condition_branch_location = &as_seq->forms.back();
     }
   }
 
   if (!condition_branch) {
-    auto as_return = dynamic_cast<IR_Return*>(in->get());
+    auto as_return = ir_cast<IR_Return>(*in);
     if (as_return) {
       return get_condition_branch(&as_return->dead_code);
     }
   }
 
   if (!condition_branch) {
-    auto as_break = dynamic_cast<IR_Break*>(in->get());
+    auto as_break = ir_cast<IR_Break>(*in);
     if (as_break) {
       return get_condition_branch(&as_break->dead_code);
     }
@@ -109,9 +109,9 @@ std::pair<IR_Branch*, std::shared_ptr<IR>*> get_condition_branch(std::shared_ptr
  * compare IR instead of a branch.
  * Doesn't "rebalance" the leading condition because this runs way before expression compaction.
  */
-void clean_up_cond_with_else(std::shared_ptr<IR>* ir, LinkedObjectFile& file) {
+void clean_up_cond_with_else(IR** ir, LinkedObjectFile& file) {
   (void)file;
-  auto cwe = dynamic_cast<IR_CondWithElse*>(ir->get());
+  auto cwe = ir_cast<IR_CondWithElse>(*ir);
   assert(cwe);
   for (auto& e : cwe->entries) {
     if (e.cleaned) {
@@ -121,7 +121,7 @@ void clean_up_cond_with_else(std::shared_ptr<IR>* ir, LinkedObjectFile& file) {
     assert(jump_to_next.first);
     assert(jump_to_next.first->branch_delay.kind == BranchDelay::NOP);
     // patch the jump to next with a condition.
-    auto replacement = std::make_shared<IR_Compare>(jump_to_next.first->condition);
+    auto replacement = make_ir<IR_Compare>(jump_to_next.first->condition);
     replacement->condition.invert();
     *(jump_to_next.second) = replacement;
 
@@ -136,14 +136,14 @@ void clean_up_cond_with_else(std::shared_ptr<IR>* ir, LinkedObjectFile& file) {
     // in this case, we can just replace the branch with a NOP IR to indicate that nothing
     // happens in this case, but there was still GOAL code to test for it.
     // this happens rarely, as you would expect.
-    auto as_end_of_sequence = get_condition_branch_as_vector(e.body.get());
+    auto as_end_of_sequence = get_condition_branch_as_vector(e.body);
     if (as_end_of_sequence.first) {
       assert(as_end_of_sequence.second->size() > 1);
       as_end_of_sequence.second->pop_back();
     } else {
       // In the future we could consider having a more explicit "this case is empty" operator so
       // this doesn't get confused with an actual MIPS nop.
-      *(jump_to_end.second) = std::make_shared<IR_Nop>();
+      *(jump_to_end.second) = make_ir<IR_Nop>();
     }
     e.cleaned = true;
   }
@@ -153,7 +153,7 @@ void clean_up_until_loop(IR_UntilLoop* ir) {
   auto condition_branch = get_condition_branch(&ir->condition);
   assert(condition_branch.first);
   assert(condition_branch.first->branch_delay.kind == BranchDelay::NOP);
-  auto replacement = std::make_shared<IR_Compare>(condition_branch.first->condition);
+  auto replacement = make_ir<IR_Compare>(condition_branch.first->condition);
   *(condition_branch.second) = replacement;
 }
 
@@ -162,14 +162,14 @@ void clean_up_infinite_while_loop(IR_WhileLoop* ir) {
   assert(jump.first);
   assert(jump.first->branch_delay.kind == BranchDelay::NOP);
   assert(jump.first->condition.kind == Condition::ALWAYS);
-  auto as_end_of_sequence = get_condition_branch_as_vector(ir->body.get());
+  auto as_end_of_sequence = get_condition_branch_as_vector(ir->body);
   if (as_end_of_sequence.first) {
     assert(as_end_of_sequence.second->size() > 1);
     as_end_of_sequence.second->pop_back();
   } else {
     // In the future we could consider having a more explicit "this case is empty" operator so
     // this doesn't get confused with an actual MIPS nop.
-    *(jump.second) = std::make_shared<IR_Nop>();
+    *(jump.second) = make_ir<IR_Nop>();
   }
   ir->cleaned = true;  // so we don't try this later...
 }
@@ -179,14 +179,14 @@ void clean_up_return(IR_Return* ir) {
   assert(jump_to_end.first);
   assert(jump_to_end.first->branch_delay.kind == BranchDelay::NOP);
   assert(jump_to_end.first->condition.kind == Condition::ALWAYS);
-  auto as_end_of_sequence = get_condition_branch_as_vector(ir->return_code.get());
+  auto as_end_of_sequence = get_condition_branch_as_vector(ir->return_code);
   if (as_end_of_sequence.first) {
     assert(as_end_of_sequence.second->size() > 1);
     as_end_of_sequence.second->pop_back();
   } else {
     // In the future we could consider having a more explicit "this case is empty" operator so
     // this doesn't get confused with an actual MIPS nop.
-    *(jump_to_end.second) = std::make_shared<IR_Nop>();
+    *(jump_to_end.second) = make_ir<IR_Nop>();
   }
 }
 
@@ -195,14 +195,14 @@ void clean_up_break(IR_Break* ir) {
   assert(jump_to_end.first);
   assert(jump_to_end.first->branch_delay.kind == BranchDelay::NOP);
   assert(jump_to_end.first->condition.kind == Condition::ALWAYS);
-  auto as_end_of_sequence = get_condition_branch_as_vector(ir->return_code.get());
+  auto as_end_of_sequence = get_condition_branch_as_vector(ir->return_code);
   if (as_end_of_sequence.first) {
     assert(as_end_of_sequence.second->size() > 1);
     as_end_of_sequence.second->pop_back();
   } else {
     // In the future we could consider having a more explicit "this case is empty" operator so
     // this doesn't get confused with an actual MIPS nop.
-    *(jump_to_end.second) = std::make_shared<IR_Nop>();
+    *(jump_to_end.second) = make_ir<IR_Nop>();
   }
 }
 
@@ -218,9 +218,9 @@ bool delay_slot_sets_false(IR_Branch* branch) {
 
   if (branch->condition.kind == Condition::FALSE &&
       branch->branch_delay.kind == BranchDelay::SET_REG_REG) {
-    auto reg_check = dynamic_cast<IR_Register*>(branch->condition.src0.get());
+    auto reg_check = ir_cast<IR_Register>(branch->condition.src0);
     assert(reg_check);
-    auto reg_read = dynamic_cast<IR_Register*>(branch->branch_delay.source.get());
+    auto reg_read = ir_cast<IR_Register>(branch->branch_delay.source);
     assert(reg_read);
     return reg_check->reg == reg_read->reg;
   }
@@ -240,9 +240,9 @@ bool delay_slot_sets_truthy(IR_Branch* branch) {
 
   if (branch->condition.kind == Condition::TRUTHY &&
       branch->branch_delay.kind == BranchDelay::SET_REG_REG) {
-    auto reg_check = dynamic_cast<IR_Register*>(branch->condition.src0.get());
+    auto reg_check = ir_cast<IR_Register>(branch->condition.src0);
     assert(reg_check);
-    auto reg_read = dynamic_cast<IR_Register*>(branch->branch_delay.source.get());
+    auto reg_read = ir_cast<IR_Register>(branch->branch_delay.source);
     assert(reg_read);
     return reg_check->reg == reg_read->reg;
   }
@@ -253,10 +253,10 @@ bool delay_slot_sets_truthy(IR_Branch* branch) {
 /*!
  * Try to convert a short circuit to an and.
  */
-bool try_clean_up_sc_as_and(std::shared_ptr<IR_ShortCircuit>& ir, LinkedObjectFile& file) {
+bool try_clean_up_sc_as_and(IR_ShortCircuit* ir, LinkedObjectFile& file) {
   (void)file;
   Register destination;
-  std::shared_ptr<IR> ir_dest = nullptr;
+  IR* ir_dest = nullptr;
   for (int i = 0; i < int(ir->entries.size()) - 1; i++) {
     auto branch = get_condition_branch(&ir->entries.at(i).condition);
     assert(branch.first);
@@ -266,10 +266,9 @@ bool try_clean_up_sc_as_and(std::shared_ptr<IR_ShortCircuit>& ir, LinkedObjectFi
 
     if (i == 0) {
       ir_dest = branch.first->branch_delay.destination;
-      destination = dynamic_cast<IR_Register*>(branch.first->branch_delay.destination.get())->reg;
+      destination = ir_cast<IR_Register>(branch.first->branch_delay.destination)->reg;
     } else {
-      if (destination !=
-          dynamic_cast<IR_Register*>(branch.first->branch_delay.destination.get())->reg) {
+      if (destination != ir_cast<IR_Register>(branch.first->branch_delay.destination)->reg) {
         return false;
       }
     }
@@ -282,7 +281,7 @@ bool try_clean_up_sc_as_and(std::shared_ptr<IR_ShortCircuit>& ir, LinkedObjectFi
   for (int i = 0; i < int(ir->entries.size()) - 1; i++) {
     auto branch = get_condition_branch(&ir->entries.at(i).condition);
     assert(branch.first);
-    auto replacement = std::make_shared<IR_Compare>(branch.first->condition);
+    auto replacement = make_ir<IR_Compare>(branch.first->condition);
     replacement->condition.invert();
     *(branch.second) = replacement;
   }
@@ -294,24 +293,23 @@ bool try_clean_up_sc_as_and(std::shared_ptr<IR_ShortCircuit>& ir, LinkedObjectFi
  * Try to convert a short circuit to an or.
  * Note - this will convert an and to a very strange or, so always use the try as and first.
  */
-bool try_clean_up_sc_as_or(std::shared_ptr<IR_ShortCircuit>& ir, LinkedObjectFile& file) {
+bool try_clean_up_sc_as_or(IR_ShortCircuit* ir, LinkedObjectFile& file) {
   (void)file;
   Register destination;
-  std::shared_ptr<IR> ir_dest = nullptr;
+  IR* ir_dest = nullptr;
   for (int i = 0; i < int(ir->entries.size()) - 1; i++) {
     auto branch = get_condition_branch(&ir->entries.at(i).condition);
     assert(branch.first);
     if (!delay_slot_sets_truthy(branch.first)) {
       return false;
     }
-    assert(dynamic_cast<IR_Register*>(branch.first->branch_delay.destination.get()));
+    assert(ir_cast<IR_Register>(branch.first->branch_delay.destination));
 
     if (i == 0) {
       ir_dest = branch.first->branch_delay.destination;
-      destination = dynamic_cast<IR_Register*>(branch.first->branch_delay.destination.get())->reg;
+      destination = ir_cast<IR_Register>(branch.first->branch_delay.destination)->reg;
     } else {
-      if (destination !=
-          dynamic_cast<IR_Register*>(branch.first->branch_delay.destination.get())->reg) {
+      if (destination != ir_cast<IR_Register>(branch.first->branch_delay.destination)->reg) {
         return false;
       }
     }
@@ -323,14 +321,14 @@ bool try_clean_up_sc_as_or(std::shared_ptr<IR_ShortCircuit>& ir, LinkedObjectFil
   for (int i = 0; i < int(ir->entries.size()) - 1; i++) {
     auto branch = get_condition_branch(&ir->entries.at(i).condition);
     assert(branch.first);
-    auto replacement = std::make_shared<IR_Compare>(branch.first->condition);
+    auto replacement = make_ir<IR_Compare>(branch.first->condition);
     *(branch.second) = replacement;
   }
 
   return true;
 }
 
-void clean_up_sc(std::shared_ptr<IR_ShortCircuit>& ir, LinkedObjectFile& file);
+void clean_up_sc(IR_ShortCircuit* ir, LinkedObjectFile& file);
 
 /*!
  * A form like (and x (or y z)) will be recognized as a single SC Vertex by the CFG pass.
@@ -341,7 +339,7 @@ void clean_up_sc(std::shared_ptr<IR_ShortCircuit>& ir, LinkedObjectFile& file);
  * (and x (or y (and a b)) c d (or z))
  * will work correctly.  This may require doing more splitting on both sections!
  */
-bool try_splitting_nested_sc(std::shared_ptr<IR_ShortCircuit>& ir, LinkedObjectFile& file) {
+bool try_splitting_nested_sc(IR_ShortCircuit* ir, LinkedObjectFile& file) {
   auto first_branch = get_condition_branch(&ir->entries.front().condition);
   assert(first_branch.first);
   bool first_is_and = delay_slot_sets_false(first_branch.first);
@@ -379,7 +377,7 @@ bool try_splitting_nested_sc(std::shared_ptr<IR_ShortCircuit>& ir, LinkedObjectF
     ir->entries.pop_back();
   }
 
-  auto nested_sc = std::make_shared<IR_ShortCircuit>(nested_ir);
+  auto nested_sc = make_ir<IR_ShortCircuit>(nested_ir);
   clean_up_sc(nested_sc, file);
 
   // the real trick
@@ -396,7 +394,7 @@ bool try_splitting_nested_sc(std::shared_ptr<IR_ShortCircuit>& ir, LinkedObjectF
  * Try to clean up a single short circuit IR. It may get split up into nested IR_ShortCircuits
  * if there is a case like (and a (or b c))
  */
-void clean_up_sc(std::shared_ptr<IR_ShortCircuit>& ir, LinkedObjectFile& file) {
+void clean_up_sc(IR_ShortCircuit* ir, LinkedObjectFile& file) {
   (void)file;
   assert(ir->entries.size() > 1);
   if (!try_clean_up_sc_as_and(ir, file)) {
@@ -414,33 +412,33 @@ void clean_up_sc(std::shared_ptr<IR_ShortCircuit>& ir, LinkedObjectFile& file) {
  * This either succeeds or asserts and must be called with with something that can be converted
  * successfully
  */
-void convert_cond_no_else_to_compare(std::shared_ptr<IR>* ir) {
-  auto cne = dynamic_cast<IR_Cond*>(ir->get());
+void convert_cond_no_else_to_compare(IR** ir) {
+  auto cne = ir_cast<IR_Cond>(*ir);
   assert(cne);
   auto condition = get_condition_branch(&cne->entries.front().condition);
   assert(condition.first);
-  auto body = dynamic_cast<IR_Set*>(cne->entries.front().body.get());
+  auto body = ir_cast<IR_Set>(cne->entries.front().body);
   assert(body);
   auto dst = body->dst;
-  auto src = dynamic_cast<IR_Symbol*>(body->src.get());
+  auto src = ir_cast<IR_Symbol>(body->src);
   assert(src->name == "#f");
   assert(cne->entries.size() == 1);
 
-  auto condition_as_single = dynamic_cast<IR_Branch*>(cne->entries.front().condition.get());
+  auto condition_as_single = ir_cast<IR_Branch>(cne->entries.front().condition);
   if (condition_as_single) {
-    auto replacement = std::make_shared<IR_Set>(
-        IR_Set::REG_64, dst, std::make_shared<IR_Compare>(condition.first->condition));
+    auto replacement = make_ir<IR_Set>(
+        IR_Set::REG_64, dst, make_ir<IR_Compare>(condition.first->condition));
     *ir = replacement;
   } else {
-    auto condition_as_seq = dynamic_cast<IR_Begin*>(cne->entries.front().condition.get());
+    auto condition_as_seq = ir_cast<IR_Begin>(cne->entries.front().condition);
     assert(condition_as_seq);
     if (condition_as_seq) {
-      auto replacement = std::make_shared<IR_Begin>();
+      auto replacement = make_ir<IR_Begin>();
       replacement->forms = condition_as_seq->forms;
       assert(condition.second == &condition_as_seq->forms.back());
       replacement->forms.pop_back();
-      replacement->forms.push_back(std::make_shared<IR_Set>(
-          IR_Set::REG_64, dst, std::make_shared<IR_Compare>(condition.first->condition)));
+      replacement->forms.push_back(make_ir<IR_Set>(
+          IR_Set::REG_64, dst, make_ir<IR_Compare>(condition.first->condition)));
       *ir = replacement;
     }
   }
@@ -455,9 +453,9 @@ void convert_cond_no_else_to_compare(std::shared_ptr<IR>* ir) {
  * But it generally seems inconsistent.  The expression propagation step will have to deal with
  * this.
  */
-void clean_up_cond_no_else(std::shared_ptr<IR>* ir, LinkedObjectFile& file) {
+void clean_up_cond_no_else(IR** ir, LinkedObjectFile& file) {
   (void)file;
-  auto cne = dynamic_cast<IR_Cond*>(ir->get());
+  auto cne = ir_cast<IR_Cond>(*ir);
   assert(cne);
   for (size_t idx = 0; idx < cne->entries.size(); idx++) {
     auto& e = cne->entries.at(idx);
@@ -482,7 +480,7 @@ void clean_up_cond_no_else(std::shared_ptr<IR>* ir, LinkedObjectFile& file) {
         assert(e.false_destination);
       }
 
-      auto replacement = std::make_shared<IR_Compare>(jump_to_next.first->condition);
+      auto replacement = make_ir<IR_Compare>(jump_to_next.first->condition);
       replacement->condition.invert();
       *(jump_to_next.second) = replacement;
       e.cleaned = true;
@@ -492,12 +490,12 @@ void clean_up_cond_no_else(std::shared_ptr<IR>* ir, LinkedObjectFile& file) {
         assert(jump_to_end.first);
         assert(jump_to_end.first->branch_delay.kind == BranchDelay::NOP);
         assert(jump_to_end.first->condition.kind == Condition::ALWAYS);
-        auto as_end_of_sequence = get_condition_branch_as_vector(e.body.get());
+        auto as_end_of_sequence = get_condition_branch_as_vector(e.body);
         if (as_end_of_sequence.first) {
           assert(as_end_of_sequence.second->size() > 1);
           as_end_of_sequence.second->pop_back();
         } else {
-          *(jump_to_end.second) = std::make_shared<IR_Nop>();
+          *(jump_to_end.second) = make_ir<IR_Nop>();
         }
       }
     }
@@ -516,24 +514,24 @@ bool is_int_math_3(IR* ir,
                    Register* src0_out = nullptr,
                    Register* src1_out = nullptr) {
   // should be a set reg to int math 2 ir
-  auto set = dynamic_cast<IR_Set*>(ir);
+  auto set = ir_cast<IR_Set>(ir);
   if (!set) {
     return false;
   }
 
   // destination should be a register
-  auto dest = dynamic_cast<IR_Register*>(set->dst.get());
+  auto dest = ir_cast<IR_Register>(set->dst);
   if (!dest || dst != dest->reg) {
     return false;
   }
 
-  auto math = dynamic_cast<IR_IntMath2*>(set->src.get());
+  auto math = ir_cast<IR_IntMath2>(set->src);
   if (!math || kind != math->kind) {
     return false;
   }
 
-  auto arg0 = dynamic_cast<IR_Register*>(math->arg0.get());
-  auto arg1 = dynamic_cast<IR_Register*>(math->arg1.get());
+  auto arg0 = ir_cast<IR_Register>(math->arg0);
+  auto arg1 = ir_cast<IR_Register>(math->arg1);
 
   if (!arg0 || src0 != arg0->reg || !arg1 || src1 != arg1->reg) {
     return false;
@@ -561,23 +559,23 @@ bool is_int_math_2(IR* ir,
                    Register* dst_out = nullptr,
                    Register* src0_out = nullptr) {
   // should be a set reg to int math 2 ir
-  auto set = dynamic_cast<IR_Set*>(ir);
+  auto set = ir_cast<IR_Set>(ir);
   if (!set) {
     return false;
   }
 
   // destination should be a register
-  auto dest = dynamic_cast<IR_Register*>(set->dst.get());
+  auto dest = ir_cast<IR_Register>(set->dst);
   if (!dest || dst != dest->reg) {
     return false;
   }
 
-  auto math = dynamic_cast<IR_IntMath1*>(set->src.get());
+  auto math = ir_cast<IR_IntMath1>(set->src);
   if (!math || kind != math->kind) {
     return false;
   }
 
-  auto arg = dynamic_cast<IR_Register*>(math->arg.get());
+  auto arg = ir_cast<IR_Register>(math->arg);
 
   if (!arg || src0 != arg->reg) {
     return false;
@@ -599,8 +597,8 @@ bool is_int_math_2(IR* ir,
  * Are these IR's both the same register? False if either is not a register.
  */
 bool is_same_reg(IR* a, IR* b) {
-  auto ar = dynamic_cast<IR_Register*>(a);
-  auto br = dynamic_cast<IR_Register*>(b);
+  auto ar = ir_cast<IR_Register>(a);
+  auto br = ir_cast<IR_Register>(b);
   return ar && br && ar->reg == br->reg;
 }
 
@@ -608,7 +606,7 @@ bool is_same_reg(IR* a, IR* b) {
  * Try to convert this SC Vertex into an abs (integer).
  * Will return a converted abs IR if successful, or nullptr if its not possible
  */
-std::shared_ptr<IR> try_sc_as_abs(Function& f, LinkedObjectFile& file, ShortCircuit* vtx) {
+IR* try_sc_as_abs(Function& f, LinkedObjectFile& file, ShortCircuit* vtx) {
   if (vtx->entries.size() != 1) {
     return nullptr;
   }
@@ -620,9 +618,9 @@ std::shared_ptr<IR> try_sc_as_abs(Function& f, LinkedObjectFile& file, ShortCirc
 
   // todo, seems possible to be a single op instead of a begin here.
   auto b0_ptr = cfg_to_ir(f, file, b0);
-  auto b0_ir = dynamic_cast<IR_Begin*>(b0_ptr.get());
+  auto b0_ir = ir_cast<IR_Begin>(b0_ptr);
 
-  auto branch = dynamic_cast<IR_Branch*>(b0_ir->forms.back().get());
+  auto branch = ir_cast<IR_Branch>(b0_ir->forms.back());
   if (!branch) {
     return nullptr;
   }
@@ -636,7 +634,7 @@ std::shared_ptr<IR> try_sc_as_abs(Function& f, LinkedObjectFile& file, ShortCirc
   auto input = branch->condition.src0;
   auto output = branch->branch_delay.destination;
 
-  assert(is_same_reg(input.get(), branch->branch_delay.source.get()));
+  assert(is_same_reg(input, branch->branch_delay.source));
 
   if (b0_ir->forms.size() == 1) {
     // this is probably fine but happens to not occur in anything we try yet.
@@ -645,8 +643,8 @@ std::shared_ptr<IR> try_sc_as_abs(Function& f, LinkedObjectFile& file, ShortCirc
     // remove the branch
     b0_ir->forms.pop_back();
     // add the ash
-    b0_ir->forms.push_back(std::make_shared<IR_Set>(
-        IR_Set::REG_64, output, std::make_shared<IR_IntMath1>(IR_IntMath1::ABS, input)));
+    b0_ir->forms.push_back(make_ir<IR_Set>(
+        IR_Set::REG_64, output, make_ir<IR_IntMath1>(IR_IntMath1::ABS, input)));
     return b0_ptr;
   }
 
@@ -658,7 +656,7 @@ std::shared_ptr<IR> try_sc_as_abs(Function& f, LinkedObjectFile& file, ShortCirc
  * GOAL's shift function accepts positive/negative numbers to determine the direction
  * of the shift.
  */
-std::shared_ptr<IR> try_sc_as_ash(Function& f, LinkedObjectFile& file, ShortCircuit* vtx) {
+IR* try_sc_as_ash(Function& f, LinkedObjectFile& file, ShortCircuit* vtx) {
   if (vtx->entries.size() != 2) {
     return nullptr;
   }
@@ -672,16 +670,16 @@ std::shared_ptr<IR> try_sc_as_ash(Function& f, LinkedObjectFile& file, ShortCirc
 
   // todo, seems possible to be a single op instead of a begin...
   auto b0_ptr = cfg_to_ir(f, file, b0);
-  auto b0_ir = dynamic_cast<IR_Begin*>(b0_ptr.get());
+  auto b0_ir = ir_cast<IR_Begin>(b0_ptr);
 
   auto b1_ptr = cfg_to_ir(f, file, b1);
-  auto b1_ir = dynamic_cast<IR_Begin*>(b1_ptr.get());
+  auto b1_ir = ir_cast<IR_Begin>(b1_ptr);
 
   if (!b0_ir || !b1_ir) {
     return nullptr;
   }
 
-  auto branch = dynamic_cast<IR_Branch*>(b0_ir->forms.back().get());
+  auto branch = ir_cast<IR_Branch>(b0_ir->forms.back());
   if (!branch || b1_ir->forms.size() != 2) {
     return nullptr;
   }
@@ -700,11 +698,11 @@ std::shared_ptr<IR> try_sc_as_ash(Function& f, LinkedObjectFile& file, ShortCirc
       dsrav a0, a0, a1  ; a0 is both input and output here
    */
 
-  auto sa_in = dynamic_cast<IR_Register*>(branch->condition.src0.get());
+  auto sa_in = ir_cast<IR_Register>(branch->condition.src0);
   assert(sa_in);
-  auto result = dynamic_cast<IR_Register*>(branch->branch_delay.destination.get());
-  auto value_in = dynamic_cast<IR_Register*>(branch->branch_delay.source.get());
-  auto sa_in2 = dynamic_cast<IR_Register*>(branch->branch_delay.source2.get());
+  auto result = ir_cast<IR_Register>(branch->branch_delay.destination);
+  auto value_in = ir_cast<IR_Register>(branch->branch_delay.source);
+  auto sa_in2 = ir_cast<IR_Register>(branch->branch_delay.source2);
   assert(result && value_in && sa_in2);
   assert(sa_in->reg == sa_in2->reg);
 
@@ -712,36 +710,36 @@ std::shared_ptr<IR> try_sc_as_ash(Function& f, LinkedObjectFile& file, ShortCirc
   auto dsrav_candidate = b1_ir->forms.at(1);
 
   Register clobber;
-  //  if (!is_int_math_3(dsubu_candidate.get(), IR_IntMath2::SUB, {}, make_gpr(Reg::R0), sa_in->reg,
+  //  if (!is_int_math_3(dsubu_candidate, IR_IntMath2::SUB, {}, make_gpr(Reg::R0), sa_in->reg,
   //                     &clobber)) {
   //    return nullptr;
   //  }
-  if (!is_int_math_2(dsubu_candidate.get(), IR_IntMath1::NEG, {}, sa_in->reg, &clobber)) {
+  if (!is_int_math_2(dsubu_candidate, IR_IntMath1::NEG, {}, sa_in->reg, &clobber)) {
     return nullptr;
   }
 
   assert(result);
   assert(value_in);
 
-  bool is_arith = is_int_math_3(dsrav_candidate.get(), IR_IntMath2::RIGHT_SHIFT_ARITH, result->reg,
+  bool is_arith = is_int_math_3(dsrav_candidate, IR_IntMath2::RIGHT_SHIFT_ARITH, result->reg,
                                 value_in->reg, clobber);
-  bool is_logical = is_int_math_3(dsrav_candidate.get(), IR_IntMath2::RIGHT_SHIFT_LOGIC,
+  bool is_logical = is_int_math_3(dsrav_candidate, IR_IntMath2::RIGHT_SHIFT_LOGIC,
                                   result->reg, value_in->reg, clobber);
 
   if (!is_arith && !is_logical) {
     return nullptr;
   }
 
-  std::shared_ptr<IR> clobber_ir = nullptr;
-  auto dsubu_set = dynamic_cast<IR_Set*>(dsubu_candidate.get());
-  auto dsrav_set = dynamic_cast<IR_Set*>(dsrav_candidate.get());
+  IR* clobber_ir = nullptr;
+  auto dsubu_set = ir_cast<IR_Set>(dsubu_candidate);
+  auto dsrav_set = ir_cast<IR_Set>(dsrav_candidate);
   if (clobber != result->reg) {
     clobber_ir = dsubu_set->dst;
   }
 
-  std::shared_ptr<IR> dest_ir = branch->branch_delay.destination;
-  std::shared_ptr<IR> shift_ir = branch->condition.src0;
-  std::shared_ptr<IR> value_ir = dynamic_cast<IR_IntMath2*>(dsrav_set->src.get())->arg0;
+  IR* dest_ir = branch->branch_delay.destination;
+  IR* shift_ir = branch->condition.src0;
+  IR* value_ir = ir_cast<IR_IntMath2>(dsrav_set->src)->arg0;
   if (b0_ir->forms.size() == 1) {
     // this is probably fine but happens to not occur in anything we try yet.
     assert(false);
@@ -749,9 +747,9 @@ std::shared_ptr<IR> try_sc_as_ash(Function& f, LinkedObjectFile& file, ShortCirc
     // remove the branch
     b0_ir->forms.pop_back();
     // add the ash
-    b0_ir->forms.push_back(std::make_shared<IR_Set>(
+    b0_ir->forms.push_back(make_ir<IR_Set>(
         IR_Set::REG_64, dest_ir,
-        std::make_shared<IR_Ash>(shift_ir, value_ir, clobber_ir, is_arith)));
+        make_ir<IR_Ash>(shift_ir, value_ir, clobber_ir, is_arith)));
     return b0_ptr;
   }
 
@@ -762,7 +760,7 @@ std::shared_ptr<IR> try_sc_as_ash(Function& f, LinkedObjectFile& file, ShortCirc
  * Try to convert a short circuiting expression into a "type-of" expression.
  * We do this before attempting the normal and/or expressions.
  */
-std::shared_ptr<IR> try_sc_as_type_of(Function& f, LinkedObjectFile& file, ShortCircuit* vtx) {
+IR* try_sc_as_type_of(Function& f, LinkedObjectFile& file, ShortCircuit* vtx) {
   // the assembly looks like this:
   /*
          dsll32 v1, a0, 29                   ;; (set! v1 (shl a0 61))
@@ -791,38 +789,38 @@ std::shared_ptr<IR> try_sc_as_type_of(Function& f, LinkedObjectFile& file, Short
   }
 
   auto b0_ptr = cfg_to_ir(f, file, b0);
-  auto b0_ir = dynamic_cast<IR_Begin*>(b0_ptr.get());
+  auto b0_ir = ir_cast<IR_Begin>(b0_ptr);
 
   auto b1_ptr = cfg_to_ir(f, file, b1);
-  auto b1_ir = dynamic_cast<IR_Branch*>(b1_ptr.get());
+  auto b1_ir = ir_cast<IR_Branch>(b1_ptr);
 
   auto b2_ptr = cfg_to_ir(f, file, b2);
-  auto b2_ir = dynamic_cast<IR_Set*>(b2_ptr.get());
+  auto b2_ir = ir_cast<IR_Set>(b2_ptr);
   if (!b0_ir || !b1_ir || !b2_ir) {
     return nullptr;
   }
 
-  auto set_shift = dynamic_cast<IR_Set*>(b0_ir->forms.at(b0_ir->forms.size() - 2).get());
+  auto set_shift = ir_cast<IR_Set>(b0_ir->forms.at(b0_ir->forms.size() - 2));
   if (!set_shift) {
     return nullptr;
   }
 
-  auto temp_reg0 = dynamic_cast<IR_Register*>(set_shift->dst.get());
+  auto temp_reg0 = ir_cast<IR_Register>(set_shift->dst);
   if (!temp_reg0) {
     return nullptr;
   }
 
-  auto shift = dynamic_cast<IR_IntMath2*>(set_shift->src.get());
+  auto shift = ir_cast<IR_IntMath2>(set_shift->src);
   if (!shift || shift->kind != IR_IntMath2::LEFT_SHIFT) {
     return nullptr;
   }
-  auto src_reg = dynamic_cast<IR_Register*>(shift->arg0.get());
-  auto sa = dynamic_cast<IR_IntegerConstant*>(shift->arg1.get());
+  auto src_reg = ir_cast<IR_Register>(shift->arg0);
+  auto sa = ir_cast<IR_IntegerConstant>(shift->arg1);
   if (!src_reg || !sa || sa->value != 61) {
     return nullptr;
   }
 
-  auto first_branch = dynamic_cast<IR_Branch*>(b0_ir->forms.back().get());
+  auto first_branch = ir_cast<IR_Branch>(b0_ir->forms.back());
   auto second_branch = b1_ir;
   auto else_case = b2_ir;
 
@@ -830,10 +828,10 @@ std::shared_ptr<IR> try_sc_as_type_of(Function& f, LinkedObjectFile& file, Short
       first_branch->condition.kind != Condition::ZERO || !first_branch->likely) {
     return nullptr;
   }
-  auto temp_reg = dynamic_cast<IR_Register*>(first_branch->condition.src0.get());
+  auto temp_reg = ir_cast<IR_Register>(first_branch->condition.src0);
   assert(temp_reg);
   assert(temp_reg->reg == temp_reg0->reg);
-  auto dst_reg = dynamic_cast<IR_Register*>(first_branch->branch_delay.destination.get());
+  auto dst_reg = ir_cast<IR_Register>(first_branch->branch_delay.destination);
   assert(dst_reg);
 
   if (!second_branch || second_branch->branch_delay.kind != BranchDelay::SET_PAIR ||
@@ -843,24 +841,24 @@ std::shared_ptr<IR> try_sc_as_type_of(Function& f, LinkedObjectFile& file, Short
   }
 
   // check we agree on destination register.
-  auto dst_reg2 = dynamic_cast<IR_Register*>(second_branch->branch_delay.destination.get());
+  auto dst_reg2 = ir_cast<IR_Register>(second_branch->branch_delay.destination);
   assert(dst_reg2->reg == dst_reg->reg);
 
   // else case is a lwu to grab the type from a basic
   assert(else_case);
-  auto dst_reg3 = dynamic_cast<IR_Register*>(else_case->dst.get());
+  auto dst_reg3 = ir_cast<IR_Register>(else_case->dst);
   assert(dst_reg3);
   assert(dst_reg3->reg == dst_reg->reg);
-  auto load_op = dynamic_cast<IR_Load*>(else_case->src.get());
+  auto load_op = ir_cast<IR_Load>(else_case->src);
   if (!load_op || load_op->kind != IR_Load::UNSIGNED || load_op->size != 4) {
     return nullptr;
   }
-  auto load_loc = dynamic_cast<IR_IntMath2*>(load_op->location.get());
+  auto load_loc = ir_cast<IR_IntMath2>(load_op->location);
   if (!load_loc || load_loc->kind != IR_IntMath2::ADD) {
     return nullptr;
   }
-  auto src_reg3 = dynamic_cast<IR_Register*>(load_loc->arg0.get());
-  auto offset = dynamic_cast<IR_IntegerConstant*>(load_loc->arg1.get());
+  auto src_reg3 = ir_cast<IR_Register>(load_loc->arg0);
+  auto offset = ir_cast<IR_IntegerConstant>(load_loc->arg1);
   if (!src_reg3 || !offset) {
     return nullptr;
   }
@@ -868,36 +866,36 @@ std::shared_ptr<IR> try_sc_as_type_of(Function& f, LinkedObjectFile& file, Short
   assert(src_reg3->reg == src_reg->reg);
   assert(offset->value == -4);
 
-  std::shared_ptr<IR> clobber = nullptr;
+  IR* clobber = nullptr;
   if (temp_reg->reg != dst_reg->reg) {
     clobber = first_branch->condition.src0;
   }
   if (b0_ir->forms.size() == 2) {
-    return std::make_shared<IR_Set>(IR_Set::REG_64, else_case->dst,
-                                    std::make_shared<IR_GetRuntimeType>(shift->arg0, clobber));
+    return make_ir<IR_Set>(IR_Set::REG_64, else_case->dst,
+                           make_ir<IR_GetRuntimeType>(shift->arg0, clobber));
   } else {
     // remove the branch
     b0_ir->forms.pop_back();
     // remove the shift
     b0_ir->forms.pop_back();
     // add the type-of
-    b0_ir->forms.push_back(std::make_shared<IR_Set>(
-        IR_Set::REG_64, else_case->dst, std::make_shared<IR_GetRuntimeType>(shift->arg0, clobber)));
+    b0_ir->forms.push_back(make_ir<IR_Set>(
+        IR_Set::REG_64, else_case->dst, make_ir<IR_GetRuntimeType>(shift->arg0, clobber)));
     return b0_ptr;
   }
 }
 
-std::shared_ptr<IR> merge_cond_else_with_sc_cond(CondWithElse* cwe,
-                                                 const std::shared_ptr<IR>& else_ir,
-                                                 Function& f,
-                                                 LinkedObjectFile& file) {
-  auto as_seq = dynamic_cast<IR_Begin*>(else_ir.get());
+IR* merge_cond_else_with_sc_cond(CondWithElse* cwe,
+                                 IR* else_ir,
+                                 Function& f,
+                                 LinkedObjectFile& file) {
+  auto as_seq = ir_cast<IR_Begin>(else_ir);
   if (!as_seq || as_seq->forms.size() != 2) {
     return nullptr;
   }
 
-  auto first = dynamic_cast<IR_ShortCircuit*>(as_seq->forms.at(0).get());
-  auto second = dynamic_cast<IR_Cond*>(as_seq->forms.at(1).get());
+  auto first = ir_cast<IR_ShortCircuit>(as_seq->forms.at(0));
+  auto second = ir_cast<IR_Cond>(as_seq->forms.at(1));
   if (!first || !second) {
     return nullptr;
   }
@@ -910,7 +908,7 @@ std::shared_ptr<IR> merge_cond_else_with_sc_cond(CondWithElse* cwe,
     entries.push_back(std::move(e));
   }
 
-  auto first_condition = std::make_shared<IR_Begin>();
+  auto first_condition = make_ir<IR_Begin>();
   first_condition->forms.push_back(as_seq->forms.at(0));
   first_condition->forms.push_back(second->entries.front().condition);
 
@@ -919,7 +917,7 @@ std::shared_ptr<IR> merge_cond_else_with_sc_cond(CondWithElse* cwe,
   for (auto& x : second->entries) {
     entries.push_back(x);
   }
-  std::shared_ptr<IR> result = std::make_shared<IR_Cond>(entries);
+  IR* result = make_ir<IR_Cond>(entries);
   clean_up_cond_no_else(&result, file);
   return result;
 }
@@ -927,57 +925,56 @@ std::shared_ptr<IR> merge_cond_else_with_sc_cond(CondWithElse* cwe,
 /*!
  * Main CFG vertex to IR conversion.  Will pull basic IR ops from the provided function as needed.
  */
-std::shared_ptr<IR> cfg_to_ir(Function& f, LinkedObjectFile& file, CfgVtx* vtx) {
+IR* cfg_to_ir(Function& f, LinkedObjectFile& file, CfgVtx* vtx) {
   if (dynamic_cast<BlockVtx*>(vtx)) {
     auto* bv = dynamic_cast<BlockVtx*>(vtx);
     auto& block = f.basic_blocks.at(bv->block_id);
-    std::vector<std::shared_ptr<IR>> irs;
+    std::vector<IR*> irs;
     IR* last = nullptr;
     for (int instr = block.start_word; instr < block.end_word; instr++) {
       auto got = f.get_basic_op_at_instr(instr);
-      if (got.get() == last) {
+      if (got == last) {
         continue;
       }
-      last = got.get();
+      last = got;
       irs.push_back(got);
     }
 
     if (irs.size() == 1) {
       return irs.front();
     } else {
-      return std::make_shared<IR_Begin>(irs);
+      return make_ir<IR_Begin>(irs);
     }
 
   } else if (dynamic_cast<SequenceVtx*>(vtx)) {
     auto* sv = dynamic_cast<SequenceVtx*>(vtx);
 
-    std::vector<std::shared_ptr<IR>> irs;
+    std::vector<IR*> irs;
     insert_cfg_into_list(f, file, &irs, sv);
 
-    return std::make_shared<IR_Begin>(irs);
+    return make_ir<IR_Begin>(irs);
   } else if (dynamic_cast<WhileLoop*>(vtx)) {
     auto wvtx = dynamic_cast<WhileLoop*>(vtx);
-    auto result = std::make_shared<IR_WhileLoop>(cfg_to_ir(f, file, wvtx->condition),
-                                                 cfg_to_ir(f, file, wvtx->body));
+    auto result = make_ir<IR_WhileLoop>(cfg_to_ir(f, file, wvtx->condition),
+                                        cfg_to_ir(f, file, wvtx->body));
     return result;
   } else if (dynamic_cast<UntilLoop*>(vtx)) {
     auto wvtx = dynamic_cast<UntilLoop*>(vtx);
-    auto result = std::make_shared<IR_UntilLoop>(cfg_to_ir(f, file, wvtx->condition),
-                                                 cfg_to_ir(f, file, wvtx->body));
-    clean_up_until_loop(result.get());
+    auto result = make_ir<IR_UntilLoop>(cfg_to_ir(f, file, wvtx->condition),
+                                        cfg_to_ir(f, file, wvtx->body));
+    clean_up_until_loop(result);
     return result;
   } else if (dynamic_cast<UntilLoop_single*>(vtx)) {
     auto wvtx = dynamic_cast<UntilLoop_single*>(vtx);
-    auto result =
-        std::make_shared<IR_UntilLoop>(cfg_to_ir(f, file, wvtx->block), std::make_shared<IR_Nop>());
-    clean_up_until_loop(result.get());
+    auto result = make_ir<IR_UntilLoop>(cfg_to_ir(f, file, wvtx->block), make_ir<IR_Nop>());
+    clean_up_until_loop(result);
     return result;
   } else if (dynamic_cast<InfiniteLoopBlock*>(vtx)) {
     auto wvtx = dynamic_cast<InfiniteLoopBlock*>(vtx);
-    auto result = std::make_shared<IR_WhileLoop>(
-        std::make_shared<IR_Compare>(Condition(Condition::ALWAYS, nullptr, nullptr, nullptr)),
+    auto result = make_ir<IR_WhileLoop>(
+        make_ir<IR_Compare>(Condition(Condition::ALWAYS, nullptr, nullptr, nullptr)),
         cfg_to_ir(f, file, wvtx->block));
-    clean_up_infinite_while_loop(result.get());
+    clean_up_infinite_while_loop(result);
     return result;
   } else if (dynamic_cast<CondWithElse*>(vtx)) {
     auto* cvtx = dynamic_cast<CondWithElse*>(vtx);
@@ -994,8 +991,8 @@ std::shared_ptr<IR> cfg_to_ir(Function& f, LinkedObjectFile& file, CfgVtx* vtx)
       return fancy_compact_result;
     }
 
-    if (dynamic_cast<IR_Cond*>(else_ir.get())) {
-      auto extra_cond = dynamic_cast<IR_Cond*>(else_ir.get());
+    if (ir_cast<IR_Cond>(else_ir)) {
+      auto extra_cond = ir_cast<IR_Cond>(else_ir);
       std::vector<IR_Cond::Entry> entries;
       for (auto& x : cvtx->entries) {
         IR_Cond::Entry e;
@@ -1006,7 +1003,7 @@ std::shared_ptr<IR> cfg_to_ir(Function& f, LinkedObjectFile& file, CfgVtx* vtx)
       for (auto& x : extra_cond->entries) {
         entries.push_back(x);
       }
-      std::shared_ptr<IR> result = std::make_shared<IR_Cond>(entries);
+      IR* result = make_ir<IR_Cond>(entries);
       clean_up_cond_no_else(&result, file);
       return result;
     } else {
@@ -1017,7 +1014,7 @@ std::shared_ptr<IR> cfg_to_ir(Function& f, LinkedObjectFile& file, CfgVtx* vtx)
         e.body = cfg_to_ir(f, file, x.body);
         entries.push_back(std::move(e));
       }
-      std::shared_ptr<IR> result = std::make_shared<IR_CondWithElse>(entries, else_ir);
+      IR* result = make_ir<IR_CondWithElse>(entries, else_ir);
       clean_up_cond_with_else(&result, file);
       return result;
     }
@@ -1045,7 +1042,7 @@ std::shared_ptr<IR> cfg_to_ir(Function& f, LinkedObjectFile& file, CfgVtx* vtx)
       e.condition = cfg_to_ir(f, file, x);
       entries.push_back(e);
     }
-    auto result = std::make_shared<IR_ShortCircuit>(entries);
+    auto result = make_ir<IR_ShortCircuit>(entries);
     clean_up_sc(result, file);
     return result;
   } else if (dynamic_cast<CondNoElse*>(vtx)) {
@@ -1057,20 +1054,20 @@ std::shared_ptr<IR> cfg_to_ir(Function& f, LinkedObjectFile& file, CfgVtx* vtx)
       e.body = cfg_to_ir(f, file, x.body);
       entries.push_back(std::move(e));
     }
-    std::shared_ptr<IR> result = std::make_shared<IR_Cond>(entries);
+    IR* result = make_ir<IR_Cond>(entries);
     clean_up_cond_no_else(&result, file);
     return result;
   } else if (dynamic_cast<GotoEnd*>(vtx)) {
     auto* cvtx = dynamic_cast<GotoEnd*>(vtx);
-    auto result = std::make_shared<IR_Return>(cfg_to_ir(f, file, cvtx->body),
-                                              cfg_to_ir(f, file, cvtx->unreachable_block));
-    clean_up_return(result.get());
+    auto result = make_ir<IR_Return>(cfg_to_ir(f, file, cvtx->body),
+                                     cfg_to_ir(f, file, cvtx->unreachable_block));
+    clean_up_return(result);
     return result;
   } else if (dynamic_cast<Break*>(vtx)) {
     auto* cvtx = dynamic_cast<Break*>(vtx);
-    auto result = std::make_shared<IR_Break>(cfg_to_ir(f, file, cvtx->body),
-                                             cfg_to_ir(f, file, cvtx->unreachable_block));
-    clean_up_break(result.get());
+    auto result = make_ir<IR_Break>(cfg_to_ir(f, file, cvtx->body),
+                                    cfg_to_ir(f, file, cvtx->unreachable_block));
+    clean_up_break(result);
     return result;
   }
 
@@ -1087,10 +1084,10 @@ void clean_up_while_loops(IR_Begin* sequence, LinkedObjectFile& file) {
   (void)file;
   std::vector<size_t> to_remove;  // the list of branches to remove by index in this sequence
   for (size_t i = 0; i < sequence->forms.size(); i++) {
-    auto* form_as_while = dynamic_cast<IR_WhileLoop*>(sequence->forms.at(i).get());
+    auto* form_as_while = ir_cast<IR_WhileLoop>(sequence->forms.at(i));
     if (form_as_while && !form_as_while->cleaned) {
       assert(i != 0);
-      auto prev_as_branch = dynamic_cast<IR_Branch*>(sequence->forms.at(i - 1).get());
+      auto prev_as_branch = ir_cast<IR_Branch>(sequence->forms.at(i - 1));
       assert(prev_as_branch);
       // printf("got while intro branch %s\n", prev_as_branch->print(file).c_str());
       // this should be an always jump. We'll assume that the CFG builder successfully checked
@@ -1106,7 +1103,7 @@ void clean_up_while_loops(IR_Begin* sequence, LinkedObjectFile& file) {
       assert(condition_branch.first);
       assert(condition_branch.first->branch_delay.kind == BranchDelay::NOP);
       // printf("got while condition branch %s\n", condition_branch.first->print(file).c_str());
-      auto replacement = std::make_shared<IR_Compare>(condition_branch.first->condition);
+      auto replacement = make_ir<IR_Compare>(condition_branch.first->condition);
       *(condition_branch.second) = replacement;
     }
   }
@@ -1114,7 +1111,7 @@ void clean_up_while_loops(IR_Begin* sequence, LinkedObjectFile& file) {
   // remove the implied forward always branches.
   for (int i = int(to_remove.size()); i-- > 0;) {
     auto idx = to_remove.at(i);
-    assert(dynamic_cast<IR_Branch*>(sequence->forms.at(idx).get()));
+    assert(ir_cast<IR_Branch>(sequence->forms.at(idx)));
     sequence->forms.erase(sequence->forms.begin() + idx);
   }
 }
@@ -1125,27 +1122,27 @@ void clean_up_while_loops(IR_Begin* sequence, LinkedObjectFile& file) {
  * This should be done after basic ops are added and before typing, variable splitting, and
  * expression compaction.
  */
-std::shared_ptr<IR> build_cfg_ir(Function& function,
-                                 ControlFlowGraph& cfg,
-                                 LinkedObjectFile& file) {
+IR* build_cfg_ir(Function& function, ControlFlowGraph& cfg, LinkedObjectFile& file) {
   //  printf("build cfg ir\n");
   if (!cfg.is_fully_resolved()) {
     return nullptr;
   }
 
+  IR_ArenaScope arena_scope(function.ir_arena.get());
+
   try {
     auto top_level = cfg.get_single_top_level();
     // and possibly annotate the IR control flow structure so that we can determine if its and/or
     // or whatever. This may require rejecting a huge number of inline assembly functions, and
     // possibly resolving the min/max/ash issue.
     // auto ir = cfg_to_ir(function, file, top_level);
-    auto ir = std::make_shared<IR_Begin>();
+    auto ir = make_ir<IR_Begin>();
     insert_cfg_into_list(function, file, &ir->forms, top_level);
     auto all_children = ir->get_all_ir(file);
     all_children.push_back(ir);
     for (auto& child : all_children) {
       //      printf("child is %s\n", child->print(file).c_str());
-      auto as_begin = dynamic_cast<IR_Begin*>(child.get());
+      auto as_begin = ir_cast<IR_Begin>(child);
       if (as_begin) {
         clean_up_while_loops(as_begin, file);
       }
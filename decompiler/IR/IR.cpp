@@ -2,9 +2,26 @@
 #include "decompiler/ObjectFile/LinkedObjectFile.h"
 #include "common/goos/PrettyPrinter.h"
 
-std::vector<std::shared_ptr<IR>> IR::get_all_ir(LinkedObjectFile& file) const {
+namespace {
+thread_local Arena* current_arena = nullptr;
+}
+
+IR_ArenaScope::IR_ArenaScope(Arena* arena) : m_prev(current_arena) {
+  current_arena = arena;
+}
+
+IR_ArenaScope::~IR_ArenaScope() {
+  current_arena = m_prev;
+}
+
+Arena* current_ir_arena() {
+  assert(current_arena);
+  return current_arena;
+}
+
+std::vector<IR*> IR::get_all_ir(LinkedObjectFile& file) const {
   (void)file;
-  std::vector<std::shared_ptr<IR>> result;
+  std::vector<IR*> result;
   get_children(&result);
   size_t last_checked = 0;
   size_t last_last_checked = -1;
@@ -13,7 +30,7 @@ std::vector<std::shared_ptr<IR>> IR::get_all_ir(LinkedObjectFile& file) const {
     last_last_checked = last_checked;
     auto end_of_check = result.size();
     for (size_t i = last_checked; i < end_of_check; i++) {
-      auto it = result.at(i).get();
+      auto it = result.at(i);
       assert(it);
       it->get_children(&result);
     }
@@ -39,7 +56,7 @@ goos::Object IR_Failed::to_form(const LinkedObjectFile& file) const {
   return pretty_print::build_list("INVALID-OPERATION");
 }
 
-void IR_Failed::get_children(std::vector<std::shared_ptr<IR>>* output) const {
+void IR_Failed::get_children(std::vector<IR*>* output) const {
   (void)output;
 }
 
@@ -48,7 +65,7 @@ goos::Object IR_Register::to_form(const LinkedObjectFile& file) const {
   return pretty_print::to_symbol(reg.to_charp());
 }
 
-void IR_Register::get_children(std::vector<std::shared_ptr<IR>>* output) const {
+void IR_Register::get_children(std::vector<IR*>* output) const {
   (void)output;
 }
 
@@ -57,7 +74,7 @@ goos::Object IR_Set::to_form(const LinkedObjectFile& file) const {
                                   src->to_form(file));
 }
 
-void IR_Set::get_children(std::vector<std::shared_ptr<IR>>* output) const {
+void IR_Set::get_children(std::vector<IR*>* output) const {
   // note that we are not returning clobber here because it shouldn't contain anything that
   // the IR simplification code should touch.
   output->push_back(dst);
@@ -104,7 +121,7 @@ goos::Object IR_Symbol::to_form(const LinkedObjectFile& file) const {
   return pretty_print::to_symbol("'" + name);
 }
 
-void IR_Symbol::get_children(std::vector<std::shared_ptr<IR>>* output) const {
+void IR_Symbol::get_children(std::vector<IR*>* output) const {
   (void)output;
 }
 
@@ -113,7 +130,7 @@ goos::Object IR_SymbolValue::to_form(const LinkedObjectFile& file) const {
   return pretty_print::to_symbol(name);
 }
 
-void IR_SymbolValue::get_children(std::vector<std::shared_ptr<IR>>* output) const {
+void IR_SymbolValue::get_children(std::vector<IR*>* output) const {
   (void)output;
 }
 
@@ -122,7 +139,7 @@ goos::Object IR_StaticAddress::to_form(const LinkedObjectFile& file) const {
   return pretty_print::to_symbol(file.get_label_name(label_id));
 }
 
-void IR_StaticAddress::get_children(std::vector<std::shared_ptr<IR>>* output) const {
+void IR_StaticAddress::get_children(std::vector<IR*>* output) const {
   (void)output;
 }
 
@@ -174,7 +191,7 @@ goos::Object IR_Load::to_form(const LinkedObjectFile& file) const {
   return pretty_print::build_list(pretty_print::to_symbol(load_operator), location->to_form(file));
 }
 
-void IR_Load::get_children(std::vector<std::shared_ptr<IR>>* output) const {
+void IR_Load::get_children(std::vector<IR*>* output) const {
   output->push_back(location);
 }
 
@@ -207,12 +224,12 @@ goos::Object IR_FloatMath2::to_form(const LinkedObjectFile& file) const {
                                   arg1->to_form(file));
 }
 
-void IR_FloatMath2::get_children(std::vector<std::shared_ptr<IR>>* output) const {
+void IR_FloatMath2::get_children(std::vector<IR*>* output) const {
   output->push_back(arg0);
   output->push_back(arg1);
 }
 
-void IR_FloatMath1::get_children(std::vector<std::shared_ptr<IR>>* output) const {
+void IR_FloatMath1::get_children(std::vector<IR*>* output) const {
   output->push_back(arg);
 }
 
@@ -277,7 +294,7 @@ goos::Object IR_IntMath2::to_form(const LinkedObjectFile& file) const {
                                   arg1->to_form(file));
 }
 
-void IR_IntMath2::get_children(std::vector<std::shared_ptr<IR>>* output) const {
+void IR_IntMath2::get_children(std::vector<IR*>* output) const {
   output->push_back(arg0);
   output->push_back(arg1);
 }
@@ -300,7 +317,7 @@ goos::Object IR_IntMath1::to_form(const LinkedObjectFile& file) const {
   return pretty_print::build_list(pretty_print::to_symbol(math_operator), arg->to_form(file));
 }
 
-void IR_IntMath1::get_children(std::vector<std::shared_ptr<IR>>* output) const {
+void IR_IntMath1::get_children(std::vector<IR*>* output) const {
   output->push_back(arg);
 }
 
@@ -333,7 +350,7 @@ goos::Object IR_Call::to_form(const LinkedObjectFile& file) const {
   return pretty_print::build_list("call!");
 }
 
-void IR_Call::get_children(std::vector<std::shared_ptr<IR>>* output) const {
+void IR_Call::get_children(std::vector<IR*>* output) const {
   (void)output;
 }
 
@@ -342,7 +359,7 @@ goos::Object IR_IntegerConstant::to_form(const LinkedObjectFile& file) const {
   return pretty_print::to_symbol(std::to_string(value));
 }
 
-void IR_IntegerConstant::get_children(std::vector<std::shared_ptr<IR>>* output) const {
+void IR_IntegerConstant::get_children(std::vector<IR*>* output) const {
   (void)output;
 }
 
@@ -381,7 +398,7 @@ goos::Object BranchDelay::to_form(const LinkedObjectFile& file) const {
   }
 }
 
-void BranchDelay::get_children(std::vector<std::shared_ptr<IR>>* output) const {
+void BranchDelay::get_children(std::vector<IR*>* output) const {
   if (destination) {
     output->push_back(destination);
   }
@@ -436,7 +453,7 @@ int Condition::num_args() const {
   }
 }
 
-void Condition::get_children(std::vector<std::shared_ptr<IR>>* output) const {
+void Condition::get_children(std::vector<IR*>* output) const {
   if (src0) {
     output->push_back(src0);
   }
@@ -640,7 +657,7 @@ goos::Object IR_Branch::to_form(const LinkedObjectFile& file) const {
       pretty_print::to_symbol(file.get_label_name(dest_label_idx)), branch_delay.to_form(file));
 }
 
-void IR_Branch::get_children(std::vector<std::shared_ptr<IR>>* output) const {
+void IR_Branch::get_children(std::vector<IR*>* output) const {
   condition.get_children(output);
   branch_delay.get_children(output);
 }
@@ -649,7 +666,7 @@ goos::Object IR_Compare::to_form(const LinkedObjectFile& file) const {
   return condition.to_form(file);
 }
 
-void IR_Compare::get_children(std::vector<std::shared_ptr<IR>>* output) const {
+void IR_Compare::get_children(std::vector<IR*>* output) const {
   condition.get_children(output);
 }
 
@@ -658,11 +675,11 @@ goos::Object IR_Suspend::to_form(const LinkedObjectFile& file) const {
   return pretty_print::build_list("suspend!");
 }
 
-void IR_Nop::get_children(std::vector<std::shared_ptr<IR>>* output) const {
+void IR_Nop::get_children(std::vector<IR*>* output) const {
   (void)output;
 }
 
-void IR_Suspend::get_children(std::vector<std::shared_ptr<IR>>* output) const {
+void IR_Suspend::get_children(std::vector<IR*>* output) const {
   (void)output;
 }
 
@@ -675,7 +692,7 @@ goos::Object IR_Begin::to_form(const LinkedObjectFile& file) const {
   return pretty_print::build_list(list);
 }
 
-void IR_Begin::get_children(std::vector<std::shared_ptr<IR>>* output) const {
+void IR_Begin::get_children(std::vector<IR*>* output) const {
   for (auto& x : forms) {
     output->push_back(x);
   }
@@ -683,7 +700,7 @@ void IR_Begin::get_children(std::vector<std::shared_ptr<IR>>* output) const {
 
 namespace {
 void print_inlining_begin(std::vector<goos::Object>* output, IR* ir, const LinkedObjectFile& file) {
-  auto as_begin = dynamic_cast<IR_Begin*>(ir);
+  auto as_begin = ir_cast<IR_Begin>(ir);
   if (as_begin) {
     for (auto& x : as_begin->forms) {
       output->push_back(x->to_form(file));
@@ -694,7 +711,7 @@ void print_inlining_begin(std::vector<goos::Object>* output, IR* ir, const Linke
 }
 
 bool is_single_expression(IR* in) {
-  return !dynamic_cast<IR_Begin*>(in);
+  return !ir_cast<IR_Begin>(in);
 }
 }  // namespace
 
@@ -702,11 +719,11 @@ goos::Object IR_WhileLoop::to_form(const LinkedObjectFile& file) const {
   std::vector<goos::Object> list;
   list.push_back(pretty_print::to_symbol("while"));
   list.push_back(condition->to_form(file));
-  print_inlining_begin(&list, body.get(), file);
+  print_inlining_begin(&list, body, file);
   return pretty_print::build_list(list);
 }
 
-void IR_WhileLoop::get_children(std::vector<std::shared_ptr<IR>>* output) const {
+void IR_WhileLoop::get_children(std::vector<IR*>* output) const {
   output->push_back(condition);
   output->push_back(body);
 }
@@ -715,11 +732,11 @@ goos::Object IR_UntilLoop::to_form(const LinkedObjectFile& file) const {
   std::vector<goos::Object> list;
   list.push_back(pretty_print::to_symbol("until"));
   list.push_back(condition->to_form(file));
-  print_inlining_begin(&list, body.get(), file);
+  print_inlining_begin(&list, body, file);
   return pretty_print::build_list(list);
 }
 
-void IR_UntilLoop::get_children(std::vector<std::shared_ptr<IR>>* output) const {
+void IR_UntilLoop::get_children(std::vector<IR*>* output) const {
   output->push_back(condition);
   output->push_back(body);
 }
@@ -727,8 +744,8 @@ void IR_UntilLoop::get_children(std::vector<std::shared_ptr<IR>>* output) const
 goos::Object IR_CondWithElse::to_form(const LinkedObjectFile& file) const {
   // for now we only turn it into an if statement if both cases won't require a begin at the top
   // level. I think it is more common to write these as a two-case cond instead of an if with begin.
-  if (entries.size() == 1 && is_single_expression(entries.front().body.get()) &&
-      is_single_expression(else_ir.get())) {
+  if (entries.size() == 1 && is_single_expression(entries.front().body) &&
+      is_single_expression(else_ir)) {
     std::vector<goos::Object> list;
     list.push_back(pretty_print::to_symbol("if"));
     list.push_back(entries.front().condition->to_form(file));
@@ -741,18 +758,18 @@ goos::Object IR_CondWithElse::to_form(const LinkedObjectFile& file) const {
     for (auto& e : entries) {
       std::vector<goos::Object> entry;
       entry.push_back(e.condition->to_form(file));
-      print_inlining_begin(&entry, e.body.get(), file);
+      print_inlining_begin(&entry, e.body, file);
       list.push_back(pretty_print::build_list(entry));
     }
     std::vector<goos::Object> else_form;
     else_form.push_back(pretty_print::to_symbol("else"));
-    print_inlining_begin(&else_form, else_ir.get(), file);
+    print_inlining_begin(&else_form, else_ir, file);
     list.push_back(pretty_print::build_list(else_form));
     return pretty_print::build_list(list);
   }
 }
 
-void IR_CondWithElse::get_children(std::vector<std::shared_ptr<IR>>* output) const {
+void IR_CondWithElse::get_children(std::vector<IR*>* output) const {
   for (auto& e : entries) {
     output->push_back(e.condition);
     output->push_back(e.body);
@@ -765,12 +782,12 @@ goos::Object IR_GetRuntimeType::to_form(const LinkedObjectFile& file) const {
   return pretty_print::build_list(list);
 }
 
-void IR_GetRuntimeType::get_children(std::vector<std::shared_ptr<IR>>* output) const {
+void IR_GetRuntimeType::get_children(std::vector<IR*>* output) const {
   output->push_back(object);
 }
 
 goos::Object IR_Cond::to_form(const LinkedObjectFile& file) const {
-  if (entries.size() == 1 && is_single_expression(entries.front().body.get())) {
+  if (entries.size() == 1 && is_single_expression(entries.front().body)) {
     // print as an if statement if we can put the body in a single form.
     std::vector<goos::Object> list;
     list.push_back(pretty_print::to_symbol("if"));
@@ -784,7 +801,7 @@ goos::Object IR_Cond::to_form(const LinkedObjectFile& file) const {
     std::vector<goos::Object> list;
     list.push_back(pretty_print::to_symbol("when"));
     list.push_back(entries.front().condition->to_form(file));
-    print_inlining_begin(&list, entries.front().body.get(), file);
+    print_inlining_begin(&list, entries.front().body, file);
     return pretty_print::build_list(list);
   } else {
     std::vector<goos::Object> list;
@@ -792,14 +809,14 @@ goos::Object IR_Cond::to_form(const LinkedObjectFile& file) const {
     for (auto& e : entries) {
       std::vector<goos::Object> entry;
       entry.push_back(e.condition->to_form(file));
-      print_inlining_begin(&entry, e.body.get(), file);
+      print_inlining_begin(&entry, e.body, file);
       list.push_back(pretty_print::build_list(entry));
     }
     return pretty_print::build_list(list);
   }
 }
 
-void IR_Cond::get_children(std::vector<std::shared_ptr<IR>>* output) const {
+void IR_Cond::get_children(std::vector<IR*>* output) const {
   for (auto& e : entries) {
     output->push_back(e.condition);
     output->push_back(e.body);
@@ -827,7 +844,7 @@ goos::Object IR_ShortCircuit::to_form(const LinkedObjectFile& file) const {
   return pretty_print::build_list(forms);
 }
 
-void IR_ShortCircuit::get_children(std::vector<std::shared_ptr<IR>>* output) const {
+void IR_ShortCircuit::get_children(std::vector<IR*>* output) const {
   for (auto& x : entries) {
     output->push_back(x.condition);
     if (x.output) {
@@ -841,7 +858,7 @@ goos::Object IR_Ash::to_form(const LinkedObjectFile& file) const {
                                   value->to_form(file), shift_amount->to_form(file));
 }
 
-void IR_Ash::get_children(std::vector<std::shared_ptr<IR>>* output) const {
+void IR_Ash::get_children(std::vector<IR*>* output) const {
   output->push_back(value);
   output->push_back(shift_amount);
 }
@@ -857,7 +874,7 @@ goos::Object IR_AsmOp::to_form(const LinkedObjectFile& file) const {
   return pretty_print::build_list(forms);
 }
 
-void IR_AsmOp::get_children(std::vector<std::shared_ptr<IR>>* output) const {
+void IR_AsmOp::get_children(std::vector<IR*>* output) const {
   for (auto& x : {dst, src0, src1}) {
     if (x) {
       output->push_back(x);
@@ -871,7 +888,7 @@ goos::Object IR_CMoveF::to_form(const LinkedObjectFile& file) const {
       src->to_form(file));
 }
 
-void IR_CMoveF::get_children(std::vector<std::shared_ptr<IR>>* output) const {
+void IR_CMoveF::get_children(std::vector<IR*>* output) const {
   output->push_back(src);
 }
 
@@ -887,7 +904,7 @@ goos::Object IR_AsmReg::to_form(const LinkedObjectFile& file) const {
   }
 }
 
-void IR_AsmReg::get_children(std::vector<std::shared_ptr<IR>>* output) const {
+void IR_AsmReg::get_children(std::vector<IR*>* output) const {
   (void)output;
 }
 
@@ -899,7 +916,7 @@ goos::Object IR_Return::to_form(const LinkedObjectFile& file) const {
   return pretty_print::build_list(forms);
 }
 
-void IR_Return::get_children(std::vector<std::shared_ptr<IR>>* output) const {
+void IR_Return::get_children(std::vector<IR*>* output) const {
   output->push_back(return_code);
   output->push_back(dead_code);
 }
@@ -912,7 +929,7 @@ goos::Object IR_Break::to_form(const LinkedObjectFile& file) const {
   return pretty_print::build_list(forms);
 }
 
-void IR_Break::get_children(std::vector<std::shared_ptr<IR>>* output) const {
+void IR_Break::get_children(std::vector<IR*>* output) const {
   output->push_back(return_code);
   output->push_back(dead_code);
 }
\ No newline at end of file
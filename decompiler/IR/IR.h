@@ -2,10 +2,11 @@
 #define JAK_IR_H
 
 #include <cassert>
+#include <cstdint>
 #include <utility>
-#include <memory>
-#include <unordered_map>
 #include "decompiler/Disasm/Register.h"
+#include "decompiler/util/Arena.h"
+#include "decompiler/util/TypeMap.h"
 #include "common/type_system/TypeSpec.h"
 
 class LinkedObjectFile;
@@ -15,15 +16,55 @@ namespace goos {
 class Object;
 }
 
-// Map of what type is in each register.
-using TypeMap = std::unordered_map<Register, TypeSpec, Register::hash>;
-
+/*!
+ * Which IR_ class an IR is. Each class has its own KIND, which is stored in the IR so ir_cast can
+ * check it without RTTI.
+ */
+enum class IRKind : uint8_t {
+  FAILED,
+  REGISTER,
+  SET,
+  STORE,
+  SYMBOL,
+  SYMBOL_VALUE,
+  STATIC_ADDRESS,
+  LOAD,
+  FLOAT_MATH_2,
+  FLOAT_MATH_1,
+  INT_MATH_2,
+  INT_MATH_1,
+  CALL,
+  INTEGER_CONSTANT,
+  BRANCH,
+  COMPARE,
+  NOP,
+  SUSPEND,
+  BEGIN,
+  WHILE_LOOP,
+  UNTIL_LOOP,
+  COND_WITH_ELSE,
+  COND,
+  GET_RUNTIME_TYPE,
+  SHORT_CIRCUIT,
+  ASH,
+  ASM_OP,
+  CMOVE_F,
+  ASM_REG,
+  RETURN,
+  BREAK
+};
+
+/*!
+ * A node of the IR. These are created with make_ir, and are owned by the arena of the function
+ * they were created for, so they are referred to by plain pointers and may be shared.
+ */
 class IR {
  public:
+  explicit IR(IRKind _ir_kind) : ir_kind(_ir_kind) {}
   virtual goos::Object to_form(const LinkedObjectFile& file) const = 0;
-  std::vector<std::shared_ptr<IR>> get_all_ir(LinkedObjectFile& file) const;
+  std::vector<IR*> get_all_ir(LinkedObjectFile& file) const;
   std::string print(const LinkedObjectFile& file) const;
-  virtual void get_children(std::vector<std::shared_ptr<IR>>* output) const = 0;
+  virtual void get_children(std::vector<IR*>* output) const = 0;
   virtual bool update_types(TypeMap& reg_types,
                             DecompilerTypeSystem& dts,
                             LinkedObjectFile& file) const;
@@ -32,21 +73,24 @@ class IR {
                                 LinkedObjectFile& file,
                                 TypeSpec* out) const;
 
+  const IRKind ir_kind;
   bool is_basic_op = false;
 };
 
 class IR_Failed : public IR {
  public:
-  IR_Failed() = default;
+  static constexpr IRKind KIND = IRKind::FAILED;
+  IR_Failed() : IR(KIND) {}
   goos::Object to_form(const LinkedObjectFile& file) const override;
-  void get_children(std::vector<std::shared_ptr<IR>>* output) const override;
+  void get_children(std::vector<IR*>* output) const override;
 };
 
 class IR_Register : public IR {
  public:
-  IR_Register(Register _reg, int _instr_idx) : reg(_reg), instr_idx(_instr_idx) {}
+  static constexpr IRKind KIND = IRKind::REGISTER;
+  IR_Register(Register _reg, int _instr_idx) : IR(KIND), reg(_reg), instr_idx(_instr_idx) {}
   goos::Object to_form(const LinkedObjectFile& file) const override;
-  void get_children(std::vector<std::shared_ptr<IR>>* output) const override;
+  void get_children(std::vector<IR*>* output) const override;
   bool get_type_of_expr(const TypeMap& reg_types,
                         DecompilerTypeSystem& dts,
                         LinkedObjectFile& file,
@@ -57,6 +101,7 @@ class IR_Register : public IR {
 
 class IR_Set : public IR {
  public:
+  static constexpr IRKind KIND = IRKind::SET;
   enum Kind {
     REG_64,
     LOAD,
@@ -68,32 +113,38 @@ class IR_Set : public IR {
     REG_FLT,
     REG_I128
   } kind;
-  IR_Set(Kind _kind, std::shared_ptr<IR> _dst, std::shared_ptr<IR> _src)
-      : kind(_kind), dst(std::move(_dst)), src(std::move(_src)) {}
+  IR_Set(Kind _kind, IR* _dst, IR* _src) : IR_Set(KIND, _kind, _dst, _src) {}
   goos::Object to_form(const LinkedObjectFile& file) const override;
-  void get_children(std::vector<std::shared_ptr<IR>>* output) const override;
+  void get_children(std::vector<IR*>* output) const override;
   bool update_types(TypeMap& reg_types,
                     DecompilerTypeSystem& dts,
                     LinkedObjectFile& file) const override;
-  std::shared_ptr<IR> dst, src;
-  std::shared_ptr<IR> clobber = nullptr;
+  IR* dst = nullptr;
+  IR* src = nullptr;
+  IR* clobber = nullptr;
+
+ protected:
+  IR_Set(IRKind _ir_kind, Kind _kind, IR* _dst, IR* _src)
+      : IR(_ir_kind), kind(_kind), dst(_dst), src(_src) {}
 };
 
 class IR_Store : public IR_Set {
  public:
+  static constexpr IRKind KIND = IRKind::STORE;
   enum Kind { INTEGER, FLOAT } kind;
-  IR_Store(Kind _kind, std::shared_ptr<IR> _dst, std::shared_ptr<IR> _src, int _size)
-      : IR_Set(IR_Set::LOAD, std::move(_dst), std::move(_src)), kind(_kind), size(_size) {}
+  IR_Store(Kind _kind, IR* _dst, IR* _src, int _size)
+      : IR_Set(KIND, IR_Set::LOAD, _dst, _src), kind(_kind), size(_size) {}
   int size;
   goos::Object to_form(const LinkedObjectFile& file) const override;
 };
 
 class IR_Symbol : public IR {
  public:
-  explicit IR_Symbol(std::string _name) : name(std::move(_name)) {}
+  static constexpr IRKind KIND = IRKind::SYMBOL;
+  explicit IR_Symbol(std::string _name) : IR(KIND), name(std::move(_name)) {}
   std::string name;
   goos::Object to_form(const LinkedObjectFile& file) const override;
-  void get_children(std::vector<std::shared_ptr<IR>>* output) const override;
+  void get_children(std::vector<IR*>* output) const override;
   bool get_type_of_expr(const TypeMap& reg_types,
                         DecompilerTypeSystem& dts,
                         LinkedObjectFile& file,
@@ -102,10 +153,11 @@ class IR_Symbol : public IR {
 
 class IR_SymbolValue : public IR {
  public:
-  explicit IR_SymbolValue(std::string _name) : name(std::move(_name)) {}
+  static constexpr IRKind KIND = IRKind::SYMBOL_VALUE;
+  explicit IR_SymbolValue(std::string _name) : IR(KIND), name(std::move(_name)) {}
   std::string name;
   goos::Object to_form(const LinkedObjectFile& file) const override;
-  void get_children(std::vector<std::shared_ptr<IR>>* output) const override;
+  void get_children(std::vector<IR*>* output) const override;
   bool get_type_of_expr(const TypeMap& reg_types,
                         DecompilerTypeSystem& dts,
                         LinkedObjectFile& file,
@@ -114,22 +166,24 @@ class IR_SymbolValue : public IR {
 
 class IR_StaticAddress : public IR {
  public:
-  explicit IR_StaticAddress(int _label_id) : label_id(_label_id) {}
+  static constexpr IRKind KIND = IRKind::STATIC_ADDRESS;
+  explicit IR_StaticAddress(int _label_id) : IR(KIND), label_id(_label_id) {}
   int label_id = -1;
   goos::Object to_form(const LinkedObjectFile& file) const override;
-  void get_children(std::vector<std::shared_ptr<IR>>* output) const override;
+  void get_children(std::vector<IR*>* output) const override;
 };
 
 class IR_Load : public IR {
  public:
+  static constexpr IRKind KIND = IRKind::LOAD;
   enum Kind { UNSIGNED, SIGNED, FLOAT } kind;
 
-  IR_Load(Kind _kind, int _size, std::shared_ptr<IR> _location)
-      : kind(_kind), size(_size), location(std::move(_location)) {}
+  IR_Load(Kind _kind, int _size, IR* _location)
+      : IR(KIND), kind(_kind), size(_size), location(_location) {}
   int size;
-  std::shared_ptr<IR> location;
+  IR* location;
   goos::Object to_form(const LinkedObjectFile& file) const override;
-  void get_children(std::vector<std::shared_ptr<IR>>* output) const override;
+  void get_children(std::vector<IR*>* output) const override;
   bool get_type_of_expr(const TypeMap& reg_types,
                         DecompilerTypeSystem& dts,
                         LinkedObjectFile& file,
@@ -138,12 +192,14 @@ class IR_Load : public IR {
 
 class IR_FloatMath2 : public IR {
  public:
+  static constexpr IRKind KIND = IRKind::FLOAT_MATH_2;
   enum Kind { DIV, MUL, ADD, SUB, MIN, MAX } kind;
-  IR_FloatMath2(Kind _kind, std::shared_ptr<IR> _arg0, std::shared_ptr<IR> _arg1)
-      : kind(_kind), arg0(std::move(_arg0)), arg1(std::move(_arg1)) {}
-  std::shared_ptr<IR> arg0, arg1;
+  IR_FloatMath2(Kind _kind, IR* _arg0, IR* _arg1)
+      : IR(KIND), kind(_kind), arg0(_arg0), arg1(_arg1) {}
+  IR* arg0 = nullptr;
+  IR* arg1 = nullptr;
   goos::Object to_form(const LinkedObjectFile& file) const override;
-  void get_children(std::vector<std::shared_ptr<IR>>* output) const override;
+  void get_children(std::vector<IR*>* output) const override;
   bool get_type_of_expr(const TypeMap& reg_types,
                         DecompilerTypeSystem& dts,
                         LinkedObjectFile& file,
@@ -152,15 +208,17 @@ class IR_FloatMath2 : public IR {
 
 class IR_FloatMath1 : public IR {
  public:
+  static constexpr IRKind KIND = IRKind::FLOAT_MATH_1;
   enum Kind { FLOAT_TO_INT, INT_TO_FLOAT, ABS, NEG, SQRT } kind;
-  IR_FloatMath1(Kind _kind, std::shared_ptr<IR> _arg) : kind(_kind), arg(std::move(_arg)) {}
-  std::shared_ptr<IR> arg;
+  IR_FloatMath1(Kind _kind, IR* _arg) : IR(KIND), kind(_kind), arg(_arg) {}
+  IR* arg;
   goos::Object to_form(const LinkedObjectFile& file) const override;
-  void get_children(std::vector<std::shared_ptr<IR>>* output) const override;
+  void get_children(std::vector<IR*>* output) const override;
 };
 
 class IR_IntMath2 : public IR {
  public:
+  static constexpr IRKind KIND = IRKind::INT_MATH_2;
   enum Kind {
     ADD,
     SUB,
@@ -180,11 +238,12 @@ class IR_IntMath2 : public IR {
     MIN_SIGNED,
     MAX_SIGNED
   } kind;
-  IR_IntMath2(Kind _kind, std::shared_ptr<IR> _arg0, std::shared_ptr<IR> _arg1)
-      : kind(_kind), arg0(std::move(_arg0)), arg1(std::move(_arg1)) {}
-  std::shared_ptr<IR> arg0, arg1;
+  IR_IntMath2(Kind _kind, IR* _arg0, IR* _arg1)
+      : IR(KIND), kind(_kind), arg0(_arg0), arg1(_arg1) {}
+  IR* arg0 = nullptr;
+  IR* arg1 = nullptr;
   goos::Object to_form(const LinkedObjectFile& file) const override;
-  void get_children(std::vector<std::shared_ptr<IR>>* output) const override;
+  void get_children(std::vector<IR*>* output) const override;
   bool get_type_of_expr(const TypeMap& reg_types,
                         DecompilerTypeSystem& dts,
                         LinkedObjectFile& file,
@@ -193,11 +252,12 @@ class IR_IntMath2 : public IR {
 
 class IR_IntMath1 : public IR {
  public:
+  static constexpr IRKind KIND = IRKind::INT_MATH_1;
   enum Kind { NOT, ABS, NEG } kind;
-  IR_IntMath1(Kind _kind, std::shared_ptr<IR> _arg) : kind(_kind), arg(std::move(_arg)) {}
-  std::shared_ptr<IR> arg;
+  IR_IntMath1(Kind _kind, IR* _arg) : IR(KIND), kind(_kind), arg(_arg) {}
+  IR* arg;
   goos::Object to_form(const LinkedObjectFile& file) const override;
-  void get_children(std::vector<std::shared_ptr<IR>>* output) const override;
+  void get_children(std::vector<IR*>* output) const override;
   bool get_type_of_expr(const TypeMap& reg_types,
                         DecompilerTypeSystem& dts,
                         LinkedObjectFile& file,
@@ -206,17 +266,19 @@ class IR_IntMath1 : public IR {
 
 class IR_Call : public IR {
  public:
-  IR_Call() = default;
+  static constexpr IRKind KIND = IRKind::CALL;
+  IR_Call() : IR(KIND) {}
   goos::Object to_form(const LinkedObjectFile& file) const override;
-  void get_children(std::vector<std::shared_ptr<IR>>* output) const override;
+  void get_children(std::vector<IR*>* output) const override;
 };
 
 class IR_IntegerConstant : public IR {
  public:
+  static constexpr IRKind KIND = IRKind::INTEGER_CONSTANT;
   int64_t value;
-  explicit IR_IntegerConstant(int64_t _value) : value(_value) {}
+  explicit IR_IntegerConstant(int64_t _value) : IR(KIND), value(_value) {}
   goos::Object to_form(const LinkedObjectFile& file) const override;
-  void get_children(std::vector<std::shared_ptr<IR>>* output) const override;
+  void get_children(std::vector<IR*>* output) const override;
   bool get_type_of_expr(const TypeMap& reg_types,
                         DecompilerTypeSystem& dts,
                         LinkedObjectFile& file,
@@ -235,10 +297,12 @@ struct BranchDelay {
     NEGATE,
     UNKNOWN
   } kind;
-  std::shared_ptr<IR> destination = nullptr, source = nullptr, source2 = nullptr;
+  IR* destination = nullptr;
+  IR* source = nullptr;
+  IR* source2 = nullptr;
   explicit BranchDelay(Kind _kind) : kind(_kind) {}
   goos::Object to_form(const LinkedObjectFile& file) const;
-  void get_children(std::vector<std::shared_ptr<IR>>* output) const;
+  void get_children(std::vector<IR*>* output) const;
 };
 
 struct Condition {
@@ -271,11 +335,8 @@ struct Condition {
     FLOAT_GREATER_THAN,
   } kind;
 
-  Condition(Kind _kind,
-            std::shared_ptr<IR> _src0,
-            std::shared_ptr<IR> _src1,
-            std::shared_ptr<IR> _clobber)
-      : kind(_kind), src0(std::move(_src0)), src1(std::move(_src1)), clobber(std::move(_clobber)) {
+  Condition(Kind _kind, IR* _src0, IR* _src1, IR* _clobber)
+      : kind(_kind), src0(_src0), src1(_src1), clobber(_clobber) {
     int nargs = num_args();
     if (nargs == 2) {
       assert(src0 && src1);
@@ -288,15 +349,19 @@ struct Condition {
 
   int num_args() const;
   goos::Object to_form(const LinkedObjectFile& file) const;
-  std::shared_ptr<IR> src0, src1, clobber;
-  void get_children(std::vector<std::shared_ptr<IR>>* output) const;
+  IR* src0 = nullptr;
+  IR* src1 = nullptr;
+  IR* clobber = nullptr;
+  void get_children(std::vector<IR*>* output) const;
   void invert();
 };
 
 class IR_Branch : public IR {
  public:
+  static constexpr IRKind KIND = IRKind::BRANCH;
   IR_Branch(Condition _condition, int _dest_label_idx, BranchDelay _branch_delay, bool _likely)
-      : condition(std::move(_condition)),
+      : IR(KIND),
+        condition(std::move(_condition)),
         dest_label_idx(_dest_label_idx),
         branch_delay(std::move(_branch_delay)),
         likely(_likely) {}
@@ -307,7 +372,7 @@ class IR_Branch : public IR {
   bool likely;
 
   goos::Object to_form(const LinkedObjectFile& file) const override;
-  void get_children(std::vector<std::shared_ptr<IR>>* output) const override;
+  void get_children(std::vector<IR*>* output) const override;
   virtual bool update_types(TypeMap& reg_types,
                             DecompilerTypeSystem& dts,
                             LinkedObjectFile& file) const;
@@ -315,12 +380,13 @@ class IR_Branch : public IR {
 
 class IR_Compare : public IR {
  public:
-  explicit IR_Compare(Condition _condition) : condition(std::move(_condition)) {}
+  static constexpr IRKind KIND = IRKind::COMPARE;
+  explicit IR_Compare(Condition _condition) : IR(KIND), condition(std::move(_condition)) {}
 
   Condition condition;
 
   goos::Object to_form(const LinkedObjectFile& file) const override;
-  void get_children(std::vector<std::shared_ptr<IR>>* output) const override;
+  void get_children(std::vector<IR*>* output) const override;
   bool get_type_of_expr(const TypeMap& reg_types,
                         DecompilerTypeSystem& dts,
                         LinkedObjectFile& file,
@@ -329,168 +395,234 @@ class IR_Compare : public IR {
 
 class IR_Nop : public IR {
  public:
-  IR_Nop() = default;
+  static constexpr IRKind KIND = IRKind::NOP;
+  IR_Nop() : IR(KIND) {}
   goos::Object to_form(const LinkedObjectFile& file) const override;
-  void get_children(std::vector<std::shared_ptr<IR>>* output) const override;
+  void get_children(std::vector<IR*>* output) const override;
 };
 
 class IR_Suspend : public IR {
  public:
-  IR_Suspend() = default;
+  static constexpr IRKind KIND = IRKind::SUSPEND;
+  IR_Suspend() : IR(KIND) {}
   goos::Object to_form(const LinkedObjectFile& file) const override;
-  void get_children(std::vector<std::shared_ptr<IR>>* output) const override;
+  void get_children(std::vector<IR*>* output) const override;
 };
 
 class IR_Begin : public IR {
  public:
-  IR_Begin() = default;
-  explicit IR_Begin(const std::vector<std::shared_ptr<IR>>& _forms) : forms(std::move(_forms)) {}
+  static constexpr IRKind KIND = IRKind::BEGIN;
+  IR_Begin() : IR(KIND) {}
+  explicit IR_Begin(std::vector<IR*> _forms) : IR(KIND), forms(std::move(_forms)) {}
   goos::Object to_form(const LinkedObjectFile& file) const override;
-  void get_children(std::vector<std::shared_ptr<IR>>* output) const override;
-  std::vector<std::shared_ptr<IR>> forms;
+  void get_children(std::vector<IR*>* output) const override;
+  std::vector<IR*> forms;
 };
 
 class IR_WhileLoop : public IR {
  public:
-  IR_WhileLoop(std::shared_ptr<IR> _condition, std::shared_ptr<IR> _body)
-      : condition(std::move(_condition)), body(std::move(_body)) {}
+  static constexpr IRKind KIND = IRKind::WHILE_LOOP;
+  IR_WhileLoop(IR* _condition, IR* _body) : IR(KIND), condition(_condition), body(_body) {}
   goos::Object to_form(const LinkedObjectFile& file) const override;
-  void get_children(std::vector<std::shared_ptr<IR>>* output) const override;
-  std::shared_ptr<IR> condition, body;
+  void get_children(std::vector<IR*>* output) const override;
+  IR* condition = nullptr;
+  IR* body = nullptr;
   bool cleaned = false;
 };
 
 class IR_UntilLoop : public IR {
  public:
-  IR_UntilLoop(std::shared_ptr<IR> _condition, std::shared_ptr<IR> _body)
-      : condition(std::move(_condition)), body(std::move(_body)) {}
+  static constexpr IRKind KIND = IRKind::UNTIL_LOOP;
+  IR_UntilLoop(IR* _condition, IR* _body) : IR(KIND), condition(_condition), body(_body) {}
   goos::Object to_form(const LinkedObjectFile& file) const override;
-  void get_children(std::vector<std::shared_ptr<IR>>* output) const override;
-  std::shared_ptr<IR> condition, body;
+  void get_children(std::vector<IR*>* output) const override;
+  IR* condition = nullptr;
+  IR* body = nullptr;
 };
 
 class IR_CondWithElse : public IR {
  public:
+  static constexpr IRKind KIND = IRKind::COND_WITH_ELSE;
   struct Entry {
-    std::shared_ptr<IR> condition = nullptr;
-    std::shared_ptr<IR> body = nullptr;
+    IR* condition = nullptr;
+    IR* body = nullptr;
     bool cleaned = false;
   };
   std::vector<Entry> entries;
-  std::shared_ptr<IR> else_ir;
-  IR_CondWithElse(std::vector<Entry> _entries, std::shared_ptr<IR> _else_ir)
-      : entries(std::move(_entries)), else_ir(std::move(_else_ir)) {}
+  IR* else_ir;
+  IR_CondWithElse(std::vector<Entry> _entries, IR* _else_ir)
+      : IR(KIND), entries(std::move(_entries)), else_ir(_else_ir) {}
   goos::Object to_form(const LinkedObjectFile& file) const override;
-  void get_children(std::vector<std::shared_ptr<IR>>* output) const override;
+  void get_children(std::vector<IR*>* output) const override;
 };
 
 // this one doesn't have an else statement. Will return false if none of the cases are taken.
 class IR_Cond : public IR {
  public:
+  static constexpr IRKind KIND = IRKind::COND;
   struct Entry {
-    std::shared_ptr<IR> condition = nullptr;
-    std::shared_ptr<IR> body = nullptr;
-    std::shared_ptr<IR> false_destination = nullptr;
+    IR* condition = nullptr;
+    IR* body = nullptr;
+    IR* false_destination = nullptr;
     bool cleaned = false;
   };
   std::vector<Entry> entries;
-  explicit IR_Cond(std::vector<Entry> _entries) : entries(std::move(_entries)) {}
+  explicit IR_Cond(std::vector<Entry> _entries) : IR(KIND), entries(std::move(_entries)) {}
   goos::Object to_form(const LinkedObjectFile& file) const override;
-  void get_children(std::vector<std::shared_ptr<IR>>* output) const override;
+  void get_children(std::vector<IR*>* output) const override;
 };
 
 // this will work on pairs, bintegers, or basics
 class IR_GetRuntimeType : public IR {
  public:
-  std::shared_ptr<IR> object, clobber;
-  IR_GetRuntimeType(std::shared_ptr<IR> _object, std::shared_ptr<IR> _clobber)
-      : object(std::move(_object)), clobber(std::move(_clobber)) {}
+  static constexpr IRKind KIND = IRKind::GET_RUNTIME_TYPE;
+  IR* object = nullptr;
+  IR* clobber = nullptr;
+  IR_GetRuntimeType(IR* _object, IR* _clobber) : IR(KIND), object(_object), clobber(_clobber) {}
   goos::Object to_form(const LinkedObjectFile& file) const override;
-  void get_children(std::vector<std::shared_ptr<IR>>* output) const override;
+  void get_children(std::vector<IR*>* output) const override;
 };
 
 class IR_ShortCircuit : public IR {
  public:
+  static constexpr IRKind KIND = IRKind::SHORT_CIRCUIT;
   struct Entry {
-    std::shared_ptr<IR> condition = nullptr;
-    std::shared_ptr<IR> output = nullptr;  // where the delay slot writes to.
+    IR* condition = nullptr;
+    IR* output = nullptr;  // where the delay slot writes to.
     bool cleaned = false;
   };
 
   enum Kind { UNKNOWN, AND, OR } kind = UNKNOWN;
 
-  std::shared_ptr<IR> final_result = nullptr;  // the register that the final result goes in.
+  IR* final_result = nullptr;  // the register that the final result goes in.
 
   std::vector<Entry> entries;
-  explicit IR_ShortCircuit(std::vector<Entry> _entries) : entries(std::move(_entries)) {}
+  explicit IR_ShortCircuit(std::vector<Entry> _entries)
+      : IR(KIND), entries(std::move(_entries)) {}
   goos::Object to_form(const LinkedObjectFile& file) const override;
-  void get_children(std::vector<std::shared_ptr<IR>>* output) const override;
+  void get_children(std::vector<IR*>* output) const override;
 };
 
 class IR_Ash : public IR {
  public:
-  std::shared_ptr<IR> shift_amount, value, clobber;
+  static constexpr IRKind KIND = IRKind::ASH;
+  IR* shift_amount = nullptr;
+  IR* value = nullptr;
+  IR* clobber = nullptr;
   bool is_signed = true;
-  IR_Ash(std::shared_ptr<IR> _shift_amount,
-         std::shared_ptr<IR> _value,
-         std::shared_ptr<IR> _clobber,
-         bool _is_signed)
-      : shift_amount(std::move(_shift_amount)),
-        value(std::move(_value)),
-        clobber(std::move(_clobber)),
+  IR_Ash(IR* _shift_amount, IR* _value, IR* _clobber, bool _is_signed)
+      : IR(KIND),
+        shift_amount(_shift_amount),
+        value(_value),
+        clobber(_clobber),
         is_signed(_is_signed) {}
   goos::Object to_form(const LinkedObjectFile& file) const override;
-  void get_children(std::vector<std::shared_ptr<IR>>* output) const override;
+  void get_children(std::vector<IR*>* output) const override;
 };
 
 class IR_AsmOp : public IR {
  public:
-  std::shared_ptr<IR> dst = nullptr;
-  std::shared_ptr<IR> src0 = nullptr;
-  std::shared_ptr<IR> src1 = nullptr;
-  std::shared_ptr<IR> src2 = nullptr;
+  static constexpr IRKind KIND = IRKind::ASM_OP;
+  IR* dst = nullptr;
+  IR* src0 = nullptr;
+  IR* src1 = nullptr;
+  IR* src2 = nullptr;
   std::string name;
-  IR_AsmOp(std::string _name) : name(std::move(_name)) {}
+  IR_AsmOp(std::string _name) : IR(KIND), name(std::move(_name)) {}
   goos::Object to_form(const LinkedObjectFile& file) const override;
-  void get_children(std::vector<std::shared_ptr<IR>>* output) const override;
+  void get_children(std::vector<IR*>* output) const override;
 };
 
 class IR_CMoveF : public IR {
  public:
-  std::shared_ptr<IR> src = nullptr;
+  static constexpr IRKind KIND = IRKind::CMOVE_F;
+  IR* src = nullptr;
   bool on_zero = false;
-  explicit IR_CMoveF(std::shared_ptr<IR> _src, bool _on_zero)
-      : src(std::move(_src)), on_zero(_on_zero) {}
+  explicit IR_CMoveF(IR* _src, bool _on_zero) : IR(KIND), src(_src), on_zero(_on_zero) {}
   goos::Object to_form(const LinkedObjectFile& file) const override;
-  void get_children(std::vector<std::shared_ptr<IR>>* output) const override;
+  void get_children(std::vector<IR*>* output) const override;
 };
 
 class IR_AsmReg : public IR {
  public:
+  static constexpr IRKind KIND = IRKind::ASM_REG;
   enum Kind { VU_Q, VU_ACC } kind;
-  explicit IR_AsmReg(Kind _kind) : kind(_kind) {}
+  explicit IR_AsmReg(Kind _kind) : IR(KIND), kind(_kind) {}
   goos::Object to_form(const LinkedObjectFile& file) const override;
-  void get_children(std::vector<std::shared_ptr<IR>>* output) const override;
+  void get_children(std::vector<IR*>* output) const override;
 };
 
 class IR_Return : public IR {
  public:
-  std::shared_ptr<IR> return_code;
-  std::shared_ptr<IR> dead_code;
-  IR_Return(std::shared_ptr<IR> _return_code, std::shared_ptr<IR> _dead_code)
-      : return_code(std::move(_return_code)), dead_code(std::move(_dead_code)) {}
+  static constexpr IRKind KIND = IRKind::RETURN;
+  IR* return_code;
+  IR* dead_code;
+  IR_Return(IR* _return_code, IR* _dead_code)
+      : IR(KIND), return_code(_return_code), dead_code(_dead_code) {}
   goos::Object to_form(const LinkedObjectFile& file) const override;
-  void get_children(std::vector<std::shared_ptr<IR>>* output) const override;
+  void get_children(std::vector<IR*>* output) const override;
 };
 
 class IR_Break : public IR {
  public:
-  std::shared_ptr<IR> return_code;
-  std::shared_ptr<IR> dead_code;
-  IR_Break(std::shared_ptr<IR> _return_code, std::shared_ptr<IR> _dead_code)
-      : return_code(std::move(_return_code)), dead_code(std::move(_dead_code)) {}
+  static constexpr IRKind KIND = IRKind::BREAK;
+  IR* return_code;
+  IR* dead_code;
+  IR_Break(IR* _return_code, IR* _dead_code)
+      : IR(KIND), return_code(_return_code), dead_code(_dead_code) {}
   goos::Object to_form(const LinkedObjectFile& file) const override;
-  void get_children(std::vector<std::shared_ptr<IR>>* output) const override;
+  void get_children(std::vector<IR*>* output) const override;
 };
 
+/*!
+ * Does an IR of this kind have type T?
+ */
+template <typename T>
+bool ir_kind_matches(IRKind kind) {
+  return kind == T::KIND;
+}
+
+template <>
+inline bool ir_kind_matches<IR_Set>(IRKind kind) {
+  return kind == IRKind::SET || kind == IRKind::STORE;
+}
+
+/*!
+ * Get ir as a T, or nullptr if it isn't one. Like dynamic_cast, but only checks the kind.
+ */
+template <typename T>
+T* ir_cast(IR* ir) {
+  return ir && ir_kind_matches<T>(ir->ir_kind) ? static_cast<T*>(ir) : nullptr;
+}
+
+template <typename T>
+const T* ir_cast(const IR* ir) {
+  return ir && ir_kind_matches<T>(ir->ir_kind) ? static_cast<const T*>(ir) : nullptr;
+}
+
+/*!
+ * Selects the arena that make_ir allocates from on this thread, until it goes out of scope.
+ * Scopes can be nested.
+ */
+class IR_ArenaScope {
+ public:
+  explicit IR_ArenaScope(Arena* arena);
+  ~IR_ArenaScope();
+  IR_ArenaScope(const IR_ArenaScope&) = delete;
+  IR_ArenaScope& operator=(const IR_ArenaScope&) = delete;
+
+ private:
+  Arena* m_prev = nullptr;
+};
+
+Arena* current_ir_arena();
+
+/*!
+ * Create an IR in the arena of the current IR_ArenaScope.
+ */
+template <typename T, typename... Args>
+T* make_ir(Args&&... args) {
+  return current_ir_arena()->make<T>(std::forward<Args>(args)...);
+}
+
 #endif  // JAK_IR_H
@@ -18,11 +18,10 @@ bool IR_Register::get_type_of_expr(const TypeMap& reg_types,
                                    DecompilerTypeSystem& dts,
                                    LinkedObjectFile& file,
                                    TypeSpec* out) const {
-  (void)dts;
   (void)file;
-  auto kv = reg_types.find(reg);
-  if (kv != reg_types.end()) {
-    *out = kv->second;
+  auto type = reg_types.get(reg);
+  if (type != NO_TYPE) {
+    *out = dts.type_ids.get(type);
     return true;
   }
   return false;
@@ -31,13 +30,13 @@ bool IR_Register::get_type_of_expr(const TypeMap& reg_types,
 bool IR_Set::update_types(TypeMap& reg_types,
                           DecompilerTypeSystem& dts,
                           LinkedObjectFile& file) const {
-  auto dest_as_reg = dynamic_cast<IR_Register*>(dst.get());
+  auto dest_as_reg = ir_cast<IR_Register>(dst);
   if (dest_as_reg) {
     TypeSpec src_type;
     if (!src->get_type_of_expr(reg_types, dts, file, &src_type)) {
       return false;
     }
-    reg_types[dest_as_reg->reg] = src_type;
+    reg_types.set(dest_as_reg->reg, dts.type_ids.intern(src_type));
     return true;
   }
 
@@ -48,7 +47,7 @@ bool IR_Load::get_type_of_expr(const TypeMap& reg_types,
                                DecompilerTypeSystem& dts,
                                LinkedObjectFile& file,
                                TypeSpec* out) const {
-  auto loc_as_static = dynamic_cast<IR_StaticAddress*>(location.get());
+  auto loc_as_static = ir_cast<IR_StaticAddress>(location);
   if (loc_as_static) {
     // this will need to get upgraded once we have good support for static data.
     // but for now we will do a "best guess" that should cover common cases.
@@ -134,7 +133,7 @@ bool IR_IntMath2::get_type_of_expr(const TypeMap& reg_types,
   TypeSpec arg1_type;
 
   // special case for subtraction with r0
-  //  auto arg0_as_reg = dynamic_cast<IR_Register*>(arg0.get());
+  //  auto arg0_as_reg = ir_cast<IR_Register>(arg0);
   //  if(arg0_as_reg && arg0_as_reg->reg == make_gpr(Reg::R0) && kind == SUB) {
   //    if (!arg1->get_type_of_expr(reg_types, dts, file, &arg1_type)) {
   //      return false;
@@ -151,7 +150,6 @@ bool IR_IntMath2::get_type_of_expr(const TypeMap& reg_types,
   }
 
   if (!arg1->get_type_of_expr(reg_types, dts, file, &arg1_type)) {
-    fmt::print("a1 fail\n");
     return false;
   }
 
@@ -161,7 +159,7 @@ bool IR_IntMath2::get_type_of_expr(const TypeMap& reg_types,
     return true;
   }
 
-  auto arg1_as_int = dynamic_cast<IR_IntegerConstant*>(arg1.get());
+  auto arg1_as_int = ir_cast<IR_IntegerConstant>(arg1);
   if (kind == ADD && arg1_as_int) {
     // it's a memory thing...
     ReverseDerefInputInfo info;
@@ -178,7 +176,7 @@ bool IR_IntMath2::get_type_of_expr(const TypeMap& reg_types,
     }
   }
 
-  //  auto arg0_as_int = dynamic_cast<IR_IntegerConstant*>(arg0.get());
+  //  auto arg0_as_int = ir_cast<IR_IntegerConstant>(arg0);
   //  if (kind == ADD && arg0_as_int) {
   //    // it's a memory thing...
   //    ReverseDerefInputInfo info;
@@ -224,38 +222,40 @@ bool IR_Branch::update_types(TypeMap& reg_types,
   (void)file;
   switch (branch_delay.kind) {
     case BranchDelay::DSLLV: {
-      auto dst_as_reg = dynamic_cast<IR_Register*>(branch_delay.destination.get());
+      auto dst_as_reg = ir_cast<IR_Register>(branch_delay.destination);
       if (dst_as_reg) {
-        reg_types[dst_as_reg->reg] = dts.ts.make_typespec("int");  // todo?
+        // todo?
+        reg_types.set(dst_as_reg->reg, dts.type_ids.intern(dts.ts.make_typespec("int")));
         return true;
       }
     } break;
     case BranchDelay::NEGATE: {
-      auto dst_as_reg = dynamic_cast<IR_Register*>(branch_delay.destination.get());
+      auto dst_as_reg = ir_cast<IR_Register>(branch_delay.destination);
       if (dst_as_reg) {
-        reg_types[dst_as_reg->reg] = dts.ts.make_typespec("int");  // todo?
+        // todo?
+        reg_types.set(dst_as_reg->reg, dts.type_ids.intern(dts.ts.make_typespec("int")));
         return true;
       }
     } break;
     case BranchDelay::SET_REG_FALSE: {
-      auto dst_as_reg = dynamic_cast<IR_Register*>(branch_delay.destination.get());
+      auto dst_as_reg = ir_cast<IR_Register>(branch_delay.destination);
       if (dst_as_reg) {
-        // this probably will break a lot of things when using the result of an if.
-        reg_types[dst_as_reg->reg] = dts.ts.make_typespec("basic");  // todo?
+        // this probably will break a lot of things when using the result of an if. todo?
+        reg_types.set(dst_as_reg->reg, dts.type_ids.intern(dts.ts.make_typespec("basic")));
         return true;
       }
     } break;
     case BranchDelay::NOP:
       return true;
     case BranchDelay::SET_REG_REG: {
-      auto dst_as_reg = dynamic_cast<IR_Register*>(branch_delay.destination.get());
+      auto dst_as_reg = ir_cast<IR_Register>(branch_delay.destination);
       if (dst_as_reg) {
         // this probably will break a lot of things when using the result of an if.
-        auto src_as_reg = dynamic_cast<IR_Register*>(branch_delay.source.get());
+        auto src_as_reg = ir_cast<IR_Register>(branch_delay.source);
         if (src_as_reg) {
-          auto src_kv = reg_types.find(src_as_reg->reg);
-          if (src_kv != reg_types.end()) {
-            reg_types[dst_as_reg->reg] = reg_types[src_as_reg->reg];
+          auto src_type = reg_types.get(src_as_reg->reg);
+          if (src_type != NO_TYPE) {
+            reg_types.set(dst_as_reg->reg, src_type);
             return true;
           }
         }
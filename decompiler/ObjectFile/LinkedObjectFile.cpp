@@ -12,8 +12,8 @@
 #include "LinkedObjectFile.h"
 #include "decompiler/Disasm/InstructionDecode.h"
 #include "decompiler/config.h"
+#include "decompiler/util/OrderedLog.h"
 #include "third-party/json.hpp"
-#include "third-party/spdlog/include/spdlog/spdlog.h"
 #include "common/goos/PrettyPrinter.h"
 
 /*!
@@ -88,17 +88,37 @@ bool LinkedObjectFile::label_points_to_code(int label_id) const {
  */
 Function& LinkedObjectFile::get_function_at_label(int label_id) {
   auto& label = labels.at(label_id);
-  for (auto& func : functions_by_seg.at(label.target_segment)) {
-    // + 4 to skip past type tag to the first word, which is were the label points.
-    if (func.start_word * 4 + 4 == label.offset) {
-      return func;
-    }
+  // - 4 to go back from the first word, which is where the label points, to the type tag.
+  auto func = try_get_function_containing(label.target_segment, label.offset - 4);
+  if (func && func->start_word * 4 + 4 == label.offset) {
+    return *func;
   }
 
   assert(false);
   return functions_by_seg.front().front();  // to avoid error
 }
 
+/*!
+ * Get the function which contains the given byte offset in the given segment, including its type
+ * tag and padding. Returns nullptr if there is none.
+ * The functions in a segment are sorted and don't overlap, so this is a binary search.
+ */
+Function* LinkedObjectFile::try_get_function_containing(int seg, int offset) {
+  auto& funcs = functions_by_seg.at(seg);
+  if (offset < 0) {
+    return nullptr;
+  }
+  int word = offset / 4;
+  // the first function that starts after word
+  auto it = std::upper_bound(funcs.begin(), funcs.end(), word,
+                             [](int w, const Function& func) { return w < func.start_word; });
+  if (it == funcs.begin()) {
+    return nullptr;
+  }
+  --it;
+  return word < it->end_word ? &*it : nullptr;
+}
+
 /*!
  * Get the name of the label.
  */
@@ -106,6 +126,14 @@ std::string LinkedObjectFile::get_label_name(int label_id) const {
   return labels.at(label_id).name;
 }
 
+/*!
+ * Get the name of the symbol that a word is linked to.
+ */
+const std::string& LinkedObjectFile::get_symbol_name(const LinkedWord& word) const {
+  assert(symbol_names);
+  return symbol_names->name(word.symbol_id());
+}
+
 /*!
  * Add link information that a word is a pointer to another word.
  */
@@ -116,7 +144,7 @@ bool LinkedObjectFile::pointer_link_word(int source_segment,
   assert((source_offset % 4) == 0);
 
   auto& word = words_by_seg.at(source_segment).at(source_offset / 4);
-  assert(word.kind == LinkedWord::PLAIN_DATA);
+  assert(word.kind() == LinkedWord::PLAIN_DATA);
 
   if (dest_offset / 4 > (int)words_by_seg.at(dest_segment).size()) {
     //    printf("HACK bad link ignored!\n");
@@ -124,8 +152,7 @@ bool LinkedObjectFile::pointer_link_word(int source_segment,
   }
   assert(dest_offset / 4 <= (int)words_by_seg.at(dest_segment).size());
 
-  word.kind = LinkedWord::PTR;
-  word.label_id = get_label_id_for(dest_segment, dest_offset);
+  word.set_to_label(LinkedWord::PTR, get_label_id_for(dest_segment, dest_offset));
   return true;
 }
 
@@ -138,12 +165,11 @@ void LinkedObjectFile::symbol_link_word(int source_segment,
                                         LinkedWord::Kind kind) {
   assert((source_offset % 4) == 0);
   auto& word = words_by_seg.at(source_segment).at(source_offset / 4);
-  //  assert(word.kind == LinkedWord::PLAIN_DATA);
-  if (word.kind != LinkedWord::PLAIN_DATA) {
-    printf("bad symbol link word\n");
+  //  assert(word.kind() == LinkedWord::PLAIN_DATA);
+  if (word.kind() != LinkedWord::PLAIN_DATA) {
+    ordered_log::print("bad symbol link word\n");
   }
-  word.kind = kind;
-  word.symbol_name = name;
+  word.set_to_symbol(kind, symbol_names->intern(name));
 }
 
 /*!
@@ -153,9 +179,8 @@ void LinkedObjectFile::symbol_link_word(int source_segment,
 void LinkedObjectFile::symbol_link_offset(int source_segment, int source_offset, const char* name) {
   assert((source_offset % 4) == 0);
   auto& word = words_by_seg.at(source_segment).at(source_offset / 4);
-  assert(word.kind == LinkedWord::PLAIN_DATA);
-  word.kind = LinkedWord::SYM_OFFSET;
-  word.symbol_name = name;
+  assert(word.kind() == LinkedWord::PLAIN_DATA);
+  word.set_to_symbol(LinkedWord::SYM_OFFSET, symbol_names->intern(name));
 }
 
 /*!
@@ -173,14 +198,12 @@ void LinkedObjectFile::pointer_link_split_word(int source_segment,
   auto& lo_word = words_by_seg.at(source_segment).at(source_lo_offset / 4);
 
   //  assert(dest_offset / 4 <= (int)words_by_seg.at(dest_segment).size());
-  assert(hi_word.kind == LinkedWord::PLAIN_DATA);
-  assert(lo_word.kind == LinkedWord::PLAIN_DATA);
-
-  hi_word.kind = LinkedWord::HI_PTR;
-  hi_word.label_id = get_label_id_for(dest_segment, dest_offset);
+  assert(hi_word.kind() == LinkedWord::PLAIN_DATA);
+  assert(lo_word.kind() == LinkedWord::PLAIN_DATA);
 
-  lo_word.kind = LinkedWord::LO_PTR;
-  lo_word.label_id = hi_word.label_id;
+  auto label_id = get_label_id_for(dest_segment, dest_offset);
+  hi_word.set_to_label(LinkedWord::HI_PTR, label_id);
+  lo_word.set_to_label(LinkedWord::LO_PTR, label_id);
 }
 
 /*!
@@ -250,32 +273,32 @@ std::string LinkedObjectFile::print_words() {
 void LinkedObjectFile::append_word_to_string(std::string& dest, const LinkedWord& word) const {
   char buff[128];
 
-  switch (word.kind) {
+  switch (word.kind()) {
     case LinkedWord::PLAIN_DATA:
       sprintf(buff, "    .word 0x%x\n", word.data);
       break;
     case LinkedWord::PTR:
-      sprintf(buff, "    .word %s\n", labels.at(word.label_id).name.c_str());
+      sprintf(buff, "    .word %s\n", labels.at(word.label_id()).name.c_str());
       break;
     case LinkedWord::SYM_PTR:
-      sprintf(buff, "    .symbol %s\n", word.symbol_name.c_str());
+      sprintf(buff, "    .symbol %s\n", get_symbol_name(word).c_str());
       break;
     case LinkedWord::TYPE_PTR:
-      sprintf(buff, "    .type %s\n", word.symbol_name.c_str());
+      sprintf(buff, "    .type %s\n", get_symbol_name(word).c_str());
       break;
     case LinkedWord::EMPTY_PTR:
       sprintf(buff, "    .empty-list\n");  // ?
       break;
     case LinkedWord::HI_PTR:
       sprintf(buff, "    .ptr-hi 0x%x %s\n", word.data >> 16,
-              labels.at(word.label_id).name.c_str());
+              labels.at(word.label_id()).name.c_str());
       break;
     case LinkedWord::LO_PTR:
       sprintf(buff, "    .ptr-lo 0x%x %s\n", word.data >> 16,
-              labels.at(word.label_id).name.c_str());
+              labels.at(word.label_id()).name.c_str());
       break;
     case LinkedWord::SYM_OFFSET:
-      sprintf(buff, "    .sym-off 0x%x %s\n", word.data >> 16, word.symbol_name.c_str());
+      sprintf(buff, "    .sym-off 0x%x %s\n", word.data >> 16, get_symbol_name(word).c_str());
       break;
     default:
       throw std::runtime_error("nyi");
@@ -292,8 +315,8 @@ void LinkedObjectFile::find_code() {
     // single segment object files should never have any code.
     auto& seg = words_by_seg.front();
     for (auto& word : seg) {
-      if (!word.symbol_name.empty()) {
-        assert(word.symbol_name != "function");
+      if (word.has_symbol()) {
+        assert(word.symbol_id() != SymbolNameTable::FUNCTION_ID);
       }
     }
     offset_of_data_zone_by_seg.at(0) = 0;
@@ -312,7 +335,7 @@ void LinkedObjectFile::find_code() {
       size_t function_loc = -1;
       for (size_t j = words_by_seg.at(i).size(); j-- > 0;) {
         auto& word = words_by_seg.at(i).at(j);
-        if (word.kind == LinkedWord::TYPE_PTR && word.symbol_name == "function") {
+        if (word.is_type_ptr(SymbolNameTable::FUNCTION_ID)) {
           function_loc = j;
           found_function = true;
           break;
@@ -327,7 +350,7 @@ void LinkedObjectFile::find_code() {
 
         for (size_t j = function_loc; j < words_by_seg.at(i).size(); j++) {
           auto& word = words_by_seg.at(i).at(j);
-          if (word.kind == LinkedWord::PLAIN_DATA && word.data == jr_ra) {
+          if (word.kind() == LinkedWord::PLAIN_DATA && word.data == jr_ra) {
             found_jr_ra = true;
             jr_ra_loc = j;
           }
@@ -351,7 +374,7 @@ void LinkedObjectFile::find_code() {
       // verify there are no functions after the data section starts
       for (size_t j = offset_of_data_zone_by_seg.at(i); j < words_by_seg.at(i).size(); j++) {
         auto& word = words_by_seg.at(i).at(j);
-        if (word.kind == LinkedWord::TYPE_PTR && word.symbol_name == "function") {
+        if (word.is_type_ptr(SymbolNameTable::FUNCTION_ID)) {
           assert(false);
         }
       }
@@ -387,7 +410,7 @@ void LinkedObjectFile::find_functions() {
         bool found_function_tag_loc = false;
         for (; function_tag_loc-- > 0;) {
           auto& word = words_by_seg.at(seg).at(function_tag_loc);
-          if (word.kind == LinkedWord::TYPE_PTR && word.symbol_name == "function") {
+          if (word.is_type_ptr(SymbolNameTable::FUNCTION_ID)) {
             found_function_tag_loc = true;
             break;
           }
@@ -411,11 +434,9 @@ void LinkedObjectFile::find_functions() {
 void LinkedObjectFile::disassemble_functions() {
   for (int seg = 0; seg < segments; seg++) {
     for (auto& function : functions_by_seg.at(seg)) {
-      for (auto word = function.start_word; word < function.end_word; word++) {
-        // decode!
-        function.instructions.push_back(
-            decode_instruction(words_by_seg.at(seg).at(word), *this, seg, word));
-        if (function.instructions.back().is_valid()) {
+      function.instructions = decode_instructions(*this, seg, function.start_word, function.end_word);
+      for (auto& instr : function.instructions) {
+        if (instr.is_valid()) {
           stats.decoded_ops++;
         }
       }
@@ -498,7 +519,9 @@ void LinkedObjectFile::process_fp_relative_links() {
               } break;
 
               default:
-                printf("unknown fp using op: %s\n", instr.to_string(*this).c_str());
+                ordered_log::print(
+                    fmt::format("unknown fp using op: {}\n", instr.to_string(*this)));
+                ordered_log::flush_captured();
                 assert(false);
             }
           }
@@ -518,10 +541,10 @@ std::string LinkedObjectFile::to_asm_json(const std::string& obj_file_name) {
       auto& func = functions_by_seg.at(seg).at(fi);
       auto fname = func.guessed_name.to_string();
       if (functions_seen.find(fname) != functions_seen.end()) {
-        spdlog::warn(
+        ordered_log::warn(fmt::format(
             "Function {} appears multiple times in the same object file {} - it cannot be uniquely "
             "referenced from config",
-            func.guessed_name.to_string(), obj_file_name);
+            func.guessed_name.to_string(), obj_file_name));
         functions_seen[fname]++;
         fname += "-v" + std::to_string(functions_seen[fname]);
       } else {
@@ -551,9 +574,9 @@ std::string LinkedObjectFile::to_asm_json(const std::string& obj_file_name) {
           if (func.has_typemaps()) {
             auto& tm = func.get_typemap_by_instr_idx(i);
             auto& json_type_map = op["type_map"];
-            for (auto& kv : tm) {
-              json_type_map[kv.first.to_charp()] = kv.second.print();
-            }
+            tm.for_each([&](Register reg, TypeId type) {
+              json_type_map[reg.to_charp()] = func.get_typemap_type(type).print();
+            });
           }
         }
 
@@ -645,10 +668,11 @@ std::string LinkedObjectFile::print_function_disassembly(Function& func,
           for (auto reg_kind : {Reg::RegisterKind::GPR, Reg::RegisterKind::FPR}) {
             for (int reg_idx = 0; reg_idx < 32; reg_idx++) {
               auto gpr = Register(reg_kind, reg_idx);
-              auto kv = tm.find(gpr);
-              if (kv != tm.end()) {
+              auto type = tm.get(gpr);
+              if (type != NO_TYPE) {
                 added = true;
-                line += fmt::format("{}: {}, ", gpr.to_charp(), kv->second.print());
+                line +=
+                    fmt::format("{}: {}, ", gpr.to_charp(), func.get_typemap_type(type).print());
               }
             }
           }
@@ -784,7 +808,7 @@ std::string LinkedObjectFile::print_disassembly() {
       auto& word = words_by_seg[seg][i];
       append_word_to_string(result, word);
 
-      if (word.kind == LinkedWord::TYPE_PTR && word.symbol_name == "string") {
+      if (word.is_type_ptr(SymbolNameTable::STRING_ID)) {
         result += "; " + get_goal_string(seg, i) + "\n";
       }
     }
@@ -806,7 +830,7 @@ std::string LinkedObjectFile::get_goal_string(int seg, int word_idx, bool with_q
     return "invalid string!\n";
   }
   LinkedWord& size_word = words_by_seg[seg].at(word_idx + 1);
-  if (size_word.kind != LinkedWord::PLAIN_DATA) {
+  if (size_word.kind() != LinkedWord::PLAIN_DATA) {
     // sometimes an array of string pointer triggers this!
     return "invalid string!\n";
   }
@@ -817,7 +841,7 @@ std::string LinkedObjectFile::get_goal_string(int seg, int word_idx, bool with_q
     int word_offset = word_idx + 2 + (i / 4);
     int byte_offset = i % 4;
     auto& word = words_by_seg[seg].at(word_offset);
-    if (word.kind != LinkedWord::PLAIN_DATA) {
+    if (word.kind() != LinkedWord::PLAIN_DATA) {
       return "invalid string! (check me!)\n";
     }
     char cword[4];
@@ -880,7 +904,7 @@ std::string LinkedObjectFile::print_scripts() {
 bool LinkedObjectFile::is_empty_list(int seg, int byte_idx) {
   assert((byte_idx % 4) == 0);
   auto& word = words_by_seg.at(seg).at(byte_idx / 4);
-  return word.kind == LinkedWord::EMPTY_PTR;
+  return word.kind() == LinkedWord::EMPTY_PTR;
 }
 
 /*!
@@ -919,9 +943,10 @@ goos::Object LinkedObjectFile::to_form_script(int seg, int word_idx, std::vector
         assert((cdr_addr % 4) == 0);
         auto& cdr_word = words_by_seg.at(seg).at(cdr_addr / 4);
         // check for proper list
-        if (cdr_word.kind == LinkedWord::PTR && (labels.at(cdr_word.label_id).offset & 7) == 2) {
+        if (cdr_word.kind() == LinkedWord::PTR &&
+            (labels.at(cdr_word.label_id()).offset & 7) == 2) {
           // yes, proper list. add another pair and link it in to the list.
-          goal_print_obj = labels.at(cdr_word.label_id).offset;
+          goal_print_obj = labels.at(cdr_word.label_id()).offset;
           fill.as_pair()->cdr = goos::PairObject::make_new(goos::EmptyListObject::make_new(),
                                                            goos::EmptyListObject::make_new());
           fill = fill.as_pair()->cdr;
@@ -953,7 +978,7 @@ bool LinkedObjectFile::is_string(int seg, int byte_idx) {
     return false;
   }
   auto& type_word = words_by_seg.at(seg).at(type_tag_ptr / 4);
-  return type_word.kind == LinkedWord::TYPE_PTR && type_word.symbol_name == "string";
+  return type_word.is_type_ptr(SymbolNameTable::STRING_ID);
 }
 
 /*!
@@ -968,15 +993,15 @@ goos::Object LinkedObjectFile::to_form_script_object(int seg,
     case 0:
     case 4: {
       auto& word = words_by_seg.at(seg).at(byte_idx / 4);
-      if (word.kind == LinkedWord::SYM_PTR) {
+      if (word.kind() == LinkedWord::SYM_PTR) {
         // .symbol xxxx
-        result = pretty_print::to_symbol(word.symbol_name);
-      } else if (word.kind == LinkedWord::PLAIN_DATA) {
+        result = pretty_print::to_symbol(get_symbol_name(word));
+      } else if (word.kind() == LinkedWord::PLAIN_DATA) {
         // .word xxxxx
         result = pretty_print::to_symbol(std::to_string(word.data));
-      } else if (word.kind == LinkedWord::PTR) {
+      } else if (word.kind() == LinkedWord::PTR) {
         // might be a sub-list, or some other random pointer
-        auto offset = labels.at(word.label_id).offset;
+        auto offset = labels.at(word.label_id()).offset;
         if ((offset & 7) == 2) {
           // list!
           result = to_form_script(seg, offset / 4, seen);
@@ -985,15 +1010,16 @@ goos::Object LinkedObjectFile::to_form_script_object(int seg,
             result = pretty_print::to_symbol(get_goal_string(seg, offset / 4 - 1));
           } else {
             // some random pointer, just print the label.
-            result = pretty_print::to_symbol(labels.at(word.label_id).name);
+            result = pretty_print::to_symbol(labels.at(word.label_id()).name);
           }
         }
-      } else if (word.kind == LinkedWord::EMPTY_PTR) {
+      } else if (word.kind() == LinkedWord::EMPTY_PTR) {
         result = goos::EmptyListObject::make_new();
       } else {
         std::string debug;
         append_word_to_string(debug, word);
-        printf("don't know how to print %s\n", debug.c_str());
+        ordered_log::print(fmt::format("don't know how to print {}\n", debug));
+        ordered_log::flush_captured();
         assert(false);
       }
     } break;
@@ -1001,7 +1027,8 @@ goos::Object LinkedObjectFile::to_form_script_object(int seg,
     case 2:  // bad, a pair snuck through.
     default:
       // pointers should be aligned!
-      printf("align %d\n", byte_idx & 7);
+      ordered_log::print(fmt::format("align {}\n", byte_idx & 7));
+      ordered_log::flush_captured();
       assert(false);
   }
 
@@ -1011,7 +1038,7 @@ goos::Object LinkedObjectFile::to_form_script_object(int seg,
 u32 LinkedObjectFile::read_data_word(const Label& label) {
   assert(0 == (label.offset % 4));
   auto& word = words_by_seg.at(label.target_segment).at(label.offset / 4);
-  assert(word.kind == LinkedWord::Kind::PLAIN_DATA);
+  assert(word.kind() == LinkedWord::Kind::PLAIN_DATA);
   return word.data;
 }
 
@@ -33,6 +33,7 @@ struct Label {
 class LinkedObjectFile {
  public:
   LinkedObjectFile() = default;
+  explicit LinkedObjectFile(SymbolNameTable* _symbol_names) : symbol_names(_symbol_names) {}
   void set_segment_count(int n_segs);
   void push_back_word_to_segment(uint32_t word, int segment);
   int get_label_id_for(int seg, int offset);
@@ -50,7 +51,9 @@ class LinkedObjectFile {
                         LinkedWord::Kind kind);
   void symbol_link_offset(int source_segment, int source_offset, const char* name);
   Function& get_function_at_label(int label_id);
+  Function* try_get_function_containing(int seg, int offset);
   std::string get_label_name(int label_id) const;
+  const std::string& get_symbol_name(const LinkedWord& word) const;
   uint32_t set_ordered_label_names();
   void find_code();
   std::string print_words();
@@ -129,9 +132,12 @@ class LinkedObjectFile {
   int segments = 0;
   std::vector<std::vector<LinkedWord>> words_by_seg;
   std::vector<uint32_t> offset_of_data_zone_by_seg;
-  std::vector<std::vector<Function>> functions_by_seg;
+  std::vector<std::vector<Function>> functions_by_seg;  // sorted by start_word
   std::vector<Label> labels;
 
+  // names of linked symbols, shared by all object files in the ObjectFileDB.
+  SymbolNameTable* symbol_names = nullptr;
+
  private:
   goos::Object to_form_script(int seg, int word_idx, std::vector<bool>& seen);
   goos::Object to_form_script_object(int seg, int byte_idx, std::vector<bool>& seen);
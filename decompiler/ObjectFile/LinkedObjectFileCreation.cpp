@@ -9,6 +9,8 @@
 #include "LinkedObjectFileCreation.h"
 #include "decompiler/config.h"
 #include "decompiler/util/DecompilerTypeSystem.h"
+#include "decompiler/util/OrderedLog.h"
+#include "third-party/fmt/core.h"
 #include "common/link_types.h"
 
 // There are three link versions:
@@ -75,14 +77,14 @@ enum class SymbolLinkKind {
  * Handle symbol links for a single symbol in a V2/V4 object file.
  */
 static uint32_t c_symlink2(LinkedObjectFile& f,
-                           const std::vector<uint8_t>& data,
+                           const ObjectFileBytes& data,
                            uint32_t code_ptr_offset,
                            uint32_t link_ptr_offset,
                            SymbolLinkKind kind,
                            const char* name,
                            int seg_id,
-                           DecompilerTypeSystem& dts) {
-  dts.add_symbol(name);
+                           std::vector<LinkedSymbol>& symbols) {
+  symbols.push_back({name, false});
   auto initial_offset = code_ptr_offset;
   do {
     auto table_value = data.at(link_ptr_offset);
@@ -128,7 +130,7 @@ static uint32_t c_symlink2(LinkedObjectFile& f,
           word_kind = LinkedWord::EMPTY_PTR;
           break;
         case SymbolLinkKind::TYPE:
-          dts.add_symbol(name, "type");
+          symbols.push_back({name, true});
           word_kind = LinkedWord::TYPE_PTR;
           break;
         default:
@@ -155,14 +157,14 @@ static uint32_t c_symlink2(LinkedObjectFile& f,
  * Handle symbol links for a single symbol in a V3 object file.
  */
 static uint32_t c_symlink3(LinkedObjectFile& f,
-                           const std::vector<uint8_t>& data,
+                           const ObjectFileBytes& data,
                            uint32_t code_ptr,
                            uint32_t link_ptr,
                            SymbolLinkKind kind,
                            const char* name,
                            int seg,
-                           DecompilerTypeSystem& dts) {
-  dts.add_symbol(name);
+                           std::vector<LinkedSymbol>& symbols) {
+  symbols.push_back({name, false});
   auto initial_offset = code_ptr;
   do {
     // seek, with a variable length encoding that sucks.
@@ -186,7 +188,7 @@ static uint32_t c_symlink3(LinkedObjectFile& f,
           word_kind = LinkedWord::EMPTY_PTR;
           break;
         case SymbolLinkKind::TYPE:
-          dts.add_symbol(name, "type");
+          symbols.push_back({name, true});
           word_kind = LinkedWord::TYPE_PTR;
           break;
         default:
@@ -231,9 +233,9 @@ static uint32_t align16(uint32_t in) {
  * frame and level data is ~10 MB.
  */
 static void link_v2_or_v4(LinkedObjectFile& f,
-                          const std::vector<uint8_t>& data,
+                          const ObjectFileBytes& data,
                           const std::string& name,
-                          DecompilerTypeSystem& dts) {
+                          std::vector<LinkedSymbol>& symbols) {
   const auto* header = (const LinkHeaderV4*)&data.at(0);
   assert(header->version == 4 || header->version == 2);
 
@@ -309,7 +311,7 @@ static void link_v2_or_v4(LinkedObjectFile& f,
           for (uint8_t i = 0; i < count; i++) {
             if (!f.pointer_link_word(0, code_ptr_offset - code_offset, 0,
                                      *((const uint32_t*)(&data.at(code_ptr_offset))))) {
-              printf("WARNING bad link in %s\n", name.c_str());
+              ordered_log::print(fmt::format("WARNING bad link in {}\n", name));
             }
             f.stats.total_v2_pointers++;
             code_ptr_offset += 4;
@@ -385,7 +387,7 @@ static void link_v2_or_v4(LinkedObjectFile& f,
 
       link_ptr_offset += strlen(s_name) + 1;
       f.stats.total_v2_symbol_count++;
-      link_ptr_offset = c_symlink2(f, data, code_offset, link_ptr_offset, kind, s_name, 0, dts);
+      link_ptr_offset = c_symlink2(f, data, code_offset, link_ptr_offset, kind, s_name, 0, symbols);
       if (data.at(link_ptr_offset) == 0)
         break;
     }
@@ -411,12 +413,12 @@ static void assert_string_empty_after(const char* str, int size) {
 }
 
 static void link_v5(LinkedObjectFile& f,
-                    const std::vector<uint8_t>& data,
+                    const ObjectFileBytes& data,
                     const std::string& name,
-                    DecompilerTypeSystem& dts) {
+                    std::vector<LinkedSymbol>& symbols) {
   auto header = (const LinkHeaderV5*)(&data.at(0));
   if (header->n_segments == 1) {
-    printf("abandon %s!\n", name.c_str());
+    ordered_log::print(fmt::format("abandon {}!\n", name));
     return;
   }
   assert(header->type_tag == 0);
@@ -474,10 +476,10 @@ static void link_v5(LinkedObjectFile& f,
     }
 
     if (adjusted) {
-      printf(
-          "Adjusted the size of segment %d in %s, this is fine, but rare (and may indicate a "
+      ordered_log::print(fmt::format(
+          "Adjusted the size of segment {} in {}, this is fine, but rare (and may indicate a "
           "bigger problem if it happens often)\n",
-          seg_id, name.c_str());
+          seg_id, name));
     }
     //    }
 
@@ -511,7 +513,8 @@ static void link_v5(LinkedObjectFile& f,
               if ((old_code >> 24) == 0) {
                 f.stats.v3_word_pointers++;
                 if (!f.pointer_link_word(seg_id, data_ptr - base_ptr, seg_id, old_code)) {
-                  printf("WARNING bad pointer_link_word (2) in %s\n", name.c_str());
+                  ordered_log::print(
+                      fmt::format("WARNING bad pointer_link_word (2) in {}\n", name));
                 }
               } else {
                 f.stats.v3_split_pointers++;
@@ -568,10 +571,10 @@ static void link_v5(LinkedObjectFile& f,
 
           if (std::string("_empty_") == sname) {
             link_ptr = c_symlink2(f, data, segment_data_offsets[seg_id], link_ptr,
-                                  SymbolLinkKind::EMPTY_LIST, sname, seg_id, dts);
+                                  SymbolLinkKind::EMPTY_LIST, sname, seg_id, symbols);
           } else {
             link_ptr = c_symlink2(f, data, segment_data_offsets[seg_id], link_ptr,
-                                  SymbolLinkKind::SYMBOL, sname, seg_id, dts);
+                                  SymbolLinkKind::SYMBOL, sname, seg_id, symbols);
           }
         } else if ((reloc & 0x3f) == 0x3f) {
           assert(false);  // todo, does this ever get hit?
@@ -585,7 +588,7 @@ static void link_v5(LinkedObjectFile& f,
           const char* sname = (const char*)(&data.at(link_ptr));
           link_ptr += strlen(sname) + 1;
           link_ptr = c_symlink2(f, data, segment_data_offsets[seg_id], link_ptr,
-                                SymbolLinkKind::TYPE, sname, seg_id, dts);
+                                SymbolLinkKind::TYPE, sname, seg_id, symbols);
         }
 
         sub_link_ptr = link_ptr;
@@ -614,9 +617,9 @@ static void link_v5(LinkedObjectFile& f,
 }
 
 static void link_v3(LinkedObjectFile& f,
-                    const std::vector<uint8_t>& data,
+                    const ObjectFileBytes& data,
                     const std::string& name,
-                    DecompilerTypeSystem& dts) {
+                    std::vector<LinkedSymbol>& symbols) {
   auto header = (const LinkHeaderV3*)(&data.at(0));
   assert(name == header->name);
   assert(header->segments == 3);
@@ -675,10 +678,10 @@ static void link_v3(LinkedObjectFile& f,
       }
 
       if (adjusted) {
-        printf(
-            "Adjusted the size of segment %d in %s, this is fine, but rare (and may indicate a "
+        ordered_log::print(fmt::format(
+            "Adjusted the size of segment {} in {}, this is fine, but rare (and may indicate a "
             "bigger problem if it happens often)\n",
-            seg_id, name.c_str());
+            seg_id, name));
       }
     }
 
@@ -712,7 +715,8 @@ static void link_v3(LinkedObjectFile& f,
               if ((old_code >> 24) == 0) {
                 f.stats.v3_word_pointers++;
                 if (!f.pointer_link_word(seg_id, data_ptr - base_ptr, seg_id, old_code)) {
-                  printf("WARNING bad pointer_link_word (2) in %s\n", name.c_str());
+                  ordered_log::print(
+                      fmt::format("WARNING bad pointer_link_word (2) in {}\n", name));
                 }
               } else {
                 f.stats.v3_split_pointers++;
@@ -780,7 +784,7 @@ static void link_v3(LinkedObjectFile& f,
 
       link_ptr += strlen(s_name) + 1;
       f.stats.v3_symbol_count++;
-      link_ptr = c_symlink3(f, data, base_ptr, link_ptr, kind, s_name, seg_id, dts);
+      link_ptr = c_symlink3(f, data, base_ptr, link_ptr, kind, s_name, seg_id, symbols);
     }
     segment_link_ends[seg_id] = link_ptr;
   }
@@ -804,26 +808,44 @@ static void link_v3(LinkedObjectFile& f,
 
 /*!
  * Main function to generate LinkedObjectFiles from raw object data.
+ * Symbol names are interned in symbol_names, which may be shared with other object files.
+ * Symbols referenced by the link data are appended to symbols, in the order they are found.
+ * This doesn't modify any shared state, so it is safe to link several objects at the same time.
  */
-LinkedObjectFile to_linked_object_file(const std::vector<uint8_t>& data,
+LinkedObjectFile to_linked_object_file(const ObjectFileBytes& data,
                                        const std::string& name,
-                                       DecompilerTypeSystem& dts) {
-  LinkedObjectFile result;
+                                       SymbolNameTable& symbol_names,
+                                       std::vector<LinkedSymbol>& symbols) {
+  LinkedObjectFile result(&symbol_names);
   const auto* header = (const LinkHeaderCommon*)&data.at(0);
 
   // use appropriate linker
   if (header->version == 3) {
     assert(header->type_tag == 0);
-    link_v3(result, data, name, dts);
+    link_v3(result, data, name, symbols);
   } else if (header->version == 4 || header->version == 2) {
     assert(header->type_tag == 0xffffffff);
-    link_v2_or_v4(result, data, name, dts);
+    link_v2_or_v4(result, data, name, symbols);
   } else if (header->version == 5) {
-    link_v5(result, data, name, dts);
+    link_v5(result, data, name, symbols);
   } else {
-    printf("Unsupported version %d\n", header->version);
+    ordered_log::print(fmt::format("Unsupported version {}\n", header->version));
+    ordered_log::flush_captured();
     assert(false);
   }
 
   return result;
 }
+
+/*!
+ * Add symbols found by to_linked_object_file to the type system.
+ */
+void add_linked_symbols(const std::vector<LinkedSymbol>& symbols, DecompilerTypeSystem& dts) {
+  for (auto& sym : symbols) {
+    if (sym.is_type) {
+      dts.add_symbol(sym.name, "type");
+    } else {
+      dts.add_symbol(sym.name);
+    }
+  }
+}
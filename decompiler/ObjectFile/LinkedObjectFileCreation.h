@@ -10,10 +10,22 @@
 #define NEXT_LINKEDOBJECTFILECREATION_H
 
 #include "LinkedObjectFile.h"
+#include "ObjectFileBytes.h"
 
 class DecompilerTypeSystem;
-LinkedObjectFile to_linked_object_file(const std::vector<uint8_t>& data,
+
+/*!
+ * A symbol referenced by the link data of an object file.
+ */
+struct LinkedSymbol {
+  std::string name;
+  bool is_type = false;  // linked as a type
+};
+
+LinkedObjectFile to_linked_object_file(const ObjectFileBytes& data,
                                        const std::string& name,
-                                       DecompilerTypeSystem& dts);
+                                       SymbolNameTable& symbol_names,
+                                       std::vector<LinkedSymbol>& symbols);
+void add_linked_symbols(const std::vector<LinkedSymbol>& symbols, DecompilerTypeSystem& dts);
 
 #endif  // NEXT_LINKEDOBJECTFILECREATION_H
@@ -0,0 +1,47 @@
+/*!
+ * @file LinkedWord.cpp
+ * A word (4 bytes), possibly with some linking info.
+ */
+
+#include <mutex>
+#include "LinkedWord.h"
+
+SymbolNameTable::SymbolNameTable() {
+  intern("function");
+  intern("string");
+  assert(name(FUNCTION_ID) == "function");
+  assert(name(STRING_ID) == "string");
+}
+
+/*!
+ * Get the id for a symbol name, adding it to the table if it isn't there already.
+ */
+int SymbolNameTable::intern(const std::string& name) {
+  {
+    std::shared_lock<std::shared_mutex> lk(m_lock);
+    auto it = m_ids.find(name);
+    if (it != m_ids.end()) {
+      return it->second;
+    }
+  }
+
+  std::unique_lock<std::shared_mutex> lk(m_lock);
+  auto it = m_ids.find(name);
+  if (it != m_ids.end()) {
+    return it->second;
+  }
+  int id = int(m_names.size());
+  m_names.push_back(name);
+  m_ids.insert({name, id});
+  return id;
+}
+
+const std::string& SymbolNameTable::name(int id) const {
+  std::shared_lock<std::shared_mutex> lk(m_lock);
+  return m_names.at(id);
+}
+
+int SymbolNameTable::size() const {
+  std::shared_lock<std::shared_mutex> lk(m_lock);
+  return int(m_names.size());
+}
@@ -8,14 +8,44 @@
 #ifndef JAK2_DISASSEMBLER_LINKEDWORD_H
 #define JAK2_DISASSEMBLER_LINKEDWORD_H
 
+#include <cassert>
 #include <cstdint>
+#include <deque>
+#include <shared_mutex>
 #include <string>
+#include <unordered_map>
 
+/*!
+ * Table of symbol names referenced by linked words. Each name is stored once and is referred to by
+ * an id. Safe to use from multiple threads.
+ */
+class SymbolNameTable {
+ public:
+  SymbolNameTable();
+  int intern(const std::string& name);
+  const std::string& name(int id) const;
+  int size() const;
+
+  // type names which are checked for on every word while scanning for code, so they get fixed ids
+  // and can be compared without taking the lock.
+  static constexpr int FUNCTION_ID = 0;
+  static constexpr int STRING_ID = 1;
+
+ private:
+  mutable std::shared_mutex m_lock;
+  std::unordered_map<std::string, int> m_ids;
+  std::deque<std::string> m_names;  // deque, so references to names stay valid as it grows.
+};
+
+/*!
+ * A word (4 bytes), possibly with some linking info.
+ * The kind and the label or symbol id are packed into a second word, so this is only 8 bytes.
+ */
 class LinkedWord {
  public:
   explicit LinkedWord(uint32_t _data) : data(_data) {}
 
-  enum Kind {
+  enum Kind : uint8_t {
     PLAIN_DATA,  // just plain data
     PTR,         // pointer to a location
     HI_PTR,      // lower 16-bits of this data are the upper 16 bits of a pointer
@@ -24,12 +54,63 @@ class LinkedWord {
     EMPTY_PTR,   // this is a pointer to the empty list
     SYM_OFFSET,  // this is an offset of a symbol in the symbol table
     TYPE_PTR     // this is a pointer to a type
-  } kind = PLAIN_DATA;
+  };
 
   uint32_t data = 0;
 
-  int label_id = -1;
-  std::string symbol_name;
+  Kind kind() const { return Kind(m_info & KIND_MASK); }
+
+  bool has_label() const {
+    auto k = kind();
+    return k == PTR || k == HI_PTR || k == LO_PTR;
+  }
+
+  bool has_symbol() const {
+    auto k = kind();
+    return k == SYM_PTR || k == EMPTY_PTR || k == SYM_OFFSET || k == TYPE_PTR;
+  }
+
+  int label_id() const {
+    assert(has_label());
+    return int(m_info >> KIND_BITS);
+  }
+
+  /*!
+   * Get the id of the symbol in the SymbolNameTable for this word's object file.
+   */
+  int symbol_id() const {
+    assert(has_symbol());
+    return int(m_info >> KIND_BITS);
+  }
+
+  /*!
+   * Is this a pointer to the type with the given symbol id?
+   */
+  bool is_type_ptr(int type_symbol_id) const {
+    return kind() == TYPE_PTR && int(m_info >> KIND_BITS) == type_symbol_id;
+  }
+
+  void set_to_label(Kind kind, int label_id) {
+    assert(label_id >= 0 && uint32_t(label_id) <= MAX_ID);
+    m_info = (uint32_t(label_id) << KIND_BITS) | kind;
+    assert(has_label());
+  }
+
+  void set_to_symbol(Kind kind, int symbol_id) {
+    assert(symbol_id >= 0 && uint32_t(symbol_id) <= MAX_ID);
+    m_info = (uint32_t(symbol_id) << KIND_BITS) | kind;
+    assert(has_symbol());
+  }
+
+ private:
+  static constexpr uint32_t KIND_BITS = 4;
+  static constexpr uint32_t KIND_MASK = (1 << KIND_BITS) - 1;
+  static constexpr uint32_t MAX_ID = UINT32_MAX >> KIND_BITS;
+
+  // low bits are the kind, high bits are the label id or symbol id.
+  uint32_t m_info = PLAIN_DATA;
 };
 
+static_assert(sizeof(LinkedWord) == 8, "LinkedWord size");
+
 #endif  // JAK2_DISASSEMBLER_LINKEDWORD_H
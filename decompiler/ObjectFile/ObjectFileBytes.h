@@ -0,0 +1,49 @@
+#pragma once
+
+/*!
+ * @file ObjectFileBytes.h
+ * The raw bytes of an object file.
+ */
+
+#include <memory>
+#include <stdexcept>
+#include <vector>
+#include "common/common_types.h"
+#include "common/util/MappedFile.h"
+
+/*!
+ * The raw bytes of an object file.
+ * These are either owned, or are a view into a memory mapped file. A view keeps its mapping alive.
+ */
+class ObjectFileBytes {
+ public:
+  ObjectFileBytes() = default;
+
+  /*!
+   * Take ownership of some bytes.
+   */
+  explicit ObjectFileBytes(std::vector<u8> owned) : m_owned(std::move(owned)) {}
+
+  /*!
+   * View part of a mapped file, without copying.
+   */
+  ObjectFileBytes(std::shared_ptr<const MappedFile> mapping, const u8* ptr, size_t size)
+      : m_mapping(std::move(mapping)), m_view(ptr), m_view_size(size) {}
+
+  const u8* data() const { return m_mapping ? m_view : m_owned.data(); }
+  size_t size() const { return m_mapping ? m_view_size : m_owned.size(); }
+  bool is_view() const { return bool(m_mapping); }
+
+  const u8& at(size_t idx) const {
+    if (idx >= size()) {
+      throw std::out_of_range("ObjectFileBytes::at");
+    }
+    return data()[idx];
+  }
+
+ private:
+  std::vector<u8> m_owned;
+  std::shared_ptr<const MappedFile> m_mapping;
+  const u8* m_view = nullptr;
+  size_t m_view_size = 0;
+};
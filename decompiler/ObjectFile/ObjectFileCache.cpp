@@ -0,0 +1,365 @@
+/*!
+ * @file ObjectFileCache.cpp
+ * On-disk cache of the results of linking and finding code in object files.
+ */
+
+#include <cstdio>
+#include <stdexcept>
+#include <thread>
+#include <unordered_map>
+#include "ObjectFileCache.h"
+#include "common/util/BinaryReader.h"
+#include "common/util/BinaryWriter.h"
+#include "common/util/FileUtil.h"
+#include "third-party/fmt/core.h"
+
+namespace {
+constexpr uint32_t CACHE_MAGIC = 0x48434344;  // DCCH
+
+struct CacheHeader {
+  uint32_t magic;
+  uint32_t version;
+  uint32_t config_hash;
+  uint32_t obj_hash;
+  uint64_t obj_size;
+};
+
+void add_string(BinaryWriter& writer, const std::string& str) {
+  writer.add<uint32_t>(str.size());
+  writer.add_data(str.data(), str.size());
+}
+
+/*!
+ * Reader for a cache entry. Throws if the entry is truncated, instead of reading past the end.
+ */
+class EntryReader {
+ public:
+  explicit EntryReader(const std::vector<uint8_t>& data) : m_reader(data) {}
+
+  template <typename T>
+  T read() {
+    check(sizeof(T));
+    return m_reader.read<T>();
+  }
+
+  std::string read_string() {
+    auto len = read<uint32_t>();
+    check(len);
+    std::string result((const char*)m_reader.here(), len);
+    m_reader.ffwd(len);
+    return result;
+  }
+
+  bool at_end() const { return m_reader.bytes_left() == 0; }
+
+ private:
+  void check(size_t size) const {
+    if (m_reader.bytes_left() < size) {
+      throw std::runtime_error("cache entry is truncated");
+    }
+  }
+
+  BinaryReader m_reader;
+};
+
+void check(bool condition, const char* what) {
+  if (!condition) {
+    throw std::runtime_error(what);
+  }
+}
+
+void add_atom(BinaryWriter& writer, const InstructionAtom& atom) {
+  writer.add<uint8_t>(atom.kind);
+  switch (atom.kind) {
+    case InstructionAtom::REGISTER:
+      writer.add<Register>(atom.get_reg());
+      break;
+    case InstructionAtom::IMM:
+      writer.add<int32_t>(atom.get_imm());
+      break;
+    case InstructionAtom::IMM_SYM:
+      add_string(writer, atom.get_sym());
+      break;
+    case InstructionAtom::LABEL:
+      writer.add<int32_t>(atom.get_label());
+      break;
+    default:
+      break;
+  }
+}
+
+InstructionAtom read_atom(EntryReader& reader, const LinkedObjectFile& file) {
+  InstructionAtom atom;
+  auto kind = reader.read<uint8_t>();
+  switch (kind) {
+    case InstructionAtom::REGISTER:
+      atom.set_reg(reader.read<Register>());
+      break;
+    case InstructionAtom::IMM:
+      atom.set_imm(reader.read<int32_t>());
+      break;
+    case InstructionAtom::IMM_SYM:
+      atom.set_sym(reader.read_string());
+      break;
+    case InstructionAtom::LABEL: {
+      auto label = reader.read<int32_t>();
+      check(label >= 0 && label < int(file.labels.size()), "bad label in cached instruction");
+      atom.set_label(label);
+    } break;
+    case InstructionAtom::VU_ACC:
+      atom.set_vu_acc();
+      break;
+    case InstructionAtom::VU_Q:
+      atom.set_vu_q();
+      break;
+    case InstructionAtom::INVALID:
+      break;
+    default:
+      throw std::runtime_error("bad atom kind in cache entry");
+  }
+  return atom;
+}
+
+void add_instruction(BinaryWriter& writer, const Instruction& instr) {
+  writer.add<uint16_t>((uint16_t)instr.kind);
+  writer.add<uint8_t>(instr.n_src);
+  writer.add<uint8_t>(instr.n_dst);
+  writer.add<uint8_t>(instr.cop2_dest);
+  writer.add<uint8_t>(instr.cop2_bc);
+  writer.add<uint8_t>(instr.il);
+  for (int i = 0; i < instr.n_src; i++) {
+    add_atom(writer, instr.src[i]);
+  }
+  for (int i = 0; i < instr.n_dst; i++) {
+    add_atom(writer, instr.dst[i]);
+  }
+}
+
+Instruction read_instruction(EntryReader& reader, const LinkedObjectFile& file) {
+  Instruction instr;
+  auto kind = reader.read<uint16_t>();
+  check(kind < (uint16_t)InstructionKind::EE_OP_MAX, "bad instruction kind in cache entry");
+  instr.kind = (InstructionKind)kind;
+  auto n_src = reader.read<uint8_t>();
+  auto n_dst = reader.read<uint8_t>();
+  check(n_src <= MAX_INSTRUCTION_SOURCE && n_dst <= MAX_INTRUCTION_DEST,
+        "bad atom count in cache entry");
+  instr.cop2_dest = reader.read<uint8_t>();
+  instr.cop2_bc = reader.read<uint8_t>();
+  instr.il = reader.read<uint8_t>();
+  for (int i = 0; i < n_src; i++) {
+    auto atom = read_atom(reader, file);
+    instr.add_src(atom);
+  }
+  for (int i = 0; i < n_dst; i++) {
+    auto atom = read_atom(reader, file);
+    instr.add_dst(atom);
+  }
+  return instr;
+}
+}  // namespace
+
+ObjectFileCache::ObjectFileCache(std::string cache_dir, uint32_t config_hash)
+    : m_cache_dir(std::move(cache_dir)), m_config_hash(config_hash) {
+  file_util::create_dir_if_needed(m_cache_dir);
+}
+
+std::string ObjectFileCache::entry_path(uint32_t obj_hash, size_t obj_size) const {
+  return file_util::combine_path(m_cache_dir, fmt::format("{:08x}-{:x}.bin", obj_hash, obj_size));
+}
+
+/*!
+ * Try to load the cached LinkedObjectFile for an object.
+ * Returns false if there is no usable cache entry, in which case result and symbols are unchanged.
+ */
+bool ObjectFileCache::load(uint32_t obj_hash,
+                           size_t obj_size,
+                           SymbolNameTable& symbol_names,
+                           LinkedObjectFile& result,
+                           std::vector<LinkedSymbol>& symbols) const {
+  std::vector<uint8_t> data;
+  try {
+    data = file_util::read_binary_file(entry_path(obj_hash, obj_size));
+  } catch (std::runtime_error&) {
+    return false;
+  }
+
+  try {
+    EntryReader reader(data);
+    auto header = reader.read<CacheHeader>();
+    if (header.magic != CACHE_MAGIC || header.version != OBJECT_FILE_CACHE_VERSION ||
+        header.config_hash != m_config_hash || header.obj_hash != obj_hash ||
+        header.obj_size != obj_size) {
+      return false;
+    }
+
+    LinkedObjectFile file(&symbol_names);
+    auto segments = reader.read<int32_t>();
+    check(segments >= 0 && segments <= 3, "bad segment count in cache entry");
+    file.set_segment_count(segments);
+
+    // symbols referenced by words, numbered in the order they appear in the entry.
+    std::vector<int> symbol_ids;
+    auto symbol_count = reader.read<uint32_t>();
+    for (uint32_t i = 0; i < symbol_count; i++) {
+      symbol_ids.push_back(symbol_names.intern(reader.read_string()));
+    }
+
+    auto label_count = reader.read<uint32_t>();
+    for (uint32_t i = 0; i < label_count; i++) {
+      auto seg = reader.read<int32_t>();
+      auto offset = reader.read<int32_t>();
+      check(seg >= 0 && seg < segments, "bad label segment in cache entry");
+      check(file.get_label_id_for(seg, offset) == int(i), "duplicate label in cache entry");
+      file.labels.at(i).name = reader.read_string();
+    }
+
+    for (int seg = 0; seg < segments; seg++) {
+      file.offset_of_data_zone_by_seg.at(seg) = reader.read<uint32_t>();
+      auto word_count = reader.read<uint32_t>();
+      for (uint32_t i = 0; i < word_count; i++) {
+        file.push_back_word_to_segment(reader.read<uint32_t>(), seg);
+        auto kind = (LinkedWord::Kind)reader.read<uint8_t>();
+        auto id = reader.read<uint32_t>();
+        auto& word = file.words_by_seg.at(seg).back();
+        switch (kind) {
+          case LinkedWord::PLAIN_DATA:
+            break;
+          case LinkedWord::PTR:
+          case LinkedWord::HI_PTR:
+          case LinkedWord::LO_PTR:
+            check(id < label_count, "bad label id in cache entry");
+            word.set_to_label(kind, id);
+            break;
+          case LinkedWord::SYM_PTR:
+          case LinkedWord::EMPTY_PTR:
+          case LinkedWord::SYM_OFFSET:
+          case LinkedWord::TYPE_PTR:
+            check(id < symbol_count, "bad symbol id in cache entry");
+            word.set_to_symbol(kind, symbol_ids.at(id));
+            break;
+          default:
+            throw std::runtime_error("bad word kind in cache entry");
+        }
+      }
+    }
+
+    for (int seg = 0; seg < segments; seg++) {
+      auto function_count = reader.read<uint32_t>();
+      for (uint32_t i = 0; i < function_count; i++) {
+        auto start_word = reader.read<int32_t>();
+        auto end_word = reader.read<int32_t>();
+        auto& func = file.functions_by_seg.at(seg).emplace_back(start_word, end_word);
+        func.uses_fp_register = reader.read<uint8_t>();
+        auto instruction_count = reader.read<uint32_t>();
+        for (uint32_t j = 0; j < instruction_count; j++) {
+          func.instructions.push_back(read_instruction(reader, file));
+        }
+      }
+    }
+
+    std::vector<LinkedSymbol> linked_symbols;
+    auto linked_symbol_count = reader.read<uint32_t>();
+    for (uint32_t i = 0; i < linked_symbol_count; i++) {
+      LinkedSymbol sym;
+      sym.name = reader.read_string();
+      sym.is_type = reader.read<uint8_t>();
+      linked_symbols.push_back(sym);
+    }
+
+    file.stats = reader.read<LinkedObjectFile::Stats>();
+    check(reader.at_end(), "cache entry has extra data");
+
+    result = std::move(file);
+    symbols = std::move(linked_symbols);
+    return true;
+  } catch (std::runtime_error&) {
+    // a bad entry is treated as a miss, and will be replaced.
+    return false;
+  }
+}
+
+/*!
+ * Save an object's LinkedObjectFile, after find_code, and the symbols found while linking it.
+ */
+void ObjectFileCache::save(uint32_t obj_hash,
+                           size_t obj_size,
+                           const LinkedObjectFile& file,
+                           const std::vector<LinkedSymbol>& symbols) const {
+  BinaryWriter writer;
+  writer.add<CacheHeader>(
+      {CACHE_MAGIC, OBJECT_FILE_CACHE_VERSION, m_config_hash, obj_hash, (uint64_t)obj_size});
+  writer.add<int32_t>(file.segments);
+
+  // give the symbols used by this object their own ids, in the order they are first used.
+  std::unordered_map<int, uint32_t> local_symbol_ids;
+  std::vector<const std::string*> local_symbols;
+  for (auto& seg : file.words_by_seg) {
+    for (auto& word : seg) {
+      if (word.has_symbol() && local_symbol_ids.find(word.symbol_id()) == local_symbol_ids.end()) {
+        local_symbol_ids[word.symbol_id()] = local_symbols.size();
+        local_symbols.push_back(&file.get_symbol_name(word));
+      }
+    }
+  }
+
+  writer.add<uint32_t>(local_symbols.size());
+  for (auto name : local_symbols) {
+    add_string(writer, *name);
+  }
+
+  writer.add<uint32_t>(file.labels.size());
+  for (auto& label : file.labels) {
+    writer.add<int32_t>(label.target_segment);
+    writer.add<int32_t>(label.offset);
+    add_string(writer, label.name);
+  }
+
+  for (int seg = 0; seg < file.segments; seg++) {
+    writer.add<uint32_t>(file.offset_of_data_zone_by_seg.at(seg));
+    writer.add<uint32_t>(file.words_by_seg.at(seg).size());
+    for (auto& word : file.words_by_seg.at(seg)) {
+      writer.add<uint32_t>(word.data);
+      writer.add<uint8_t>(word.kind());
+      if (word.has_label()) {
+        writer.add<uint32_t>(word.label_id());
+      } else if (word.has_symbol()) {
+        writer.add<uint32_t>(local_symbol_ids.at(word.symbol_id()));
+      } else {
+        writer.add<uint32_t>(0);
+      }
+    }
+  }
+
+  for (int seg = 0; seg < file.segments; seg++) {
+    writer.add<uint32_t>(file.functions_by_seg.at(seg).size());
+    for (auto& func : file.functions_by_seg.at(seg)) {
+      writer.add<int32_t>(func.start_word);
+      writer.add<int32_t>(func.end_word);
+      writer.add<uint8_t>(func.uses_fp_register);
+      writer.add<uint32_t>(func.instructions.size());
+      for (auto& instr : func.instructions) {
+        add_instruction(writer, instr);
+      }
+    }
+  }
+
+  writer.add<uint32_t>(symbols.size());
+  for (auto& sym : symbols) {
+    add_string(writer, sym.name);
+    writer.add<uint8_t>(sym.is_type);
+  }
+
+  writer.add<LinkedObjectFile::Stats>(file.stats);
+
+  // write to a temporary file first, so an interrupted run can't leave a partial entry behind.
+  // objects with different names may have the same data, so the name is unique to this thread.
+  auto path = entry_path(obj_hash, obj_size);
+  auto temp_path =
+      fmt::format("{}.{:x}.tmp", path, std::hash<std::thread::id>()(std::this_thread::get_id()));
+  writer.write_to_file(temp_path);
+  std::remove(path.c_str());
+  if (std::rename(temp_path.c_str(), path.c_str())) {
+    throw std::runtime_error("failed to write cache entry " + path);
+  }
+}
@@ -0,0 +1,45 @@
+#pragma once
+
+/*!
+ * @file ObjectFileCache.h
+ * On-disk cache of the results of linking and finding code in object files.
+ */
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "LinkedObjectFile.h"
+#include "LinkedObjectFileCreation.h"
+
+/*!
+ * Increase this when a change to linking, find_code, the disassembler or the cache format changes
+ * the results, so old cache entries aren't used.
+ */
+constexpr uint32_t OBJECT_FILE_CACHE_VERSION = 1;
+
+/*!
+ * On-disk cache of the results of linking and finding code in object files.
+ * Each entry holds the state of a LinkedObjectFile after find_code (words, labels, functions and
+ * their instructions) and the symbols found while linking. Entries are keyed by the object's hash
+ * and size, and are only used if they were created with the same config and cache version.
+ */
+class ObjectFileCache {
+ public:
+  ObjectFileCache(std::string cache_dir, uint32_t config_hash);
+
+  bool load(uint32_t obj_hash,
+            size_t obj_size,
+            SymbolNameTable& symbol_names,
+            LinkedObjectFile& result,
+            std::vector<LinkedSymbol>& symbols) const;
+  void save(uint32_t obj_hash,
+            size_t obj_size,
+            const LinkedObjectFile& file,
+            const std::vector<LinkedSymbol>& symbols) const;
+
+ private:
+  std::string entry_path(uint32_t obj_hash, size_t obj_size) const;
+
+  std::string m_cache_dir;
+  uint32_t m_config_hash = 0;
+};
@@ -7,6 +7,8 @@
 
 #include "ObjectFileDB.h"
 #include <algorithm>
+#include <atomic>
+#include <future>
 #include <set>
 #include <cstring>
 #include <map>
@@ -19,10 +21,12 @@
 #include "common/util/BinaryReader.h"
 #include "common/util/Timer.h"
 #include "common/util/FileUtil.h"
+#include "decompiler/Disasm/InstructionDecode.h"
 #include "decompiler/Function/BasicBlocks.h"
 #include "decompiler/IR/BasicOpBuilder.h"
 #include "decompiler/IR/CfgBuilder.h"
 #include "decompiler/Function/TypeInspector.h"
+#include "decompiler/util/AsyncFileWriter.h"
 #include "third-party/spdlog/include/spdlog/spdlog.h"
 #include "third-party/json.hpp"
 
@@ -108,9 +112,15 @@ ObjectFileData& ObjectFileDB::lookup_record(const ObjectFileRecord& rec) {
 ObjectFileDB::ObjectFileDB(const std::vector<std::string>& _dgos,
                            const std::string& obj_file_name_map_file,
                            const std::vector<std::string>& object_files,
-                           const std::vector<std::string>& str_files) {
+                           const std::vector<std::string>& str_files)
+    : pool(get_config().threads) {
   Timer timer;
 
+  spdlog::info("-Using {} thread(s)", pool.thread_count());
+  if (!get_config().cache_dir.empty()) {
+    spdlog::info("-Using object file cache in {}", get_config().cache_dir);
+    cache = std::make_unique<ObjectFileCache>(get_config().cache_dir, get_config().hash);
+  }
   spdlog::info("-Loading types...");
   dts.parse_type_defs({"decompiler", "config", "all-types.gc"});
 
@@ -125,38 +135,36 @@ ObjectFileDB::ObjectFileDB(const std::vector<std::string>& _dgos,
   }
 
   spdlog::info("-Loading DGOs...");
+  std::vector<std::string> needed_dgos;
   for (auto& dgo : _dgos) {
-    get_objs_from_dgo(dgo);
+    if (is_dgo_needed(dgo)) {
+      needed_dgos.push_back(dgo);
+    }
+  }
+  if (needed_dgos.size() != _dgos.size()) {
+    spdlog::info("Skipping {} DGOs with no allowed objects", _dgos.size() - needed_dgos.size());
   }
+  load_dgos(needed_dgos);
 
   spdlog::info("-Loading plain object files...");
   for (auto& obj : object_files) {
-    auto data = file_util::read_binary_file(obj);
+    auto mapping = std::make_shared<const MappedFile>(obj);
     auto name = obj_filename_to_name(obj);
-    add_obj_from_dgo(name, name, data.data(), data.size(), "NO-XGO");
+    add_obj_from_dgo(name, name, mapping->data(), mapping->size(), "NO-XGO", mapping);
   }
 
   spdlog::info("-Loading streaming object files...");
-  for (auto& obj : str_files) {
-    StrFileReader reader(obj);
-    // name from the file name
-    std::string base_name = obj_filename_to_name(obj);
-    // name from inside the file (this does a lot of sanity checking)
-    auto obj_name = reader.get_full_name(base_name + ".STR");
-    for (int i = 0; i < reader.chunk_count(); i++) {
-      // append the chunk ID to the full name
-      std::string name = obj_name + fmt::format("+{}", i);
-      auto& data = reader.get_chunk(i);
-      add_obj_from_dgo(name, name, data.data(), data.size(), "NO-XGO");
-    }
-  }
+  load_str_files(str_files);
 
   spdlog::info("ObjectFileDB Initialized:");
-  spdlog::info("Total DGOs: {}", int(_dgos.size()));
+  spdlog::info("Total DGOs: {}", int(needed_dgos.size()));
   spdlog::info("Total data: {} bytes", stats.total_dgo_bytes);
   spdlog::info("Total objs: {}", stats.total_obj_files);
   spdlog::info("Unique objs: {}", stats.unique_obj_files);
   spdlog::info("Unique data: {} bytes", stats.unique_obj_bytes);
+  if (!get_config().allowed_objects.empty()) {
+    spdlog::info("Skipped objs: {} (not in allowed_objects)", stats.skipped_obj_files);
+  }
   spdlog::info("Total {:.2f} ms ({:.3f} MB/sec, {:.2f} obj/sec)", timer.getMs(),
                stats.total_dgo_bytes / ((1u << 20u) * timer.getSeconds()),
                stats.total_obj_files / timer.getSeconds());
@@ -187,6 +195,50 @@ void ObjectFileDB::load_map_file(const std::string& map_data) {
   }
 }
 
+/*!
+ * Should this object be added to the database? Objects are allowed if allowed_objects is empty,
+ * or if their name (or their name in the map file) matches one of its globs.
+ */
+bool ObjectFileDB::is_object_allowed(const std::string& obj_name,
+                                     const std::string& dgo_name) const {
+  const auto& allowed = get_config().allowed_objects;
+  if (allowed.empty() || file_util::glob_match_any(allowed, obj_name)) {
+    return true;
+  }
+
+  auto dgo_kv = dgo_obj_name_map.find(strip_dgo_extension(dgo_name));
+  if (dgo_kv != dgo_obj_name_map.end()) {
+    auto name_kv = dgo_kv->second.find(obj_name);
+    if (name_kv != dgo_kv->second.end()) {
+      return file_util::glob_match_any(allowed, name_kv->second);
+    }
+  }
+  return false;
+}
+
+/*!
+ * Does this DGO need to be loaded? Uses the map file to find out what's in the DGO without loading
+ * it. Without a map file, every DGO has to be loaded to see which objects it contains.
+ */
+bool ObjectFileDB::is_dgo_needed(const std::string& dgo_file) const {
+  if (get_config().allowed_objects.empty()) {
+    return true;
+  }
+
+  auto dgo_name = file_util::base_name(dgo_file);
+  auto dgo_kv = dgo_obj_name_map.find(strip_dgo_extension(dgo_name));
+  if (dgo_kv == dgo_obj_name_map.end()) {
+    return true;
+  }
+
+  for (auto& name_kv : dgo_kv->second) {
+    if (is_object_allowed(name_kv.first, dgo_name)) {
+      return true;
+    }
+  }
+  return false;
+}
+
 // Header for a DGO file
 struct DgoHeader {
   uint32_t size;
@@ -210,7 +262,9 @@ void assert_string_empty_after(const char* str, int size) {
 }  // namespace
 
 namespace {
-std::string get_object_file_name(const std::string& original_name, uint8_t* data, int size) {
+std::string get_object_file_name(const std::string& original_name,
+                                 const uint8_t* data,
+                                 int size) {
   const char art_group_text[] =
       "/src/next/data/art-group6/";  // todo, this may change in other games
   const char suffix[] = "-ag.go";
@@ -244,68 +298,217 @@ std::string get_object_file_name(const std::string& original_name, uint8_t* data
 }  // namespace
 
 constexpr int MAX_CHUNK_SIZE = 0x8000;
+
+namespace {
 /*!
- * Load the objects stored in the given DGO into the ObjectFileDB
+ * Does this DGO file start with the header for a compressed DGO?
  */
-void ObjectFileDB::get_objs_from_dgo(const std::string& filename) {
-  auto dgo_data = file_util::read_binary_file(filename);
-  stats.total_dgo_bytes += dgo_data.size();
-
+bool is_compressed_dgo(const MappedFile& file) {
   const char jak2_header[] = "oZlB";
-  bool is_jak2 = true;
-  for (int i = 0; i < 4; i++) {
-    if (jak2_header[i] != dgo_data[i]) {
-      is_jak2 = false;
+  if (file.size() < 4) {
+    return false;
+  }
+  return !memcmp(file.data(), jak2_header, 4);
+}
+
+/*!
+ * A chunk of a compressed DGO. Every chunk decompresses to MAX_CHUNK_SIZE bytes, except the last.
+ */
+struct DgoChunk {
+  const uint8_t* data = nullptr;
+  uint32_t size = 0;  // size in the file
+  bool compressed = false;
+  size_t output_offset = 0;
+  size_t output_size = 0;
+};
+
+/*!
+ * Find the chunks of a compressed (oZlB) DGO. The size of each chunk is stored before it, so this
+ * doesn't need to decompress anything.
+ */
+std::vector<DgoChunk> find_dgo_chunks(const MappedFile& file, uint32_t* decompressed_size) {
+  BinaryReader compressed_reader(file.data(), file.size());
+  // seek past oZlB
+  compressed_reader.ffwd(4);
+  *decompressed_size = compressed_reader.read<uint32_t>();
+  std::vector<DgoChunk> chunks;
+  size_t output_offset = 0;
+  while (output_offset < *decompressed_size) {
+    // seek past alignment bytes and read the next chunk size
+    uint32_t chunk_size = 0;
+    while (!chunk_size) {
+      chunk_size = compressed_reader.read<uint32_t>();
+    }
+
+    DgoChunk chunk;
+    chunk.data = compressed_reader.here();
+    chunk.output_offset = output_offset;
+    chunk.output_size = std::min(size_t(MAX_CHUNK_SIZE), *decompressed_size - output_offset);
+    if (chunk_size < MAX_CHUNK_SIZE) {
+      chunk.compressed = true;
+      chunk.size = chunk_size;
+    } else {
+      // nope - sometimes chunk_size is bigger than MAX, but we should still use max.
+      //        assert(chunk_size == MAX_CHUNK_SIZE);
+      chunk.size = MAX_CHUNK_SIZE;
+    }
+    chunks.push_back(chunk);
+    compressed_reader.ffwd(chunk.size);
+    output_offset += chunk.output_size;
+
+    while (output_offset < *decompressed_size && compressed_reader.get_seek() % 4) {
+      compressed_reader.ffwd(1);
     }
   }
+  return chunks;
+}
 
-  if (is_jak2) {
-    if (lzo_init() != LZO_E_OK) {
-      assert(false);
+/*!
+ * Decompress a compressed (oZlB) DGO. The chunks are independent, so they are decompressed in
+ * parallel.
+ */
+std::vector<uint8_t> decompress_dgo(const MappedFile& file, ThreadPool& pool) {
+  uint32_t decompressed_size = 0;
+  auto chunks = find_dgo_chunks(file, &decompressed_size);
+  std::vector<uint8_t> decompressed_data(decompressed_size);
+
+  pool.parallel_for(chunks.size(), [&](size_t idx) {
+    auto& chunk = chunks.at(idx);
+    auto dest = decompressed_data.data() + chunk.output_offset;
+    if (!chunk.compressed) {
+      memcpy(dest, chunk.data, chunk.output_size);
+      return;
     }
-    BinaryReader compressed_reader(dgo_data);
-    // seek past oZlB
-    compressed_reader.ffwd(4);
-    auto decompressed_size = compressed_reader.read<uint32_t>();
-    std::vector<uint8_t> decompressed_data;
-    decompressed_data.resize(decompressed_size);
-    size_t output_offset = 0;
-    while (true) {
-      // seek past alignment bytes and read the next chunk size
-      uint32_t chunk_size = 0;
-      while (!chunk_size) {
-        chunk_size = compressed_reader.read<uint32_t>();
-      }
 
-      if (chunk_size < MAX_CHUNK_SIZE) {
-        lzo_uint bytes_written;
-        auto lzo_rv =
-            lzo1x_decompress(compressed_reader.here(), chunk_size,
-                             decompressed_data.data() + output_offset, &bytes_written, nullptr);
-        assert(lzo_rv == LZO_E_OK);
-        compressed_reader.ffwd(chunk_size);
-        output_offset += bytes_written;
-      } else {
-        // nope - sometimes chunk_size is bigger than MAX, but we should still use max.
-        //        assert(chunk_size == MAX_CHUNK_SIZE);
-        memcpy(decompressed_data.data() + output_offset, compressed_reader.here(), MAX_CHUNK_SIZE);
-        compressed_reader.ffwd(MAX_CHUNK_SIZE);
-        output_offset += MAX_CHUNK_SIZE;
-      }
+    lzo_uint bytes_written = chunk.output_size;
+    auto lzo_rv = lzo1x_decompress_safe(chunk.data, chunk.size, dest, &bytes_written, nullptr);
+    if (lzo_rv != LZO_E_OK || bytes_written != chunk.output_size) {
+      throw std::runtime_error(fmt::format(
+          "Failed to decompress DGO {}: chunk at 0x{:x} decompressed to {} bytes (expected {})",
+          file.name(), chunk.data - file.data(), bytes_written, chunk.output_size));
+    }
+  });
+  return decompressed_data;
+}
+}  // namespace
 
-      if (output_offset >= decompressed_size)
-        break;
-      while (compressed_reader.get_seek() % 4) {
-        compressed_reader.ffwd(1);
-      }
+/*!
+ * Map a DGO, and decompress it if needed. Doesn't modify the ObjectFileDB, so several DGOs can be
+ * loaded at the same time.
+ */
+ObjectFileDB::LoadedDgo ObjectFileDB::load_dgo(const std::string& filename, ThreadPool& pool) {
+  LoadedDgo result;
+  result.name = filename;
+  result.mapping = std::make_shared<const MappedFile>(filename);
+  result.file_size = result.mapping->size();
+  if (is_compressed_dgo(*result.mapping)) {
+    result.decompressed_data = decompress_dgo(*result.mapping, pool);
+    // objects will be copied out of the decompressed data, so don't hold on to the mapping.
+    result.mapping.reset();
+  }
+  return result;
+}
+
+/*!
+ * Load all DGOs. This is a pipeline:
+ *  - DGOs are mapped and decompressed by the thread pool, several at a time. The chunks of a
+ *    compressed DGO are decompressed in parallel too.
+ *  - As each DGO finishes (in order), its objects are added to the database on this thread.
+ * Only a few DGOs are loaded ahead of the one being added, to limit memory use.
+ */
+void ObjectFileDB::load_dgos(const std::vector<std::string>& dgos) {
+  if (lzo_init() != LZO_E_OK) {
+    assert(false);
+  }
+
+  std::vector<std::promise<LoadedDgo>> loaded(dgos.size());
+  std::vector<std::future<LoadedDgo>> results;
+  for (auto& x : loaded) {
+    results.push_back(x.get_future());
+  }
+
+  size_t next_to_start = 0;
+  auto start_next = [&]() {
+    if (next_to_start < dgos.size()) {
+      auto idx = next_to_start++;
+      pool.run([&, idx]() {
+        try {
+          profiler::ScopedObject profile([&] { return file_util::base_name(dgos.at(idx)); }, 0);
+          auto dgo = load_dgo(dgos.at(idx), pool);
+          profile.set_bytes(dgo.file_size);
+          loaded.at(idx).set_value(std::move(dgo));
+        } catch (...) {
+          loaded.at(idx).set_exception(std::current_exception());
+        }
+      });
     }
-    dgo_data = decompressed_data;
+  };
+
+  size_t max_in_flight = 2 * pool.thread_count();
+  while (next_to_start < std::min(max_in_flight, dgos.size())) {
+    start_next();
   }
 
-  BinaryReader reader(dgo_data);
+  try {
+    for (auto& result : results) {
+      auto dgo = result.get();
+      start_next();
+      add_objs_from_dgo(dgo);
+    }
+  } catch (...) {
+    // DGOs which are still loading write to loaded, so wait for them before it goes away.
+    pool.wait();
+    throw;
+  }
+
+  pool.wait();
+}
+
+/*!
+ * Map and check all the STR files in parallel, then add their chunks to the ObjectFileDB in order.
+ * Chunks are views into the mappings, so no STR data is copied, and only the pages that are used
+ * are ever read.
+ */
+void ObjectFileDB::load_str_files(const std::vector<std::string>& str_files) {
+  struct LoadedStr {
+    std::unique_ptr<StrFileReader> reader;
+    std::string name;
+  };
+  std::vector<LoadedStr> loaded(str_files.size());
+
+  pool.parallel_for(str_files.size(), [&](size_t idx) {
+    auto& file = str_files.at(idx);
+    profiler::ScopedObject profile([&] { return file_util::base_name(file); }, 0);
+    auto reader = std::make_unique<StrFileReader>(file);
+    profile.set_bytes(reader->mapping()->size());
+    // name from inside the file (this does a lot of sanity checking)
+    loaded.at(idx).name = reader->get_full_name(obj_filename_to_name(file) + ".STR");
+    loaded.at(idx).reader = std::move(reader);
+  });
+
+  for (auto& str : loaded) {
+    for (int i = 0; i < str.reader->chunk_count(); i++) {
+      // append the chunk ID to the full name
+      std::string name = str.name + fmt::format("+{}", i);
+      auto& chunk = str.reader->get_chunk(i);
+      add_obj_from_dgo(name, name, chunk.data, chunk.size, "NO-XGO", str.reader->mapping());
+    }
+  }
+}
+
+/*!
+ * Add the objects stored in a loaded DGO to the ObjectFileDB.
+ * Objects from an uncompressed DGO are views into the mapping, so only the pages of unique objects
+ * are ever read. Objects from a compressed DGO are copied out of the decompressed data.
+ */
+void ObjectFileDB::add_objs_from_dgo(const LoadedDgo& dgo) {
+  stats.total_dgo_bytes += dgo.file_size;
+
+  BinaryReader reader = dgo.mapping ? BinaryReader(dgo.mapping->data(), dgo.mapping->size())
+                                    : BinaryReader(dgo.decompressed_data);
   auto header = reader.read<DgoHeader>();
 
-  auto dgo_base_name = file_util::base_name(filename);
+  auto dgo_base_name = file_util::base_name(dgo.name);
   assert(header.name == dgo_base_name);
   assert_string_empty_after(header.name, 60);
 
@@ -325,7 +528,8 @@ void ObjectFileDB::get_objs_from_dgo(const std::string& filename) {
 
     auto name = get_object_file_name(obj_header.name, reader.here(), obj_header.size);
 
-    add_obj_from_dgo(name, obj_header.name, reader.here(), obj_header.size, dgo_base_name);
+    add_obj_from_dgo(name, obj_header.name, reader.here(), obj_header.size, dgo_base_name,
+                     dgo.mapping);
     reader.ffwd(obj_header.size);
   }
 
@@ -334,14 +538,22 @@ void ObjectFileDB::get_objs_from_dgo(const std::string& filename) {
 }
 
 /*!
- * Add an object file to the ObjectFileDB
+ * Add an object file to the ObjectFileDB.
+ * The object is hashed where it is, and is only copied if it hasn't been seen before. If obj_data
+ * points into mapping, the object keeps a view of the mapping instead of making a copy.
  */
 void ObjectFileDB::add_obj_from_dgo(const std::string& obj_name,
                                     const std::string& name_in_dgo,
                                     const uint8_t* obj_data,
                                     uint32_t obj_size,
-                                    const std::string& dgo_name) {
+                                    const std::string& dgo_name,
+                                    const std::shared_ptr<const MappedFile>& mapping) {
   stats.total_obj_files++;
+  if (!is_object_allowed(obj_name, dgo_name)) {
+    stats.skipped_obj_files++;
+    return;
+  }
+
   assert(obj_size > 128);
   uint16_t version = *(const uint16_t*)(obj_data + 8);
   auto hash = file_util::crc32(obj_data, obj_size);
@@ -372,8 +584,11 @@ void ObjectFileDB::add_obj_from_dgo(const std::string& obj_name,
 
   // nope, have to add a new one.
   ObjectFileData data;
-  data.data.resize(obj_size);
-  memcpy(data.data.data(), obj_data, obj_size);
+  if (mapping) {
+    data.data = ObjectFileBytes(mapping, obj_data, obj_size);
+  } else {
+    data.data = ObjectFileBytes(std::vector<uint8_t>(obj_data, obj_data + obj_size));
+  }
   data.record.hash = hash;
   data.record.name = obj_name;
   data.dgo_names.push_back(dgo_name);
@@ -426,7 +641,7 @@ std::string ObjectFileDB::generate_dgo_listing() {
   for (const auto& name : dgo_names) {
     result += "(\"" + name + "\"\n";
     for (auto& obj_rec : obj_files_by_dgo[name]) {
-      auto obj = lookup_record(obj_rec);
+      auto& obj = lookup_record(obj_rec);
       std::string extension = ".o";
       if (obj.obj_version == 4 || obj.obj_version == 2) {
         extension = ".go";
@@ -471,8 +686,10 @@ std::string ObjectFileDB::generate_obj_listing() {
   // this check is extremely important. It makes sure we don't have any repeat names. This could
   // be caused by two files with the same name, in the same DGOs, but different data.
   assert(int(all_unique_names.size()) == unique_count);
-  result.pop_back();  // kill last new line
-  result.pop_back();  // kill last comma
+  if (unique_count) {
+    result.pop_back();  // kill last new line
+    result.pop_back();  // kill last comma
+  }
   return result + "]";
 }
 
@@ -485,11 +702,31 @@ void ObjectFileDB::process_link_data() {
 
   LinkedObjectFile::Stats combined_stats;
 
+  for_each_obj_parallel([&](ObjectFileData& obj) {
+    obj.loaded_from_cache =
+        cache && cache->load(obj.record.hash, obj.data.size(), symbol_names, obj.linked_data,
+                             obj.linked_symbols);
+    if (!obj.loaded_from_cache) {
+      obj.linked_data =
+          to_linked_object_file(obj.data, obj.record.name, symbol_names, obj.linked_symbols);
+    }
+  });
+
+  // symbols are added to the type system in object order, so the output doesn't depend on the
+  // order the objects were linked in.
+  int cached_count = 0;
   for_each_obj([&](ObjectFileData& obj) {
-    obj.linked_data = to_linked_object_file(obj.data, obj.record.name, dts);
+    add_linked_symbols(obj.linked_symbols, dts);
     combined_stats.add(obj.linked_data.stats);
+    if (obj.loaded_from_cache) {
+      cached_count++;
+    }
   });
 
+  if (cache) {
+    spdlog::info("Loaded {} / {} objects from the cache", cached_count, obj_count());
+  }
+
   spdlog::info("Processed Link Data:");
   spdlog::info(" Code {} bytes", combined_stats.total_code_bytes);
   spdlog::info(" v2 Code {} bytes", combined_stats.total_v2_code_bytes);
@@ -520,7 +757,11 @@ void ObjectFileDB::process_labels() {
   spdlog::info("- Processing Labels...");
   Timer process_label_timer;
   uint32_t total = 0;
-  for_each_obj([&](ObjectFileData& obj) { total += obj.linked_data.set_ordered_label_names(); });
+  auto label_counts = map_obj_parallel<uint32_t>(
+      [&](ObjectFileData& obj) { return obj.linked_data.set_ordered_label_names(); });
+  for (auto count : label_counts) {
+    total += count;
+  }
 
   spdlog::info("Processed Labels:");
   spdlog::info(" Total {} labels", total);
@@ -561,46 +802,52 @@ void ObjectFileDB::write_object_file_words(const std::string& output_dir, bool d
 
 /*!
  * Dump disassembly for object files containing code.  Data zones will also be dumped.
+ * The text for each object is generated in parallel, and written by background threads while
+ * other objects are still being disassembled.
  */
 void ObjectFileDB::write_disassembly(const std::string& output_dir,
                                      bool disassemble_objects_without_functions) {
   spdlog::info("- Writing functions...");
   Timer timer;
-  uint32_t total_bytes = 0, total_files = 0;
+  std::atomic<uint64_t> total_bytes = {0};
+  std::atomic<uint32_t> total_files = {0};
 
-  std::string asm_functions;
+  AsyncFileWriter writer;
+  OrderedFileAppender asm_functions(file_util::combine_path(output_dir, "asm_functions.func"));
 
-  for_each_obj([&](ObjectFileData& obj) {
+  for_each_obj_parallel_indexed([&](ObjectFileData& obj, size_t idx) {
     if (obj.linked_data.has_any_functions() || disassemble_objects_without_functions) {
       auto file_text = obj.linked_data.print_disassembly();
-      asm_functions += obj.linked_data.print_asm_function_disassembly(obj.to_unique_name());
+      asm_functions.add(idx, obj.linked_data.print_asm_function_disassembly(obj.to_unique_name()));
       auto file_name = file_util::combine_path(output_dir, obj.to_unique_name() + ".asm");
 
       if (get_config().analyze_functions) {
         auto json_asm_text = obj.linked_data.to_asm_json(obj.to_unique_name());
         auto json_asm_file_name =
             file_util::combine_path(output_dir, obj.to_unique_name() + "_asm.json");
-        file_util::write_text_file(json_asm_file_name, json_asm_text);
         total_files++;
         total_bytes += json_asm_text.size();
+        writer.write_text_file(json_asm_file_name, std::move(json_asm_text));
       }
 
       total_bytes += file_text.size();
-      file_util::write_text_file(file_name, file_text);
       total_files++;
+      writer.write_text_file(file_name, std::move(file_text));
+    } else {
+      asm_functions.add(idx, "");
     }
   });
 
-  total_bytes += asm_functions.size();
+  asm_functions.finish();
+  writer.finish();
+  total_bytes += asm_functions.bytes_written();
   total_files++;
-  file_util::write_text_file(file_util::combine_path(output_dir, "asm_functions.func"),
-                             asm_functions);
 
   spdlog::info("Wrote functions dumps:");
-  spdlog::info(" Total {} files", total_files);
-  spdlog::info(" Total {} MB", total_bytes / ((float)(1u << 20u)));
+  spdlog::info(" Total {} files", total_files.load());
+  spdlog::info(" Total {} MB", total_bytes.load() / ((float)(1u << 20u)));
   spdlog::info(" Total {} ms ({:.3f} MB/sec)", timer.getMs(),
-               total_bytes / ((1u << 20u) * timer.getSeconds()));
+               total_bytes.load() / ((1u << 20u) * timer.getSeconds()));
 }
 
 /*!
@@ -611,7 +858,12 @@ void ObjectFileDB::find_code() {
   LinkedObjectFile::Stats combined_stats;
   Timer timer;
 
-  for_each_obj([&](ObjectFileData& obj) {
+  for_each_obj_parallel([&](ObjectFileData& obj) {
+    if (obj.loaded_from_cache) {
+      // the cache entry already has the results of find_code.
+      return;
+    }
+
     //      printf("fc %s\n", obj.record.to_unique_name().c_str());
     obj.linked_data.find_code();
     obj.linked_data.find_functions();
@@ -620,17 +872,23 @@ void ObjectFileDB::find_code() {
     if (get_config().game_version == 1 || obj.to_unique_name() != "effect-control-v0") {
       obj.linked_data.process_fp_relative_links();
     } else {
-      spdlog::warn("Skipping process_fp_relative_links in {}", obj.to_unique_name().c_str());
+      ordered_log::warn(
+          fmt::format("Skipping process_fp_relative_links in {}", obj.to_unique_name()));
     }
 
     auto& obj_stats = obj.linked_data.stats;
     if (obj_stats.code_bytes / 4 > obj_stats.decoded_ops) {
-      spdlog::warn("Failed to decode all in {} ({} / {})", obj.to_unique_name().c_str(),
-                   obj_stats.decoded_ops, obj_stats.code_bytes / 4);
+      ordered_log::warn(fmt::format("Failed to decode all in {} ({} / {})", obj.to_unique_name(),
+                                    obj_stats.decoded_ops, obj_stats.code_bytes / 4));
+    }
+
+    if (cache) {
+      cache->save(obj.record.hash, obj.data.size(), obj.linked_data, obj.linked_symbols);
     }
-    combined_stats.add(obj.linked_data.stats);
   });
 
+  for_each_obj([&](ObjectFileData& obj) { combined_stats.add(obj.linked_data.stats); });
+
   spdlog::info("Found code:");
   spdlog::info(" Code {:.3f} MB", combined_stats.code_bytes / (float)(1 << 20));
   spdlog::info(" Data {:.3f} MB", combined_stats.data_bytes / (float)(1 << 20));
@@ -654,8 +912,12 @@ void ObjectFileDB::find_and_write_scripts(const std::string& output_dir) {
   Timer timer;
   std::string all_scripts;
 
+  auto scripts_by_obj = map_obj_parallel<std::string>(
+      [&](ObjectFileData& obj) { return obj.linked_data.print_scripts(); });
+
+  size_t obj_idx = 0;
   for_each_obj([&](ObjectFileData& obj) {
-    auto scripts = obj.linked_data.print_scripts();
+    auto& scripts = scripts_by_obj.at(obj_idx++);
     if (!scripts.empty()) {
       all_scripts += ";--------------------------------------\n";
       all_scripts += "; " + obj.to_unique_name() + "\n";
@@ -676,15 +938,32 @@ void ObjectFileDB::process_tpages() {
   std::string tpage_string = "tpage-";
   int total = 0, success = 0;
   Timer timer;
-  for_each_obj([&](ObjectFileData& data) {
+  // decoding is fast, so most of the time is compressing, which happens on these threads. Use as
+  // many as the pool has so the configured thread count is respected.
+  int encoder_threads = pool.thread_count();
+  AsyncFileWriter png_writer(encoder_threads);
+  auto stats_by_obj = map_obj_parallel<TPageResultStats>([&](ObjectFileData& data) {
     if (data.name_in_dgo.substr(0, tpage_string.length()) == tpage_string) {
-      auto statistics = process_tpage(data);
-      total += statistics.total_textures;
-      success += statistics.successful_textures;
+      return process_tpage(data, png_writer, get_config().texture_compression);
     }
+    return TPageResultStats();
   });
+  png_writer.finish();
+
+  for (auto& statistics : stats_by_obj) {
+    total += statistics.total_textures;
+    success += statistics.successful_textures;
+  }
+  auto png_stats = png_writer.stats();
+  double ms = timer.getMs();
   spdlog::info("Processed {} / {} textures {:.2f}% in {:.2f} ms", success, total,
-               100.f * float(success) / float(total), timer.getMs());
+               100.f * float(success) / float(total), ms);
+  spdlog::info(" Wrote {:.2f} MB of PNGs from {:.2f} MB of pixels ({:.1f}%), {:.2f} MB/s",
+               png_stats.output_bytes / (1024. * 1024.), png_stats.input_bytes / (1024. * 1024.),
+               100. * png_stats.output_bytes / std::max(size_t(1), png_stats.input_bytes),
+               png_stats.input_bytes / (1024. * 1024.) / (ms / 1000.));
+  spdlog::info(" Compression took {:.2f} ms on {} encoder threads", png_stats.encode_ms,
+               encoder_threads);
 }
 
 std::string ObjectFileDB::process_game_text() {
@@ -799,43 +1078,86 @@ void ObjectFileDB::analyze_functions() {
   std::map<int, std::vector<std::string>> unresolved_by_length;
 
   timer.start();
+
+  // first, run the per-function analysis in parallel. This only modifies the Function, and only
+  // reads the type system and linked data.
+  std::vector<std::string> type_defs_by_func;
+  for_each_function_def_order([&](Function&, int, ObjectFileData&) {
+    type_defs_by_func.emplace_back();
+  });
+
+  // functions which aren't in allowed_functions keep their names, but aren't analyzed.
+  auto is_function_allowed = [&](const Function& func) {
+    return config.allowed_functions.empty() ||
+           file_util::glob_match_any(config.allowed_functions, func.guessed_name.to_string());
+  };
+
+  for_each_function_def_order_parallel(
+      [&](Function& func, int segment_id, ObjectFileData& data, size_t idx) {
+        if (!is_function_allowed(func)) {
+          return;
+        }
+
+        //      printf("in %s from %s\n", func.guessed_name.to_string().c_str(),
+        //             data.to_unique_name().c_str());
+        func.basic_blocks = find_blocks_in_function(data.linked_data, segment_id, func);
+
+        if (!func.suspected_asm) {
+          // first, find the prologue/epilogue
+          func.analyze_prologue(data.linked_data);
+        }
+
+        if (!func.suspected_asm) {
+          // run analysis
+
+          // build a control flow graph
+          func.cfg = build_cfg(data.linked_data, segment_id, func);
+
+          // convert individual basic blocks to sequences of IR Basic Ops
+          for (auto& block : func.basic_blocks) {
+            if (block.end_word > block.start_word) {
+              add_basic_ops_to_block(&func, block, &data.linked_data);
+            }
+          }
+
+          if (func.is_inspect_method) {
+            auto result =
+                inspect_inspect_method(func, func.method_of_type, dts, data.linked_data);
+            type_defs_by_func.at(idx) = ";; " + data.to_unique_name() + "\n";
+            type_defs_by_func.at(idx) += result.print_as_deftype() + "\n";
+          }
+
+          // Combine basic ops + CFG to build a nested IR
+          func.ir = build_cfg_ir(func, *func.cfg, data.linked_data);
+
+          if (!func.cfg->is_fully_resolved()) {
+            ordered_log::warn(fmt::format("Function {} from {} failed cfg ir",
+                                          func.guessed_name.to_string(), data.to_unique_name()));
+          }
+        }
+      });
+
+  // next, collect results in definition order.
   int total_basic_blocks = 0;
+  int skipped_functions = 0;
+  size_t func_idx = 0;
   for_each_function_def_order([&](Function& func, int segment_id, ObjectFileData& data) {
-    //      printf("in %s from %s\n", func.guessed_name.to_string().c_str(),
-    //             data.to_unique_name().c_str());
-    auto blocks = find_blocks_in_function(data.linked_data, segment_id, func);
-    total_basic_blocks += blocks.size();
-    func.basic_blocks = blocks;
+    (void)segment_id;
+    (void)data;
+    if (!is_function_allowed(func)) {
+      skipped_functions++;
+      func_idx++;
+      return;
+    }
 
+    total_basic_blocks += func.basic_blocks.size();
     total_functions++;
-    if (!func.suspected_asm) {
-      // first, find the prologue/epilogue
-      func.analyze_prologue(data.linked_data);
-    }
 
     if (!func.suspected_asm) {
-      // run analysis
-
-      // build a control flow graph
-      func.cfg = build_cfg(data.linked_data, segment_id, func);
-
-      // convert individual basic blocks to sequences of IR Basic Ops
-      for (auto& block : func.basic_blocks) {
-        if (block.end_word > block.start_word) {
-          add_basic_ops_to_block(&func, block, &data.linked_data);
-        }
-      }
       total_basic_ops += func.get_basic_op_count();
       total_failed_basic_ops += func.get_failed_basic_op_count();
+      all_type_defs += type_defs_by_func.at(func_idx);
 
-      if (func.is_inspect_method) {
-        auto result = inspect_inspect_method(func, func.method_of_type, dts, data.linked_data);
-        all_type_defs += ";; " + data.to_unique_name() + "\n";
-        all_type_defs += result.print_as_deftype() + "\n";
-      }
-
-      // Combine basic ops + CFG to build a nested IR
-      func.ir = build_cfg_ir(func, *func.cfg, data.linked_data);
       non_asm_funcs++;
       if (func.ir) {
         successful_cfg_irs++;
@@ -843,9 +1165,6 @@ void ObjectFileDB::analyze_functions() {
 
       if (func.cfg->is_fully_resolved()) {
         resolved_cfg_functions++;
-      } else {
-        spdlog::warn("Function {} from {} failed cfg ir", func.guessed_name.to_string(),
-                     data.to_unique_name());
       }
 
       // type analysis
@@ -860,16 +1179,15 @@ void ObjectFileDB::analyze_functions() {
           }
           // GOOD!
           func.type = kv->second;
+        }
+      }
 
-          /*
-          spdlog::info("Type Analysis on {} {}", func.guessed_name.to_string(),
-                       kv->second.print());
-          func.run_type_analysis(kv->second, dts, data.linked_data);
-           */
-
-          if (func.has_typemaps()) {
-            successful_type_analysis++;
-          }
+      if (get_config().run_type_analysis && func.has_basic_ops()) {
+        // functions of unknown type still get types for code that doesn't use the arguments.
+        auto type = func.type.arg_count() > 0 ? func.type : dts.ts.make_typespec("function");
+        func.run_type_analysis(type, dts, data.linked_data);
+        if (func.has_typemaps()) {
+          successful_type_analysis++;
         }
       }
     } else {
@@ -891,6 +1209,7 @@ void ObjectFileDB::analyze_functions() {
     if (!func.guessed_name.empty()) {
       total_named_functions++;
     }
+    func_idx++;
   });
 
   spdlog::info("Found {} functions ({} with no control flow)", total_functions,
@@ -898,6 +1217,9 @@ void ObjectFileDB::analyze_functions() {
   spdlog::info("Named {}/{} functions ({:.3f}%)", total_named_functions, total_functions,
                100.f * float(total_named_functions) / float(total_functions));
   spdlog::info("Excluding {} asm functions", asm_funcs);
+  if (skipped_functions) {
+    spdlog::info("Skipped {} functions (not in allowed_functions)", skipped_functions);
+  }
   spdlog::info("Found {} basic blocks in {:.3f} ms", total_basic_blocks, timer.getMs());
   spdlog::info(" {}/{} functions passed cfg analysis stage ({:.3f}%)", resolved_cfg_functions,
                non_asm_funcs, 100.f * float(resolved_cfg_functions) / float(non_asm_funcs));
@@ -14,9 +14,16 @@
 #include <string>
 #include <unordered_map>
 #include <vector>
+#include <memory>
 #include "LinkedObjectFile.h"
+#include "LinkedObjectFileCreation.h"
+#include "ObjectFileBytes.h"
+#include "ObjectFileCache.h"
 #include "decompiler/util/DecompilerTypeSystem.h"
+#include "decompiler/util/OrderedLog.h"
+#include "decompiler/util/Profiler.h"
 #include "common/common_types.h"
+#include "common/util/ThreadPool.h"
 
 /*!
  * A "record" which can be used to identify an object file.
@@ -31,7 +38,7 @@ struct ObjectFileRecord {
  * All of the data for a single object file
  */
 struct ObjectFileData {
-  std::vector<uint8_t> data;     // raw bytes
+  ObjectFileBytes data;          // raw bytes
   LinkedObjectFile linked_data;  // data including linking annotations
   ObjectFileRecord record;       // name
   std::vector<std::string> dgo_names;
@@ -41,6 +48,8 @@ struct ObjectFileData {
   std::string name_from_map;
   std::string to_unique_name() const;
   uint32_t reference_count = 0;  // number of times its used.
+  std::vector<LinkedSymbol> linked_symbols;  // symbols found while linking
+  bool loaded_from_cache = false;            // linked_data was loaded from the ObjectFileCache
 };
 
 class ObjectFileDB {
@@ -66,14 +75,51 @@ class ObjectFileDB {
   DecompilerTypeSystem dts;
   std::string all_type_defs;
 
+  /*!
+   * Apply f to all functions
+   * takes (Function, segment, linked_data)
+   * Does it in the right order.
+   */
+  template <typename Func>
+  void for_each_function(Func f) {
+    for_each_obj([&](ObjectFileData& data) {
+      //      printf("IN %s\n", data.record.to_unique_name().c_str());
+      for (int i = 0; i < int(data.linked_data.segments); i++) {
+        //        printf("seg %d\n", i);
+        int fn = 0;
+        for (auto& goal_func : data.linked_data.functions_by_seg.at(i)) {
+          //          printf("fn %d\n", fn);
+          f(goal_func, i, data);
+          fn++;
+        }
+      }
+    });
+  }
+
  private:
   void load_map_file(const std::string& map_data);
-  void get_objs_from_dgo(const std::string& filename);
+  bool is_object_allowed(const std::string& obj_name, const std::string& dgo_name) const;
+  bool is_dgo_needed(const std::string& dgo_file) const;
+  /*!
+   * A DGO file which has been mapped, and decompressed if it was compressed.
+   */
+  struct LoadedDgo {
+    std::string name;
+    size_t file_size = 0;
+    std::shared_ptr<const MappedFile> mapping;  // null if the DGO was compressed
+    std::vector<uint8_t> decompressed_data;
+  };
+
+  static LoadedDgo load_dgo(const std::string& filename, ThreadPool& pool);
+  void load_dgos(const std::vector<std::string>& dgos);
+  void add_objs_from_dgo(const LoadedDgo& dgo);
+  void load_str_files(const std::vector<std::string>& str_files);
   void add_obj_from_dgo(const std::string& obj_name,
                         const std::string& name_in_dgo,
                         const uint8_t* obj_data,
                         uint32_t obj_size,
-                        const std::string& dgo_name);
+                        const std::string& dgo_name,
+                        const std::shared_ptr<const MappedFile>& mapping);
 
   /*!
    * Apply f to all ObjectFileData's. Does it in the right order.
@@ -89,26 +135,73 @@ class ObjectFileDB {
   }
 
   /*!
-   * Apply f to all functions
-   * takes (Function, segment, linked_data)
-   * Does it in the right order.
+   * Apply f to all ObjectFileData's, in parallel. f should only modify the object it is given.
+   * Messages logged with ordered_log are printed in the same order as they would be with
+   * for_each_obj.
    */
   template <typename Func>
-  void for_each_function(Func f) {
-    for_each_obj([&](ObjectFileData& data) {
-      //      printf("IN %s\n", data.record.to_unique_name().c_str());
-      for (int i = 0; i < int(data.linked_data.segments); i++) {
-        //        printf("seg %d\n", i);
-        int fn = 0;
-        for (auto& goal_func : data.linked_data.functions_by_seg.at(i)) {
-          //          printf("fn %d\n", fn);
-          f(goal_func, i, data);
-          fn++;
-        }
-      }
+  void for_each_obj_parallel(Func f) {
+    for_each_obj_parallel_indexed([&](ObjectFileData& obj, size_t idx) {
+      (void)idx;
+      f(obj);
+    });
+  }
+
+  /*!
+   * Apply f to all ObjectFileData's, in parallel, and return the results in the same order as
+   * for_each_obj would visit the objects.
+   */
+  template <typename T, typename Func>
+  std::vector<T> map_obj_parallel(Func f) {
+    std::vector<T> result(obj_count());
+    for_each_obj_parallel_indexed(
+        [&](ObjectFileData& obj, size_t idx) { result.at(idx) = f(obj); });
+    return result;
+  }
+
+  template <typename Func>
+  void for_each_obj_parallel_indexed(Func f) {
+    std::vector<ObjectFileData*> objs;
+    for_each_obj([&](ObjectFileData& obj) { objs.push_back(&obj); });
+    parallel_for_ordered_log(objs.size(), [&](size_t idx) {
+      auto& obj = *objs.at(idx);
+      profiler::ScopedObject profile([&] { return obj.to_unique_name(); }, obj.data.size());
+      f(obj, idx);
     });
   }
 
+  /*!
+   * Call f(i) for i in [0, count), in parallel.
+   * Messages logged with ordered_log are printed in order of i.
+   */
+  template <typename Func>
+  void parallel_for_ordered_log(size_t count, Func f) {
+    std::vector<ordered_log::Buffer> logs(count);
+    try {
+      pool.parallel_for(count, [&](size_t idx) {
+        ordered_log::ScopedCapture capture(&logs.at(idx));
+        f(idx);
+      });
+    } catch (...) {
+      for (auto& log : logs) {
+        ordered_log::flush(log);
+      }
+      throw;
+    }
+
+    for (auto& log : logs) {
+      ordered_log::flush(log);
+    }
+  }
+
+  size_t obj_count() const {
+    size_t count = 0;
+    for (auto& kv : obj_files_by_name) {
+      count += kv.second.size();
+    }
+    return count;
+  }
+
   template <typename Func>
   void for_each_function_def_order(Func f) {
     for_each_obj([&](ObjectFileData& data) {
@@ -126,6 +219,31 @@ class ObjectFileDB {
     });
   }
 
+  /*!
+   * Apply f to all functions, in parallel. f should only modify the function it is given.
+   * takes (Function, segment, linked_data, idx), where idx is the position of the function in
+   * for_each_function_def_order. Messages logged with ordered_log are printed in that order.
+   */
+  template <typename Func>
+  void for_each_function_def_order_parallel(Func f) {
+    struct FunctionRef {
+      Function* func;
+      int segment;
+      ObjectFileData* data;
+    };
+    std::vector<FunctionRef> funcs;
+    for_each_function_def_order([&](Function& func, int segment, ObjectFileData& data) {
+      funcs.push_back({&func, segment, &data});
+    });
+
+    parallel_for_ordered_log(funcs.size(), [&](size_t idx) {
+      auto& ref = funcs.at(idx);
+      profiler::ScopedObject profile([&] { return ref.data->to_unique_name(); },
+                                     4 * (ref.func->end_word - ref.func->start_word));
+      f(*ref.func, ref.segment, *ref.data, idx);
+    });
+  }
+
   // Danger: after adding all object files, we assume that the vector never reallocates.
   std::unordered_map<std::string, std::vector<ObjectFileData>> obj_files_by_name;
   std::unordered_map<std::string, std::vector<ObjectFileRecord>> obj_files_by_dgo;
@@ -133,11 +251,19 @@ class ObjectFileDB {
   std::vector<std::string> obj_file_order;
   std::unordered_map<std::string, std::unordered_map<std::string, std::string>> dgo_obj_name_map;
 
+  ThreadPool pool;
+
+  // names of all symbols referenced by linked words, in any object file.
+  SymbolNameTable symbol_names;
+
+  std::unique_ptr<ObjectFileCache> cache;  // null if caching is disabled
+
   struct {
     uint32_t total_dgo_bytes = 0;
     uint32_t total_obj_files = 0;
     uint32_t unique_obj_files = 0;
     uint32_t unique_obj_bytes = 0;
+    uint32_t skipped_obj_files = 0;
   } stats;
 };
 
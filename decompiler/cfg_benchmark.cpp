@@ -0,0 +1,107 @@
+/*!
+ * @file cfg_benchmark.cpp
+ * Times structuring the control flow graphs of the largest functions in the game's object files,
+ * with the worklist and with the reference version which rescans the whole graph after each
+ * change, and checks that they agree. For testing structuring changes.
+ */
+
+#include <algorithm>
+#include <cstdio>
+#include <string>
+#include <vector>
+#include "ObjectFile/ObjectFileDB.h"
+#include "config.h"
+#include "Disasm/InstructionDecode.h"
+#include "Function/BasicBlocks.h"
+#include "Function/CfgVtx.h"
+#include "third-party/spdlog/include/spdlog/spdlog.h"
+#include "common/util/FileUtil.h"
+#include "common/util/Timer.h"
+
+int main(int argc, char** argv) {
+  if (argc != 3) {
+    printf("Usage: cfg_benchmark <config_file> <in_folder>\n");
+    return 1;
+  }
+
+  file_util::init_crc();
+  init_opcode_info();
+  set_config(argv[1]);
+  std::string in_folder = argv[2];
+
+  std::vector<std::string> dgos, objs;
+  for (const auto& dgo_name : get_config().dgo_names) {
+    dgos.push_back(file_util::combine_path(in_folder, dgo_name));
+  }
+  for (const auto& obj_name : get_config().object_file_names) {
+    objs.push_back(file_util::combine_path(in_folder, obj_name));
+  }
+
+  ObjectFileDB db(dgos, get_config().obj_file_name_map_file, objs, {});
+  db.process_link_data();
+  db.find_code();
+  db.process_labels();
+
+  spdlog::info("- Benchmarking control flow graph structuring...");
+  constexpr size_t FUNCTION_COUNT = 100;
+
+  struct Candidate {
+    Function* func;
+    int segment;
+    ObjectFileData* data;
+  };
+  std::vector<Candidate> candidates;
+  db.for_each_function([&](Function& func, int segment_id, ObjectFileData& data) {
+    if (func.suspected_asm) {
+      return;
+    }
+    func.basic_blocks = find_blocks_in_function(data.linked_data, segment_id, func);
+    func.analyze_prologue(data.linked_data);
+    if (!func.suspected_asm) {
+      candidates.push_back({&func, segment_id, &data});
+    }
+  });
+  std::stable_sort(candidates.begin(), candidates.end(), [](const auto& a, const auto& b) {
+    return a.func->basic_blocks.size() > b.func->basic_blocks.size();
+  });
+  if (candidates.size() > FUNCTION_COUNT) {
+    candidates.resize(FUNCTION_COUNT);
+  }
+
+  double worklist_ms = 0, reference_ms = 0;
+  size_t block_count = 0;
+  int mismatches = 0;
+  for (auto& c : candidates) {
+    auto& func = *c.func;
+    auto& file = c.data->linked_data;
+    // building the graph links up the basic blocks, so each build needs unlinked blocks.
+    auto blocks = func.basic_blocks;
+    block_count += blocks.size();
+
+    auto cfg = build_unstructured_cfg(file, c.segment, func);
+    Timer timer;
+    cfg->structure();
+    worklist_ms += timer.getMs();
+
+    func.basic_blocks = blocks;
+    auto reference_cfg = build_unstructured_cfg(file, c.segment, func);
+    timer.start();
+    reference_cfg->structure_reference();
+    reference_ms += timer.getMs();
+
+    if (cfg->to_form_string() != reference_cfg->to_form_string()) {
+      spdlog::error(" Structuring disagrees on {}", func.guessed_name.to_string());
+      mismatches++;
+    }
+  }
+
+  spdlog::info("Benchmarked structuring of {} functions with {} basic blocks:", candidates.size(),
+               block_count);
+  spdlog::info(" reference {:.3f} ms, worklist {:.3f} ms ({:.2f}x)", reference_ms, worklist_ms,
+               reference_ms / worklist_ms);
+  if (mismatches) {
+    spdlog::error(" Structuring disagrees on {} functions", mismatches);
+    return 1;
+  }
+  return 0;
+}
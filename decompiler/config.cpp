@@ -12,11 +12,24 @@ void set_config(const std::string& path_to_config_file) {
   auto config_str = file_util::read_text_file(path_to_config_file);
   // to ignore comments in json, which may be useful
   auto cfg = nlohmann::json::parse(config_str, nullptr, true, true);
+  gConfig.hash = file_util::crc32((const uint8_t*)config_str.data(), config_str.size());
 
   gConfig.game_version = cfg.at("game_version").get<int>();
   gConfig.dgo_names = cfg.at("dgo_names").get<std::vector<std::string>>();
   gConfig.object_file_names = cfg.at("object_file_names").get<std::vector<std::string>>();
   gConfig.str_file_names = cfg.at("str_file_names").get<std::vector<std::string>>();
+  if (cfg.contains("threads")) {
+    gConfig.threads = cfg.at("threads").get<int>();
+  }
+  if (cfg.contains("cache_dir")) {
+    gConfig.cache_dir = cfg.at("cache_dir").get<std::string>();
+  }
+  if (cfg.contains("allowed_objects")) {
+    gConfig.allowed_objects = cfg.at("allowed_objects").get<std::vector<std::string>>();
+  }
+  if (cfg.contains("allowed_functions")) {
+    gConfig.allowed_functions = cfg.at("allowed_functions").get<std::vector<std::string>>();
+  }
   if (cfg.contains("obj_file_name_map_file")) {
     gConfig.obj_file_name_map_file = cfg.at("obj_file_name_map_file").get<std::string>();
   }
@@ -30,6 +43,21 @@ void set_config(const std::string& path_to_config_file) {
   gConfig.analyze_functions = cfg.at("analyze_functions").get<bool>();
   gConfig.process_tpages = cfg.at("process_tpages").get<bool>();
   gConfig.process_game_text = cfg.at("process_game_text").get<bool>();
+  if (cfg.contains("run_type_analysis")) {
+    gConfig.run_type_analysis = cfg.at("run_type_analysis").get<bool>();
+  }
+  if (cfg.contains("texture_compression")) {
+    auto level = cfg.at("texture_compression").get<std::string>();
+    if (level == "stored") {
+      gConfig.texture_compression = deflate::Level::STORED;
+    } else if (level == "fast") {
+      gConfig.texture_compression = deflate::Level::FAST;
+    } else if (level == "best") {
+      gConfig.texture_compression = deflate::Level::BEST;
+    } else {
+      throw std::runtime_error("Unknown texture_compression " + level);
+    }
+  }
 
   std::vector<std::string> asm_functions_by_name =
       cfg.at("asm_functions_by_name").get<std::vector<std::string>>();
@@ -3,12 +3,19 @@
 #ifndef JAK2_DISASSEMBLER_CONFIG_H
 #define JAK2_DISASSEMBLER_CONFIG_H
 
+#include <cstdint>
 #include <string>
 #include <vector>
 #include <unordered_set>
+#include "common/util/Deflate.h"
 
 struct Config {
   int game_version = -1;
+  int threads = 0;  // 0 for one per hardware thread, 1 to run everything on the main thread
+  uint32_t hash = 0;      // hash of the config file
+  std::string cache_dir;  // empty to disable the object file cache
+  std::vector<std::string> allowed_objects;    // globs, empty to allow all objects
+  std::vector<std::string> allowed_functions;  // globs, empty to allow all functions
   std::vector<std::string> dgo_names;
   std::vector<std::string> object_file_names;
   std::vector<std::string> str_file_names;
@@ -23,6 +30,8 @@ struct Config {
   bool analyze_functions = false;
   bool process_tpages = false;
   bool process_game_text = false;
+  bool run_type_analysis = false;
+  deflate::Level texture_compression = deflate::Level::FAST;
   std::unordered_set<std::string> asm_functions_by_name;
   // ...
 };
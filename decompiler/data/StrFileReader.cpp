@@ -3,20 +3,22 @@
  * Utility class to read a .STR file and extract the full file name.
  */
 
-#include <cassert>
+#include <algorithm>
 #include <cstring>
+#include <stdexcept>
 #include "common/util/FileUtil.h"
 #include "game/common/overlord_common.h"
 #include "game/common/str_rpc_types.h"
 #include "StrFileReader.h"
 
-StrFileReader::StrFileReader(const std::string& file_path) {
-  auto data = file_util::read_binary_file(file_path);
-  assert(data.size() >= SECTOR_SIZE);      // must have at least the header sector
-  assert(data.size() % SECTOR_SIZE == 0);  // should be multiple of the sector size.
-  int end_sector = int(data.size()) / SECTOR_SIZE;
+StrFileReader::StrFileReader(const std::string& file_path)
+    : m_mapping(std::make_shared<const MappedFile>(file_path)) {
+  size_t size = m_mapping->size();
+  check(size >= SECTOR_SIZE, "missing header sector");
+  check(size % SECTOR_SIZE == 0, "size is not a multiple of the sector size");
+  int end_sector = int(size / SECTOR_SIZE);
 
-  auto* header = (StrFileHeaderSector*)data.data();
+  auto* header = (const StrFileHeaderSector*)m_mapping->data();
 
   bool got_zero = false;
   for (int i = 0; i < SECTOR_TABLE_SIZE; i++) {
@@ -29,14 +31,14 @@ StrFileReader::StrFileReader(const std::string& file_path) {
       next_sector = header->sectors[i + 1];
     }
     if (sector) {
-      assert(!got_zero);             // shouldn't have a non-zero after a zero!
-      assert(next_sector > sector);  // should have a positive size.
-      assert(next_sector * SECTOR_SIZE <= int(data.size()));  // check for overflowing the file
-      // get chunk data.
-      std::vector<u8> chunk;
-      chunk.insert(chunk.end(), data.begin() + sector * SECTOR_SIZE,
-                   data.begin() + next_sector * SECTOR_SIZE);
-      m_chunks.emplace_back(std::move(chunk));
+      check(!got_zero, "chunk after an empty chunk");
+      check(next_sector > sector, "chunk with a negative size");
+      check(next_sector <= end_sector, "chunk past the end of the file");
+      // the chunk is part of the mapping.
+      Chunk chunk;
+      chunk.data = m_mapping->data() + size_t(sector) * SECTOR_SIZE;
+      chunk.size = size_t(next_sector - sector) * SECTOR_SIZE;
+      m_chunks.push_back(chunk);
     } else {
       got_zero = true;
     }
@@ -46,15 +48,21 @@ StrFileReader::StrFileReader(const std::string& file_path) {
   // are sized assuming they are packed in order and dense (sectors);
   for (int i = 0; i < SECTOR_TABLE_SIZE; i++) {
     if (header->sectors[i]) {
-      assert(header->sizes[i] == m_chunks.at(i).size());
+      check(header->sizes[i] == m_chunks.at(i).size, "chunk size doesn't match the sectors");
     } else {
-      assert(header->sizes[i] == 0);
+      check(header->sizes[i] == 0, "empty chunk with a size");
     }
   }
 
   // check nothing stored in the padding.
   for (auto x : header->pad) {
-    assert(x == 0);
+    check(x == 0, "data in the header padding");
+  }
+}
+
+void StrFileReader::check(bool ok, const std::string& what) const {
+  if (!ok) {
+    throw std::runtime_error("Invalid STR file " + m_mapping->name() + ": " + what);
   }
 }
 
@@ -62,7 +70,7 @@ int StrFileReader::chunk_count() const {
   return m_chunks.size();
 }
 
-const std::vector<u8>& StrFileReader::get_chunk(int idx) const {
+const StrFileReader::Chunk& StrFileReader::get_chunk(int idx) const {
   return m_chunks.at(idx);
 }
 
@@ -86,8 +94,7 @@ std::string get_string_of_max_length(const char* data, int max_length) {
       return result;
     }
   }
-  assert(false);
-  return "";
+  throw std::runtime_error("File name in STR file is too long");
 }
 
 struct FullName {
@@ -98,8 +105,9 @@ struct FullName {
 FullName extract_name(const std::string& file_info_name) {
   FullName name;
   name.name = file_info_name;
-  assert(name.name.length() > 10);
-  assert(name.name.substr(name.name.length() - 6, 6) == "-ag.go");
+  if (name.name.length() <= 10 || name.name.substr(name.name.length() - 6, 6) != "-ag.go") {
+    throw std::runtime_error("Bad file name in STR file: " + file_info_name);
+  }
   name.name = name.name.substr(0, name.name.length() - 6);
   int chunk_id = 0;
   int place = 0;
@@ -117,7 +125,9 @@ FullName extract_name(const std::string& file_info_name) {
       break;
     }
   }
-  assert(name.name.back() == '+');
+  if (name.name.back() != '+') {
+    throw std::runtime_error("Bad file name in STR file: " + file_info_name);
+  }
   name.name.pop_back();
   name.chunk_idx = chunk_id;
   return name;
@@ -142,26 +152,24 @@ std::string StrFileReader::get_full_name(const std::string& short_name) const {
     std::string chunk_long_name;
 
     // find the file info string in the chunk.
-    int offset;
-    if (find_string_in_data(chunk.data(), int(chunk.size()), file_info_string, &offset)) {
-      offset += file_info_string.length();
-    } else {
-      assert(false);
-    }
+    int offset = 0;
+    check(find_string_in_data(chunk.data, int(chunk.size), file_info_string, &offset),
+          "no file info in chunk");
+    offset += file_info_string.length();
 
     // extract the name info as a "name" + "chunk id" + "-ag.go" format.
-    auto full_name =
-        extract_name(get_string_of_max_length((const char*)(chunk.data() + offset), 128));
+    auto full_name = extract_name(get_string_of_max_length(
+        (const char*)(chunk.data + offset), std::min(128, int(chunk.size) - offset)));
 
     // make sure it matches previous chunks for the name
     if (!done_first) {
       result = full_name.name;
     } else {
-      assert(result == full_name.name);
+      check(result == full_name.name, "chunks have different names");
     }
 
     // make sure the index is right.
-    assert(full_name.chunk_idx == chunk_id);
+    check(full_name.chunk_idx == chunk_id, "chunks are out of order");
 
     done_first = true;
     chunk_id++;
@@ -175,7 +183,7 @@ std::string StrFileReader::get_full_name(const std::string& short_name) const {
   file_util::MakeISOName(iso_name_1, short_name.c_str());
   // second, using the full name.
   file_util::ISONameFromAnimationName(iso_name_2, result.c_str());
-  assert(strcmp(iso_name_1, iso_name_2) == 0);
+  check(strcmp(iso_name_1, iso_name_2) == 0, "name doesn't match the file name " + short_name);
 
   return result;
 }
\ No newline at end of file
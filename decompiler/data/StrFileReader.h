@@ -5,17 +5,38 @@
  * Utility class to read a .STR file and extract the full file name.
  */
 
+#include <memory>
 #include <string>
 #include <vector>
 #include "common/common_types.h"
+#include "common/util/MappedFile.h"
 
+/*!
+ * Reads the chunks of a .STR file. The file is mapped, and chunks point into the mapping, so
+ * nothing is copied and pages are only read when they are used.
+ * Throws std::runtime_error if the file's header doesn't make sense.
+ */
 class StrFileReader {
  public:
+  struct Chunk {
+    const u8* data = nullptr;
+    size_t size = 0;
+  };
+
   explicit StrFileReader(const std::string& file_path);
   int chunk_count() const;
-  const std::vector<u8>& get_chunk(int idx) const;
+  const Chunk& get_chunk(int idx) const;
   std::string get_full_name(const std::string& short_name) const;
 
+  /*!
+   * The mapping that the chunks point into. Keep a reference to this to use the chunks after the
+   * reader is gone.
+   */
+  const std::shared_ptr<const MappedFile>& mapping() const { return m_mapping; }
+
  private:
-  std::vector<std::vector<u8>> m_chunks;
+  void check(bool ok, const std::string& what) const;
+
+  std::shared_ptr<const MappedFile> m_mapping;
+  std::vector<Chunk> m_chunks;
 };
@@ -0,0 +1,49 @@
+#pragma once
+
+/*!
+ * @file swizzle.h
+ * Conversion between pixel locations in a texture and addresses in PS2 VRAM (GS local memory).
+ * See Ch. 8, Details of GS Local Memory, in the GS manual.
+ */
+
+#include <vector>
+#include "common/common_types.h"
+
+// texture format enums
+enum class PSM { PSMCT32 = 0x0, PSMCT16 = 0x02, PSMT8 = 0x13, PSMT4 = 0x14 };
+// clut format enums
+enum class CPSM { PSMCT32 = 0x0, PSMCT16 = 0x02 };
+
+// the address of a single pixel. For PSMT4, the address is in half bytes.
+u32 psmct32_addr(u32 x, u32 y, u32 width);
+u32 psmct16_addr(u32 x, u32 y, u32 width);
+u32 psmt8_addr(u32 x, u32 y, u32 width);
+u32 psmt4_addr_half_byte(u32 x, u32 y, u32 width);
+
+u32 rgba15_to_rgba32(u32 in);
+
+/*!
+ * Get the address of every pixel in a w by h area of a buffer with the given width, in row order.
+ * The addresses are the same as the *_addr functions above, but are built from a precomputed
+ * table for a single page, so this doesn't redo all the swizzle math for each pixel.
+ */
+std::vector<u32> make_swizzle_table(PSM psm, u32 width, u32 w, u32 h);
+
+/*!
+ * Copy 32-bit data to VRAM in PSMCT32 format, like a texture upload.
+ */
+void upload_psmct32(u8* vram, const u32* data, u32 width, u32 height);
+
+/*!
+ * Read a texture out of VRAM and convert it to RGBA8888. dest and clutdest are in 256 byte blocks,
+ * like the TEX0 register. Returns false if the psm/clutpsm combination isn't supported.
+ */
+bool read_texture(const u8* vram,
+                  int psm,
+                  int clutpsm,
+                  u32 width,
+                  u32 w,
+                  u32 h,
+                  u32 dest,
+                  u32 clutdest,
+                  std::vector<u32>* out);
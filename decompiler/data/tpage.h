@@ -1,10 +1,15 @@
 #pragma once
 
+#include "common/util/Deflate.h"
+
 class ObjectFileData;
+class AsyncFileWriter;
 
 struct TPageResultStats {
   int total_textures = 0;
   int successful_textures = 0;
 };
 
-TPageResultStats process_tpage(ObjectFileData& data);
\ No newline at end of file
+TPageResultStats process_tpage(ObjectFileData& data,
+                               AsyncFileWriter& png_writer,
+                               deflate::Level compression);
\ No newline at end of file
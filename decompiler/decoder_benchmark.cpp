@@ -0,0 +1,108 @@
+/*!
+ * @file decoder_benchmark.cpp
+ * Times the instruction decoder on all code in the game's object files. Compares looking up
+ * opcodes with the decode tables against the nested switch decoder, and decoding one instruction
+ * at a time against decoding a whole function at once. For testing decoder changes.
+ */
+
+#include <cstdio>
+#include <string>
+#include <vector>
+#include "ObjectFile/ObjectFileDB.h"
+#include "config.h"
+#include "Disasm/InstructionDecode.h"
+#include "third-party/spdlog/include/spdlog/spdlog.h"
+#include "common/util/FileUtil.h"
+#include "common/util/Timer.h"
+
+int main(int argc, char** argv) {
+  if (argc != 3) {
+    printf("Usage: decoder_benchmark <config_file> <in_folder>\n");
+    return 1;
+  }
+
+  file_util::init_crc();
+  init_opcode_info();
+  set_config(argv[1]);
+  std::string in_folder = argv[2];
+
+  std::vector<std::string> dgos, objs;
+  for (const auto& dgo_name : get_config().dgo_names) {
+    dgos.push_back(file_util::combine_path(in_folder, dgo_name));
+  }
+  for (const auto& obj_name : get_config().object_file_names) {
+    objs.push_back(file_util::combine_path(in_folder, obj_name));
+  }
+
+  ObjectFileDB db(dgos, get_config().obj_file_name_map_file, objs, {});
+  db.process_link_data();
+  db.find_code();
+
+  spdlog::info("- Benchmarking instruction decoder...");
+  constexpr int REPEAT_COUNT = 10;
+
+  // only the words inside functions, so data in the code segment isn't counted.
+  std::vector<uint32_t> code;
+  db.for_each_function([&](Function& func, int segment_id, ObjectFileData& data) {
+    auto& words = data.linked_data.words_by_seg.at(segment_id);
+    for (int word = func.start_word; word < func.end_word; word++) {
+      code.push_back(words.at(word).data);
+    }
+  });
+
+  // check the tables agree with the switch decoder before timing them.
+  int mismatches = 0;
+  for (auto word : code) {
+    if (decode_opcode(word) != decode_opcode_reference(word)) {
+      mismatches++;
+    }
+  }
+
+  uint64_t checksum = 0;
+  Timer timer;
+  for (int i = 0; i < REPEAT_COUNT; i++) {
+    for (auto word : code) {
+      checksum += (uint64_t)decode_opcode_reference(word);
+    }
+  }
+  double switch_ms = timer.getMs();
+
+  timer.start();
+  for (int i = 0; i < REPEAT_COUNT; i++) {
+    for (auto word : code) {
+      checksum -= (uint64_t)decode_opcode(word);
+    }
+  }
+  double table_ms = timer.getMs();
+
+  size_t instruction_count = 0;
+  timer.start();
+  db.for_each_function([&](Function& func, int segment_id, ObjectFileData& data) {
+    for (int word = func.start_word; word < func.end_word; word++) {
+      auto& linked_word = data.linked_data.words_by_seg.at(segment_id).at(word);
+      instruction_count +=
+          decode_instruction(linked_word, data.linked_data, segment_id, word).is_valid();
+    }
+  });
+  double single_ms = timer.getMs();
+
+  timer.start();
+  db.for_each_function([&](Function& func, int segment_id, ObjectFileData& data) {
+    auto instrs = decode_instructions(data.linked_data, segment_id, func.start_word, func.end_word);
+    for (auto& instr : instrs) {
+      instruction_count -= instr.is_valid();
+    }
+  });
+  double batch_ms = timer.getMs();
+
+  spdlog::info("Benchmarked decoder on {} words of code:", code.size());
+  spdlog::info(" Opcode lookup x{}: switch {:.3f} ms, table {:.3f} ms ({:.2f}x)", REPEAT_COUNT,
+               switch_ms, table_ms, switch_ms / table_ms);
+  spdlog::info(" Full decode: single {:.3f} ms, batch {:.3f} ms ({:.2f}x)", single_ms, batch_ms,
+               single_ms / batch_ms);
+  if (mismatches || checksum || instruction_count) {
+    spdlog::error(" Decoders disagree on {} words", mismatches);
+    return 1;
+  }
+  return 0;
+}
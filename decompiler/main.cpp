@@ -1,12 +1,35 @@
 #include <cstdio>
+#include <memory>
 #include <string>
 #include <vector>
 #include "ObjectFile/ObjectFileDB.h"
 #include "config.h"
+#include "util/Profiler.h"
 #include "third-party/spdlog/include/spdlog/spdlog.h"
 #include "third-party/spdlog/include/spdlog/sinks/basic_file_sink.h"
 #include "common/util/FileUtil.h"
 
+namespace {
+/*!
+ * Split a comma separated list.
+ */
+std::vector<std::string> split_list(const std::string& list) {
+  std::vector<std::string> result;
+  size_t start = 0;
+  while (start <= list.size()) {
+    auto end = list.find(',', start);
+    if (end == std::string::npos) {
+      end = list.size();
+    }
+    if (end > start) {
+      result.push_back(list.substr(start, end - start));
+    }
+    start = end + 1;
+  }
+  return result;
+}
+}  // namespace
+
 int main(int argc, char** argv) {
   spdlog::info("Beginning disassembly. This may take a few minutes...");
 
@@ -18,14 +41,44 @@ int main(int argc, char** argv) {
   file_util::init_crc();
   init_opcode_info();
 
-  if (argc != 4) {
-    printf("Usage: jak_disassembler <config_file> <in_folder> <out_folder>\n");
+  std::vector<std::string> args;
+  std::vector<std::string> allowed_objects, allowed_functions;
+  bool bad_args = false;
+  for (int i = 1; i < argc; i++) {
+    std::string arg = argv[i];
+    if (arg == "--profile") {
+      profiler::set_enabled(true);
+    } else if (arg == "--objects" || arg == "--functions") {
+      if (i + 1 == argc) {
+        bad_args = true;
+        break;
+      }
+      auto globs = split_list(argv[++i]);
+      auto& dest = arg == "--objects" ? allowed_objects : allowed_functions;
+      dest.insert(dest.end(), globs.begin(), globs.end());
+    } else {
+      args.push_back(arg);
+    }
+  }
+
+  if (bad_args || args.size() != 3) {
+    printf(
+        "Usage: jak_disassembler [--profile] [--objects <globs>] [--functions <globs>] "
+        "<config_file> <in_folder> <out_folder>\n"
+        "  --objects and --functions take comma separated globs, and replace allowed_objects "
+        "and allowed_functions from the config.\n");
     return 1;
   }
 
-  set_config(argv[1]);
-  std::string in_folder = argv[2];
-  std::string out_folder = argv[3];
+  set_config(args.at(0));
+  if (!allowed_objects.empty()) {
+    get_config().allowed_objects = allowed_objects;
+  }
+  if (!allowed_functions.empty()) {
+    get_config().allowed_functions = allowed_functions;
+  }
+  std::string in_folder = args.at(1);
+  std::string out_folder = args.at(2);
 
   std::vector<std::string> dgos, objs, strs;
   for (const auto& dgo_name : get_config().dgo_names) {
@@ -40,38 +93,62 @@ int main(int argc, char** argv) {
     strs.push_back(file_util::combine_path(in_folder, str_name));
   }
 
+  std::unique_ptr<profiler::ScopedPass> load_pass =
+      std::make_unique<profiler::ScopedPass>("load");
   ObjectFileDB db(dgos, get_config().obj_file_name_map_file, objs, strs);
-  file_util::write_text_file(file_util::combine_path(out_folder, "dgo.txt"),
-                             db.generate_dgo_listing());
-  file_util::write_text_file(file_util::combine_path(out_folder, "obj.txt"),
-                             db.generate_obj_listing());
+  load_pass.reset();
+
+  {
+    profiler::ScopedPass pass("listings");
+    file_util::write_text_file(file_util::combine_path(out_folder, "dgo.txt"),
+                               db.generate_dgo_listing());
+    file_util::write_text_file(file_util::combine_path(out_folder, "obj.txt"),
+                               db.generate_obj_listing());
+  }
 
-  db.process_link_data();
-  db.find_code();
-  db.process_labels();
+  {
+    profiler::ScopedPass pass("process_link_data");
+    db.process_link_data();
+  }
+
+  {
+    profiler::ScopedPass pass("find_code");
+    db.find_code();
+  }
+
+  {
+    profiler::ScopedPass pass("process_labels");
+    db.process_labels();
+  }
 
   if (get_config().write_scripts) {
+    profiler::ScopedPass pass("write_scripts");
     db.find_and_write_scripts(out_folder);
   }
 
   if (get_config().write_hexdump) {
+    profiler::ScopedPass pass("write_hexdump");
     db.write_object_file_words(out_folder, get_config().write_hexdump_on_v3_only);
   }
 
   if (get_config().analyze_functions) {
+    profiler::ScopedPass pass("analyze_functions");
     db.analyze_functions();
   }
 
   if (get_config().process_game_text) {
+    profiler::ScopedPass pass("process_game_text");
     auto result = db.process_game_text();
     file_util::write_text_file(file_util::get_file_path({"assets", "game_text.txt"}), result);
   }
 
   if (get_config().process_tpages) {
+    profiler::ScopedPass pass("process_tpages");
     db.process_tpages();
   }
 
   if (get_config().write_disassembly) {
+    profiler::ScopedPass pass("write_disassembly");
     db.write_disassembly(out_folder, get_config().disassemble_objects_without_functions);
   }
 
@@ -80,6 +157,11 @@ int main(int argc, char** argv) {
 
   file_util::write_text_file(file_util::combine_path(out_folder, "all-syms.gc"),
                              db.dts.dump_symbol_types());
+
+  if (profiler::enabled()) {
+    file_util::write_text_file(file_util::combine_path(out_folder, "profile.json"),
+                               profiler::to_json());
+  }
   spdlog::info("Disassembly has completed successfully.");
   return 0;
 }
@@ -0,0 +1,62 @@
+/*!
+ * @file Arena.cpp
+ * A bump allocator for objects which all live and die together, like the vertices of a graph.
+ */
+
+#include <algorithm>
+#include "Arena.h"
+
+Arena::~Arena() {
+  reset();
+}
+
+/*!
+ * Destroy all the objects (in reverse order of creation) and free all the blocks. The arena can
+ * be used again afterward.
+ */
+void Arena::reset() {
+  for (auto d = m_last_destructor; d; d = d->prev) {
+    d->destroy(d->obj);
+  }
+  m_last_destructor = nullptr;
+
+  auto block = m_last_block;
+  while (block) {
+    auto prev = block->prev;
+    ::operator delete(block);
+    block = prev;
+  }
+  m_last_block = nullptr;
+  m_next = nullptr;
+  m_end = nullptr;
+  m_bytes_used = 0;
+}
+
+/*!
+ * Start a new block, and allocate from it. Allocations bigger than a block get a block of their
+ * own. The rest of the current block is wasted, which is fine, as blocks are much larger than
+ * most allocations.
+ */
+void* Arena::allocate_in_new_block(size_t size, size_t alignment) {
+  size_t header_size = (sizeof(Block) + alignof(std::max_align_t) - 1) &
+                       ~(alignof(std::max_align_t) - 1);
+  size_t data_size = std::max(m_block_size, size + alignment);
+  auto block = static_cast<Block*>(::operator new(header_size + data_size));
+  block->prev = m_last_block;
+  m_last_block = block;
+  m_next = reinterpret_cast<char*>(block) + header_size;
+  m_end = m_next + data_size;
+  return allocate(size, alignment);
+}
+
+/*!
+ * Remember to destroy obj when the arena is destroyed. The record of this is also stored in the
+ * arena.
+ */
+void Arena::add_destructor(void* obj, void (*destroy)(void*)) {
+  auto d = static_cast<Destructor*>(allocate(sizeof(Destructor), alignof(Destructor)));
+  d->obj = obj;
+  d->destroy = destroy;
+  d->prev = m_last_destructor;
+  m_last_destructor = d;
+}
@@ -0,0 +1,73 @@
+#pragma once
+
+/*!
+ * @file Arena.h
+ * A bump allocator for objects which all live and die together, like the vertices of a graph.
+ */
+
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+/*!
+ * Allocates objects by bumping a pointer through large blocks of memory. Nothing is freed until
+ * the arena is reset or destroyed, which destroys all the objects (in reverse order of creation)
+ * and frees all the blocks at once.
+ */
+class Arena {
+ public:
+  explicit Arena(size_t block_size = 16 * 1024) : m_block_size(block_size) {}
+  ~Arena();
+  Arena(const Arena&) = delete;
+  Arena& operator=(const Arena&) = delete;
+
+  /*!
+   * Get uninitialized memory, which is freed when the arena is destroyed.
+   */
+  void* allocate(size_t size, size_t alignment) {
+    auto addr = (reinterpret_cast<size_t>(m_next) + alignment - 1) & ~(alignment - 1);
+    if (!m_next || addr + size > reinterpret_cast<size_t>(m_end)) {
+      return allocate_in_new_block(size, alignment);
+    }
+    m_next = reinterpret_cast<char*>(addr + size);
+    m_bytes_used += size;
+    return reinterpret_cast<void*>(addr);
+  }
+
+  /*!
+   * Construct an object in the arena. It will be destroyed when the arena is destroyed.
+   */
+  template <typename T, typename... Args>
+  T* make(Args&&... args) {
+    T* result = new (allocate(sizeof(T), alignof(T))) T(std::forward<Args>(args)...);
+    if (!std::is_trivially_destructible<T>::value) {
+      add_destructor(result, [](void* obj) { static_cast<T*>(obj)->~T(); });
+    }
+    return result;
+  }
+
+  void reset();
+  size_t bytes_used() const { return m_bytes_used; }
+
+ private:
+  struct Block {
+    Block* prev;
+  };
+
+  struct Destructor {
+    void* obj;
+    void (*destroy)(void*);
+    Destructor* prev;
+  };
+
+  void* allocate_in_new_block(size_t size, size_t alignment);
+  void add_destructor(void* obj, void (*destroy)(void*));
+
+  size_t m_block_size = 0;
+  size_t m_bytes_used = 0;
+  Block* m_last_block = nullptr;
+  char* m_next = nullptr;
+  char* m_end = nullptr;
+  Destructor* m_last_destructor = nullptr;
+};
@@ -0,0 +1,235 @@
+/*!
+ * @file AsyncFileWriter.cpp
+ * Write output files on background threads, so generating the text and writing it to disk can
+ * happen at the same time.
+ */
+
+#include <cassert>
+#include <stdexcept>
+#include "AsyncFileWriter.h"
+#include "common/util/FileUtil.h"
+#include "common/util/Timer.h"
+
+AsyncFileWriter::AsyncFileWriter(int thread_count, size_t max_queued_bytes)
+    : m_max_queued_bytes(max_queued_bytes) {
+  for (int i = 0; i < thread_count; i++) {
+    m_threads.emplace_back(&AsyncFileWriter::writer_loop, this);
+  }
+}
+
+AsyncFileWriter::~AsyncFileWriter() {
+  {
+    std::lock_guard<std::mutex> lk(m_lock);
+    m_stop = true;
+  }
+  m_queue_cv.notify_all();
+  for (auto& thread : m_threads) {
+    thread.join();
+  }
+}
+
+void AsyncFileWriter::write_text_file(const std::string& file_name, std::string text) {
+  Job job;
+  job.file_name = file_name;
+  job.text = std::move(text);
+  add_job(std::move(job));
+}
+
+void AsyncFileWriter::write_rgba_png(const std::string& file_name,
+                                     std::vector<u32> rgba,
+                                     int w,
+                                     int h,
+                                     deflate::Level level) {
+  assert(w > 0 && h > 0 && rgba.size() == size_t(w) * h);
+  Job job;
+  job.file_name = file_name;
+  job.rgba = std::move(rgba);
+  job.w = w;
+  job.h = h;
+  job.level = level;
+  add_job(std::move(job));
+}
+
+void AsyncFileWriter::add_job(Job job) {
+  std::unique_lock<std::mutex> lk(m_lock);
+  // always accept a job if nothing is queued, so a single huge file can't block forever.
+  m_space_cv.wait(lk, [&]() {
+    return m_jobs.empty() || m_queued_bytes + job.size() <= m_max_queued_bytes;
+  });
+  m_queued_bytes += job.size();
+  m_jobs.push_back(std::move(job));
+  lk.unlock();
+  m_queue_cv.notify_one();
+}
+
+void AsyncFileWriter::finish() {
+  std::unique_lock<std::mutex> lk(m_lock);
+  m_space_cv.wait(lk, [&]() { return m_jobs.empty() && m_in_progress == 0; });
+  std::exception_ptr e;
+  std::swap(e, m_exception);
+  lk.unlock();
+  if (e) {
+    std::rethrow_exception(e);
+  }
+}
+
+AsyncFileWriter::Stats AsyncFileWriter::stats() {
+  std::lock_guard<std::mutex> lk(m_lock);
+  return m_stats;
+}
+
+void AsyncFileWriter::writer_loop() {
+  while (true) {
+    Job job;
+    {
+      std::unique_lock<std::mutex> lk(m_lock);
+      m_queue_cv.wait(lk, [&]() { return m_stop || !m_jobs.empty(); });
+      if (m_jobs.empty()) {
+        return;
+      }
+      job = std::move(m_jobs.front());
+      m_jobs.pop_front();
+      m_in_progress++;
+    }
+
+    std::exception_ptr e;
+    size_t output_bytes = 0;
+    double encode_ms = 0;
+    try {
+      if (job.w) {
+        Timer timer;
+        auto png = file_util::encode_rgba_png(job.rgba.data(), job.w, job.h, job.level);
+        encode_ms = timer.getMs();
+        file_util::write_binary_file(job.file_name, png.data(), png.size());
+        output_bytes = png.size();
+      } else {
+        file_util::write_text_file(job.file_name, job.text);
+        output_bytes = job.text.size() + 1;
+      }
+    } catch (...) {
+      e = std::current_exception();
+    }
+
+    {
+      std::lock_guard<std::mutex> lk(m_lock);
+      m_queued_bytes -= job.size();
+      m_in_progress--;
+      if (e && !m_exception) {
+        m_exception = e;
+      }
+      if (!e) {
+        m_stats.files++;
+        m_stats.input_bytes += job.size();
+        m_stats.output_bytes += output_bytes;
+        m_stats.encode_ms += encode_ms;
+      }
+    }
+    m_space_cv.notify_all();
+  }
+}
+
+OrderedFileAppender::OrderedFileAppender(const std::string& file_name, size_t max_waiting_bytes)
+    : m_file_name(file_name),
+      m_spill_file_name(file_name + ".spill"),
+      m_max_waiting_bytes(max_waiting_bytes) {
+  m_fp = fopen(file_name.c_str(), "w");
+  if (!m_fp) {
+    throw std::runtime_error("Failed to open file " + file_name);
+  }
+}
+
+OrderedFileAppender::~OrderedFileAppender() {
+  if (m_fp) {
+    fclose(m_fp);
+  }
+  if (m_spill_fp) {
+    fclose(m_spill_fp);
+    std::remove(m_spill_file_name.c_str());
+  }
+}
+
+void OrderedFileAppender::add(size_t idx, std::string text) {
+  std::lock_guard<std::mutex> lk(m_lock);
+  if (idx != m_next_idx) {
+    WaitingPiece piece;
+    piece.size = text.size();
+    if (m_waiting_bytes + text.size() <= m_max_waiting_bytes) {
+      m_waiting_bytes += text.size();
+      piece.text = std::move(text);
+    } else {
+      piece.spill_offset = spill(text);
+    }
+    m_waiting[idx] = std::move(piece);
+    return;
+  }
+
+  write(text);
+  m_next_idx++;
+
+  auto it = m_waiting.begin();
+  while (it != m_waiting.end() && it->first == m_next_idx) {
+    write_waiting(it->second);
+    m_next_idx++;
+    it = m_waiting.erase(it);
+  }
+}
+
+void OrderedFileAppender::finish() {
+  std::lock_guard<std::mutex> lk(m_lock);
+  if (!m_waiting.empty()) {
+    throw std::runtime_error("Missing part of file " + m_file_name);
+  }
+  write("\n");
+  if (fclose(m_fp)) {
+    m_fp = nullptr;
+    throw std::runtime_error("Failed to write file " + m_file_name);
+  }
+  m_fp = nullptr;
+}
+
+void OrderedFileAppender::write(const std::string& text) {
+  if (!m_fp) {
+    throw std::runtime_error("File " + m_file_name + " is already finished");
+  }
+  if (!text.empty() && fwrite(text.data(), text.size(), 1, m_fp) != 1) {
+    throw std::runtime_error("Failed to write file " + m_file_name);
+  }
+  m_bytes_written += text.size();
+}
+
+/*!
+ * Write a piece which was waiting, reading it back from the spill file if needed.
+ */
+void OrderedFileAppender::write_waiting(WaitingPiece& piece) {
+  if (piece.spill_offset < 0) {
+    m_waiting_bytes -= piece.size;
+    write(piece.text);
+    return;
+  }
+
+  std::string text(piece.size, '\0');
+  if (fseek(m_spill_fp, piece.spill_offset, SEEK_SET) ||
+      (!text.empty() && fread(text.data(), text.size(), 1, m_spill_fp) != 1)) {
+    throw std::runtime_error("Failed to read spill file " + m_spill_file_name);
+  }
+  write(text);
+}
+
+/*!
+ * Add a piece to the end of the spill file, and return where it is.
+ */
+long OrderedFileAppender::spill(const std::string& text) {
+  if (!m_spill_fp) {
+    m_spill_fp = fopen(m_spill_file_name.c_str(), "w+b");
+    if (!m_spill_fp) {
+      throw std::runtime_error("Failed to open spill file " + m_spill_file_name);
+    }
+  }
+
+  long offset = -1;
+  if (fseek(m_spill_fp, 0, SEEK_END) || (offset = ftell(m_spill_fp)) < 0 ||
+      (!text.empty() && fwrite(text.data(), text.size(), 1, m_spill_fp) != 1)) {
+    throw std::runtime_error("Failed to write spill file " + m_spill_file_name);
+  }
+  return offset;
+}
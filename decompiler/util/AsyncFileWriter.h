@@ -0,0 +1,145 @@
+#pragma once
+
+/*!
+ * @file AsyncFileWriter.h
+ * Write output files on background threads, so generating the text and writing it to disk can
+ * happen at the same time.
+ */
+
+#include <condition_variable>
+#include <cstdio>
+#include <deque>
+#include <exception>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "common/common_types.h"
+#include "common/util/Deflate.h"
+
+/*!
+ * Writes text files and PNGs on background threads. PNGs are also compressed on these threads.
+ * Queueing a file only blocks if too much data is already waiting to be written, so the amount
+ * of output held in memory is bounded.
+ */
+class AsyncFileWriter {
+ public:
+  explicit AsyncFileWriter(int thread_count = 2, size_t max_queued_bytes = 64 << 20);
+  ~AsyncFileWriter();
+  AsyncFileWriter(const AsyncFileWriter&) = delete;
+  AsyncFileWriter& operator=(const AsyncFileWriter&) = delete;
+
+  /*!
+   * Queue a text file to be written, like file_util::write_text_file. Safe to call from any thread.
+   */
+  void write_text_file(const std::string& file_name, std::string text);
+
+  /*!
+   * Queue an RGBA image to be compressed and written, like file_util::write_rgba_png. Safe to call
+   * from any thread.
+   */
+  void write_rgba_png(const std::string& file_name,
+                      std::vector<u32> rgba,
+                      int w,
+                      int h,
+                      deflate::Level level);
+
+  /*!
+   * Wait for all queued files to be written. If any write failed, rethrows the first error.
+   */
+  void finish();
+
+  struct Stats {
+    int files = 0;
+    size_t input_bytes = 0;   // text, or uncompressed pixels
+    size_t output_bytes = 0;  // bytes written to disk
+    double encode_ms = 0;     // total time spent compressing, over all threads
+  };
+
+  /*!
+   * Totals for the files written so far. Call after finish to get totals for everything queued.
+   */
+  Stats stats();
+
+ private:
+  struct Job {
+    std::string file_name;
+    std::string text;
+    std::vector<u32> rgba;  // if w is not zero, this job is a PNG.
+    int w = 0;
+    int h = 0;
+    deflate::Level level = deflate::Level::FAST;
+
+    size_t size() const { return text.size() + rgba.size() * sizeof(u32); }
+  };
+
+  void add_job(Job job);
+  void writer_loop();
+
+  std::vector<std::thread> m_threads;
+  std::mutex m_lock;
+  std::condition_variable m_queue_cv;  // a job was added, or we're stopping
+  std::condition_variable m_space_cv;  // a job was taken, or finished
+  std::deque<Job> m_jobs;
+  size_t m_max_queued_bytes = 0;
+  size_t m_queued_bytes = 0;
+  int m_in_progress = 0;
+  bool m_stop = false;
+  std::exception_ptr m_exception;
+  Stats m_stats;
+};
+
+/*!
+ * Builds a single text file from pieces which may be generated out of order, by several threads.
+ * Pieces are numbered, and each piece is appended to the file as soon as all the pieces before it
+ * have been added, so the whole file is never held in memory.
+ * Pieces which arrive early are held in memory, up to max_waiting_bytes. Past that they are put in a
+ * temporary spill file until their turn comes. Adding a piece never blocks, because the thread
+ * which would add the missing earlier piece may be waiting to run behind it.
+ */
+class OrderedFileAppender {
+ public:
+  explicit OrderedFileAppender(const std::string& file_name, size_t max_waiting_bytes = 64 << 20);
+  ~OrderedFileAppender();
+  OrderedFileAppender(const OrderedFileAppender&) = delete;
+  OrderedFileAppender& operator=(const OrderedFileAppender&) = delete;
+
+  /*!
+   * Add piece number idx. Safe to call from any thread.
+   */
+  void add(size_t idx, std::string text);
+
+  /*!
+   * Finish the file. All pieces from 0 up to the highest piece added must have been added.
+   * Like file_util::write_text_file, this adds a newline at the end.
+   */
+  void finish();
+
+  size_t bytes_written() const { return m_bytes_written; }
+
+ private:
+  /*!
+   * A piece that arrived before an earlier piece. Either in memory, or in the spill file.
+   */
+  struct WaitingPiece {
+    std::string text;
+    long spill_offset = -1;  // -1 if the piece is in memory
+    size_t size = 0;
+  };
+
+  void write(const std::string& text);
+  void write_waiting(WaitingPiece& piece);
+  long spill(const std::string& text);
+
+  std::string m_file_name;
+  std::string m_spill_file_name;
+  FILE* m_fp = nullptr;
+  FILE* m_spill_fp = nullptr;  // opened the first time a piece is spilled.
+  std::mutex m_lock;
+  size_t m_next_idx = 0;
+  std::map<size_t, WaitingPiece> m_waiting;
+  size_t m_max_waiting_bytes = 0;
+  size_t m_waiting_bytes = 0;  // size of the pieces in m_waiting which are in memory.
+  size_t m_bytes_written = 0;
+};
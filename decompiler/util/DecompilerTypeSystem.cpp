@@ -133,6 +133,27 @@ bool DecompilerTypeSystem::lookup_flags(const std::string& type, u64* dest) cons
   return false;
 }
 
+/*!
+ * Lowest common ancestor of two interned types. These are remembered, as type analysis asks for
+ * the same pairs over and over.
+ */
+TypeId DecompilerTypeSystem::lowest_common_ancestor(TypeId a, TypeId b) {
+  if (a == b) {
+    return a;
+  }
+  if (a > b) {
+    std::swap(a, b);
+  }
+  u32 key = (u32(a) << 16) | b;
+  auto kv = m_lca_cache.find(key);
+  if (kv != m_lca_cache.end()) {
+    return kv->second;
+  }
+  auto result = type_ids.intern(ts.lowest_common_ancestor(type_ids.get(a), type_ids.get(b)));
+  m_lca_cache[key] = result;
+  return result;
+}
+
 void DecompilerTypeSystem::add_symbol(const std::string& name, const TypeSpec& type_spec) {
   add_symbol(name);
   auto skv = symbol_types.find(name);
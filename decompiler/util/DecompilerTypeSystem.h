@@ -2,6 +2,7 @@
 #define JAK_DECOMPILERTYPESYSTEM_H
 
 #include "common/type_system/TypeSystem.h"
+#include "decompiler/util/TypeMap.h"
 
 class DecompilerTypeSystem {
  public:
@@ -12,6 +13,7 @@ class DecompilerTypeSystem {
   std::vector<std::string> symbol_add_order;
   std::unordered_map<std::string, u64> type_flags;
   std::unordered_map<std::string, std::string> type_parents;
+  TypeIdTable type_ids;  // types seen by type analysis
 
   void add_symbol(const std::string& name) {
     if (symbols.find(name) == symbols.end()) {
@@ -34,6 +36,10 @@ class DecompilerTypeSystem {
   std::string dump_symbol_types();
   std::string lookup_parent_from_inspects(const std::string& child) const;
   bool lookup_flags(const std::string& type, u64* dest) const;
+  TypeId lowest_common_ancestor(TypeId a, TypeId b);
+
+ private:
+  std::unordered_map<u32, TypeId> m_lca_cache;
 };
 
 #endif  // JAK_DECOMPILERTYPESYSTEM_H
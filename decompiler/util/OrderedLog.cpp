@@ -0,0 +1,70 @@
+#include <cstdio>
+#include "OrderedLog.h"
+#include "third-party/spdlog/include/spdlog/spdlog.h"
+
+namespace ordered_log {
+namespace {
+thread_local Buffer* t_buffer = nullptr;
+
+void print_entry(const Entry& entry) {
+  switch (entry.kind) {
+    case Entry::Kind::PRINT:
+      fputs(entry.text.c_str(), stdout);
+      break;
+    case Entry::Kind::INFO:
+      spdlog::info("{}", entry.text);
+      break;
+    case Entry::Kind::WARN:
+      spdlog::warn("{}", entry.text);
+      break;
+    case Entry::Kind::ERR:
+      spdlog::error("{}", entry.text);
+      break;
+  }
+}
+
+void log(Entry::Kind kind, const std::string& text) {
+  if (t_buffer) {
+    t_buffer->push_back({kind, text});
+  } else {
+    print_entry({kind, text});
+  }
+}
+}  // namespace
+
+Buffer* capture(Buffer* buffer) {
+  auto prev = t_buffer;
+  t_buffer = buffer;
+  return prev;
+}
+
+void flush(const Buffer& buffer) {
+  for (auto& entry : buffer) {
+    print_entry(entry);
+  }
+}
+
+void flush_captured() {
+  if (t_buffer) {
+    flush(*t_buffer);
+    t_buffer->clear();
+  }
+}
+
+void print(const std::string& text) {
+  log(Entry::Kind::PRINT, text);
+}
+
+void info(const std::string& text) {
+  log(Entry::Kind::INFO, text);
+}
+
+void warn(const std::string& text) {
+  log(Entry::Kind::WARN, text);
+}
+
+void error(const std::string& text) {
+  log(Entry::Kind::ERR, text);
+}
+
+}  // namespace ordered_log
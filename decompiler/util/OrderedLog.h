@@ -0,0 +1,59 @@
+#pragma once
+
+/*!
+ * @file OrderedLog.h
+ * Logging for decompiler passes which may run on several threads at once.
+ * A thread can capture its messages into a buffer, and the buffers can be printed later in a fixed
+ * order, so the output is the same as if everything had run on a single thread.
+ */
+
+#include <string>
+#include <vector>
+
+namespace ordered_log {
+
+struct Entry {
+  enum class Kind { PRINT, INFO, WARN, ERR } kind;
+  std::string text;
+};
+
+using Buffer = std::vector<Entry>;
+
+/*!
+ * Send messages logged by this thread to buffer instead of printing them.
+ * Pass nullptr to go back to printing immediately. Returns the previous buffer.
+ */
+Buffer* capture(Buffer* buffer);
+
+/*!
+ * Capture messages logged by this thread into a buffer until this goes out of scope.
+ */
+class ScopedCapture {
+ public:
+  explicit ScopedCapture(Buffer* buffer) : m_prev(capture(buffer)) {}
+  ~ScopedCapture() { capture(m_prev); }
+  ScopedCapture(const ScopedCapture&) = delete;
+  ScopedCapture& operator=(const ScopedCapture&) = delete;
+
+ private:
+  Buffer* m_prev = nullptr;
+};
+
+/*!
+ * Print everything in a buffer.
+ */
+void flush(const Buffer& buffer);
+
+/*!
+ * Print and clear the messages this thread has captured so far. Call this right before an assert
+ * fails, so the messages explaining the failure aren't lost when the program aborts.
+ */
+void flush_captured();
+
+// print is a replacement for printf, the rest go to spdlog.
+void print(const std::string& text);
+void info(const std::string& text);
+void warn(const std::string& text);
+void error(const std::string& text);
+
+}  // namespace ordered_log
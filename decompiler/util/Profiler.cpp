@@ -0,0 +1,295 @@
+/*!
+ * @file Profiler.cpp
+ * Optional profiling of decompiler passes. Records time, memory use and the amount of work done
+ * for each pass and each object, and writes it out as JSON.
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <cstdlib>
+#include <mutex>
+#include <new>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "Profiler.h"
+#include "third-party/json.hpp"
+
+#ifdef __linux__
+#include <sys/resource.h>
+#include <time.h>
+#elif _WIN32
+#include <Windows.h>
+#include <psapi.h>
+#endif
+
+namespace profiler {
+namespace {
+std::atomic<bool> g_enabled = {false};
+
+////////////////////////
+// Allocation Counting
+////////////////////////
+
+// Each thread counts its own allocations, so counting doesn't make threads fight over a shared
+// counter. Only the owning thread writes to its counters.
+struct AllocCounters {
+  std::atomic<uint64_t> count = {0};
+  std::atomic<uint64_t> bytes = {0};
+};
+
+constexpr int MAX_COUNTED_THREADS = 1024;
+std::atomic<AllocCounters*> g_counters[MAX_COUNTED_THREADS];
+std::atomic<int> g_counter_count = {0};
+thread_local AllocCounters* t_counters = nullptr;
+
+AllocCounters* thread_counters() {
+  if (!t_counters) {
+    // this is called from operator new, so it can't use new. The counters are never freed.
+    t_counters = new (malloc(sizeof(AllocCounters))) AllocCounters();
+    int idx = g_counter_count++;
+    if (idx < MAX_COUNTED_THREADS) {
+      g_counters[idx] = t_counters;
+    }
+  }
+  return t_counters;
+}
+
+void add(std::atomic<uint64_t>& counter, uint64_t amount) {
+  counter.store(counter.load(std::memory_order_relaxed) + amount, std::memory_order_relaxed);
+}
+
+/*!
+ * Total allocations made by all threads.
+ */
+void total_allocations(uint64_t* count, uint64_t* bytes) {
+  *count = 0;
+  *bytes = 0;
+  int n = std::min(g_counter_count.load(), MAX_COUNTED_THREADS);
+  for (int i = 0; i < n; i++) {
+    auto counters = g_counters[i].load();
+    if (counters) {
+      *count += counters->count.load(std::memory_order_relaxed);
+      *bytes += counters->bytes.load(std::memory_order_relaxed);
+    }
+  }
+}
+
+/////////////////////////
+// Time and Memory Use
+/////////////////////////
+
+#ifdef _WIN32
+int64_t filetime_to_ns(const FILETIME& time) {
+  return 100 * ((int64_t(time.dwHighDateTime) << 32) | time.dwLowDateTime);
+}
+#endif
+
+int64_t thread_cpu_ns() {
+#ifdef __linux__
+  struct timespec now = {};
+  clock_gettime(CLOCK_THREAD_CPUTIME_ID, &now);
+  return int64_t(now.tv_sec) * 1000000000 + now.tv_nsec;
+#elif _WIN32
+  FILETIME creation, exit, kernel, user;
+  GetThreadTimes(GetCurrentThread(), &creation, &exit, &kernel, &user);
+  return filetime_to_ns(kernel) + filetime_to_ns(user);
+#else
+  return 0;
+#endif
+}
+
+int64_t process_cpu_ns() {
+#ifdef __linux__
+  struct timespec now = {};
+  clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &now);
+  return int64_t(now.tv_sec) * 1000000000 + now.tv_nsec;
+#elif _WIN32
+  FILETIME creation, exit, kernel, user;
+  GetProcessTimes(GetCurrentProcess(), &creation, &exit, &kernel, &user);
+  return filetime_to_ns(kernel) + filetime_to_ns(user);
+#else
+  return 0;
+#endif
+}
+
+uint64_t peak_rss_bytes() {
+#ifdef __linux__
+  struct rusage usage = {};
+  getrusage(RUSAGE_SELF, &usage);
+  return uint64_t(usage.ru_maxrss) * 1024;
+#elif _WIN32
+  PROCESS_MEMORY_COUNTERS counters = {};
+  GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters));
+  return counters.PeakWorkingSetSize;
+#else
+  return 0;
+#endif
+}
+
+////////////////
+// Records
+////////////////
+
+struct Record {
+  double wall_ms = 0;
+  double cpu_ms = 0;
+  uint64_t bytes = 0;
+  uint64_t items = 0;
+  uint64_t allocations = 0;
+  uint64_t allocated_bytes = 0;
+
+  void add(const Record& other) {
+    wall_ms += other.wall_ms;
+    cpu_ms += other.cpu_ms;
+    bytes += other.bytes;
+    items += other.items;
+    allocations += other.allocations;
+    allocated_bytes += other.allocated_bytes;
+  }
+};
+
+struct PassRecord {
+  std::string name;
+  Record total;
+  std::unordered_map<std::string, Record> objects;
+};
+
+std::mutex g_lock;
+std::vector<PassRecord> g_passes;
+bool g_in_pass = false;
+
+// state at the start of the current pass
+Timer g_pass_timer;
+int64_t g_pass_start_cpu_ns = 0;
+uint64_t g_pass_start_allocations = 0;
+uint64_t g_pass_start_allocated_bytes = 0;
+
+nlohmann::json record_to_json(const Record& record) {
+  nlohmann::json result;
+  result["wall_ms"] = record.wall_ms;
+  result["cpu_ms"] = record.cpu_ms;
+  result["bytes"] = record.bytes;
+  result["items"] = record.items;
+  result["allocations"] = record.allocations;
+  result["allocated_bytes"] = record.allocated_bytes;
+  return result;
+}
+}  // namespace
+
+void count_allocation(size_t size) {
+  if (g_enabled.load(std::memory_order_relaxed)) {
+    auto counters = thread_counters();
+    add(counters->count, 1);
+    add(counters->bytes, size);
+  }
+}
+
+void set_enabled(bool enabled) {
+  g_enabled = enabled;
+}
+
+bool enabled() {
+  return g_enabled.load(std::memory_order_relaxed);
+}
+
+ScopedPass::ScopedPass(const std::string& name) {
+  if (!enabled()) {
+    return;
+  }
+
+  std::lock_guard<std::mutex> lk(g_lock);
+  assert(!g_in_pass);
+  g_in_pass = true;
+  m_active = true;
+  g_passes.emplace_back();
+  g_passes.back().name = name;
+  total_allocations(&g_pass_start_allocations, &g_pass_start_allocated_bytes);
+  g_pass_start_cpu_ns = process_cpu_ns();
+  g_pass_timer.start();
+}
+
+ScopedPass::~ScopedPass() {
+  if (!m_active) {
+    return;
+  }
+
+  std::lock_guard<std::mutex> lk(g_lock);
+  auto& pass = g_passes.back();
+  pass.total.wall_ms = g_pass_timer.getMs();
+  pass.total.cpu_ms = (process_cpu_ns() - g_pass_start_cpu_ns) / 1.e6;
+  uint64_t allocations, allocated_bytes;
+  total_allocations(&allocations, &allocated_bytes);
+  pass.total.allocations = allocations - g_pass_start_allocations;
+  pass.total.allocated_bytes = allocated_bytes - g_pass_start_allocated_bytes;
+  for (auto& kv : pass.objects) {
+    pass.total.bytes += kv.second.bytes;
+    pass.total.items += kv.second.items;
+  }
+  g_in_pass = false;
+}
+
+void ScopedObject::start(std::string name, uint64_t bytes, uint64_t items) {
+  m_active = true;
+  m_name = std::move(name);
+  m_bytes = bytes;
+  m_items = items;
+  auto counters = thread_counters();
+  m_start_allocations = counters->count.load(std::memory_order_relaxed);
+  m_start_allocated_bytes = counters->bytes.load(std::memory_order_relaxed);
+  m_start_cpu_ns = thread_cpu_ns();
+  m_timer.start();
+}
+
+ScopedObject::~ScopedObject() {
+  if (!m_active) {
+    return;
+  }
+
+  Record record;
+  record.wall_ms = m_timer.getMs();
+  record.cpu_ms = (thread_cpu_ns() - m_start_cpu_ns) / 1.e6;
+  record.bytes = m_bytes;
+  record.items = m_items;
+  auto counters = thread_counters();
+  record.allocations = counters->count.load(std::memory_order_relaxed) - m_start_allocations;
+  record.allocated_bytes =
+      counters->bytes.load(std::memory_order_relaxed) - m_start_allocated_bytes;
+
+  std::lock_guard<std::mutex> lk(g_lock);
+  if (g_in_pass) {
+    g_passes.back().objects[m_name].add(record);
+  }
+}
+
+std::string to_json() {
+  std::lock_guard<std::mutex> lk(g_lock);
+  nlohmann::json result;
+  std::vector<nlohmann::json> passes;
+  for (auto& pass : g_passes) {
+    auto pass_json = record_to_json(pass.total);
+    pass_json["name"] = pass.name;
+
+    // slowest objects first
+    std::vector<std::pair<std::string, Record>> objects(pass.objects.begin(), pass.objects.end());
+    std::sort(objects.begin(), objects.end(), [](const auto& a, const auto& b) {
+      return a.second.wall_ms > b.second.wall_ms ||
+             (a.second.wall_ms == b.second.wall_ms && a.first < b.first);
+    });
+    std::vector<nlohmann::json> objects_json;
+    for (auto& obj : objects) {
+      auto obj_json = record_to_json(obj.second);
+      obj_json["name"] = obj.first;
+      objects_json.push_back(obj_json);
+    }
+    pass_json["objects"] = objects_json;
+    passes.push_back(pass_json);
+  }
+  result["passes"] = passes;
+  // the operating system only tracks this for the whole process, so it isn't split up by pass.
+  result["peak_rss_bytes"] = peak_rss_bytes();
+  return result.dump(2);
+}
+
+}  // namespace profiler
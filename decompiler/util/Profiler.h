@@ -0,0 +1,80 @@
+#pragma once
+
+/*!
+ * @file Profiler.h
+ * Optional profiling of decompiler passes. Records time, memory use and the amount of work done
+ * for each pass and each object, and writes it out as JSON.
+ * When profiling isn't enabled, none of this does anything.
+ */
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include "common/util/Timer.h"
+
+namespace profiler {
+
+void set_enabled(bool enabled);
+bool enabled();
+
+/*!
+ * Measure a pass of the decompiler, until this goes out of scope. Passes can't be nested.
+ */
+class ScopedPass {
+ public:
+  explicit ScopedPass(const std::string& name);
+  ~ScopedPass();
+  ScopedPass(const ScopedPass&) = delete;
+  ScopedPass& operator=(const ScopedPass&) = delete;
+
+ private:
+  bool m_active = false;
+};
+
+/*!
+ * Measure work on a single object (or part of one) during the current pass, until this goes out
+ * of scope. May be used from any thread. Records for the same name in a pass are added together,
+ * so this can also be used once per function of an object.
+ * The name is only made, by calling get_name, when profiling is enabled.
+ */
+class ScopedObject {
+ public:
+  template <typename GetName>
+  ScopedObject(const GetName& get_name, uint64_t bytes, uint64_t items = 1) {
+    if (enabled()) {
+      start(get_name(), bytes, items);
+    }
+  }
+  ~ScopedObject();
+  ScopedObject(const ScopedObject&) = delete;
+  ScopedObject& operator=(const ScopedObject&) = delete;
+
+  /*!
+   * Set the number of bytes processed, for work where this isn't known until it's done.
+   */
+  void set_bytes(uint64_t bytes) { m_bytes = bytes; }
+
+ private:
+  void start(std::string name, uint64_t bytes, uint64_t items);
+
+  bool m_active = false;
+  std::string m_name;
+  uint64_t m_bytes = 0;
+  uint64_t m_items = 0;
+  Timer m_timer;
+  int64_t m_start_cpu_ns = 0;
+  uint64_t m_start_allocations = 0;
+  uint64_t m_start_allocated_bytes = 0;
+};
+
+/*!
+ * Count an allocation by the current thread. Called by the decompiler's operator new.
+ */
+void count_allocation(size_t size);
+
+/*!
+ * Get everything recorded so far as JSON.
+ */
+std::string to_json();
+
+}  // namespace profiler
@@ -0,0 +1,40 @@
+/*!
+ * @file ProfilerAllocations.cpp
+ * Replaces the global operator new, so the profiler can count allocations made by the whole
+ * program. This is part of the decompiler executable, not the decomp library, so tests and tools
+ * which link the library keep the standard operator new.
+ */
+
+#include <cstdlib>
+#include <new>
+#include "Profiler.h"
+
+// Count allocations made by the whole program, for the profiler.
+void* operator new(size_t size) {
+  profiler::count_allocation(size);
+  void* result = malloc(size ? size : 1);
+  if (!result) {
+    throw std::bad_alloc();
+  }
+  return result;
+}
+
+void* operator new[](size_t size) {
+  return operator new(size);
+}
+
+void operator delete(void* ptr) noexcept {
+  free(ptr);
+}
+
+void operator delete[](void* ptr) noexcept {
+  free(ptr);
+}
+
+void operator delete(void* ptr, size_t) noexcept {
+  free(ptr);
+}
+
+void operator delete[](void* ptr, size_t) noexcept {
+  free(ptr);
+}
@@ -0,0 +1,145 @@
+#pragma once
+
+/*!
+ * @file SmallVector.h
+ * A vector which stores its first few elements inline, and only allocates when it grows past that.
+ */
+
+#include <cassert>
+#include <cstdint>
+#include <cstring>
+#include <initializer_list>
+#include <type_traits>
+
+/*!
+ * A vector of up to N elements which doesn't allocate. If it grows past N elements, it moves to
+ * the heap like a std::vector. Elements are copied with memcpy, so T must be trivially copyable.
+ * This is meant for short lists of pointers or indices, like the edges of a graph.
+ */
+template <typename T, uint32_t N>
+class SmallVector {
+  static_assert(std::is_trivially_copyable<T>::value, "SmallVector needs a trivially copyable T");
+  static_assert(N > 0, "SmallVector needs inline storage");
+
+ public:
+  SmallVector() = default;
+  SmallVector(std::initializer_list<T> init) { assign(init.begin(), init.end()); }
+  SmallVector(const SmallVector& other) { assign(other.begin(), other.end()); }
+  SmallVector(SmallVector&& other) noexcept { take(other); }
+  ~SmallVector() { free_heap(); }
+
+  SmallVector& operator=(const SmallVector& other) {
+    if (this != &other) {
+      assign(other.begin(), other.end());
+    }
+    return *this;
+  }
+
+  SmallVector& operator=(SmallVector&& other) noexcept {
+    if (this != &other) {
+      free_heap();
+      take(other);
+    }
+    return *this;
+  }
+
+  SmallVector& operator=(std::initializer_list<T> init) {
+    assign(init.begin(), init.end());
+    return *this;
+  }
+
+  T* begin() { return m_data; }
+  T* end() { return m_data + m_size; }
+  const T* begin() const { return m_data; }
+  const T* end() const { return m_data + m_size; }
+  T* data() { return m_data; }
+  const T* data() const { return m_data; }
+
+  uint32_t size() const { return m_size; }
+  bool empty() const { return m_size == 0; }
+  uint32_t capacity() const { return m_capacity; }
+
+  T& operator[](uint32_t idx) { return m_data[idx]; }
+  const T& operator[](uint32_t idx) const { return m_data[idx]; }
+  T& at(uint32_t idx) {
+    assert(idx < m_size);
+    return m_data[idx];
+  }
+  const T& at(uint32_t idx) const {
+    assert(idx < m_size);
+    return m_data[idx];
+  }
+  T& front() { return at(0); }
+  T& back() { return at(m_size - 1); }
+  const T& front() const { return at(0); }
+  const T& back() const { return at(m_size - 1); }
+
+  void clear() { m_size = 0; }
+
+  void push_back(const T& value) {
+    if (m_size == m_capacity) {
+      // value may be one of our own elements, so copy it before growing.
+      T copy = value;
+      reserve(2 * m_capacity);
+      m_data[m_size++] = copy;
+    } else {
+      m_data[m_size++] = value;
+    }
+  }
+
+  void pop_back() {
+    assert(m_size > 0);
+    m_size--;
+  }
+
+  void reserve(uint32_t capacity) {
+    if (capacity <= m_capacity) {
+      return;
+    }
+    T* new_data = new T[capacity];
+    memcpy((void*)new_data, (const void*)m_data, m_size * sizeof(T));
+    free_heap();
+    m_data = new_data;
+    m_capacity = capacity;
+  }
+
+ private:
+  bool on_heap() const { return m_data != m_inline; }
+
+  void free_heap() {
+    if (on_heap()) {
+      delete[] m_data;
+      m_data = m_inline;
+      m_capacity = N;
+    }
+  }
+
+  void assign(const T* first, const T* last) {
+    auto count = uint32_t(last - first);
+    m_size = 0;
+    reserve(count);
+    memcpy((void*)m_data, (const void*)first, count * sizeof(T));
+    m_size = count;
+  }
+
+  /*!
+   * Take the contents of other, leaving it empty. We must not have anything on the heap.
+   */
+  void take(SmallVector& other) {
+    if (other.on_heap()) {
+      m_data = other.m_data;
+      m_capacity = other.m_capacity;
+      other.m_data = other.m_inline;
+      other.m_capacity = N;
+    } else {
+      memcpy((void*)m_inline, (const void*)other.m_inline, other.m_size * sizeof(T));
+    }
+    m_size = other.m_size;
+    other.m_size = 0;
+  }
+
+  T* m_data = m_inline;
+  uint32_t m_size = 0;
+  uint32_t m_capacity = N;
+  T m_inline[N];
+};
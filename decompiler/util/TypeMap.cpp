@@ -0,0 +1,48 @@
+/*!
+ * @file TypeMap.cpp
+ * The types in each register, used by type analysis.
+ */
+
+#include <cassert>
+#include <stdexcept>
+#include "TypeMap.h"
+
+TypeIdTable::TypeIdTable() {
+  // id 0 is NO_TYPE.
+  m_types.emplace_back();
+}
+
+TypeId TypeIdTable::intern(const TypeSpec& type) {
+  auto kv = m_ids.find(type);
+  if (kv != m_ids.end()) {
+    return kv->second;
+  }
+
+  if (m_types.size() > UINT16_MAX) {
+    throw std::runtime_error("Too many types in TypeIdTable");
+  }
+  auto id = TypeId(m_types.size());
+  m_types.push_back(type);
+  m_ids[type] = id;
+  return id;
+}
+
+const TypeSpec& TypeIdTable::get(TypeId id) const {
+  assert(id != NO_TYPE);
+  return m_types.at(id);
+}
+
+void TypeMap::set_slot(int idx, TypeId type) {
+  if (get_slot(idx) == type) {
+    return;
+  }
+
+  if (!m_slots) {
+    m_slots = std::make_shared<Slots>();
+    m_slots->fill(NO_TYPE);
+  } else if (m_slots.use_count() > 1) {
+    // shared with another map, copy before modifying.
+    m_slots = std::make_shared<Slots>(*m_slots);
+  }
+  (*m_slots)[idx] = type;
+}
@@ -0,0 +1,79 @@
+#pragma once
+
+/*!
+ * @file TypeMap.h
+ * The types in each register, used by type analysis.
+ */
+
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+#include "decompiler/Disasm/Register.h"
+#include "common/type_system/TypeSpec.h"
+
+// index of an interned TypeSpec in a TypeIdTable. 0 is "no type".
+using TypeId = uint16_t;
+constexpr TypeId NO_TYPE = 0;
+
+/*!
+ * Gives each distinct TypeSpec a small integer id, so type maps can store and compare types
+ * without copying or comparing the TypeSpecs.
+ */
+class TypeIdTable {
+ public:
+  TypeIdTable();
+  TypeId intern(const TypeSpec& type);
+  const TypeSpec& get(TypeId id) const;
+  int size() const { return int(m_types.size()); }
+
+ private:
+  std::vector<TypeSpec> m_types;
+  std::unordered_map<TypeSpec, TypeId, TypeSpec::hash> m_ids;
+};
+
+/*!
+ * Map of what type is in each register.
+ * This is a fixed size array, indexed by register, of type ids. Copies share the array until one
+ * of them is modified, so keeping a copy for every basic op is cheap.
+ */
+class TypeMap {
+ public:
+  static constexpr int REGS_PER_KIND = 32;
+  static constexpr int SLOT_COUNT = Reg::MAX_KIND * REGS_PER_KIND;
+
+  TypeId get(Register reg) const { return m_slots ? (*m_slots)[slot(reg)] : NO_TYPE; }
+  bool contains(Register reg) const { return get(reg) != NO_TYPE; }
+  TypeId get_slot(int idx) const { return m_slots ? (*m_slots)[idx] : NO_TYPE; }
+  void set(Register reg, TypeId type) { set_slot(slot(reg), type); }
+  void set_slot(int idx, TypeId type);
+
+  /*!
+   * Do these maps share the same array? If so, they are definitely equal.
+   */
+  bool shares_with(const TypeMap& other) const { return m_slots == other.m_slots; }
+
+  /*!
+   * Call f(Register, TypeId) for each register with a type, in register order.
+   */
+  template <typename T>
+  void for_each(T f) const {
+    if (!m_slots) {
+      return;
+    }
+    for (int i = 0; i < SLOT_COUNT; i++) {
+      if ((*m_slots)[i] != NO_TYPE) {
+        f(Register(Reg::RegisterKind(i / REGS_PER_KIND), i % REGS_PER_KIND), (*m_slots)[i]);
+      }
+    }
+  }
+
+ private:
+  using Slots = std::array<TypeId, SLOT_COUNT>;
+  static int slot(Register reg) {
+    auto id = reg.reg_id();
+    return (id >> 8) * REGS_PER_KIND + (id & 0xff);
+  }
+  std::shared_ptr<Slots> m_slots;
+};
@@ -9,7 +9,19 @@
 
 using namespace goos;
 
-Compiler::Compiler() : m_debugger(&m_listener) {
+Compiler::Compiler()
+    : m_debugger(&m_listener),
+      m_gc_roots([this](goos::GcTracer& tracer) {
+        for (auto& kv : m_global_constants) {
+          tracer.mark(kv.first);
+          tracer.mark(kv.second);
+        }
+        for (auto& kv : m_inlineable_functions) {
+          tracer.mark(kv.first);
+          tracer.mark(kv.second->lambda.body);
+        }
+        m_settings.trace(tracer);
+      }) {
   init_logger();
   init_settings();
   m_listener.add_debugger(&m_debugger);
@@ -24,6 +36,9 @@ Compiler::Compiler() : m_debugger(&m_listener) {
 
 void Compiler::execute_repl() {
   while (!m_want_exit) {
+    // nothing from the last form is still in use, so free the GOOS objects it left behind.
+    goos::collect_garbage();
+
     try {
       // 1). get a line from the user (READ)
       std::string prompt = "g";
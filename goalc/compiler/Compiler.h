@@ -117,9 +117,11 @@ class Compiler {
   Debugger m_debugger;
   goos::Interpreter m_goos;
   std::unordered_map<std::string, TypeSpec> m_symbol_types;
-  std::unordered_map<std::shared_ptr<goos::SymbolObject>, goos::Object> m_global_constants;
-  std::unordered_map<std::shared_ptr<goos::SymbolObject>, LambdaVal*> m_inlineable_functions;
+  std::unordered_map<goos::HeapPtr<goos::SymbolObject>, goos::Object> m_global_constants;
+  std::unordered_map<goos::HeapPtr<goos::SymbolObject>, LambdaVal*> m_inlineable_functions;
   CompilerSettings m_settings;
+  // the GOOS objects kept between forms, which aren't in the GOOS interpreter.
+  goos::GcRoots m_gc_roots;
   bool m_throw_on_define_extern_redefinition = false;
   MathMode get_math_mode(const TypeSpec& ts);
   bool is_number(const TypeSpec& ts);
@@ -25,6 +25,12 @@ void CompilerSettings::set(const std::string& name, const goos::Object& value) {
   }
 }
 
+void CompilerSettings::trace(goos::GcTracer& tracer) const {
+  for (auto& kv : m_settings) {
+    tracer.mark(kv.second.value);
+  }
+}
+
 void CompilerSettings::link(bool& val, const std::string& name) {
   m_settings[name].kind = SettingKind::BOOL;
   m_settings[name].boolp = &val;
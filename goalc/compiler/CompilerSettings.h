@@ -17,6 +17,7 @@ class CompilerSettings {
   bool print_timing = false;
 
   void set(const std::string& name, const goos::Object& value);
+  void trace(goos::GcTracer& tracer) const;
 
  private:
   void link(bool& val, const std::string& name);
@@ -250,7 +250,7 @@ class WithInlineEnv : public Env {
 class SymbolMacroEnv : public Env {
  public:
   explicit SymbolMacroEnv(Env* parent) : Env(parent) {}
-  std::unordered_map<std::shared_ptr<goos::SymbolObject>, goos::Object> macros;
+  std::unordered_map<goos::HeapPtr<goos::SymbolObject>, goos::Object> macros;
   std::string print() override { return "symbol-macro-env"; }
 };
 
@@ -33,9 +33,9 @@ Val* Compiler::compile_goos_macro(const goos::Object& o,
                                   Env* env) {
   auto macro = macro_obj.as_macro();
   Arguments args = m_goos.get_args(o, rest, macro->args);
-  auto mac_env_obj = EnvironmentObject::make_new();
+  auto mac_env_obj =
+      EnvironmentObject::make_frame(m_goos.global_environment.as_env(), macro->args.frame_size());
   auto mac_env = mac_env_obj.as_env();
-  mac_env->parent_env = m_goos.global_environment.as_env();
   m_goos.set_args_in_env(o, args, macro->args, mac_env);
   m_goos.goal_to_goos.enclosing_method_type =
       get_parent_env_of_type<FunctionEnv>(env)->method_of_type_name;
@@ -3,4 +3,6 @@
 # Directory of this script
 DIR="$( cd "$( dirname "${BASH_SOURCE[0]}" )" >/dev/null 2>&1 && pwd )"
 
+set -e
 $DIR/build/test/goalc-test --gtest_color=yes "$@"
+$DIR/build/test/decompiler-test --gtest_color=yes "$@"
@@ -0,0 +1,83 @@
+#include "decompiler/util/Arena.h"
+#include "gtest/gtest.h"
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+namespace {
+// records the order its objects are destroyed in.
+struct Tracked {
+  Tracked(int _id, std::vector<int>* _destroyed) : id(_id), destroyed(_destroyed) {}
+  ~Tracked() { destroyed->push_back(id); }
+  int id;
+  std::vector<int>* destroyed;
+};
+}  // namespace
+
+TEST(Arena, Alignment) {
+  Arena arena;
+  for (size_t alignment : {1, 2, 4, 8, 16, 64}) {
+    arena.allocate(1, 1);
+    auto addr = reinterpret_cast<uintptr_t>(arena.allocate(24, alignment));
+    EXPECT_EQ(0u, addr % alignment) << alignment;
+  }
+  auto d = arena.make<double>(1.5);
+  EXPECT_EQ(0u, reinterpret_cast<uintptr_t>(d) % alignof(double));
+  EXPECT_EQ(*d, 1.5);
+}
+
+TEST(Arena, GrowsAcrossBlocks) {
+  Arena arena(256);
+  std::vector<uint8_t*> allocations;
+  for (int i = 0; i < 100; i++) {
+    auto mem = static_cast<uint8_t*>(arena.allocate(100, 8));
+    memset(mem, i, 100);
+    allocations.push_back(mem);
+  }
+  // bigger than a block, so it gets its own.
+  auto big = static_cast<uint8_t*>(arena.allocate(1000, 16));
+  memset(big, 0xff, 1000);
+  EXPECT_EQ(arena.bytes_used(), 100 * 100 + 1000u);
+
+  // nothing overlapped, so every allocation still has what was written to it.
+  for (int i = 0; i < 100; i++) {
+    for (int j = 0; j < 100; j++) {
+      ASSERT_EQ(allocations[i][j], i);
+    }
+  }
+  for (int j = 0; j < 1000; j++) {
+    ASSERT_EQ(big[j], 0xff);
+  }
+}
+
+TEST(Arena, DestroysInReverseOrder) {
+  std::vector<int> destroyed;
+  {
+    Arena arena(64);
+    for (int i = 0; i < 10; i++) {
+      EXPECT_EQ(arena.make<Tracked>(i, &destroyed)->id, i);
+    }
+    EXPECT_TRUE(destroyed.empty());
+  }
+  EXPECT_EQ(destroyed, std::vector<int>({9, 8, 7, 6, 5, 4, 3, 2, 1, 0}));
+}
+
+TEST(Arena, Reset) {
+  std::vector<int> destroyed;
+  Arena arena(64);
+  for (int i = 0; i < 5; i++) {
+    arena.make<Tracked>(i, &destroyed);
+  }
+  arena.reset();
+  EXPECT_EQ(destroyed, std::vector<int>({4, 3, 2, 1, 0}));
+  EXPECT_EQ(arena.bytes_used(), 0u);
+
+  // usable again, and only the new objects are destroyed with it.
+  destroyed.clear();
+  arena.make<Tracked>(10, &destroyed);
+  EXPECT_EQ(*arena.make<int>(7), 7);
+  arena.reset();
+  EXPECT_EQ(destroyed, std::vector<int>({10}));
+  arena.reset();
+  EXPECT_EQ(destroyed, std::vector<int>({10}));
+}
@@ -0,0 +1,40 @@
+#include "common/util/FileUtil.h"
+#include "decompiler/util/AsyncFileWriter.h"
+#include "gtest/gtest.h"
+#include <filesystem>
+#include <string>
+#include <vector>
+
+TEST(OrderedFileAppender, OutOfOrderPieces) {
+  auto file_name =
+      (std::filesystem::temp_directory_path() / "jak-ordered-file-appender-test.txt").string();
+  std::vector<std::string> pieces;
+  std::string expected;
+  for (int i = 0; i < 20; i++) {
+    pieces.push_back(std::string(i * 10, 'a' + i));
+    expected += pieces.back();
+  }
+  expected += "\n";
+
+  // only a few pieces fit in memory, so most of the early pieces go to the spill file.
+  OrderedFileAppender appender(file_name, 500);
+  for (size_t i = pieces.size(); i-- > 1;) {
+    appender.add(i, pieces.at(i));
+  }
+  EXPECT_TRUE(std::filesystem::exists(file_name + ".spill"));
+  appender.add(0, pieces.at(0));
+  appender.finish();
+
+  EXPECT_EQ(file_util::read_text_file(file_name), expected);
+  EXPECT_EQ(appender.bytes_written(), expected.size());
+  std::filesystem::remove(file_name);
+}
+
+TEST(OrderedFileAppender, MissingPiece) {
+  auto file_name =
+      (std::filesystem::temp_directory_path() / "jak-ordered-file-appender-test.txt").string();
+  OrderedFileAppender appender(file_name, 0);
+  appender.add(1, "b");
+  EXPECT_THROW(appender.finish(), std::runtime_error);
+  std::filesystem::remove(file_name);
+}
@@ -0,0 +1,153 @@
+#include "decompiler/Function/BasicBlocks.h"
+#include "decompiler/Function/CfgVtx.h"
+#include "gtest/gtest.h"
+#include <random>
+#include <vector>
+
+namespace {
+// how a basic block ends.
+enum class BlockEnd { FALL_THROUGH, BRANCH, BRANCH_LIKELY, BRANCH_ALWAYS };
+
+struct TestBlock {
+  BlockEnd end = BlockEnd::FALL_THROUGH;
+  int target = -1;  // block index, if this ends in a branch.
+};
+
+/*!
+ * Generates random functions built from the control flow the GOAL compiler emits: sequences,
+ * conditions with and without else, while and until loops, and and/or. Returns from the middle
+ * of a function aren't generated: structure_reference() asserts on some of those.
+ */
+class FunctionGenerator {
+ public:
+  explicit FunctionGenerator(int seed) : m_rng(seed) {}
+
+  std::vector<TestBlock> generate() {
+    statements(0);
+    add();
+    return m_blocks;
+  }
+
+ private:
+  int next() const { return int(m_blocks.size()); }
+
+  int add(BlockEnd end = BlockEnd::FALL_THROUGH, int target = -1) {
+    m_blocks.push_back({end, target});
+    return next() - 1;
+  }
+
+  void statements(int depth) {
+    int count = 1 + m_rng() % 3;
+    for (int i = 0; i < count; i++) {
+      statement(depth);
+    }
+  }
+
+  void statement(int depth) {
+    switch (depth > 3 ? 0 : m_rng() % 7) {
+      case 0:
+      case 1:
+        add();
+        break;
+      case 2: {
+        // condition without else
+        int test = add(BlockEnd::BRANCH);
+        statements(depth + 1);
+        m_blocks.at(test).target = next();
+      } break;
+      case 3: {
+        // condition with else
+        int test = add(BlockEnd::BRANCH);
+        statements(depth + 1);
+        int jump_to_end = add(BlockEnd::BRANCH_ALWAYS);
+        m_blocks.at(test).target = next();
+        statements(depth + 1);
+        m_blocks.at(jump_to_end).target = next();
+      } break;
+      case 4: {
+        // while: jump to the test at the bottom, which branches back to the body.
+        int jump_to_test = add(BlockEnd::BRANCH_ALWAYS);
+        int body = next();
+        statements(depth + 1);
+        m_blocks.at(jump_to_test).target = next();
+        add(BlockEnd::BRANCH, body);
+      } break;
+      case 5: {
+        // until: the test at the bottom branches back to the body.
+        int body = next();
+        statements(depth + 1);
+        add(BlockEnd::BRANCH, body);
+      } break;
+      case 6: {
+        // and/or: each test branches to the end, setting the result in the delay slot.
+        std::vector<int> tests;
+        int count = 2 + m_rng() % 2;
+        for (int i = 0; i < count; i++) {
+          tests.push_back(add(BlockEnd::BRANCH_LIKELY));
+        }
+        add();
+        for (auto test : tests) {
+          m_blocks.at(test).target = next();
+        }
+      } break;
+    }
+  }
+
+  std::mt19937 m_rng;
+  std::vector<TestBlock> m_blocks;
+};
+
+/*!
+ * Build an unstructured graph for the blocks, like build_unstructured_cfg does for a function.
+ */
+std::shared_ptr<ControlFlowGraph> build_graph(const std::vector<TestBlock>& test_blocks,
+                                              std::vector<BasicBlock>& basic_blocks) {
+  int count = int(test_blocks.size());
+  basic_blocks.clear();
+  for (int i = 0; i < count; i++) {
+    basic_blocks.emplace_back(i * 4, i * 4 + 4);
+  }
+
+  auto cfg = std::make_shared<ControlFlowGraph>();
+  const auto& blocks = cfg->create_blocks(count);
+  cfg->entry()->succ_ft = blocks.front();
+  blocks.front()->pred.push_back(cfg->entry());
+  cfg->exit()->pred.push_back(blocks.back());
+  blocks.back()->succ_ft = cfg->exit();
+
+  for (int i = 0; i < count; i++) {
+    auto& block = test_blocks.at(i);
+    bool not_last = i + 1 < count;
+    if (block.end != BlockEnd::FALL_THROUGH) {
+      blocks.at(i)->end_branch.has_branch = true;
+      blocks.at(i)->end_branch.branch_likely = block.end == BlockEnd::BRANCH_LIKELY;
+      cfg->link_branch(blocks.at(i), blocks.at(block.target), basic_blocks);
+      if (block.end == BlockEnd::BRANCH_ALWAYS) {
+        blocks.at(i)->end_branch.branch_always = true;
+        continue;
+      }
+    }
+    if (not_last) {
+      cfg->link_fall_through(blocks.at(i), blocks.at(i + 1), basic_blocks);
+    }
+  }
+  return cfg;
+}
+}  // namespace
+
+TEST(CfgStructure, MatchesReference) {
+  int resolved = 0;
+  constexpr int FUNCTION_COUNT = 1000;
+  for (int seed = 0; seed < FUNCTION_COUNT; seed++) {
+    auto test_blocks = FunctionGenerator(seed).generate();
+    std::vector<BasicBlock> reference_blocks, worklist_blocks;
+    auto reference = build_graph(test_blocks, reference_blocks);
+    auto worklist = build_graph(test_blocks, worklist_blocks);
+    reference->structure_reference();
+    worklist->structure();
+    ASSERT_EQ(reference->to_form_string(), worklist->to_form_string()) << "seed " << seed;
+    resolved += reference->is_fully_resolved();
+  }
+  // most generated functions structure completely, so the test covers most patterns.
+  EXPECT_GT(resolved, FUNCTION_COUNT / 2);
+}
@@ -0,0 +1,92 @@
+#include "decompiler/Disasm/InstructionDecode.h"
+#include "decompiler/Disasm/OpcodeInfo.h"
+#include "decompiler/ObjectFile/LinkedObjectFile.h"
+#include "gtest/gtest.h"
+#include <set>
+#include <vector>
+
+namespace {
+constexpr uint32_t OP_SHIFT = 26, RS_SHIFT = 21, RT_SHIFT = 16, SA_SHIFT = 6;
+
+void add_field_values(std::vector<uint32_t>& result, uint32_t base, uint32_t shift, int bits) {
+  for (uint32_t i = 0; i < (1u << bits); i++) {
+    result.push_back(base | (i << shift));
+  }
+}
+
+/*!
+ * Every opcode in the EE opcode map, with the operand fields zero.
+ */
+std::vector<uint32_t> all_opcode_encodings() {
+  std::vector<uint32_t> result;
+  // primary opcodes
+  add_field_values(result, 0, OP_SHIFT, 6);
+  // SPECIAL, by funct
+  add_field_values(result, 0b000000 << OP_SHIFT, 0, 6);
+  // REGIMM and CACHE, by rt
+  add_field_values(result, 0b000001 << OP_SHIFT, RT_SHIFT, 5);
+  add_field_values(result, 0b101111u << OP_SHIFT, RT_SHIFT, 5);
+  // COP1 by fmt, then BC1 by rt and S and W by funct
+  uint32_t cop1 = 0b010001 << OP_SHIFT;
+  add_field_values(result, cop1, RS_SHIFT, 5);
+  add_field_values(result, cop1 | (0b01000 << RS_SHIFT), RT_SHIFT, 5);
+  add_field_values(result, cop1 | (0b10000 << RS_SHIFT), 0, 6);
+  add_field_values(result, cop1 | (0b10100 << RS_SHIFT), 0, 6);
+  // MMI by funct, then MMI0-3 and PMFHL by sa
+  uint32_t mmi = 0b011100 << OP_SHIFT;
+  add_field_values(result, mmi, 0, 6);
+  for (uint32_t funct : {0b001000, 0b001001, 0b101000, 0b101001, 0b110000}) {
+    add_field_values(result, mmi | funct, SA_SHIFT, 5);
+  }
+  return result;
+}
+}  // namespace
+
+TEST(InstructionDecode, TablesMatchSwitchDecoder) {
+  std::set<InstructionKind> kinds;
+  for (auto code : all_opcode_encodings()) {
+    EXPECT_EQ(decode_opcode(code), decode_opcode_reference(code)) << std::hex << code;
+    kinds.insert(decode_opcode(code));
+  }
+
+  // everything up to the COP2 macro instructions comes from the tables, except for the COP0 and
+  // COP2 moves, which are decoded by function, and SYNC.P, which is picked by the sa field.
+  std::set<InstructionKind> not_in_tables = {
+      InstructionKind::MFPC,  InstructionKind::MTPC,  InstructionKind::MTC0,
+      InstructionKind::MTDAB, InstructionKind::MTDABM, InstructionKind::QMFC2,
+      InstructionKind::QMTC2, InstructionKind::CTC2,  InstructionKind::CFC2,
+      InstructionKind::SYNCP, InstructionKind::ERET,  InstructionKind::EI};
+  for (int i = 0; i < (int)InstructionKind::VMOVE; i++) {
+    auto kind = (InstructionKind)i;
+    EXPECT_TRUE(kinds.count(kind) || not_in_tables.count(kind)) << i;
+  }
+}
+
+TEST(InstructionDecode, BatchMatchesSingle) {
+  init_opcode_info();
+  SymbolNameTable symbol_names;
+  LinkedObjectFile file(&symbol_names);
+  file.set_segment_count(1);
+  std::vector<uint32_t> code = {
+      (25u << 26) | (29 << 21) | (29 << 16) | 0xfff0,  // daddiu sp, sp, -16
+      (0x23u << 26) | (23 << 21) | (3 << 16) | 0x40,   // lw v1, some-symbol(s7)
+      (4u << 26) | 2,                                  // beq r0, r0, L
+      (0b011100u << 26) | (4 << 21) | (5 << 16) | (6 << 11) | (0b01110 << 6) | 0b001001,  // pcpyld
+      (31u << 21) | 8,                                                                   // jr ra
+      0,                                                                                 // nop
+  };
+  for (auto word : code) {
+    file.push_back_word_to_segment(word, 0);
+  }
+  file.symbol_link_offset(0, 4, "some-symbol");
+
+  auto batch = decode_instructions(file, 0, 0, int(code.size()));
+  ASSERT_EQ(batch.size(), code.size());
+  for (int i = 0; i < int(code.size()); i++) {
+    auto single = decode_instruction(file.words_by_seg.at(0).at(i), file, 0, i);
+    EXPECT_TRUE(single.is_valid());
+    EXPECT_EQ(batch.at(i).to_string(file), single.to_string(file));
+  }
+  EXPECT_EQ(batch.at(1).to_string(file), "lw v1, some-symbol(s7)");
+  EXPECT_EQ(batch.at(3).to_string(file), "pcpyld a2, a0, a1");
+}
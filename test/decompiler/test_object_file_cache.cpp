@@ -0,0 +1,126 @@
+#include "decompiler/Disasm/InstructionDecode.h"
+#include "decompiler/Disasm/OpcodeInfo.h"
+#include "decompiler/ObjectFile/ObjectFileCache.h"
+#include "gtest/gtest.h"
+#include <filesystem>
+#include <string>
+#include <vector>
+
+namespace {
+/*!
+ * Make a small two segment object file: a function in segment 0, and data in segment 1 which
+ * points to it and to some symbols.
+ */
+LinkedObjectFile make_test_object(SymbolNameTable* symbol_names) {
+  LinkedObjectFile file(symbol_names);
+  file.set_segment_count(2);
+
+  std::vector<uint32_t> code = {
+      0,                                               // function type tag
+      (25u << 26) | (29 << 21) | (29 << 16) | 0xfff0,  // daddiu sp, sp, -16
+      (0x23u << 26) | (23 << 21) | (3 << 16) | 0x40,   // lw v1, some-symbol(s7)
+      (4u << 26) | 2,                                  // beq r0, r0, L
+      0,                                               // nop
+      (31u << 21) | 8,                                 // jr ra
+      0,                                               // nop
+  };
+  for (auto word : code) {
+    file.push_back_word_to_segment(word, 0);
+  }
+  file.symbol_link_word(0, 0, "function", LinkedWord::TYPE_PTR);
+  file.symbol_link_offset(0, 2 * 4, "some-symbol");
+
+  for (int i = 0; i < 4; i++) {
+    file.push_back_word_to_segment(0x1000 + i, 1);
+  }
+  file.pointer_link_word(1, 0, 0, 4);
+  file.symbol_link_word(1, 4, "some-type", LinkedWord::TYPE_PTR);
+  file.symbol_link_word(1, 8, "some-symbol", LinkedWord::SYM_PTR);
+  file.offset_of_data_zone_by_seg.at(0) = code.size();
+  file.offset_of_data_zone_by_seg.at(1) = 0;
+
+  auto& func = file.functions_by_seg.at(0).emplace_back(1, int(code.size()));
+  func.uses_fp_register = true;
+  func.instructions = decode_instructions(file, 0, func.start_word, func.end_word);
+  file.labels.at(0).name = "L-test";
+
+  file.stats.function_count = 1;
+  file.stats.code_bytes = code.size() * 4;
+  file.stats.data_bytes = 16;
+  return file;
+}
+}  // namespace
+
+TEST(ObjectFileCache, RoundTrip) {
+  init_opcode_info();
+  auto cache_dir = (std::filesystem::temp_directory_path() / "jak-object-file-cache-test").string();
+  std::filesystem::remove_all(cache_dir);
+
+  SymbolNameTable symbol_names;
+  auto file = make_test_object(&symbol_names);
+  std::vector<LinkedSymbol> symbols = {{"some-symbol", false}, {"some-type", true}};
+  ObjectFileCache(cache_dir, 123).save(0xabcd, 44, file, symbols);
+
+  // load into a table where the symbols have different ids.
+  SymbolNameTable loaded_names;
+  loaded_names.intern("unrelated-symbol");
+  LinkedObjectFile loaded;
+  std::vector<LinkedSymbol> loaded_symbols;
+  ASSERT_TRUE(
+      ObjectFileCache(cache_dir, 123).load(0xabcd, 44, loaded_names, loaded, loaded_symbols));
+
+  ASSERT_EQ(loaded.segments, file.segments);
+  EXPECT_EQ(loaded.offset_of_data_zone_by_seg, file.offset_of_data_zone_by_seg);
+  for (int seg = 0; seg < file.segments; seg++) {
+    auto& words = file.words_by_seg.at(seg);
+    auto& loaded_words = loaded.words_by_seg.at(seg);
+    ASSERT_EQ(loaded_words.size(), words.size());
+    for (size_t i = 0; i < words.size(); i++) {
+      EXPECT_EQ(loaded_words[i].data, words[i].data);
+      ASSERT_EQ(loaded_words[i].kind(), words[i].kind());
+      if (words[i].has_label()) {
+        EXPECT_EQ(loaded_words[i].label_id(), words[i].label_id());
+      } else if (words[i].has_symbol()) {
+        EXPECT_EQ(loaded.get_symbol_name(loaded_words[i]), file.get_symbol_name(words[i]));
+      }
+    }
+  }
+
+  ASSERT_EQ(loaded.labels.size(), file.labels.size());
+  for (size_t i = 0; i < file.labels.size(); i++) {
+    EXPECT_EQ(loaded.labels[i].name, file.labels[i].name);
+    EXPECT_EQ(loaded.labels[i].target_segment, file.labels[i].target_segment);
+    EXPECT_EQ(loaded.labels[i].offset, file.labels[i].offset);
+  }
+
+  auto& func = file.functions_by_seg.at(0).at(0);
+  ASSERT_EQ(loaded.functions_by_seg.at(0).size(), 1);
+  EXPECT_TRUE(loaded.functions_by_seg.at(1).empty());
+  auto& loaded_func = loaded.functions_by_seg.at(0).at(0);
+  EXPECT_EQ(loaded_func.start_word, func.start_word);
+  EXPECT_EQ(loaded_func.end_word, func.end_word);
+  EXPECT_EQ(loaded_func.uses_fp_register, func.uses_fp_register);
+  ASSERT_EQ(loaded_func.instructions.size(), func.instructions.size());
+  for (size_t i = 0; i < func.instructions.size(); i++) {
+    EXPECT_EQ(loaded_func.instructions[i].to_string(loaded), func.instructions[i].to_string(file));
+  }
+  EXPECT_EQ(loaded_func.instructions.at(1).to_string(loaded), "lw v1, some-symbol(s7)");
+
+  ASSERT_EQ(loaded_symbols.size(), symbols.size());
+  for (size_t i = 0; i < symbols.size(); i++) {
+    EXPECT_EQ(loaded_symbols[i].name, symbols[i].name);
+    EXPECT_EQ(loaded_symbols[i].is_type, symbols[i].is_type);
+  }
+
+  EXPECT_EQ(loaded.stats.function_count, 1);
+  EXPECT_EQ(loaded.stats.code_bytes, file.stats.code_bytes);
+  EXPECT_EQ(loaded.stats.data_bytes, file.stats.data_bytes);
+
+  // entries from a different config, or for a different object, aren't used.
+  EXPECT_FALSE(
+      ObjectFileCache(cache_dir, 124).load(0xabcd, 44, loaded_names, loaded, loaded_symbols));
+  EXPECT_FALSE(
+      ObjectFileCache(cache_dir, 123).load(0xabcd, 48, loaded_names, loaded, loaded_symbols));
+
+  std::filesystem::remove_all(cache_dir);
+}
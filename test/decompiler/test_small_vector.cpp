@@ -0,0 +1,89 @@
+#include "decompiler/util/SmallVector.h"
+#include "gtest/gtest.h"
+#include <utility>
+#include <vector>
+
+namespace {
+template <typename T, uint32_t N>
+std::vector<T> to_vector(const SmallVector<T, N>& v) {
+  return std::vector<T>(v.begin(), v.end());
+}
+}  // namespace
+
+TEST(SmallVector, SpillsToHeap) {
+  SmallVector<int, 4> v;
+  EXPECT_TRUE(v.empty());
+  EXPECT_EQ(v.capacity(), 4u);
+  auto inline_data = v.data();
+  for (int i = 0; i < 4; i++) {
+    v.push_back(i);
+  }
+  EXPECT_EQ(v.data(), inline_data);
+  EXPECT_EQ(v.capacity(), 4u);
+
+  v.push_back(4);
+  EXPECT_NE(v.data(), inline_data);
+  EXPECT_GE(v.capacity(), 5u);
+  for (int i = 5; i < 100; i++) {
+    v.push_back(i);
+  }
+  ASSERT_EQ(v.size(), 100u);
+  for (int i = 0; i < 100; i++) {
+    EXPECT_EQ(v[i], i);
+  }
+  EXPECT_EQ(v.front(), 0);
+  EXPECT_EQ(v.back(), 99);
+  v.pop_back();
+  EXPECT_EQ(v.back(), 98);
+}
+
+TEST(SmallVector, PushBackOwnElement) {
+  SmallVector<int, 2> v = {5, 6};
+  // the element is copied before the vector grows and frees the inline storage it was in.
+  v.push_back(v[0]);
+  v.push_back(v[2]);
+  EXPECT_EQ(to_vector(v), std::vector<int>({5, 6, 5, 5}));
+}
+
+TEST(SmallVector, Copy) {
+  SmallVector<int, 3> small = {1, 2};
+  SmallVector<int, 3> big = {1, 2, 3, 4, 5};
+
+  SmallVector<int, 3> small_copy(small);
+  SmallVector<int, 3> big_copy(big);
+  EXPECT_EQ(to_vector(small_copy), to_vector(small));
+  EXPECT_EQ(to_vector(big_copy), to_vector(big));
+  // copies don't share storage with the original.
+  EXPECT_NE(big_copy.data(), big.data());
+  big_copy[0] = 100;
+  EXPECT_EQ(big[0], 1);
+
+  // assigning over a spilled vector, in both directions.
+  big_copy = small;
+  EXPECT_EQ(to_vector(big_copy), std::vector<int>({1, 2}));
+  small_copy = big;
+  EXPECT_EQ(to_vector(small_copy), std::vector<int>({1, 2, 3, 4, 5}));
+  const auto& same = small_copy;
+  small_copy = same;
+  EXPECT_EQ(to_vector(small_copy), std::vector<int>({1, 2, 3, 4, 5}));
+}
+
+TEST(SmallVector, Move) {
+  SmallVector<int, 3> small = {1, 2};
+  SmallVector<int, 3> big = {1, 2, 3, 4, 5};
+  auto big_data = big.data();
+
+  SmallVector<int, 3> moved_small(std::move(small));
+  SmallVector<int, 3> moved_big(std::move(big));
+  EXPECT_EQ(to_vector(moved_small), std::vector<int>({1, 2}));
+  EXPECT_EQ(to_vector(moved_big), std::vector<int>({1, 2, 3, 4, 5}));
+  // a spilled vector hands over its heap storage instead of copying it.
+  EXPECT_EQ(moved_big.data(), big_data);
+  EXPECT_TRUE(small.empty());
+  EXPECT_TRUE(big.empty());
+  EXPECT_EQ(big.capacity(), 3u);
+
+  moved_small = std::move(moved_big);
+  EXPECT_EQ(to_vector(moved_small), std::vector<int>({1, 2, 3, 4, 5}));
+  EXPECT_TRUE(moved_big.empty());
+}
@@ -0,0 +1,98 @@
+#include "decompiler/data/StrFileReader.h"
+#include "game/common/overlord_common.h"
+#include "game/common/str_rpc_types.h"
+#include "gtest/gtest.h"
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace {
+// chunk sizes, in sectors.
+const std::vector<int> chunk_sectors = {2, 1, 3};
+
+/*!
+ * Make a .STR file with a header sector and a chunk for each entry of chunk_sectors. Each chunk is
+ * filled with its index + 1, and has the file info name of the "test-anim" art group in it.
+ */
+std::vector<u8> make_test_str() {
+  std::vector<u8> data(SECTOR_SIZE);
+  StrFileHeaderSector header;
+  memset(&header, 0, sizeof(header));
+  int sector = 1;
+  for (size_t i = 0; i < chunk_sectors.size(); i++) {
+    header.sectors[i] = sector;
+    header.sizes[i] = chunk_sectors[i] * SECTOR_SIZE;
+    sector += chunk_sectors[i];
+
+    std::vector<u8> chunk(chunk_sectors[i] * SECTOR_SIZE, u8(i + 1));
+    std::string info = "/src/next/data/art-group6/test-anim+" + std::to_string(i) + "-ag.go";
+    memcpy(chunk.data() + 100, info.c_str(), info.size() + 1);
+    data.insert(data.end(), chunk.begin(), chunk.end());
+  }
+  memcpy(data.data(), &header, sizeof(header));
+  return data;
+}
+
+void write_file(const std::string& name, const std::vector<u8>& data) {
+  auto fp = fopen(name.c_str(), "wb");
+  ASSERT_TRUE(fp);
+  fwrite(data.data(), 1, data.size(), fp);
+  fclose(fp);
+}
+
+std::string read_error(const std::string& file_name) {
+  try {
+    StrFileReader reader(file_name);
+  } catch (std::runtime_error& e) {
+    return e.what();
+  }
+  return "";
+}
+}  // namespace
+
+TEST(StrFileReader, ReadsChunks) {
+  auto file_name = (std::filesystem::temp_directory_path() / "TEANIM.STR").string();
+  write_file(file_name, make_test_str());
+
+  {
+    StrFileReader reader(file_name);
+    ASSERT_EQ(reader.chunk_count(), int(chunk_sectors.size()));
+    for (int i = 0; i < reader.chunk_count(); i++) {
+      auto& chunk = reader.get_chunk(i);
+      ASSERT_EQ(chunk.size, size_t(chunk_sectors.at(i) * SECTOR_SIZE));
+      // the chunk is in the mapping.
+      EXPECT_GE(chunk.data, reader.mapping()->data());
+      EXPECT_LE(chunk.data + chunk.size, reader.mapping()->data() + reader.mapping()->size());
+      EXPECT_EQ(chunk.data[0], i + 1);
+      EXPECT_EQ(chunk.data[chunk.size - 1], i + 1);
+    }
+    EXPECT_EQ(reader.get_full_name("TEANIM.STR"), "test-anim");
+    EXPECT_THROW(reader.get_full_name("OTHER.STR"), std::runtime_error);
+  }
+  std::filesystem::remove(file_name);
+}
+
+TEST(StrFileReader, TruncatedFile) {
+  auto file_name = (std::filesystem::temp_directory_path() / "TEANIM.STR").string();
+  auto data = make_test_str();
+
+  // part of a sector is missing.
+  write_file(file_name, std::vector<u8>(data.begin(), data.end() - 100));
+  EXPECT_NE(read_error(file_name).find("not a multiple of the sector size"), std::string::npos);
+
+  // the last sector of the last chunk is missing.
+  write_file(file_name, std::vector<u8>(data.begin(), data.end() - SECTOR_SIZE));
+  EXPECT_NE(read_error(file_name).find("chunk size doesn't match the sectors"), std::string::npos);
+
+  // the whole last chunk is missing.
+  write_file(file_name, std::vector<u8>(data.begin(), data.end() - 3 * SECTOR_SIZE));
+  EXPECT_NE(read_error(file_name).find("chunk with a negative size"), std::string::npos);
+
+  // no header.
+  write_file(file_name, std::vector<u8>(data.begin(), data.begin() + 100));
+  EXPECT_NE(read_error(file_name).find("missing header sector"), std::string::npos);
+  std::filesystem::remove(file_name);
+}
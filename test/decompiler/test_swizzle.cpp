@@ -0,0 +1,129 @@
+#include "decompiler/data/swizzle.h"
+#include "gtest/gtest.h"
+#include <random>
+#include <vector>
+
+namespace {
+// fill VRAM with random data, so any wrong address gives a wrong pixel.
+std::vector<u8> random_vram() {
+  std::vector<u8> vram(4 * 1024 * 1024);
+  std::mt19937 rng(12345);
+  for (auto& x : vram) {
+    x = rng();
+  }
+  return vram;
+}
+
+/*!
+ * The original per-pixel conversion, used as the golden output for read_texture.
+ */
+std::vector<u32> read_texture_per_pixel(const std::vector<u8>& vram,
+                                        PSM psm,
+                                        CPSM clutpsm,
+                                        u32 width,
+                                        u32 w,
+                                        u32 h,
+                                        u32 dest,
+                                        u32 clutdest) {
+  std::vector<u32> out;
+  for (u32 y = 0; y < h; y++) {
+    for (u32 x = 0; x < w; x++) {
+      u32 clx = 0, cly = 0;
+      if (psm == PSM::PSMT8) {
+        u8 value = vram.at(psmt8_addr(x, y, width) + dest * 256);
+        u32 clut_chunk = value / 16;
+        u32 off_in_chunk = value % 16;
+        clx = (clut_chunk & 1) ? 8 : 0;
+        cly = (clut_chunk >> 1) * 2;
+        if (off_in_chunk >= 8) {
+          off_in_chunk -= 8;
+          cly++;
+        }
+        clx += off_in_chunk;
+      } else if (psm == PSM::PSMT4) {
+        u32 addr4 = psmt4_addr_half_byte(x, y, width) + dest * 512;
+        u8 value = vram.at(addr4 / 2);
+        value = (addr4 & 1) ? (value >> 4) : (value & 0x0f);
+        clx = value & 0x7;
+        cly = value >> 3;
+      } else {
+        u32 addr = psmct16_addr(x, y, width) + dest * 256;
+        out.push_back(rgba15_to_rgba32(vram.at(addr) | (vram.at(addr + 1) << 8)));
+        continue;
+      }
+
+      if (clutpsm == CPSM::PSMCT32) {
+        u32 addr = psmct32_addr(clx, cly, 64) + clutdest * 256;
+        out.push_back(*(const u32*)(vram.data() + addr));
+      } else {
+        u32 addr = psmct16_addr(clx, cly, 64) + clutdest * 256;
+        out.push_back(rgba15_to_rgba32(*(const u16*)(vram.data() + addr)));
+      }
+    }
+  }
+  return out;
+}
+}  // namespace
+
+TEST(Swizzle, TableMatchesAddr) {
+  struct Format {
+    PSM psm;
+    u32 (*addr)(u32, u32, u32);
+  };
+  for (auto& format : {Format{PSM::PSMCT32, psmct32_addr}, Format{PSM::PSMCT16, psmct16_addr},
+                       Format{PSM::PSMT8, psmt8_addr}, Format{PSM::PSMT4, psmt4_addr_half_byte}}) {
+    for (u32 width : {64, 128, 256, 512}) {
+      for (u32 w : {8, 64, 200, 256}) {
+        u32 h = 300;
+        auto table = make_swizzle_table(format.psm, width, w, h);
+        ASSERT_EQ(table.size(), w * h);
+        for (u32 y = 0; y < h; y++) {
+          for (u32 x = 0; x < w; x++) {
+            ASSERT_EQ(table.at(x + y * w), format.addr(x, y, width));
+          }
+        }
+      }
+    }
+  }
+}
+
+TEST(Swizzle, Upload) {
+  std::vector<u32> data(128 * 96);
+  for (size_t i = 0; i < data.size(); i++) {
+    data[i] = i * 2654435761u;
+  }
+  std::vector<u8> vram(4 * 1024 * 1024);
+  upload_psmct32(vram.data(), data.data(), 128, 96);
+  for (u32 y = 0; y < 96; y++) {
+    for (u32 x = 0; x < 128; x++) {
+      EXPECT_EQ(*(u32*)(vram.data() + psmct32_addr(x, y, 128)), data.at(x + y * 128));
+    }
+  }
+}
+
+TEST(Swizzle, ReadTextureGolden) {
+  auto vram = random_vram();
+  struct Format {
+    PSM psm;
+    CPSM clutpsm;
+  };
+  for (auto& format : {Format{PSM::PSMT8, CPSM::PSMCT32}, Format{PSM::PSMT8, CPSM::PSMCT16},
+                       Format{PSM::PSMCT16, CPSM::PSMCT32}, Format{PSM::PSMT4, CPSM::PSMCT32},
+                       Format{PSM::PSMT4, CPSM::PSMCT16}}) {
+    for (u32 width : {64, 128, 256}) {
+      for (u32 w : {16, 64, 100}) {
+        u32 h = 70;
+        u32 dest = 37;
+        u32 clutdest = 1000;
+        std::vector<u32> out;
+        ASSERT_TRUE(read_texture(vram.data(), int(format.psm), int(format.clutpsm), width, w, h,
+                                 dest, clutdest, &out));
+        EXPECT_EQ(out, read_texture_per_pixel(vram, format.psm, format.clutpsm, width, w, h, dest,
+                                              clutdest));
+      }
+    }
+  }
+
+  std::vector<u32> out;
+  EXPECT_FALSE(read_texture(vram.data(), int(PSM::PSMCT32), 0, 64, 8, 8, 0, 0, &out));
+}
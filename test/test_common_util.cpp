@@ -1,5 +1,13 @@
+#include "common/util/Deflate.h"
 #include "common/util/FileUtil.h"
+#include "common/util/MappedFile.h"
+#include "common/util/ThreadPool.h"
 #include "gtest/gtest.h"
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <stdexcept>
 #include <string>
 #include <vector>
 
@@ -10,3 +18,331 @@ TEST(FileUtil, valid_path) {
 
   EXPECT_TRUE(true);
 }
+
+TEST(FileUtil, GlobMatch) {
+  EXPECT_TRUE(file_util::glob_match("gkernel", "gkernel"));
+  EXPECT_FALSE(file_util::glob_match("gkernel", "gkernel-h"));
+  EXPECT_TRUE(file_util::glob_match("gkernel*", "gkernel-h"));
+  EXPECT_TRUE(file_util::glob_match("*", ""));
+  EXPECT_FALSE(file_util::glob_match("?", ""));
+  EXPECT_TRUE(file_util::glob_match("g?ernel", "gkernel"));
+  EXPECT_TRUE(file_util::glob_match("*-h", "gkernel-h"));
+  EXPECT_FALSE(file_util::glob_match("*-h", "gkernel-h2"));
+  EXPECT_TRUE(file_util::glob_match("*a*b*c", "xaxxbxbxxc"));
+  EXPECT_FALSE(file_util::glob_match("*a*b*c", "xaxxbxbxxcd"));
+  EXPECT_TRUE(file_util::glob_match("(method * process)", "(method 10 process)"));
+
+  EXPECT_TRUE(file_util::glob_match_any({"gstate", "gkernel*"}, "gkernel-h"));
+  EXPECT_FALSE(file_util::glob_match_any({"gstate", "gkernel"}, "gkernel-h"));
+  EXPECT_FALSE(file_util::glob_match_any({}, "gkernel"));
+}
+
+TEST(ThreadPool, ParallelFor) {
+  for (int threads : {1, 4}) {
+    ThreadPool pool(threads);
+    std::vector<int> result(1000);
+    pool.parallel_for(result.size(), [&](size_t i) { result.at(i) = int(i) * 2; });
+    for (int i = 0; i < int(result.size()); i++) {
+      EXPECT_EQ(result.at(i), i * 2);
+    }
+  }
+}
+
+TEST(ThreadPool, NestedParallelFor) {
+  ThreadPool pool(4);
+  std::atomic<int> total = 0;
+  pool.parallel_for(10, [&](size_t) { pool.parallel_for(10, [&](size_t) { total++; }); });
+  EXPECT_EQ(total, 100);
+}
+
+TEST(ThreadPool, RunAndWait) {
+  ThreadPool pool(3);
+  std::atomic<int> total = 0;
+  for (int i = 0; i < 100; i++) {
+    pool.run([&]() { total++; });
+  }
+  pool.wait();
+  EXPECT_EQ(total, 100);
+}
+
+TEST(ThreadPool, Exceptions) {
+  for (int threads : {1, 4}) {
+    ThreadPool pool(threads);
+    EXPECT_THROW(pool.parallel_for(10,
+                                   [&](size_t i) {
+                                     if (i == 5) {
+                                       throw std::runtime_error("bad");
+                                     }
+                                   }),
+                 std::runtime_error);
+    pool.run([]() { throw std::runtime_error("bad"); });
+    EXPECT_THROW(pool.wait(), std::runtime_error);
+    // the exception is only reported once.
+    pool.wait();
+  }
+}
+
+TEST(MappedFile, MatchesRead) {
+  auto path = file_util::get_file_path({"test", "test_data", "test_reader_file0.gc"});
+  MappedFile mapping(path);
+  auto data = file_util::read_binary_file(path);
+  ASSERT_EQ(mapping.size(), data.size());
+  EXPECT_EQ(0, memcmp(mapping.data(), data.data(), data.size()));
+}
+
+TEST(MappedFile, MissingFile) {
+  EXPECT_THROW(MappedFile(file_util::get_file_path({"test", "test_data", "not-a-file"})),
+               std::runtime_error);
+}
+
+namespace {
+/*!
+ * A simple, slow inflate, to check the output of the compressor.
+ */
+class Inflater {
+ public:
+  explicit Inflater(const std::vector<u8>& in) : m_in(in) {}
+
+  std::vector<u8> inflate_zlib() {
+    EXPECT_EQ(0, ((m_in.at(0) << 8) | m_in.at(1)) % 31);
+    m_pos = 16;
+    std::vector<u8> out;
+    bool last = false;
+    while (!last) {
+      last = bits(1);
+      int type = bits(2);
+      if (type == 0) {
+        m_pos = (m_pos + 7) & ~7;
+        u32 len = bits(16);
+        EXPECT_EQ(len, bits(16) ^ 0xffff);
+        for (u32 i = 0; i < len; i++) {
+          out.push_back(bits(8));
+        }
+        continue;
+      }
+
+      std::vector<int> litlen, dist;
+      if (type == 1) {
+        for (int i = 0; i < 288; i++) {
+          litlen.push_back(i < 144 ? 8 : i < 256 ? 9 : i < 280 ? 7 : 8);
+        }
+        dist.resize(30, 5);
+      } else {
+        EXPECT_EQ(2, type);
+        int hlit = bits(5) + 257, hdist = bits(5) + 1, hclen = bits(4) + 4;
+        const int order[19] = {16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15};
+        std::vector<int> codelen(19, 0);
+        for (int i = 0; i < hclen; i++) {
+          codelen[order[i]] = bits(3);
+        }
+        auto codelen_code = make_code(codelen);
+        std::vector<int> lengths;
+        while (int(lengths.size()) < hlit + hdist) {
+          int sym = decode(codelen_code);
+          if (sym < 16) {
+            lengths.push_back(sym);
+          } else if (sym == 16) {
+            lengths.insert(lengths.end(), 3 + bits(2), lengths.at(lengths.size() - 1));
+          } else {
+            lengths.insert(lengths.end(), sym == 17 ? 3 + bits(3) : 11 + bits(7), 0);
+          }
+        }
+        litlen.assign(lengths.begin(), lengths.begin() + hlit);
+        dist.assign(lengths.begin() + hlit, lengths.end());
+      }
+
+      const int length_base[29] = {3,  4,  5,  6,  7,  8,  9,  10,  11,  13,  15,  17,  19,  23, 27,
+                                   31, 35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258};
+      auto litlen_code = make_code(litlen);
+      auto dist_code = make_code(dist);
+      while (true) {
+        int sym = decode(litlen_code);
+        if (sym < 256) {
+          out.push_back(sym);
+        } else if (sym == 256) {
+          break;
+        } else {
+          sym -= 257;
+          int extra = sym < 8 || sym == 28 ? 0 : (sym - 4) / 4;
+          int len = length_base[sym] + bits(extra);
+          int dist_sym = decode(dist_code);
+          int dist_extra = dist_sym < 4 ? 0 : (dist_sym - 2) / 2;
+          int dist_base = dist_sym < 4 ? dist_sym + 1 : ((2 + (dist_sym & 1)) << dist_extra) + 1;
+          int d = dist_base + bits(dist_extra);
+          EXPECT_LE(d, int(out.size()));
+          for (int i = 0; i < len; i++) {
+            out.push_back(out.at(out.size() - d));
+          }
+        }
+      }
+    }
+
+    m_pos = (m_pos + 7) & ~7;
+    u32 check = 0;
+    for (int i = 0; i < 4; i++) {
+      check = (check << 8) | bits(8);
+    }
+    EXPECT_EQ(check, deflate::adler32(out.data(), out.size()));
+    EXPECT_EQ(m_pos / 8, m_in.size());
+    return out;
+  }
+
+ private:
+  struct HuffmanCode {
+    int count[16] = {0};
+    std::vector<int> symbols;
+  };
+
+  HuffmanCode make_code(const std::vector<int>& lengths) {
+    HuffmanCode code;
+    for (int len = 1; len < 16; len++) {
+      for (int sym = 0; sym < int(lengths.size()); sym++) {
+        if (lengths[sym] == len) {
+          code.count[len]++;
+          code.symbols.push_back(sym);
+        }
+      }
+    }
+    return code;
+  }
+
+  int decode(const HuffmanCode& huff) {
+    int code = 0, first = 0, index = 0;
+    for (int len = 1; len < 16; len++) {
+      code |= bits(1);
+      if (code - huff.count[len] < first) {
+        return huff.symbols.at(index + code - first);
+      }
+      index += huff.count[len];
+      first = (first + huff.count[len]) << 1;
+      code <<= 1;
+    }
+    throw std::runtime_error("bad code");
+  }
+
+  u32 bits(int count) {
+    u32 result = 0;
+    for (int i = 0; i < count; i++, m_pos++) {
+      result |= ((m_in.at(m_pos / 8) >> (m_pos % 8)) & 1) << i;
+    }
+    return result;
+  }
+
+  const std::vector<u8>& m_in;
+  size_t m_pos = 0;
+};
+
+/*!
+ * Reverse the PNG row filters of an RGBA image, returning the pixels.
+ */
+std::vector<u8> unfilter_png_rows(const std::vector<u8>& filtered, int w, int h) {
+  size_t row_size = w * 4;
+  std::vector<u8> result(row_size * h);
+  for (int y = 0; y < h; y++) {
+    const u8* in = &filtered.at((row_size + 1) * y);
+    u8* row = &result.at(row_size * y);
+    const u8* prev = y ? row - row_size : nullptr;
+    for (size_t x = 0; x < row_size; x++) {
+      int a = x >= 4 ? row[x - 4] : 0;
+      int b = prev ? prev[x] : 0;
+      int c = x >= 4 && prev ? prev[x - 4] : 0;
+      int predicted = 0;
+      switch (in[0]) {
+        case 0:
+          break;
+        case 1:
+          predicted = a;
+          break;
+        case 2:
+          predicted = b;
+          break;
+        case 3:
+          predicted = (a + b) / 2;
+          break;
+        case 4: {
+          int pa = std::abs(b - c), pb = std::abs(a - c), pc = std::abs(a + b - 2 * c);
+          predicted = (pa <= pb && pa <= pc) ? a : (pb <= pc ? b : c);
+        } break;
+        default:
+          throw std::runtime_error("bad png filter type");
+      }
+      row[x] = u8(in[x + 1] + predicted);
+    }
+  }
+  return result;
+}
+}  // namespace
+
+TEST(Deflate, Checksums) {
+  const char* text = "123456789";
+  EXPECT_EQ(0xcbf43926, deflate::zlib_crc32((const u8*)text, strlen(text)));
+  const char* wiki = "Wikipedia";
+  EXPECT_EQ(0x11e60398, deflate::adler32((const u8*)wiki, strlen(wiki)));
+}
+
+TEST(Deflate, RoundTrip) {
+  std::mt19937 rng(1234);
+  for (size_t size : {0, 1, 2, 3, 100, 20000, 70000, 200000}) {
+    std::vector<std::vector<u8>> inputs(4, std::vector<u8>(size));
+    for (size_t i = 0; i < size; i++) {
+      inputs[0][i] = rng();                        // random, stored blocks
+      inputs[1][i] = (i / 7) % 5;                  // long matches
+      inputs[2][i] = "abcabcabdabcx"[rng() % 13];  // short matches, dynamic blocks
+      inputs[3][i] = i % 4 ? 0 : rng() % 3;        // mostly zero
+    }
+    for (auto& input : inputs) {
+      for (auto level : {deflate::Level::STORED, deflate::Level::FAST, deflate::Level::BEST}) {
+        auto compressed = deflate::zlib_compress(input.data(), input.size(), level);
+        EXPECT_EQ(input, Inflater(compressed).inflate_zlib());
+      }
+    }
+  }
+}
+
+TEST(FileUtil, EncodePng) {
+  int w = 37, h = 20;
+  std::vector<u32> pixels(w * h);
+  for (int i = 0; i < w * h; i++) {
+    pixels[i] = 0xff000000 | (i % w) * 3 | ((i / w) << 8);
+  }
+  size_t previous_size = SIZE_MAX;
+  for (auto level : {deflate::Level::STORED, deflate::Level::FAST, deflate::Level::BEST}) {
+    auto png = file_util::encode_rgba_png(pixels.data(), w, h, level);
+    const u8 signature[8] = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1a, '\n'};
+    ASSERT_EQ(0, memcmp(png.data(), signature, 8));
+
+    // IHDR, IDAT, IEND, each with a correct CRC.
+    auto read_u32 = [&](size_t at) {
+      u32 result = 0;
+      for (int i = 0; i < 4; i++) {
+        result = (result << 8) | png.at(at + i);
+      }
+      return result;
+    };
+    std::vector<u8> idat;
+    size_t pos = 8;
+    for (const char* type : {"IHDR", "IDAT", "IEND"}) {
+      u32 len = read_u32(pos);
+      EXPECT_EQ(0, memcmp(&png.at(pos + 4), type, 4));
+      EXPECT_EQ(read_u32(pos + len + 8), deflate::zlib_crc32(&png.at(pos + 4), len + 4));
+      if (std::string(type) == "IDAT") {
+        idat.assign(png.begin() + pos + 8, png.begin() + pos + 8 + len);
+      }
+      pos += len + 12;
+    }
+    EXPECT_EQ(pos, png.size());
+
+    // each row is a filter type and the filtered pixels.
+    auto filtered = Inflater(idat).inflate_zlib();
+    ASSERT_EQ(filtered.size(), size_t(w * 4 + 1) * h);
+    if (level == deflate::Level::STORED) {
+      for (int y = 0; y < h; y++) {
+        EXPECT_EQ(0, filtered.at(y * (w * 4 + 1)));
+      }
+    }
+    auto unfiltered = unfilter_png_rows(filtered, w, h);
+    EXPECT_EQ(0, memcmp(unfiltered.data(), pixels.data(), w * h * 4));
+    EXPECT_LT(png.size(), previous_size);
+    previous_size = png.size();
+  }
+}
@@ -855,6 +855,25 @@ TEST(GoosIntegrated, WhileLoop) {
             "4950");
 }
 
+TEST(GoosIntegrated, TailCalls) {
+  Interpreter i;
+  // calls in tail position, through if/cond and macros, don't use up the stack.
+  e(i, "(desfun count-down (n acc) (if (= n 0) acc (count-down (- n 1) (cons n acc))))");
+  EXPECT_EQ(e(i, "(car (count-down 100000 '()))"), "1");
+
+  e(i, "(defsmacro count-down-macro (n) `(count-down ,n '()))");
+  e(i, "(desfun even-length? (l) (cond ((null? l) #t) (#t (odd-length? (cdr l)))))");
+  e(i, "(desfun odd-length? (l) (cond ((null? l) #f) (#t (even-length? (cdr l)))))");
+  EXPECT_EQ(e(i, "(even-length? (count-down-macro 100000))"), "#t");
+
+  // other recursion gives an error instead of overflowing the stack.
+  e(i, "(desfun count-up (n) (if (= n 0) 0 (+ 1 (count-up (- n 1)))))");
+  EXPECT_EQ(e(i, "(count-up 1000)"), "1000");
+  i.disable_printfs();
+  EXPECT_ANY_THROW(e(i, "(count-up 100000)"));
+  EXPECT_EQ(e(i, "(count-up 1000)"), "1000");
+}
+
 TEST(GoosLib, Desfun) {
   Interpreter i;
   EXPECT_EQ(e(i, R"(
@@ -959,8 +978,8 @@ TEST(GoosObject, EmptyList) {
   EXPECT_TRUE(nil == nil2);
 
   // check we get the same heap allocated object
-  auto elo = std::dynamic_pointer_cast<EmptyListObject>(nil.heap_obj);
-  auto elo2 = std::dynamic_pointer_cast<EmptyListObject>(nil2.heap_obj);
+  auto elo = dynamic_cast<EmptyListObject*>(nil.heap_obj.get());
+  auto elo2 = dynamic_cast<EmptyListObject*>(nil2.heap_obj.get());
   EXPECT_TRUE(elo);
   EXPECT_TRUE(elo == elo2);
 
@@ -1141,6 +1160,13 @@ TEST(GoosObject, PairList) {
   EXPECT_EQ(obj.print(), "(1 2 3)");
   EXPECT_TRUE(obj == obj3);
   EXPECT_FALSE(obj == obj2);
+
+  // freeing a long list shouldn't recurse once per element.
+  Object long_list = EmptyListObject::make_new();
+  for (int i = 0; i < 1000000; i++) {
+    long_list = PairObject::make_new(Object::make_integer(i), long_list);
+  }
+  long_list = Object();
 }
 
 /*!
@@ -1186,6 +1212,11 @@ TEST(GoosSpecialForms, Define) {
   e(i, "(begin (desfun test-define () (define x 500)) (test-define))");
   EXPECT_EQ(e(i, "x"), "10");
 
+  // define a new variable next to the arguments, then use and set both.
+  EXPECT_EQ(e(i, "(begin (desfun test-define (a) (define b (+ a 1)) (set! a 5) (+ a b)) "
+                 "(test-define 1))"),
+            "7");
+
   // test manual setting of global env for define
   e(i, "(begin (desfun test-define () (define :env *global-env* x 500)) (test-define))");
   EXPECT_EQ(e(i, "x"), "500");
@@ -1299,4 +1330,24 @@ TEST(GoosBuiltins, Format) {
 TEST(GoosBuiltins, Error) {
   Interpreter i;
   EXPECT_ANY_THROW(e(i, "(error \"hi\")"));
-}
\ No newline at end of file
+}
+TEST(GoosHeap, CollectGarbage) {
+  Interpreter i;
+  e(i, "(define x '(1 2 (3 4) \"five\"))");
+  e(i, "(desfun add-x (a) (+ a (car x)))");
+  e(i, "(defsmacro twice (y) `(* 2 ,y))");
+  for (int j = 0; j < 100; j++) {
+    e(i, "'(1 2 3 4 5 6 7 8)");
+  }
+
+  // only the garbage is freed, and the rest can still be used.
+  auto count = heap_object_count();
+  auto freed = collect_garbage();
+  EXPECT_EQ(heap_object_count(), count - freed);
+#ifdef GOOS_GC_HEAP
+  EXPECT_TRUE(freed >= 100 * 8);
+#endif
+  EXPECT_EQ(e(i, "x"), "(1 2 (3 4) \"five\")");
+  EXPECT_EQ(e(i, "(add-x 2)"), "3");
+  EXPECT_EQ(e(i, "(twice 4)"), "8");
+}
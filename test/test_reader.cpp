@@ -7,6 +7,7 @@
 #include "gtest/gtest.h"
 #include "common/goos/Reader.h"
 #include "common/util/FileUtil.h"
+#include "common/util/ThreadPool.h"
 
 using namespace goos;
 
@@ -353,4 +354,34 @@ TEST(GoosReader, TextDb) {
                          file_util::get_file_path({"test", "test_data", "test_reader_file0.gc"}) +
                          ", line: 5\n(1 2 3 4)\n";
   EXPECT_EQ(expected, reader.db.get_info_for(result));
+
+  // forms that were freed are forgotten, but the ones still alive keep their text.
+  for (int i = 0; i < 5000; i++) {
+    reader.read_from_string("(a (b c) d)");
+  }
+  EXPECT_EQ(expected, reader.db.get_info_for(result));
+}
+
+TEST(GoosReader, ReadFilesInParallel) {
+  std::vector<std::vector<std::string>> files;
+  for (int i = 0; i < 20; i++) {
+    files.push_back({"test", "test_data", "test_reader_file0.gc"});
+    files.push_back({"goal_src", "goos-lib.gs"});
+  }
+
+  Reader serial_reader;
+  Reader reader;
+  ThreadPool pool(4);
+  auto results = reader.read_from_files(files, pool);
+  ASSERT_EQ(results.size(), files.size());
+  for (size_t i = 0; i < files.size(); i++) {
+    EXPECT_EQ(results.at(i).print(), serial_reader.read_from_file(files.at(i)).print());
+  }
+
+  // all files share the same symbols.
+  auto first = results.at(1).as_pair()->cdr.as_pair()->car.as_pair()->car;
+  auto second = results.at(3).as_pair()->cdr.as_pair()->car.as_pair()->car;
+  EXPECT_EQ(first.print(), "define");
+  EXPECT_TRUE(first.as_symbol() == second.as_symbol());
+  EXPECT_TRUE(first.as_symbol() == reader.symbolTable.intern("define"));
 }
@@ -79,6 +79,25 @@ TEST(TypeSystem, TypeSpecEquality) {
   EXPECT_FALSE(pointer_to_string == pointer_to_function);
 }
 
+TEST(TypeSystem, TypeSpecInterning) {
+  // typespecs built in different ways should be the same typespec
+  TypeSpec built("function");
+  built.add_arg(TypeSpec("string"));
+  built.add_arg(TypeSpec("pointer", {TypeSpec("int32")}));
+  TypeSpec direct("function", {TypeSpec("string"), TypeSpec("pointer", {TypeSpec("int32")})});
+  EXPECT_EQ(built, direct);
+  EXPECT_EQ(built.id(), direct.id());
+  EXPECT_EQ(built.print(), "(function string (pointer int32))");
+  EXPECT_EQ(built.get_arg(1).get_single_arg(), TypeSpec("int32"));
+
+  // and different typespecs should differ
+  EXPECT_NE(TypeSpec("pointer", {TypeSpec("int32")}), TypeSpec("pointer"));
+  EXPECT_NE(TypeSpec("pointer", {TypeSpec("int32")}).id(), TypeSpec("pointer").id());
+  EXPECT_EQ(TypeSpec(), TypeSpec());
+  EXPECT_EQ(TypeSpec().base_type(), "");
+  EXPECT_EQ(TypeSpec().arg_count(), 0);
+}
+
 TEST(TypeSystem, RuntimeTypes) {
   TypeSystem ts;
   ts.add_builtin_types();
@@ -317,6 +336,73 @@ TEST(TypeSystem, lca) {
             "(pointer object)");
 }
 
+TEST(TypeSystem, HierarchyOfNewTypes) {
+  TypeSystem ts;
+  ts.add_builtin_types();
+  ts.add_type("test-1", std::make_unique<BasicType>("basic", "test-1"));
+  ts.add_type("test-2", std::make_unique<BasicType>("test-1", "test-2"));
+  ts.add_type("test-3", std::make_unique<BasicType>("test-1", "test-3"));
+  ts.add_type("test-4", std::make_unique<BasicType>("test-3", "test-4"));
+  ts.forward_declare_type_as_basic("test-5");
+
+  EXPECT_EQ(ts.get_path_up_tree("test-4"),
+            std::vector<std::string>(
+                {"test-4", "test-3", "test-1", "basic", "structure", "object"}));
+  EXPECT_EQ(
+      ts.lowest_common_ancestor(ts.make_typespec("test-2"), ts.make_typespec("test-4")).print(),
+      "test-1");
+  EXPECT_EQ(
+      ts.lowest_common_ancestor(ts.make_typespec("test-4"), ts.make_typespec("test-3")).print(),
+      "test-3");
+  EXPECT_EQ(
+      ts.lowest_common_ancestor(ts.make_typespec("test-4"), ts.make_typespec("string")).print(),
+      "basic");
+
+  EXPECT_TRUE(ts.typecheck(ts.make_typespec("test-1"), ts.make_typespec("test-4")));
+  EXPECT_TRUE(ts.typecheck(ts.make_typespec("structure"), ts.make_typespec("test-4")));
+  EXPECT_FALSE(ts.typecheck(ts.make_typespec("test-2"), ts.make_typespec("test-4"), "", false,
+                            false));
+  EXPECT_FALSE(ts.typecheck(ts.make_typespec("test-4"), ts.make_typespec("test-1"), "", false,
+                            false));
+
+  // forward declared as a basic, so it's at least a basic.
+  EXPECT_TRUE(ts.typecheck(ts.make_typespec("basic"), ts.make_typespec("test-5")));
+  EXPECT_FALSE(ts.typecheck(ts.make_typespec("test-1"), ts.make_typespec("test-5"), "", false,
+                            false));
+}
+
+TEST(TypeSystem, RedefineParentRebuildsHierarchy) {
+  TypeSystem ts;
+  ts.add_builtin_types();
+  ts.set_allow_redefinition(true);
+  ts.add_type("test-1", std::make_unique<BasicType>("basic", "test-1"));
+  ts.add_type("test-2", std::make_unique<BasicType>("test-1", "test-2"));
+  ts.add_type("test-3", std::make_unique<BasicType>("test-1", "test-3"));
+  ts.add_type("test-4", std::make_unique<BasicType>("test-3", "test-4"));
+
+  // move test-3, and test-4 with it, under test-2.
+  ts.add_type("test-3", std::make_unique<BasicType>("test-2", "test-3"));
+  EXPECT_EQ(ts.get_path_up_tree("test-4"),
+            std::vector<std::string>(
+                {"test-4", "test-3", "test-2", "test-1", "basic", "structure", "object"}));
+  EXPECT_EQ(
+      ts.lowest_common_ancestor(ts.make_typespec("test-2"), ts.make_typespec("test-4")).print(),
+      "test-2");
+  EXPECT_TRUE(ts.typecheck(ts.make_typespec("test-2"), ts.make_typespec("test-4")));
+  EXPECT_TRUE(ts.typecheck(ts.make_typespec("test-1"), ts.make_typespec("test-4")));
+
+  // move test-3 out from under test-1 entirely.
+  ts.add_type("test-3", std::make_unique<BasicType>("basic", "test-3"));
+  EXPECT_EQ(ts.get_path_up_tree("test-4"),
+            std::vector<std::string>({"test-4", "test-3", "basic", "structure", "object"}));
+  EXPECT_EQ(
+      ts.lowest_common_ancestor(ts.make_typespec("test-2"), ts.make_typespec("test-4")).print(),
+      "basic");
+  EXPECT_FALSE(ts.typecheck(ts.make_typespec("test-1"), ts.make_typespec("test-4"), "", false,
+                            false));
+  EXPECT_TRUE(ts.typecheck(ts.make_typespec("test-3"), ts.make_typespec("test-4")));
+}
+
 TEST(TypeSystem, DecompLookupsTypeOfBasic) {
   TypeSystem ts;
   ts.add_builtin_types();